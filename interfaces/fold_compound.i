@@ -77,6 +77,28 @@ typedef struct {} vrna_fold_compound_t;
     return $self->length;
   }
 
+  /* enable/disable per-phase instrumentation */
+  int timing(int status = 1){
+    return vrna_fold_compound_timing($self, status);
+  }
+
+  /* per-phase measurements as JSON string (empty if instrumentation is disabled) */
+  std::string timing_json(){
+    std::string out;
+    char        *json = vrna_timing_to_json($self->timing);
+
+    if (json) {
+      out = json;
+      free(json);
+    }
+
+    return out;
+  }
+
+  void timing_reset(){
+    vrna_timing_reset($self->timing);
+  }
+
 }
 
 
@@ -390,6 +390,13 @@ char *my_circalifold(std::vector<std::string> alignment, char *constraints, floa
 
 %clear  float *energy;
 
+/* the raw batch interface requires caller-provided structure buffers */
+%ignore vrna_mfe_batch;
+
+/* prefix predictions return raw arrays or use C callbacks */
+%ignore vrna_mfe_prefix;
+%ignore vrna_mfe_prefix_cb;
+
 %include  <ViennaRNA/mfe.h>
 
 
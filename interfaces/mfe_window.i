@@ -34,6 +34,9 @@
 %ignore vrna_aliLfold;
 %ignore vrna_aliLfold_cb;
 
+/* fold_compound.mfe() dispatches to banded predictions automatically */
+%ignore vrna_mfe_banded;
+
 #ifdef VRNA_WITH_SVM
 %rename (Lfoldz)    my_Lfoldz;
 #endif
@@ -127,6 +127,8 @@ typedef struct {
 %ignore copy_pf_param;
 %ignore set_pf_param;
 
+%rename(params_cache_clear) vrna_params_cache_clear;
+
 %include <ViennaRNA/params/basic.h>
 
 
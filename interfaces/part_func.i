@@ -79,6 +79,9 @@ char *my_pf_circ_fold(char *string, float *OUTPUT);
 %ignore expLoopEnergy;
 %ignore assign_plist_gquad_from_pr;
 
+/* fold_compound.pf() dispatches to banded predictions automatically */
+%ignore vrna_pf_banded;
+
 /* tell swig that these functions return objects that require memory management */
 %newobject vrna_fold_compound_t::pf;
 
@@ -128,6 +131,10 @@ char *my_pf_circ_fold(char *string, float *OUTPUT);
   }
 }
 
+/* prefix predictions return raw arrays or use C callbacks */
+%ignore vrna_pf_prefix;
+%ignore vrna_pf_prefix_cb;
+
 %include  <ViennaRNA/part_func.h>
 %include  <ViennaRNA/equilibrium_probs.h>
 
@@ -114,6 +114,7 @@ my_path_options_findpath(int          width = 10,
 
 std::vector<vrna_path_t> my_get_path(std::string seq, std::string s1, std::string s2, int maxkeep);
 %ignore get_path;
+%ignore vrna_path_findpath_saddle_matrix;
 
 /**********************************************/
 
@@ -178,6 +179,38 @@ std::vector<vrna_path_t> my_get_path(std::string seq, std::string s1, std::strin
       return v;
   }
 
+#ifdef SWIGPYTHON
+%feature("autodoc") path_findpath_saddle_matrix;
+%feature("kwargs") path_findpath_saddle_matrix;
+#endif
+
+  std::vector<std::vector<int> >
+  path_findpath_saddle_matrix(std::vector<std::string>  structures,
+                              int                       width   = 1,
+                              int                       maxE    = INT_MAX - 1,
+                              unsigned int              options = VRNA_PATH_SADDLE_MATRIX_DEFAULT)
+  {
+    std::vector<std::vector<int> >  m;
+    std::vector<const char *>       v;
+    int                             *matrix, n;
+
+    /* convert std::vector<std::string> to vector<const char *> */
+    std::transform(structures.begin(), structures.end(), std::back_inserter(v), convert_vecstring2veccharcp);
+    v.push_back(NULL); /* mark end of structures */
+
+    n       = (int)structures.size();
+    matrix  = vrna_path_findpath_saddle_matrix($self, (const char **)&v[0], width, maxE, options);
+
+    if (matrix) {
+      for (int i = 0; i < n; i++)
+        m.push_back(std::vector<int>(matrix + n * i, matrix + n * (i + 1)));
+
+      free(matrix);
+    }
+
+    return m;
+  }
+
 #ifdef SWIGPYTHON
 %feature("autodoc") path_direct;
 %feature("kwargs") path_direct;
@@ -225,6 +258,8 @@ std::vector<vrna_path_t> my_get_path(std::string seq, std::string s1, std::strin
 
 %constant unsigned int PATH_TYPE_DOT_BRACKET  = VRNA_PATH_TYPE_DOT_BRACKET;
 %constant unsigned int PATH_TYPE_MOVES        = VRNA_PATH_TYPE_MOVES;
+%constant unsigned int PATH_SADDLE_MATRIX_DEFAULT    = VRNA_PATH_SADDLE_MATRIX_DEFAULT;
+%constant unsigned int PATH_SADDLE_MATRIX_NO_BOUNDS  = VRNA_PATH_SADDLE_MATRIX_NO_BOUNDS;
 
 %include <ViennaRNA/landscape/paths.h>
 %include <ViennaRNA/landscape/findpath.h>
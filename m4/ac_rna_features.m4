@@ -430,7 +430,7 @@ into the executables are present!
 AC_DEFUN([RNA_ENABLE_SIMD],[
 
   RNA_ADD_FEATURE([simd],
-                  [Speed-up MFE computations using explicit SIMD instructions.],
+                  [Speed-up MFE and partition function computations using explicit SIMD instructions.],
                   [yes])
 
   RNA_ADD_FEATURE([sse],
@@ -487,6 +487,37 @@ Please consider using the successor option --enable-simd instead.
     AC_LANG_POP([C])
     CFLAGS="$ac_save_CFLAGS"
 
+    AC_MSG_CHECKING([compiler support for AVX 2 instructions])
+
+    ac_save_CFLAGS="$CFLAGS"
+    CFLAGS="$ac_save_CFLAGS -Werror -mavx2"
+    AC_LANG_PUSH([C])
+
+    AC_COMPILE_IFELSE(
+    [
+      AC_LANG_PROGRAM([[
+                        #include <immintrin.h>
+                        #include <limits.h>
+                      ]],
+                        [[__m256i a = _mm256_set1_epi32(INT_MAX);
+                          __m256i b = _mm256_set1_epi32(INT_MIN);
+                          __m256i mask = _mm256_cmpgt_epi32(a, b);
+                          b = _mm256_blendv_epi8(a, _mm256_min_epi32(a, b), mask);
+                      ]])
+    ],
+    [
+      AC_MSG_RESULT([yes])
+      AC_DEFINE([VRNA_WITH_SIMD_AVX2], [1], [use AVX 2 implementations])
+      ac_simd_capability_avx2=yes
+      SIMD_AVX2_FLAGS="-mavx2"
+    ],
+    [
+      AC_MSG_RESULT([no])
+    ])
+
+    AC_LANG_POP([C])
+    CFLAGS="$ac_save_CFLAGS"
+
     AC_MSG_CHECKING([compiler support for SSE 4.1 instructions])
 
     ac_save_CFLAGS="$CFLAGS"
@@ -516,12 +547,45 @@ Please consider using the successor option --enable-simd instead.
 
     AC_LANG_POP([C])
     CFLAGS="$ac_save_CFLAGS"
+
+    AC_MSG_CHECKING([compiler support for SSE 2 instructions])
+
+    ac_save_CFLAGS="$CFLAGS"
+    CFLAGS="$ac_save_CFLAGS -Werror -msse2"
+    AC_LANG_PUSH([C])
+
+    AC_COMPILE_IFELSE(
+    [
+      AC_LANG_PROGRAM([[
+                        #include <emmintrin.h>
+                      ]],
+                        [[__m128d a = _mm_set1_pd(1.);
+                          __m128d b = _mm_set1_pd(2.);
+                          a = _mm_add_pd(a, _mm_mul_pd(a, _mm_shuffle_pd(b, b, 1)));
+                      ]])
+    ],
+    [
+      AC_MSG_RESULT([yes])
+      AC_DEFINE([VRNA_WITH_SIMD_SSE2], [1], [use SSE 2 implementations])
+      ac_simd_capability_sse2=yes
+      SIMD_SSE2_FLAGS="-msse2"
+    ],
+    [
+      AC_MSG_RESULT([no])
+    ])
+
+    AC_LANG_POP([C])
+    CFLAGS="$ac_save_CFLAGS"
   ])
 
   AC_SUBST(SIMD_AVX512_FLAGS)
+  AC_SUBST(SIMD_AVX2_FLAGS)
   AC_SUBST(SIMD_SSE41_FLAGS)
+  AC_SUBST(SIMD_SSE2_FLAGS)
   AM_CONDITIONAL(VRNA_AM_SWITCH_SIMD_AVX512, test "x$ac_simd_capability_avx512f" = "xyes")
+  AM_CONDITIONAL(VRNA_AM_SWITCH_SIMD_AVX2, test "x$ac_simd_capability_avx2" = "xyes")
   AM_CONDITIONAL(VRNA_AM_SWITCH_SIMD_SSE41, test "x$ac_simd_capability_sse41" = "xyes")
+  AM_CONDITIONAL(VRNA_AM_SWITCH_SIMD_SSE2, test "x$ac_simd_capability_sse2" = "xyes")
 ])
 
 
@@ -53,8 +53,14 @@ static baum *rl = NULL;         /* ringlist */
 static baum *wurzl = NULL;      /* virtualroot of ringlist-tree */
 static char **ptype = NULL;
 
+#ifdef _OPENMP
+/* each thread simulates its own trajectories on its own ringlist-tree */
+#pragma omp threadprivate(pairList, typeList, aliasList, rl, wurzl, ptype)
+#endif
+
 static int comp_struc(const void *A, const void *B);
 /* PUBLIC FUNCTIONES */
+void ini_start_stop (void);
 void ini_or_reset_rl (void);
 void move_it (void);
 void update_tree (int i, int j);
@@ -73,6 +79,7 @@ static void inb_nolp (baum *root);
 static void dnb (baum *rli);
 static void dnb_nolp (baum *rli);
 static void fnb (baum *rli);
+static void invalidate_loop (baum *root);
 static void make_ptypes(const short *S);
 /* debugging tool(s) */
 #if 0
@@ -204,6 +211,70 @@ static void ini_ringlist(void) {
 
 }
 
+/*
+  evaluate start and stop structure(s) once,
+  they are shared by all trajectories
+*/
+void ini_start_stop(void) {
+
+#if HAVE_LIBRNA_API3
+  GSV.currE = GSV.startE = vrna_eval_structure(GAV.vc, GAV.startform);
+#else
+  GSV.currE = GSV.startE = energy_of_structure(GAV.farbe, GAV.startform, 0);
+#endif
+
+  /* stop structure(s) */
+  if ( GTV.stop )  {
+    int i;
+
+    qsort(GAV.stopform, GSV.maxS, sizeof(char *), comp_struc);
+#if HAVE_LIBRNA_API3
+    /*
+      note that we need to hack the full length into GAV.vc again,
+      in case it was shortened due to chain growth simulation
+    */
+    unsigned int n, tmp_n;
+    n     = strlen(GAV.farbe_full);
+    tmp_n = GAV.vc->length;
+    GAV.vc->length = n;
+    for (i = 0; i< GSV.maxS; i++)
+      GAV.sE[i] = vrna_eval_structure(GAV.vc, GAV.stopform[i]);
+    GAV.vc->length = tmp_n;
+#else
+    for (i = 0; i< GSV.maxS; i++)
+      GAV.sE[i] = energy_of_structure(GAV.farbe_full, GAV.stopform[i], 0);
+#endif
+  }
+  else {
+#if HAVE_LIBRNA_API3
+    /* fold sequence to get Minimum free energy structure (Mfe) */
+    /*
+      note that we need to hack the full length into GAV.vc again,
+      in case it was shortened due to chain growth simulation
+    */
+    unsigned int n, tmp_n;
+    n     = strlen(GAV.farbe_full);
+    tmp_n = GAV.vc->length;
+    GAV.vc->length = n;
+    GAV.sE[0] = vrna_mfe_dimer(GAV.vc, GAV.stopform[0]);
+    vrna_mx_mfe_free(GAV.vc);
+    /* revaluate energy of Mfe (maye differ if --logML=logarthmic */
+    GAV.sE[0] = vrna_eval_structure(GAV.vc, GAV.stopform[0]);
+    GAV.vc->length = tmp_n;
+#else
+    if(GTV.noLP)
+      noLonelyPairs=1;
+    initialize_cofold(GSV.len);
+    /* fold sequence to get Minimum free energy structure (Mfe) */
+    GAV.sE[0] = cofold(GAV.farbe_full, GAV.stopform[0]);
+    free_arrays();
+    /* revaluate energy of Mfe (maye differ if --logML=logarthmic */
+    GAV.sE[0] = energy_of_structure(GAV.farbe_full, GAV.stopform[0], 0);
+#endif
+  }
+  GSV.stopE = GAV.sE[0];
+}
+
 /**/
 void ini_or_reset_rl(void) {
 
@@ -219,57 +290,7 @@ void ini_or_reset_rl(void) {
     GSV.currE = GSV.startE = energy_of_structure(GAV.farbe, GAV.startform, 0);
 #endif
 
-    /* stop structure(s) */
-    if ( GTV.stop )  {
-      int i;
-
-      qsort(GAV.stopform, GSV.maxS, sizeof(char *), comp_struc);
-#if HAVE_LIBRNA_API3
-      /*
-        note that we need to hack the full length into GAV.vc again,
-        in case it was shortened due to chain growth simulation
-      */
-      unsigned int n, tmp_n;
-      n     = strlen(GAV.farbe_full);
-      tmp_n = GAV.vc->length;
-      GAV.vc->length = n;
-      for (i = 0; i< GSV.maxS; i++)
-        GAV.sE[i] = vrna_eval_structure(GAV.vc, GAV.stopform[i]);
-      GAV.vc->length = tmp_n;
-#else
-      for (i = 0; i< GSV.maxS; i++)
-	GAV.sE[i] = energy_of_structure(GAV.farbe_full, GAV.stopform[i], 0);
-#endif
-    }
-    else {
-#if HAVE_LIBRNA_API3
-      /* fold sequence to get Minimum free energy structure (Mfe) */
-      /*
-        note that we need to hack the full length into GAV.vc again,
-        in case it was shortened due to chain growth simulation
-      */
-      unsigned int n, tmp_n;
-      n     = strlen(GAV.farbe_full);
-      tmp_n = GAV.vc->length;
-      GAV.vc->length = n;
-      GAV.sE[0] = vrna_mfe_dimer(GAV.vc, GAV.stopform[0]);
-      vrna_mx_mfe_free(GAV.vc);
-      /* revaluate energy of Mfe (maye differ if --logML=logarthmic */
-      GAV.sE[0] = vrna_eval_structure(GAV.vc, GAV.stopform[0]);
-      GAV.vc->length = tmp_n;
-#else
-      if(GTV.noLP)
-	noLonelyPairs=1;
-      initialize_cofold(GSV.len);
-      /* fold sequence to get Minimum free energy structure (Mfe) */
-      GAV.sE[0] = cofold(GAV.farbe_full, GAV.stopform[0]);
-      free_arrays();
-      /* revaluate energy of Mfe (maye differ if --logML=logarthmic */
-      GAV.sE[0] = energy_of_structure(GAV.farbe_full, GAV.stopform[0], 0);
-#endif
-    }
-    GSV.stopE = GAV.sE[0];
-    ini_nbList(strlen(GAV.farbe_full)*strlen(GAV.farbe_full));
+    ini_nbList(strlen(GAV.farbe_full));
   }
   else {
     /* reset ringlist-tree to start conditions */
@@ -277,8 +298,17 @@ void ini_or_reset_rl(void) {
     if(GTV.start) struc2tree(GAV.startform);
     else {
       GSV.currE = GSV.startE;
+      /* exterior loop energy of the open chain */
+#if HAVE_LIBRNA_API3
+      wurzl->loop_energy = vrna_eval_loop_pt(GAV.vc, 0, pairList);
+#else
+      wurzl->loop_energy = loop_energy(pairList, typeList, aliasList,0);
+#endif
     }
   }
+
+  /* neighbours of the start structure have to be generated from scratch */
+  invalidate_nbList();
 }
 
 /**/
@@ -758,29 +788,63 @@ void move_it (void) {
     energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0)/100.;
 #endif
   
+  /*
+    only neighbours of loops that changed since the last call
+    are generated again, see invalidate_loop()
+  */
   if ( GTV.noLP ) { /* canonical neighbours only */
+    /*
+      whether a move extends or removes a helix depends on adjacent
+      loops, so we always generate all neighbours from scratch
+    */
+    invalidate_nbList();
+    begin_nbGroup(-1);
     inb_nolp(wurzl);
+    end_nbGroup();
     for (i = 0; i < GSV.len; i++) {
       
       if (pairList[i+1]>i+1) {
+	begin_nbGroup(i);
 	inb_nolp(rl+i);      /* insert pair neighbours */
 	dnb_nolp(rl+i);  /* delete pair neighbour */
+	end_nbGroup();
       }
     }
   }
   else { /* all neighbours */
-    inb(wurzl);
+    if (!valid_nbGroup(-1)) {
+      begin_nbGroup(-1);
+      inb(wurzl);
+      end_nbGroup();
+    }
     for (i = 0; i < GSV.len; i++) {
-      
+      if (valid_nbGroup(i)) continue;
+
+      begin_nbGroup(i);
       if (pairList[i+1]>i+1) {
 	inb(rl+i); 	 /* insert pair neighbours */
 	dnb(rl+i);  /* delete pair neighbour */
 	if ( GTV.noShift == 0 ) fnb(rl+i);
       }
+      end_nbGroup();
     }
   }
 }
 
+/*
+  the neighbours generated for base pair (i,j) depend on the loop closed
+  by (i,j) and on the loop enclosing it. So whenever a loop changes, the
+  neighbours of the loop itself and of all base pairs within it are no
+  longer valid
+*/
+static void invalidate_loop (baum *root) {
+  baum *stop, *rli;
+
+  invalidate_nbGroup(root->nummer);
+  stop = root->down;
+  for (rli = stop->next; rli != stop; rli = rli->next)
+    if (rli->typ == 'p') invalidate_nbGroup(rli->nummer);
+}
 
 /**/
 void clean_up_rl(void) {
@@ -866,6 +930,9 @@ static void close_bp_en (baum *i, baum *j) {
 #else
   r->up->loop_energy = loop_energy(pairList,typeList,aliasList,r->up->nummer+1);
 #endif
+
+  invalidate_loop(i);
+  invalidate_loop(r->up);
 };
 
 static void open_bp_en (baum *i) {
@@ -879,4 +946,7 @@ static void open_bp_en (baum *i) {
 #else
   r->up->loop_energy = loop_energy(pairList,typeList,aliasList,r->up->nummer+1);
 #endif
+
+  invalidate_nbGroup(i->nummer);
+  invalidate_loop(r->up);
 };
@@ -27,119 +27,324 @@
 #endif
 
 /*
-  modify cache_f(), cache_comp() and the typedef of cache_entry
-  in cache_utils.h to suit your application
+  the cache is an open addressing hash table with linear probing,
+  keyed on the packed (5:1, base 3) encoding of the structure.
+  Entries live in a pool of slots that is swept by a CLOCK hand;
+  a lookup marks an entry as referenced, eviction picks the first
+  entry the hand finds unreferenced. The table grows as long as
+  the memory budget allows, afterwards every insertion evicts.
 */
 
 /* PUBLIC FUNCTIONES */
 cache_entry *lookup_cache (char *x);
-int write_cache (cache_entry *x);
-/*  void delete_cache (cache_entry *x); */
-void kill_cache();
-void initialize_cache();
+int write_cache (char *x, cache_entry *c);
+void initialize_cache (size_t budget);
+void kill_cache (void);
+void log_cache (FILE *fp);
 
 /* PRIVATE FUNCTIONES */
-/*  static int cache_comp(cache_entry *x, cache_entry *y); */
-INLINE static unsigned cache_f (char *x);
-
-/* #define CACHESIZE 67108864 -1 */ /* 2^26 -1   must be power of 2 -1 */
-/* #define CACHESIZE 33554432 -1 */ /* 2^25 -1   must be power of 2 -1 */
-/* #define CACHESIZE 16777216 -1 */ /* 2^24 -1   must be power of 2 -1 */ 
-/* #define CACHESIZE  4194304 -1 */ /* 2^22 -1   must be power of 2 -1 */
-#define CACHESIZE  1048576 -1  /* 2^20 -1   must be power of 2 -1 */
-/* #define CACHESIZE   262144 -1 */ /* 2^18 -1   must be power of 2 -1 */
-/* next is default */
-/* #define CACHESIZE    65536 -1 */ /* 2^16 -1   must be power of 2 -1 */
-/* #define CACHESIZE    16384 -1 */ /* 2^14 -1   must be power of 2 -1 */
-/* #define CACHESIZE     4096 -1 */ /* 2^12 -1   must be power of 2 -1 */
-
-static cache_entry *cachetab[CACHESIZE+1];
+INLINE static unsigned cache_f (const char *key, int length);
+static char *pack (const char *x);
+static int find_slot (const char *key, int length, unsigned hash);
+static int grow_cache (void);
+static void evict_entry (void);
+static void remove_slot (int i);
+static void free_entry (cache_entry *c);
+
+#define INITIAL_SLOTS 1024 /* must be power of 2 */
+
+typedef struct {
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long inserts;
+  unsigned long evictions;
+  size_t        peak;      /* max. memory in use */
+} cache_stats;
+
+static int *slots = NULL;          /* 1 + index into pool, 0 if empty */
+static cache_entry **pool = NULL;  /* entries, swept by the CLOCK hand */
+static int *free_pool = NULL;      /* stack of unused pool indices */
+static int num_slots = 0, num_pool = 0, num_free = 0, hand = 0;
+static size_t budget = 0, used = 0;
+static cache_stats stats;
+#ifdef _OPENMP
+/* each thread simulates its own trajectories and keeps its own cache */
+#pragma omp threadprivate(slots, pool, free_pool, num_slots, num_pool, \
+                          num_free, hand, budget, used, stats)
+#endif
+static cache_stats total; /* accumulated over all threads by kill_cache() */
 static char UNUSED rcsid[] ="$Id: cache.c,v 1.3 2006/10/04 12:45:12 xtof Exp $";
-unsigned long collisions=0;
-
-/* stolen from perl source */
-char coeff[] = {
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1};
-
-/* key must not be longer than 128 */
-INLINE static unsigned cache_f(char *x) { 
-  register char *s;
-  register int i;
-  register unsigned cache;
 
-  s = x;
+/* FNV-1a over the packed structure and its length */
+INLINE static unsigned cache_f(const char *key, int length) {
+  register const unsigned char *s;
+  register unsigned cache;
 
-  for (i=0,    cache = 0;
-       /* while */ *s;
-       s++,           i++ , cache *= 5 ) {
-    cache += *s * coeff[i];
+  cache = 2166136261U ^ (unsigned)length;
+  for (s = (const unsigned char *)key; *s; s++) {
+    cache ^= *s;
+    cache *= 16777619U;
   }
 
-   /* divide through CACHESIZE for normalization */
-  return ((cache) & (CACHESIZE));
+  return cache;
 }
 
+/**/
+static char *pack(const char *x) {
+  char *key;
+
+#if HAVE_LIBRNA_API3
+  key = vrna_db_pack(x);
+#else
+  key = pack_structure(x);
+#endif
+  if (key == NULL) {
+    fprintf(stderr, "cache: can't pack structure %s\n", x); exit(255);
+  }
+  return key;
+}
+
+/* returns the slot holding key, or the empty slot that ends its probe */
+static int find_slot(const char *key, int length, unsigned hash) {
+  int i;
+  cache_entry *c;
+
+  for (i = hash & (num_slots-1); slots[i]; i = (i+1) & (num_slots-1)) {
+    c = pool[slots[i]-1];
+    if (c->hash == hash && c->length == length && strcmp(c->key, key) == 0)
+      break;
+  }
+  return i;
+}
 
 /* returns NULL unless x is in the cache */
 cache_entry *lookup_cache (char *x) {
-  int cacheval;
-  cache_entry *c;
+  int i;
+  char *key;
+  cache_entry *c = NULL;
+
+  if (slots == NULL) return NULL;
+
+  key = pack(x);
+  i = find_slot(key, strlen(x), cache_f(key, strlen(x)));
+  free(key);
+  if (slots[i]) {
+    c = pool[slots[i]-1];
+    c->referenced = 1;
+    stats.hits++;
+  }
+  else stats.misses++;
+
+  return c;
+}
+
+/*
+  store c under structure x, the cache takes ownership of c.
+  returns 1 if x already was in the cache
+*/
+int write_cache (char *x, cache_entry *c) {
+  int i, p, length, found;
+
+  c->key = NULL;
+  if (slots == NULL) {
+    free_entry(c);
+    return 0;
+  }
+
+  length = strlen(x);
+  c->key = pack(x);
+  c->length = length;
+  c->hash = cache_f(c->key, length);
+  c->referenced = 0;
+  c->bytes = sizeof(cache_entry) + strlen(c->key) + 1
+    + c->top * (2*sizeof(short) + sizeof(double));
+
+  /* an entry that alone exceeds the budget is not worth keeping */
+  if (c->bytes > budget / 2) {
+    free_entry(c);
+    return 0;
+  }
+
+  found = 0;
+  i = find_slot(c->key, length, c->hash);
+  if (slots[i]) {
+    remove_slot(i);
+    found = 1;
+  }
+
+  /* make room, first try to grow the table, then evict */
+  while (used + c->bytes > budget || (num_free == 0 && !grow_cache())) {
+    if (num_free == num_pool) { /* nothing left to evict */
+      free_entry(c);
+      return found;
+    }
+    evict_entry();
+  }
+
+  p = free_pool[--num_free];
+  pool[p] = c;
+  i = find_slot(c->key, length, c->hash);
+  slots[i] = p+1;
+  used += c->bytes;
+  if (used > stats.peak) stats.peak = used;
+  stats.inserts++;
+
+  return found;
+}
 
-  cacheval=cache_f(x);
-  if ((c=cachetab[cacheval]))
-    if (strcmp(c->structure,x)==0) return c;
-  
-  return NULL;
+/* budget is the maximal memory used by the cache in bytes */
+void initialize_cache (size_t bytes) {
+  kill_cache();
+  memset(&stats, 0, sizeof(cache_stats));
+  budget = bytes;
+  used = 0;
+  num_slots = num_pool = num_free = hand = 0;
+  if (budget == 0) return;
+
+  num_slots = INITIAL_SLOTS;
+  slots = (int *) calloc(num_slots, sizeof(int));
+  if (slots == NULL) {
+    fprintf(stderr, "out of memory\n"); exit(255);
+  }
+  used = num_slots * sizeof(int);
+  grow_cache();
 }
 
-/* returns 1 if x already was in the cache */
-int write_cache (cache_entry *x) {
-  int cacheval;
+/*
+  double the number of slots (the pool holds half as many entries,
+  keeping the load factor <= 1/2). returns 0 if the budget is exceeded
+*/
+static int grow_cache (void) {
+  int i, n, *s;
+  size_t bytes;
+
+  if (pool == NULL) n = num_slots/2;     /* initial pool */
+  else {
+    n = num_slots;
+    bytes = num_slots*sizeof(int) + (n - num_pool)*(sizeof(cache_entry *)+sizeof(int));
+    if (used + bytes > budget) return 0;
+
+    s = (int *) calloc(2*num_slots, sizeof(int));
+    if (s == NULL) return 0;
+    free(slots);
+    slots = s;
+    used += num_slots*sizeof(int);
+    num_slots *= 2;
+    for (i = 0; i < num_pool; i++)
+      if (pool[i])
+        slots[find_slot(pool[i]->key, pool[i]->length, pool[i]->hash)] = i+1;
+  }
+
+  if (n > num_pool) {
+    cache_entry **p = (cache_entry **) realloc(pool, n*sizeof(cache_entry *));
+    int *f = (int *) realloc(free_pool, n*sizeof(int));
+    if (p) pool = p;
+    if (f) free_pool = f;
+    if (p == NULL || f == NULL) {
+      fprintf(stderr, "out of memory\n"); exit(255);
+    }
+    used += (n - num_pool) * (sizeof(cache_entry *)+sizeof(int));
+    /* new pool entries are handed out in ascending order */
+    for (i = n-1; i >= num_pool; i--) {
+      pool[i] = NULL;
+      free_pool[num_free++] = i;
+    }
+    num_pool = n;
+  }
+  return 1;
+}
+
+/* CLOCK: clear reference bits until an unreferenced entry comes by */
+static void evict_entry (void) {
   cache_entry *c;
-  
-  cacheval=cache_f(x->structure);
-  if ((c=cachetab[cacheval])) {
-    free(c->structure);
-    free(c->neighbors);
-    free(c->rates);
-    free(c->energies);
-    free(c);
+
+  for (;; hand = (hand+1) % num_pool) {
+    if ((c = pool[hand]) == NULL) continue;
+    if (c->referenced) {
+      c->referenced = 0;
+      continue;
+    }
+    remove_slot(find_slot(c->key, c->length, c->hash));
+    break;
   }
-  cachetab[cacheval]=x;
-  return 0;
+  hand = (hand+1) % num_pool;
+  stats.evictions++;
 }
 
-/**/
-void initialize_cache () { }
+/*
+  remove the entry in slot i from table and pool and close the gap
+  in its probe sequence by shifting subsequent entries backwards
+*/
+static void remove_slot (int i) {
+  int j, k, p, mask = num_slots-1;
 
-/**/
-void kill_cache () {
-  int i;
-  
-  for (i=0;i<CACHESIZE+1;i++) {
-    if ( cachetab[i] ) {
-      free (cachetab[i]->structure);
-      free (cachetab[i]->neighbors);
-      free (cachetab[i]->rates);
-      free (cachetab[i]->energies);
-      free (cachetab[i]);
+  p = slots[i]-1;
+  used -= pool[p]->bytes;
+  free_entry(pool[p]);
+  pool[p] = NULL;
+  free_pool[num_free++] = p;
+
+  for (j = i;;) {
+    slots[i] = 0;
+    for (;;) {
+      j = (j+1) & mask;
+      if (!slots[j]) return;
+      k = pool[slots[j]-1]->hash & mask;
+      /* entry in j may move to i unless its home slot lies in (i,j] */
+      if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j))) continue;
+      break;
     }
-    cachetab[i]=NULL;
+    slots[i] = slots[j];
+    i = j;
   }
 }
 
-#if 0
 /**/
-static int cache_comp(cache_entry *x, cache_entry *y) {
-  return strcmp(((cache_entry *)x)->structure, ((cache_entry *)y)->structure);
+static void free_entry (cache_entry *c) {
+  free(c->key);
+  free(c->neighbors);
+  free(c->rates);
+  free(c);
 }
+
+/**/
+void kill_cache (void) {
+  int i;
+
+  if (slots == NULL) return;
+
+  for (i = 0; i < num_pool; i++)
+    if (pool[i]) free_entry(pool[i]);
+  free(slots);
+  free(pool);
+  free(free_pool);
+  slots = NULL;
+  pool = NULL;
+  free_pool = NULL;
+  num_slots = num_pool = num_free = hand = 0;
+  used = 0;
+
+#ifdef _OPENMP
+#pragma omp critical (kinfold_cache)
 #endif
+  {
+    total.hits      += stats.hits;
+    total.misses    += stats.misses;
+    total.inserts   += stats.inserts;
+    total.evictions += stats.evictions;
+    if (stats.peak > total.peak) total.peak = stats.peak;
+  }
+  memset(&stats, 0, sizeof(cache_stats));
+}
+
+/* write statistics of all caches killed so far, summed over all threads */
+void log_cache (FILE *fp) {
+  unsigned long n = total.hits + total.misses;
+
+  fprintf(fp, "#Cache: hits=%lu misses=%lu hitrate=%.1f%% inserts=%lu "
+          "evictions=%lu peak=%.1fMB\n",
+          total.hits, total.misses, (n > 0) ? 100.*total.hits/n : 0.,
+          total.inserts, total.evictions, total.peak/1048576.);
+}
 
 /* End of file */
@@ -15,19 +15,28 @@
 #define UNUSED
 #endif
 
+#include <stdio.h>
+
 typedef struct {
-  char *structure;
+  char *key;         /* packed structure */
   int top;           /* number of neighbors */
   int lmin;          /* is a local minimum ? */
   double flux;       /* sum of rates */
   double energy;     /* energy of this structure */
+  long sum_dE;       /* sum of energy differences to neighbors */
   short *neighbors;  
-  float *rates;
-  double *energies;
+  double *rates;     /* cumulative rates */
+  /* maintained by the cache */
+  int length;        /* length of the structure */
+  unsigned hash;
+  size_t bytes;      /* memory occupied by this entry */
+  char referenced;   /* CLOCK reference bit */
 } cache_entry;
 
 extern cache_entry *lookup_cache (char *x);
-extern int write_cache (cache_entry *x);
+extern int write_cache (char *x, cache_entry *c);
+void initialize_cache(size_t budget);
 void kill_cache(void);
+void log_cache(FILE *fp);
 
 #endif
@@ -39,6 +39,10 @@ static void process_options_gg (int argc, char *argv[]);
 
 static const char *costring(const char *str);
 
+GlobVars GSV;
+GlobArrays GAV;
+GlobToggles GTV;
+
 static char UNUSED rcsid[] ="$Id: globals.c,v 1.8 2008/10/07 09:03:14 ivo Exp $";
 #define MAXMSG 8
 static char msg[MAXMSG][60] =
@@ -127,6 +131,8 @@ static void usage(int status) {
 	  "  --seed <int=int=int>  set random seed to <int=int=int>\n"
 	  "  --time <float>        set maxtime of simulation to <float>\n"
 	  "  --num <int>           set number of simulations to <int>\n"
+	  "  --jobs <int>          simulate <int> trajectories in parallel\n"
+	  "  --cache <int>         limit neighbor cache to <int> MB per thread\n"
 	  "  --start               set start structure\n"
 	  "  --stop                set stop structure(s)\n"
 	  "  --met                 use Metropolis rule not Kawasaki rule\n"
@@ -196,7 +202,6 @@ void log_start_stop(FILE *FP) {
   for (i = 0; i < GSV.maxS; i++) {
     fprintf(FP, "#%s (%6.2f) X%02d\n", costring(GAV.stopform[i]), GAV.sE[i], i+1);
   }
-  fprintf(FP, "(%-5hu %5hu %5hu)", GAV.subi[0], GAV.subi[1], GAV.subi[2]);
   costring(NULL);
   fflush(FP);
 }
@@ -364,6 +369,8 @@ static void process_options_gg (int argc, char *argv[]) {
   }
   GSV.time = args_info.time_arg;
   GSV.num = args_info.num_arg;
+  GSV.threads = args_info.jobs_arg;
+  GSV.cache = args_info.cache_arg;
   strncpy(GAV.BaseName, args_info.log_arg, 255);
   GSV.cut = args_info.cut_arg;
   GSV.grow = args_info.grow_arg;
@@ -550,6 +557,8 @@ static void ini_gvars(void) {
   GSV.phi = 1.0;
   GSV.simTime = 0.0;
   GSV.glen = 15;
+  GSV.threads = 1;
+  GSV.cache = 256;
 }
 
 /**/
@@ -13,6 +13,11 @@
 #include <assert.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <stdint.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #if HAVE_LIBRNA_API3
 #include <ViennaRNA/data_structures.h>
@@ -31,18 +36,27 @@
 #include "globals.h"
 
 static char UNUSED rcsid[] ="$Id: main.c,v 1.5 2008/08/28 09:40:55 ivo Exp $";
+
+/* number of trajectories per thread that may wait for their output to be written */
+#define KINFOLD_OUTPUT_WINDOW 4
+
 extern void  read_parameter_file(const char fname[]);
 extern void get_from_cache(cache_entry *c);
 
 /* PRIVAT FUNCTIONS */
 static void ini_energy_model(void);
 static void read_data(void);
+static void ini_thread(void);
+static void clean_up_thread(void);
+static void trajectory_seed(int k, unsigned short seed[3]);
+static void copy_output(FILE *from, FILE *to);
 static void clean_up(void);
 
 /**/
 int main(int argc, char *argv[]) {
-  int i;
-  char * start, *tmp;
+  int i, threads, next, window;
+  char *tmp, logFN[256];
+  FILE *logFP, **outs, **logs;
   
   /*
     process command-line optiones
@@ -70,61 +84,170 @@ int main(int argc, char *argv[]) {
   free(tmp);
 #endif
 
+  /*
+    evaluate start and stop structure(s)
+  */
+  ini_start_stop();
+
+  /* open log-file */
+  logFP = fopen(strcat(strcpy(logFN, GAV.BaseName), ".log"), "a+");
+  assert(logFP != NULL);
+
+  /* log initial condition */
+  log_prog_params(logFP);
+  log_start_stop(logFP);
+
+  /*
+    trajectories are independent of each other, so we may simulate
+    them in parallel. Each trajectory draws its random numbers from
+    its own stream, hence, results do not depend on the number of
+    threads
+  */
+  threads = 1;
+#if defined(_OPENMP) && HAVE_LIBRNA_API3
+  threads = (GSV.threads < 1) ? omp_get_max_threads() : GSV.threads;
+  if (threads > GSV.num) threads = GSV.num;
+  if (threads < 1) threads = 1;
+#endif
+
+  /*
+    with more than one thread, finished trajectories wait in their
+    output buffers until all previous trajectories have been written.
+    Trajectory i is not started before i < next + window, so a single
+    slow trajectory holds back at most window buffers (two temporary
+    files each) instead of one for every trajectory finished meanwhile
+  */
+  outs = logs = NULL;
+  next = 0;
+  window = KINFOLD_OUTPUT_WINDOW * threads;
+  if (threads > 1) {
+    outs = (FILE **)calloc(GSV.num, sizeof(FILE *));
+    logs = (FILE **)calloc(GSV.num, sizeof(FILE *));
+    assert((outs != NULL) && (logs != NULL));
+  }
+
   /*
     perform GSV.num simulations
   */
-    
-  start = strdup(GAV.startform); /* remember startform for next run */
-  for (i = 0; i < GSV.num; i++) {
-
-    /*
-      initialize or reset ringlist to start conditions
-    */
-    ini_or_reset_rl();
-    if (GSV.grow>0) {
-      if (strlen(GAV.farbe)>GSV.glen) {
-	start[GSV.glen] = '\0';
-	GAV.farbe[GSV.glen] = '\0';
-	strcpy(GAV.startform,start);
-	strcpy(GAV.currform,start);
-	GSV.len=GSV.glen;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads) copyin(GSV, GAV) private(i)
+#endif
+  {
+    char *start;
 
-#if HAVE_LIBRNA_API3
-        GAV.vc->length = GSV.len;
+    ini_thread();
+    initialize_cache((GSV.cache > 0) ? (size_t)GSV.cache << 20 : 0);
+    start = strdup(GAV.startform); /* remember startform for next run */
+
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp for schedule(dynamic, 1)
 #endif
+    for (i = 0; i < GSV.num; i++) {
+      unsigned short seed[3];
+      FILE *out = stdout, *log = logFP;
+
+      if (threads > 1) {
+        int wait = 1;
+
+        while (wait) {
+#ifdef _OPENMP
+#pragma omp critical (kinfold_output)
+#endif
+          wait = (i >= next + window);
+          if (wait) usleep(1000);
+        }
+
+        out = tmpfile();
+        log = tmpfile();
+        assert((out != NULL) && (log != NULL));
       }
-      clean_up_rl();
+
+      trajectory_seed(i, seed);
+      fprintf(log, "(%5hu %5hu %5hu)", seed[0], seed[1], seed[2]);
+      ini_trajectory(out, log, seed);
+
+      /*
+	initialize or reset ringlist to start conditions
+      */
       ini_or_reset_rl();
-    }
+      if (GSV.grow>0) {
+	if (strlen(GAV.farbe)>GSV.glen) {
+	  start[GSV.glen] = '\0';
+	  GAV.farbe[GSV.glen] = '\0';
+	  strcpy(GAV.startform,start);
+	  strcpy(GAV.currform,start);
+	  GSV.len=GSV.glen;
 
-    /*
-      perform simulation
-    */
-    for (GSV.steps = 1;; GSV.steps++) {
-      cache_entry *c;
+#if HAVE_LIBRNA_API3
+	  GAV.vc->length = GSV.len;
+#endif
+	}
+	clean_up_rl();
+	ini_or_reset_rl();
+      }
 
       /*
-	take neighbourhood of current structure from cache if there
-	else generate it from scratch
+	perform simulation
       */
-      if ( (c = lookup_cache(GAV.currform)) ) get_from_cache(c);
-      else move_it();
+      for (GSV.steps = 1;; GSV.steps++) {
+	cache_entry *c;
+
+	/*
+	  take neighbourhood of current structure from cache if there
+	  else generate it from scratch
+	*/
+	if ( (c = lookup_cache(GAV.currform)) ) get_from_cache(c);
+	else move_it();
 	
+	/*
+	  select a structure from neighbourhood of current structure
+	  and make it to the new current structure.
+	  stop simulation if stop condition is met.
+	*/
+	if ( sel_nb() > 0 ) break;
+
+	/* if (GSV.grow>0) grow_chain(); */
+      }
+
       /*
-	select a structure from neighbourhood of current structure
-	and make it to the new current structure.
-	stop simulation if stop condition is met.
+        whoever finishes a trajectory writes all buffers that are
+        ready, starting with the first one not yet written
       */
-      if ( sel_nb() > 0 ) break;
+      if (threads > 1) {
+#ifdef _OPENMP
+#pragma omp critical (kinfold_output)
+#endif
+        {
+          outs[i] = out;
+          logs[i] = log;
 
-      /* if (GSV.grow>0) grow_chain(); */
+          for (; (next < GSV.num) && (outs[next] != NULL); next++) {
+            copy_output(outs[next], stdout);
+            copy_output(logs[next], logFP);
+            outs[next] = logs[next] = NULL;
+          }
+        }
+      }
     }
+
+    free(start);
+    clean_up_thread();
   }
   
+  free(outs);
+  free(logs);
+
   /*
     clean up memory
   */
-  free(start);
+  kill_cache();
+  /*
+    cache statistics depend on how trajectories are distributed over
+    threads, keep them out of the log file
+  */
+  if (GTV.verbose) log_cache(stderr);
+  fclose(logFP);
   clean_up();
   return(0);
 }
@@ -253,6 +376,86 @@ static void read_data(void) {
   GAV.sE = (float *)calloc(GSV.maxS, sizeof(float)); 
 }
 
+/*
+  every thread but the master gets its own copy of all
+  arrays that change along a trajectory
+*/
+static void ini_thread(void) {
+#ifdef _OPENMP
+  if (omp_get_thread_num() == 0) return;
+
+  GAV.farbe     = strdup(GAV.farbe);
+  GAV.startform = strdup(GAV.startform);
+  GAV.currform  = (char *)calloc(GSV.len+1, sizeof(char));
+  GAV.prevform  = (char *)calloc(GSV.len+1, sizeof(char));
+  assert(GAV.farbe && GAV.startform && GAV.currform && GAV.prevform);
+
+#if HAVE_LIBRNA_API3
+  {
+    char *tmp;
+    tmp = vrna_cut_point_insert(GAV.farbe, cut_point);
+#pragma omp critical (kinfold_fold_compound)
+    GAV.vc = vrna_fold_compound(tmp, &(GAV.md), VRNA_OPTION_DEFAULT);
+    free(tmp);
+  }
+#endif
+#endif
+}
+
+/**/
+static void clean_up_thread(void) {
+#ifdef _OPENMP
+  if (omp_get_thread_num() == 0) return;
+
+  clean_up_rl();
+  clean_up_nbList();
+  kill_cache();
+  free(GAV.farbe);
+  free(GAV.startform);
+  free(GAV.currform);
+  free(GAV.prevform);
+#if HAVE_LIBRNA_API3
+  vrna_fold_compound_free(GAV.vc);
+#endif
+#endif
+}
+
+/*
+  the first trajectory uses the seed we were given, all others
+  derive their seed from it, such that every trajectory can be
+  reproduced on its own with the seed written to the log-file
+*/
+static void trajectory_seed(int k, unsigned short seed[3]) {
+  uint64_t x;
+
+  seed[0] = GAV.subi[0];
+  seed[1] = GAV.subi[1];
+  seed[2] = GAV.subi[2];
+  if (k == 0) return;
+
+  /* splitmix64 */
+  x  = ((uint64_t)seed[0] << 32) | ((uint64_t)seed[1] << 16) | (uint64_t)seed[2];
+  x += (uint64_t)k * 0x9E3779B97F4A7C15ULL;
+  x  = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x  = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  seed[0] = (unsigned short)(x >> 32);
+  seed[1] = (unsigned short)(x >> 16);
+  seed[2] = (unsigned short)x;
+}
+
+/**/
+static void copy_output(FILE *from, FILE *to) {
+  char buf[BUFSIZ];
+  size_t n;
+
+  rewind(from);
+  while ((n = fread(buf, 1, sizeof(buf), from)) > 0)
+    fwrite(buf, 1, n, to);
+  fclose(from);
+  fflush(to);
+}
+
 /**/
 void clean_up(void) {
   clean_up_globals();
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
 #include "globals.h"
 #include "assert.h"
 
@@ -29,9 +30,31 @@
 
 static char UNUSED rcsid[]="$Id: nachbar.c,v 1.8 2008/06/03 21:55:11 ivo Exp $";
 
+/*
+  neighbors are grouped by the loop they are generated from, i.e.
+  group 0 holds the moves inserting a base pair into the exterior
+  loop and group i+1 holds the moves inserting a base pair into
+  the loop closed by the base pair (i,j), and deleting or shifting
+  (i,j) itself. A group
+  only has to be regenerated when the loop closed by (i,j), or the
+  loop enclosing it, was changed by a move (see baum.c)
+*/
+typedef struct {
+  int num;         /* number of moves */
+  int size;        /* number of moves we have room for */
+  int min_dE;      /* lowest energy difference */
+  long sum_dE;     /* sum of energy differences (laplace stuff) */
+  short *moves;    /* move coding, 2 entries per move */
+  double *rates;   /* cumulative rates, rates[k] = sum of rates of moves 0..k */
+} nb_group;
+
 /* arrays */
-static short *neighbor_list=NULL;
-static float *bmf=NULL; /* boltzmann weight of structure */
+static nb_group *groups = NULL;
+static char *invalid = NULL;     /* groups that must be regenerated */
+static int num_groups = 0;
+static int leaves = 0;           /* number of leaves of the sum tree */
+static double *flux_tree = NULL; /* sum tree over the rates of all groups */
+static int *min_tree = NULL;     /* min tree over energy differences of all groups */
 static const char *costring(const char *str);
 
 /* globals for laplace stuff */
@@ -41,7 +64,6 @@ static double sumT = 0.0;
 static double sumK = 0.0;
 static double sumKK = 0.0;
 static double sumD = 0.0;
-static double *energies=NULL; /* energies of neighbors */
 
 /* variables */
 /*  static double highestE = -1000.0; */
@@ -49,15 +71,37 @@ static double *energies=NULL; /* energies of neighbors */
 /*  static char *highestS, *OhighestS; */
 static int lmin = 1;
 static int top = 0;
+static long sum_dE = 0;
+static int curr_E = 0;           /* energy of current structure in dcal/mol */
 static int is_from_cache = 0;
+static cache_entry *cached = NULL;
+static nb_group *current = NULL; /* group that receives new moves */
 /*  static double meanE = 0.0; */
 static double totalflux = 0.0;
 static double Zeit = 0.0;
 static double zeitInc = 0.0;
 static double _RT = 0.6;
 
+/* output streams and random number generator of the current trajectory */
+static FILE *outFP = NULL;
+static FILE *logFP = NULL;
+static unsigned short subi[3];
+
+#ifdef _OPENMP
+#pragma omp threadprivate(groups, invalid, num_groups, leaves, flux_tree, min_tree, \
+                          L, D, sumT, sumK, sumKK, sumD, lmin, top, sum_dE, curr_E, \
+                          is_from_cache, cached, current, totalflux, Zeit, zeitInc, \
+                          _RT, outFP, logFP, subi)
+#endif
+
 /* public functiones */
-void ini_nbList(int chords);
+void ini_nbList(int length);
+void ini_trajectory(FILE *out, FILE *log, unsigned short seed[3]);
+void invalidate_nbList(void);
+void invalidate_nbGroup(int i);
+int valid_nbGroup(int i);
+void begin_nbGroup(int i);
+void end_nbGroup(void);
 void update_nbList(int i, int j, int iE);
 int sel_nb(void);
 void clean_up_nbList(void);
@@ -65,106 +109,158 @@ extern void update_tree(int i, int j);
 
 /* privat functiones */
 static void reset_nbList(void);
-static void grow_chain(void);
-static FILE *logFP=NULL;
+static int grow_chain(void);
+static double rate(int dE);
+static void update_leaf(int g);
+static int select_group(double *schwelle);
+static int select_move(const double *rates, int num, double schwelle);
 
 /**/
-void ini_nbList(int chords) {
-  char logFN[256];
+void ini_nbList(int length) {
+  int g;
 
   _RT = (((temperature + K0) * GASCONST) / 1000.0);
-  if (neighbor_list!=NULL) return;
+  if (groups!=NULL) return;
   /*
-    list for move coding
-    make room for 2*chords neighbors (safe bet)
+    one group of neighbors for the exterior loop and
+    one for each potential base pair
   */
-  if (chords == 0) chords = 1;
-  neighbor_list = (short *)calloc(4*chords, sizeof(short));
-  assert(neighbor_list != NULL);
+  num_groups = length + 1;
+  groups = (nb_group *)calloc(num_groups, sizeof(nb_group));
+  assert(groups != NULL);
+  invalid = (char *)calloc(num_groups, sizeof(char));
+  assert(invalid != NULL);
+
   /*
-    list for Boltzmann-factors
+    sum tree and min tree over the groups, leaves are stored
+    in the second half of the arrays
   */
-  bmf = (float *)calloc(2*chords, sizeof(double));
-  assert(bmf != NULL);
+  for (leaves = 1; leaves < num_groups; leaves *= 2);
+  flux_tree = (double *)calloc(2*leaves, sizeof(double));
+  assert(flux_tree != NULL);
+  min_tree = (int *)calloc(2*leaves, sizeof(int));
+  assert(min_tree != NULL);
+  for (g = 0; g < 2*leaves; g++) min_tree[g] = INT_MAX;
+
+  invalidate_nbList();
+}
 
-  /* list of neighbor energies */
-  energies = (double*)calloc(2*chords, sizeof(double));
-  assert(energies != NULL);
-  
-  /* open log-file */
-  logFP = fopen(strcat(strcpy(logFN, GAV.BaseName), ".log"), "a+");
-  assert(logFP != NULL);
+/* set output streams and random number seed of a new trajectory */
+void ini_trajectory(FILE *out, FILE *log, unsigned short seed[3]) {
+  outFP = out;
+  logFP = log;
+  subi[0] = seed[0];
+  subi[1] = seed[1];
+  subi[2] = seed[2];
+}
+
+/* forget all neighbors, e.g. for a new start structure */
+void invalidate_nbList(void) {
+  int g;
 
-  /* log initial condition */
-  log_prog_params(logFP);
-  log_start_stop(logFP);
+  for (g = 0; g < num_groups; g++) {
+    groups[g].num = 0;
+    groups[g].min_dE = INT_MAX;
+    groups[g].sum_dE = 0;
+    invalid[g] = 1;
+  }
+  for (g = 0; g < 2*leaves; g++) {
+    flux_tree[g] = 0.0;
+    min_tree[g] = INT_MAX;
+  }
+  top = 0;
+  sum_dE = 0;
+}
+
+/* neighbors of loop closed by base pair starting at i (-1 for exterior loop) */
+void invalidate_nbGroup(int i) {
+  invalid[i+1] = 1;
 }
 
 /**/
-void update_nbList(int i, int j, int iE) {
-  double E, dE, p;
+int valid_nbGroup(int i) {
+  return !invalid[i+1];
+}
 
-  E = (double)iE/100.;
-  neighbor_list[2*top] = (short )i;
-  neighbor_list[2*top+1] = (short )j;
-  
-  /* compute rates and some statistics */
-  /*    meanE += E; */
-  dE = E-GSV.currE;
+/* subsequent calls of update_nbList() add moves to group of loop i */
+void begin_nbGroup(int i) {
+  current = groups + i + 1;
+  top    -= current->num;
+  sum_dE -= current->sum_dE;
+  current->num = 0;
+  current->min_dE = INT_MAX;
+  current->sum_dE = 0;
+  curr_E = (int) (GSV.currE*100 + ((GSV.currE<0)?-0.4:0.4));
+}
 
-  /* laplace stuff */
-  energies[top] = E;
-  L += GSV.currE-E;
-  D++;
-  /* fprintf(stderr, ">>%g %g<<\n", L, D); */
-  
-  if( GTV.mc ) {
-    /* metropolis rule */
-    if (dE < 0) p = 1;
-    else p = exp(-(dE / _RT*GSV.phi));
+/**/
+void end_nbGroup(void) {
+  int g = current - groups;
+
+  top    += current->num;
+  sum_dE += current->sum_dE;
+  invalid[g] = 0;
+  update_leaf(g);
+  current = NULL;
+}
+
+/**/
+void update_nbList(int i, int j, int iE) {
+  int dE;
+  nb_group *g = current;
+
+  if (g->num == g->size) {
+    g->size = 2*g->size + 16;
+    g->moves = (short *)realloc(g->moves, 2*g->size*sizeof(short));
+    assert(g->moves != NULL);
+    g->rates = (double *)realloc(g->rates, g->size*sizeof(double));
+    assert(g->rates != NULL);
   }
-  else  /* kawasaki rule */
-    p = exp(-0.5 * (dE / _RT*GSV.phi));
 
-  totalflux += p;
-  bmf[top++] = (float )p;
-  if (dE < 0) lmin = 0;
-  if ((dE == 0) && (lmin==1)) lmin = 2;
+  g->moves[2*g->num] = (short )i;
+  g->moves[2*g->num+1] = (short )j;
+
+  /* compute rates and some statistics */
+  dE = iE - curr_E;
+  g->rates[g->num] = rate(dE) + ((g->num > 0) ? g->rates[g->num-1] : 0.0);
+  g->sum_dE += dE;
+  if (dE < g->min_dE) g->min_dE = dE;
+  g->num++;
 }
 
 /**/
 void get_from_cache(cache_entry *c) {
-  top = c->top;
   totalflux = c->flux;
   GSV.currE = c->energy;
   lmin = c->lmin;
-  memcpy(neighbor_list, c->neighbors, 2*top*sizeof(short));
-  memcpy(bmf, c->rates, top*sizeof(float));
-  memcpy(energies, c->energies, top*sizeof(double));
+  cached = c;
   is_from_cache = 1;
 }
 
 /**/
 void put_in_cache(void) {
   cache_entry *c;
+  int g, n;
 
   if ((c = (cache_entry *) malloc(sizeof(cache_entry)))==NULL) {
     fprintf(stderr, "out of memory\n"); exit(255);
   }
-/*    c->structure = strdup(GAV.currform); */
-  c->structure = (char *) calloc(GSV.len+1, sizeof(char));
-  strcpy(c->structure, GAV.currform);
   c->neighbors = (short *) malloc(top*2*sizeof(short));
-  memcpy(c->neighbors,neighbor_list,top*2*sizeof(short));
-  c->rates = (float *) malloc(top*sizeof(float));
-  memcpy(c->rates, bmf, top*sizeof(float));
-  c->energies = (double*)malloc(top*sizeof(double));
-  memcpy(c->energies, energies, top*sizeof(double));
+  c->rates = (double *) malloc(top*sizeof(double));
+  /* concatenate the groups, cumulative rates continue across groups */
+  for (n = 0, g = 0; g < num_groups; g++) {
+    int k;
+    double base = (n > 0) ? c->rates[n-1] : 0.0;
+    memcpy(c->neighbors + 2*n, groups[g].moves, groups[g].num*2*sizeof(short));
+    for (k = 0; k < groups[g].num; k++)
+      c->rates[n++] = base + groups[g].rates[k];
+  }
   c->top = top;
   c->lmin = lmin;
   c->flux = totalflux;
   c->energy = GSV.currE;
-  write_cache(c);
+  c->sum_dE = sum_dE;
+  write_cache(GAV.currform, c);
 }
 
 /*============*/
@@ -172,24 +268,31 @@ void put_in_cache(void) {
 int sel_nb(void) {
 
   char trans, **s;
-  int next, i;
-  double pegel = 0.0, schwelle = 0.0, zufall = 0.0;
+  short *move = NULL;
+  int next, num;
+  double schwelle = 0.0, zufall = 0.0;
   int found_stop=0;
 
   /* before we select a move, store current conformation in cache */
   /* ... unless it just came from there */
-  if ( !is_from_cache ) put_in_cache();
-  else
-    /* laplace stuff */
-    for (i=0; i<top; i++) {
-      L += (GSV.currE - energies[i]);
-      D++;
-    }
-  is_from_cache = 0;
+  if ( !is_from_cache ) {
+    totalflux = flux_tree[1];
+    if (min_tree[1] < 0) lmin = 0;
+    else if (min_tree[1] == 0) lmin = 2;
+    else lmin = 1;
+    put_in_cache();
+  }
+
+  /* number of neighbours */
+  num = is_from_cache ? cached->top : top;
+
+  /* laplace stuff */
+  L -= (double)(is_from_cache ? cached->sum_dE : sum_dE)/100.;
+  D += num;
 
   /* draw 2 different a random number */
-  schwelle = urn();
-  while ( zufall==0 ) zufall = urn();
+  schwelle = erand48(subi);
+  while ( zufall==0 ) zufall = erand48(subi);
 
   /* advance internal clock */
   if (totalflux>0)
@@ -206,21 +309,30 @@ int sel_nb(void) {
   sumKK += L*L*zeitInc;
   sumD  += D*zeitInc;
   
-  if (GSV.grow>0 && GSV.len < strlen(GAV.farbe_full)) grow_chain();
+  /* a growing chain prevents a structure move in this step */
+  next = 0;
+  if (GSV.grow>0 && GSV.len < strlen(GAV.farbe_full)) next = -grow_chain();
 
   /* meanE /= (double)top; */
 
   /* normalize boltzmann weights */
   schwelle *=totalflux;
 
-  /* and choose a neighbour structure next */
-  for (next = 0; next < top; next++) {
-    pegel += bmf[next];
-    if (pegel > schwelle) break;
+  /*
+    and choose a neighbour structure next, either by bisection
+    of the cumulative rates of a cached neighbourhood, or by
+    descending the sum tree and bisecting within the selected group
+  */
+  if ((next < 0) || (num == 0) || (totalflux <= 0)) next = -1;
+  else if (is_from_cache) {
+    next = select_move(cached->rates, cached->top, schwelle);
+    move = cached->neighbors + 2*next;
+  }
+  else {
+    nb_group *g = groups + select_group(&schwelle);
+    next = select_move(g->rates, g->num, schwelle);
+    move = g->moves + 2*next;
   }
-
-  /* in case of rounding errors */
-  if (next==top) next=top-1;
 
   /*
     process termination contitiones
@@ -246,19 +358,19 @@ int sel_nb(void) {
     
     /* this goes to stdout */
     if ( !GTV.silent ) {
-      printf("%s %6.2f %10.3f", costring(GAV.currform), GSV.currE, Zeit);
+      fprintf(outFP, "%s %6.2f %10.3f", costring(GAV.currform), GSV.currE, Zeit);
 
       /* laplace stuff*/
-      if (GTV.phi) printf(" %8.3f %8.3f %3g", zeitInc, L, D); 
+      if (GTV.phi) fprintf(outFP, " %8.3f %8.3f %3g", zeitInc, L, D); 
 
-      if (GTV.verbose) printf(" %4d _ %d", top, lmin);
-      if (found_stop) printf(" X%d\n", found_stop);/* found a stop structure */
-      else printf(" O\n"); /* time for simulation is exceeded */
+      if (GTV.verbose) fprintf(outFP, " %4d _ %d", num, lmin);
+      if (found_stop) fprintf(outFP, " X%d\n", found_stop);/* found a stop structure */
+      else fprintf(outFP, " O\n"); /* time for simulation is exceeded */
 
       /* laplace stuff */
-      if (GTV.phi) printf("Curvature fluctuation sigma = %7.5f\n", sigma);
+      if (GTV.phi) fprintf(outFP, "Curvature fluctuation sigma = %7.5f\n", sigma);
 
-      fflush(stdout);
+      fflush(outFP);
     }
 
     /* this goes to log */
@@ -279,10 +391,6 @@ int sel_nb(void) {
 
       fprintf(logFP," %d %s\n", lmin, costring(GAV.currform));
     }
-    GAV.subi[0] = xsubi[0];
-    GAV.subi[1] = xsubi[1];
-    GAV.subi[2] = xsubi[2];
-    fprintf(logFP, "(%5hu %5hu %5hu)", GAV.subi[0], GAV.subi[1], GAV.subi[2]);
     fflush(logFP);
     
     Zeit = 0.0;
@@ -309,12 +417,12 @@ int sel_nb(void) {
 	char format[64];
 	flag = 1;
 	sprintf(format, "%%-%ds %%6.2f %%10.3f", strlen(GAV.farbe_full)+1);
-	printf(format, costring(GAV.currform), GSV.currE, Zeit);
+	fprintf(outFP, format, costring(GAV.currform), GSV.currE, Zeit);
       }
 
       /* laplace stuff */
       if (GTV.phi) {
-	printf(" %8.3f %8.3f %3g", zeitInc, L, D);
+	fprintf(outFP, " %8.3f %8.3f %3g", zeitInc, L, D);
 	L = D = 0.0; /* reset L and D for next structure */
       }
 
@@ -322,8 +430,8 @@ int sel_nb(void) {
 	int ii, jj;
 	if (next<0) trans='g'; /* growth */
 	else {
-	  ii = neighbor_list[2*next];
-	  jj = neighbor_list[2*next+1];
+	  ii = move[0];
+	  jj = move[1];
 	  if (abs(ii) < GSV.len) {
 	    if ((ii > 0) && (jj > 0)) trans = 'i';
 	    else if ((ii < 0) && (jj < 0)) trans = 'd';
@@ -334,9 +442,9 @@ int sel_nb(void) {
 	    else trans = 'D';
 	  }
 	}
-	printf(" %4d %c %d", top, trans, lmin);
+	fprintf(outFP, " %4d %c %d", num, trans, lmin);
       }
-      if (flag) printf("\n");
+      if (flag) fprintf(outFP, "\n");
     }
   }
 
@@ -373,7 +481,7 @@ int sel_nb(void) {
   }
 #endif
 
-  if (next>=0) update_tree(neighbor_list[2*next], neighbor_list[2*next+1]);
+  if (next>=0) update_tree(move[0], move[1]);
   else {
     clean_up_rl(); ini_or_reset_rl();
   }
@@ -385,30 +493,39 @@ int sel_nb(void) {
 /*==========================*/
 static void reset_nbList(void) {
 
-  top = 0;
   totalflux = 0.0;
   /*    meanE = 0.0; */
   lmin = 1;
+  is_from_cache = 0;
+  cached = NULL;
 }
 
 /*======================*/
 void clean_up_nbList(void){
+  int g;
 
-  free(neighbor_list);
-  free(bmf);
-  free(energies);
-  fprintf(logFP,"\n");
-  fclose(logFP);
+  for (g = 0; g < num_groups; g++) {
+    free(groups[g].moves);
+    free(groups[g].rates);
+  }
+  free(groups);
+  free(invalid);
+  free(flux_tree);
+  free(min_tree);
+  groups = NULL;
+  invalid = NULL;
+  flux_tree = NULL;
+  min_tree = NULL;
+  num_groups = leaves = 0;
 }
 
 /*======================*/
-static void grow_chain(void){
+static int grow_chain(void){
   int newl;
   /* note Zeit=0 corresponds to chain length GSV.glen */
-  if (Zeit<(GSV.len+1-GSV.glen) * GSV.grow) return;
+  if (Zeit<(GSV.len+1-GSV.glen) * GSV.grow) return 0;
   newl = GSV.len+1;
   Zeit = (newl-GSV.glen) * GSV.grow;
-  top=0; /* prevent structure move in sel_nb */
 
   if (GSV.len<newl) {
     strncpy(GAV.farbe, GAV.farbe_full, newl);
@@ -422,11 +539,67 @@ static void grow_chain(void){
     GAV.vc->length = newl;
 #endif
   }
+  return 1;
+}
+
+/*======================*/
+static double rate(int dE) {
+  double E = (double)dE/100.;
+
+  if( GTV.mc ) {
+    /* metropolis rule */
+    if (E < 0) return 1;
+    else return exp(-(E / _RT*GSV.phi));
+  }
+  else  /* kawasaki rule */
+    return exp(-0.5 * (E / _RT*GSV.phi));
+}
+
+/* propagate rates and energy differences of group g to the root */
+static void update_leaf(int g) {
+  int k = leaves + g;
+
+  flux_tree[k] = (groups[g].num > 0) ? groups[g].rates[groups[g].num-1] : 0.0;
+  min_tree[k]  = groups[g].min_dE;
+  for (k /= 2; k > 0; k /= 2) {
+    flux_tree[k] = flux_tree[2*k] + flux_tree[2*k+1];
+    min_tree[k]  = (min_tree[2*k] < min_tree[2*k+1]) ? min_tree[2*k] : min_tree[2*k+1];
+  }
+}
+
+/* descend sum tree, schwelle becomes relative to the selected group */
+static int select_group(double *schwelle) {
+  int k = 1;
+
+  while (k < leaves) {
+    k *= 2;
+    /* in case of rounding errors, never descend into an empty subtree */
+    if ((*schwelle >= flux_tree[k]) && (flux_tree[k+1] > 0)) {
+      *schwelle -= flux_tree[k];
+      k++;
+    }
+  }
+  return k - leaves;
+}
+
+/* first move whose cumulative rate exceeds schwelle */
+static int select_move(const double *rates, int num, double schwelle) {
+  int lo = 0, hi = num - 1;
+
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (rates[mid] > schwelle) hi = mid;
+    else lo = mid + 1;
+  }
+  return lo;
 }
 
 static const char *costring(const char *str) {
   static char* buffer=NULL;
   static int size=0;
+#ifdef _OPENMP
+#pragma omp threadprivate(buffer, size)
+#endif
   int n;
   if (str==NULL) {
     if (buffer) {
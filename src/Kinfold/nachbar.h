@@ -9,13 +9,19 @@
 #ifndef NACHBAR_H
 #define NACHBAR_H
 
+#include <stdio.h>
+
 /* used in baum.c */
-extern void ini_nbList(int chords);
+extern void ini_nbList(int length);
+extern void invalidate_nbList(void);
+extern void invalidate_nbGroup(int i);
+extern int valid_nbGroup(int i);
+extern void begin_nbGroup(int i);
+extern void end_nbGroup(void);
 extern void update_nbList(int i,int j, int iE);
 
 /* used in main.c */
+extern void ini_trajectory(FILE *out, FILE *log, unsigned short seed[3]);
 extern int sel_nb(void);
 extern void clean_up_nbList(void);
-
-extern void grow_chain(void);
 #endif
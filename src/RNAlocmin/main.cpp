@@ -454,18 +454,46 @@ int main(int argc, char **argv)
       }
 
       // findpath:
-      for (set<int>::iterator it=to_findpath.begin(); it!=to_findpath.end(); it++) {
-        set<int>::iterator it2=it;
-        it2++;
-        for (; it2!=to_findpath.end(); it2++) {
-          if (args_info.pseudoknots_flag) energy_barr[(*it2)*num+(*it)] = energy_barr[(*it)*num+(*it2)] = find_saddle_pk(seq, output_str[*it].c_str(), output_str[*it2].c_str(), args_info.depth_arg)/100.0;
-          else energy_barr[(*it2)*num+(*it)] = energy_barr[(*it)*num+(*it2)] = find_saddle(seq, output_str[*it].c_str(), output_str[*it2].c_str(), args_info.depth_arg)/100.0;
-          findpath_barr[(*it2)*num+(*it)] = findpath_barr[(*it)*num+(*it2)] = true;
-          if (args_info.verbose_lvl_arg>0 && findpath %10000==0){
-            fprintf(stderr, "Findpath:%7d/%7d\n", findpath, (int)(to_findpath.size()*(to_findpath.size()-1)/2));
+      if (args_info.pseudoknots_flag) {
+        for (set<int>::iterator it=to_findpath.begin(); it!=to_findpath.end(); it++) {
+          set<int>::iterator it2=it;
+          it2++;
+          for (; it2!=to_findpath.end(); it2++) {
+            energy_barr[(*it2)*num+(*it)] = energy_barr[(*it)*num+(*it2)] = find_saddle_pk(seq, output_str[*it].c_str(), output_str[*it2].c_str(), args_info.depth_arg)/100.0;
+            findpath_barr[(*it2)*num+(*it)] = findpath_barr[(*it)*num+(*it2)] = true;
+            if (args_info.verbose_lvl_arg>0 && findpath %10000==0){
+              fprintf(stderr, "Findpath:%7d/%7d\n", findpath, (int)(to_findpath.size()*(to_findpath.size()-1)/2));
+            }
+            findpath++;
           }
-          findpath++;
         }
+      } else if (to_findpath.size() > 1) {
+        // all pairs at once, on multiple threads. Upper bounds from already known saddles
+        // turn entries into saddles of indirect paths, which is fine for the barrier tree
+        // but not for rates and barriers between pairs of minima
+        vector<int> minima(to_findpath.begin(), to_findpath.end());
+        vector<const char*> structures;
+        for (unsigned int i=0; i<minima.size(); i++) structures.push_back(output_str[minima[i]].c_str());
+        structures.push_back(NULL);
+
+        vrna_md_t md;
+        set_model_details(&md);
+        vrna_fold_compound_t *fc = vrna_fold_compound(seq, &md, VRNA_OPTION_EVAL_ONLY);
+        vrna_fold_compound_num_threads(fc, args_info.numThreads_arg);
+
+        int m = (int)minima.size();
+        unsigned int options = (args_info.rates_flag || args_info.barrier_file_given) ? VRNA_PATH_SADDLE_MATRIX_NO_BOUNDS : VRNA_PATH_SADDLE_MATRIX_DEFAULT;
+        int *saddles = vrna_path_findpath_saddle_matrix(fc, &structures[0], args_info.depth_arg, INT_MAX - 1, options);
+        for (int i=0; i<m; i++) {
+          for (int j=i+1; j<m; j++) {
+            energy_barr[minima[j]*num+minima[i]] = energy_barr[minima[i]*num+minima[j]] = saddles[i*m+j]/100.0;
+            findpath_barr[minima[j]*num+minima[i]] = findpath_barr[minima[i]*num+minima[j]] = true;
+          }
+        }
+        findpath += m*(m-1)/2;
+
+        free(saddles);
+        vrna_fold_compound_free(fc);
       }
 
       // debug output
@@ -15,6 +15,10 @@
 #include <float.h>
 #include <math.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
@@ -49,6 +53,14 @@
 # define NR_GET_WEIGHT(a, b, c, d, e)  get_weight(b, c, d, e)
 #endif
 
+/*
+ *  When sampling from a vrna_rng_t, sample k draws its random numbers
+ *  from positions [k * 2^SAMPLE_DRAWS_SHIFT, (k + 1) * 2^SAMPLE_DRAWS_SHIFT)
+ *  of the stream. This renders each sample independent of the order in
+ *  which samples are processed, and thus of the number of threads
+ */
+#define SAMPLE_DRAWS_SHIFT  32
+
 
 /* combination of soft constraint wrappers */
 struct sc_wrappers {
@@ -127,7 +139,8 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
                 unsigned int                      num_samples,
                 vrna_boltzmann_sampling_callback  *bs_cb,
                 void                              *data,
-                struct vrna_pbacktrack_memory_s   *nr_mem);
+                struct vrna_pbacktrack_memory_s   *nr_mem,
+                struct sc_wrappers                *sc_wrap);
 
 
 PRIVATE int
@@ -178,7 +191,49 @@ PRIVATE unsigned int
 pbacktrack_circ(vrna_fold_compound_t              *fc,
                 unsigned int                      num_samples,
                 vrna_boltzmann_sampling_callback  *bs_cb,
-                void                              *data);
+                void                              *data,
+                struct sc_wrappers                *sc_wrap);
+
+
+PRIVATE unsigned int
+pbacktrack_streams(vrna_fold_compound_t             *fc,
+                   unsigned int                     length,
+                   unsigned int                     num_samples,
+                   vrna_boltzmann_sampling_callback *bs_cb,
+                   void                             *data,
+                   unsigned int                     options);
+
+
+PRIVATE int
+pbacktrack_substream(vrna_fold_compound_t *fc,
+                     unsigned int         length,
+                     const vrna_rng_t     *base,
+                     unsigned int         k,
+                     vrna_rng_t           *rng,
+                     struct sc_wrappers   *sc_wrap,
+                     char                 **structure);
+
+
+#if defined(_OPENMP) && !defined(VRNA_NR_SAMPLING_HASH)
+PRIVATE unsigned int
+pbacktrack_nr_concurrent(vrna_fold_compound_t             *fc,
+                         unsigned int                     length,
+                         unsigned int                     num_samples,
+                         vrna_boltzmann_sampling_callback *bs_cb,
+                         void                             *data,
+                         struct vrna_pbacktrack_memory_s  *nr_mem);
+
+
+#endif
+
+
+PRIVATE void
+init_ext_arrays(vrna_fold_compound_t *fc);
+
+
+PRIVATE void
+store_structure(const char  *structure,
+                void        *data);
 
 
 /*
@@ -195,11 +250,19 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
                            vrna_pbacktrack_mem_t            *nr_mem,
                            unsigned int                     options)
 {
-  unsigned int i = 0;
+  unsigned int  i = 0;
+  vrna_rng_t    *rng_prev;
 
   if (fc) {
     vrna_mx_pf_t *matrices = fc->exp_matrices;
 
+    /* draw random numbers from the generator attached to fc, if any */
+    rng_prev = vrna_rng_thread_get();
+    if ((!rng_prev) && (fc->rng))
+      vrna_rng_thread_set(fc->rng);
+
+    vrna_timing_start(fc->timing, VRNA_TIMING_SAMPLING);
+
     if (length > fc->length) {
       vrna_message_warning("vrna_pbacktrack5*(): length exceeds sequence length");
     } else if (length == 0) {
@@ -220,7 +283,12 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
         if (*nr_mem == NULL)
           *nr_mem = nr_init(fc);
 
-        i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, *nr_mem);
+#if defined(_OPENMP) && !defined(VRNA_NR_SAMPLING_HASH)
+        if (fc->num_threads != 1)
+          i = pbacktrack_nr_concurrent(fc, length, num_samples, bs_cb, data, *nr_mem);
+        else
+#endif
+        i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, *nr_mem, NULL);
 
         /* print warning if we've aborted backtracking too early */
         if ((i > 0) && (i < num_samples)) {
@@ -234,11 +302,18 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
                                fc->exp_matrices->q[fc->iindx[1] - length]);
         }
       }
+    } else if ((vrna_rng_thread_get()) ||
+               (fc->num_threads != 1)) {
+      i = pbacktrack_streams(fc, length, num_samples, bs_cb, data, options);
     } else if (fc->exp_params->model_details.circ) {
-      i = pbacktrack_circ(fc, num_samples, bs_cb, data);
+      i = pbacktrack_circ(fc, num_samples, bs_cb, data, NULL);
     } else {
-      i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, NULL);
+      i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, NULL, NULL);
     }
+
+    vrna_timing_stop(fc->timing, VRNA_TIMING_SAMPLING, (unsigned long long)i * length);
+
+    vrna_rng_thread_set(rng_prev);
   }
 
   return i; /* actual number of structures backtraced */
@@ -316,45 +391,32 @@ nr_init(vrna_fold_compound_t *fc)
 }
 
 
-/* general expr of vrna5_pbacktrack with possibility of non-redundant sampling */
+/*
+ * general expr of vrna5_pbacktrack with possibility of non-redundant sampling.
+ * Soft constraint wrappers are initialized locally unless sc_wrap is provided
+ */
 PRIVATE unsigned int
 wrap_pbacktrack(vrna_fold_compound_t              *vc,
                 unsigned int                      length,
                 unsigned int                      num_samples,
                 vrna_boltzmann_sampling_callback  *bs_cb,
                 void                              *data,
-                struct vrna_pbacktrack_memory_s   *nr_mem)
+                struct vrna_pbacktrack_memory_s   *nr_mem,
+                struct sc_wrappers                *sc_wrap)
 {
   char                *pstruc;
-  unsigned int        i, n;
-  int                 ret, pf_overflow, is_dup, *my_iindx;
-  FLT_OR_DBL          *q1k, *qln, *q;
-  vrna_mx_pf_t        *matrices;
-  struct sc_wrappers  *sc_wrap;
+  unsigned int        i;
+  int                 ret, pf_overflow, is_dup;
+  struct sc_wrappers  *sc_wrap_local;
 
-  i           = 0;
-  pf_overflow = 0;
-  sc_wrap     = sc_init(vc);
+  i             = 0;
+  pf_overflow   = 0;
+  sc_wrap_local = NULL;
 
-  n         = vc->length;
-  my_iindx  = vc->iindx;
-  matrices  = vc->exp_matrices;
-  q         = matrices->q;
-  q1k       = matrices->q1k;
-  qln       = matrices->qln;
+  if (!sc_wrap)
+    sc_wrap = sc_wrap_local = sc_init(vc);
 
-  if (!(q1k && qln)) {
-    matrices->q1k = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
-    matrices->qln = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
-    q1k           = matrices->q1k;
-    qln           = matrices->qln;
-    for (i = 1; i <= n; i++) {
-      q1k[i]  = q[my_iindx[1] - i];
-      qln[i]  = q[my_iindx[i] - n];
-    }
-    q1k[0]      = 1.0;
-    qln[n + 1]  = 1.0;
-  }
+  init_ext_arrays(vc);
 
   for (i = 0; i < num_samples; i++) {
     is_dup  = 1;
@@ -406,12 +468,415 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
       break;
   }
 
-  sc_free(sc_wrap);
+  if (sc_wrap_local)
+    sc_free(sc_wrap_local);
 
   return i;
 }
 
 
+/*
+ * Distribute samples among threads. Each sample draws from its own
+ * sub-stream of the random number generator bound to the calling thread
+ * (or a temporary one seeded from the process-wide generator). Since the
+ * partition function matrices are only read during backtracking, all
+ * threads share the same fold compound. Each thread allocates its random
+ * number generator and soft constraint wrappers only once and resets the
+ * generator for each sample.
+ */
+PRIVATE unsigned int
+pbacktrack_streams(vrna_fold_compound_t             *fc,
+                   unsigned int                     length,
+                   unsigned int                     num_samples,
+                   vrna_boltzmann_sampling_callback *bs_cb,
+                   void                             *data,
+                   unsigned int                     options)
+{
+  unsigned int  count;
+  int           num_threads, stop;
+  uint64_t      seed;
+  vrna_rng_t    *base, *tmp;
+
+  count       = 0;
+  stop        = 0;
+  tmp         = NULL;
+  base        = vrna_rng_thread_get();
+  num_threads = fc->num_threads;
+
+  if (!base) {
+    seed  = ((uint64_t)(vrna_urn() * 4294967296.) << 32) |
+            (uint64_t)(vrna_urn() * 4294967296.);
+    base  = tmp = vrna_rng_init(seed, 0);
+  }
+
+  /* lazy initialization of auxiliary arrays must take place before we fan out */
+  if (!fc->exp_params->model_details.circ)
+    init_ext_arrays(fc);
+
+#ifdef _OPENMP
+  if (num_threads < 1)
+    num_threads = omp_get_max_threads();
+
+#else
+  num_threads = 1;
+#endif
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(num_threads)
+#endif
+  {
+    char                *structure;
+    unsigned int        k;
+    int                 ret, done;
+    vrna_rng_t          *rng;
+    struct sc_wrappers  *sc_wrap;
+
+    rng     = vrna_rng_copy(base);
+    sc_wrap = sc_init(fc);
+
+    if (options & VRNA_PBACKTRACK_UNORDERED) {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+      for (k = 0; k < num_samples; k++) {
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+        done = stop;
+
+        if (done)
+          continue;
+
+        structure = NULL;
+        ret       = pbacktrack_substream(fc, length, base, k, rng, sc_wrap, &structure);
+
+        if (ret) {
+#ifdef _OPENMP
+#pragma omp critical (vrna_pbacktrack_cb)
+#endif
+          {
+            if (bs_cb)
+              bs_cb(structure, data);
+
+            count++;
+          }
+        } else {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+          stop = 1;
+        }
+
+        free(structure);
+      }
+    } else {
+#ifdef _OPENMP
+#pragma omp for ordered schedule(dynamic, 1)
+#endif
+      for (k = 0; k < num_samples; k++) {
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+        done = stop;
+
+        structure = NULL;
+        ret       = (done) ? 0 : pbacktrack_substream(fc, length, base, k, rng, sc_wrap, &structure);
+
+        /* deliver samples in the order they would have been drawn sequentially */
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+        {
+          if (!stop) {
+            if (ret) {
+              if (bs_cb)
+                bs_cb(structure, data);
+
+              count++;
+            } else {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+              stop = 1;
+            }
+          }
+        }
+
+        free(structure);
+      }
+    }
+
+    sc_free(sc_wrap);
+    vrna_rng_free(rng);
+  }
+
+  if (tmp)
+    vrna_rng_free(tmp);
+  else
+    vrna_rng_skip(base, (uint64_t)num_samples << SAMPLE_DRAWS_SHIFT);
+
+  return count;
+}
+
+
+/* draw a single sample from sub-stream k of base using the thread-local rng and sc_wrap */
+PRIVATE int
+pbacktrack_substream(vrna_fold_compound_t *fc,
+                     unsigned int         length,
+                     const vrna_rng_t     *base,
+                     unsigned int         k,
+                     vrna_rng_t           *rng,
+                     struct sc_wrappers   *sc_wrap,
+                     char                 **structure)
+{
+  unsigned int  ret;
+  vrna_rng_t    *rng_prev;
+
+  vrna_rng_assign(rng, base);
+  vrna_rng_skip(rng, (uint64_t)k << SAMPLE_DRAWS_SHIFT);
+
+  rng_prev = vrna_rng_thread_set(rng);
+
+  if (fc->exp_params->model_details.circ)
+    ret = pbacktrack_circ(fc, 1, &store_structure, (void *)structure, sc_wrap);
+  else
+    ret = wrap_pbacktrack(fc, length, 1, &store_structure, (void *)structure, NULL, sc_wrap);
+
+  vrna_rng_thread_set(rng_prev);
+
+  return (int)ret;
+}
+
+
+#if defined(_OPENMP) && !defined(VRNA_NR_SAMPLING_HASH)
+/*
+ * Non-redundant sampling with several workers that extend the same prefix
+ * tree. Sampling proceeds in rounds where each worker draws one candidate
+ * from the tree as it was at the beginning of the round, i.e. node weights
+ * remain unchanged while workers descend and only new (zero-weight) nodes
+ * are inserted concurrently. At the end of each round, the candidates are
+ * committed in order of the worker id. Candidates that duplicate a structure
+ * committed earlier in the same round are rejected, which leaves the
+ * distribution of the accepted samples identical to sequential
+ * non-redundant sampling. Nodes that were inserted for candidates that are
+ * not committed keep their zero weight and remain marked as created_recently,
+ * i.e. as not being part of any accepted sample. A later candidate that ends
+ * in such a node therefore represents a new structure, just like in the
+ * sequential case. As in pbacktrack_streams(), attempt k draws from
+ * sub-stream k, so the samples only depend on the random number generator
+ * and the number of threads.
+ */
+PRIVATE unsigned int
+pbacktrack_nr_concurrent(vrna_fold_compound_t             *fc,
+                         unsigned int                     length,
+                         unsigned int                     num_samples,
+                         vrna_boltzmann_sampling_callback *bs_cb,
+                         void                             *data,
+                         struct vrna_pbacktrack_memory_s  *nr_mem)
+{
+  char              **structures;
+  unsigned int      count, attempts;
+  int               i, num_threads, stop, *rets;
+  size_t            block_size;
+  uint64_t          seed;
+  double            pf, *weights;
+  NR_NODE           **leaves;
+  nr_locks          *locks;
+  struct nr_memory  **worker_dat;
+  vrna_rng_t        *base, *tmp;
+
+  count       = 0;
+  attempts    = 0;
+  stop        = 0;
+  tmp         = NULL;
+  base        = vrna_rng_thread_get();
+  num_threads = fc->num_threads;
+  pf          = fc->exp_matrices->q[fc->iindx[1] - length];
+  block_size  = 5000 * sizeof(NR_NODE);
+
+  if (num_threads < 1)
+    num_threads = omp_get_max_threads();
+
+  if (!base) {
+    seed  = ((uint64_t)(vrna_urn() * 4294967296.) << 32) |
+            (uint64_t)(vrna_urn() * 4294967296.);
+    base  = tmp = vrna_rng_init(seed, 0);
+  }
+
+  init_ext_arrays(fc);
+
+  locks       = create_nr_locks();
+  structures  = (char **)vrna_alloc(sizeof(char *) * num_threads);
+  leaves      = (NR_NODE **)vrna_alloc(sizeof(NR_NODE *) * num_threads);
+  weights     = (double *)vrna_alloc(sizeof(double) * num_threads);
+  rets        = (int *)vrna_alloc(sizeof(int) * num_threads);
+  worker_dat  = (struct nr_memory **)vrna_alloc(sizeof(struct nr_memory *) * num_threads);
+
+#pragma omp parallel num_threads(num_threads)
+  {
+    char                            *pstruc;
+    int                             tid, nt, t, ret, accepted, is_dup, pf_overflow;
+    vrna_rng_t                      *rng, *rng_prev;
+    struct sc_wrappers              *sc_wrap;
+    struct vrna_pbacktrack_memory_s mem;
+
+    tid       = omp_get_thread_num();
+    nt        = omp_get_num_threads();
+    sc_wrap   = sc_init(fc);
+    rng       = vrna_rng_copy(base);
+    rng_prev  = vrna_rng_thread_get();
+
+    mem.root_node   = nr_mem->root_node;
+    mem.memory_dat  = create_nr_memory_concurrent(sizeof(NR_NODE), block_size, locks);
+
+    while (!stop) {
+      /*
+       *  Descend until we reach a leaf that is connected to the root. Otherwise,
+       *  another worker inserted nodes in our way and we repeat the descent with
+       *  the same random numbers.
+       */
+      do {
+        vrna_rng_assign(rng, base);
+        vrna_rng_skip(rng, (uint64_t)(attempts + tid) << SAMPLE_DRAWS_SHIFT);
+        vrna_rng_thread_set(rng);
+
+        pstruc = vrna_alloc((length + 1) * sizeof(char));
+        memset(pstruc, '.', sizeof(char) * length);
+
+        mem.q_remain      = pf;
+        mem.current_node  = mem.root_node;
+
+#ifdef VRNA_WITH_BOUSTROPHEDON
+        ret = backtrack_ext_loop(length, pstruc, fc, length, sc_wrap, &mem);
+#else
+        ret = backtrack_ext_loop(1, pstruc, fc, length, sc_wrap, &mem);
+#endif
+
+        vrna_rng_thread_set(rng_prev);
+
+        if (get_ll_root(mem.current_node) == mem.root_node)
+          break;
+
+        free(pstruc);
+      } while (1);
+
+      structures[tid] = pstruc;
+      leaves[tid]     = mem.current_node;
+      weights[tid]    = mem.q_remain;
+      rets[tid]       = ret;
+
+#pragma omp barrier
+
+#pragma omp single
+      {
+        accepted = 0;
+        for (t = 0; (t < nt) && (!stop); t++) {
+          if (rets[t] == 0) {
+            stop = 1;
+            break;
+          }
+
+          if (is_dup_ll(leaves[t])) {
+            /* duplicates of samples accepted in this round are expected */
+            if (!accepted) {
+              vrna_message_warning("vrna_pbacktrack_nr*(): %s", info_nr_duplicates);
+              stop = 1;
+            }
+
+            continue;
+          }
+
+          traceback_to_ll_root(leaves[t], weights[t], &is_dup, &pf_overflow);
+
+          if (pf_overflow) {
+            vrna_message_warning("vrna_pbacktrack_nr*(): %s", info_nr_overflow);
+            stop = 1;
+            break;
+          }
+
+          if ((rets[t] > 0) && (bs_cb))
+            bs_cb(structures[t], data);
+
+          accepted++;
+          if (++count == num_samples)
+            stop = 1;
+        }
+
+        attempts += nt;
+      }
+
+      free(structures[tid]);
+    }
+
+    worker_dat[tid] = mem.memory_dat;
+
+    sc_free(sc_wrap);
+    vrna_rng_free(rng);
+  }
+
+  /* hand over all nodes to the memory of the caller */
+  for (i = 0; i < num_threads; i++)
+    merge_nr_memory(&(nr_mem->memory_dat), worker_dat[i]);
+
+  nr_mem->current_node = nr_mem->root_node;
+
+  free_nr_locks(locks);
+  free(structures);
+  free(leaves);
+  free(weights);
+  free(rets);
+  free(worker_dat);
+
+  if (tmp)
+    vrna_rng_free(tmp);
+  else
+    vrna_rng_skip(base, (uint64_t)attempts << SAMPLE_DRAWS_SHIFT);
+
+  return count;
+}
+
+
+#endif
+
+
+PRIVATE void
+init_ext_arrays(vrna_fold_compound_t *fc)
+{
+  unsigned int  i, n;
+  int           *my_iindx;
+  FLT_OR_DBL    *q1k, *qln, *q;
+  vrna_mx_pf_t  *matrices;
+
+  n         = fc->length;
+  my_iindx  = fc->iindx;
+  matrices  = fc->exp_matrices;
+  q         = matrices->q;
+
+  if (!(matrices->q1k && matrices->qln)) {
+    matrices->q1k = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
+    matrices->qln = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+    q1k           = matrices->q1k;
+    qln           = matrices->qln;
+    for (i = 1; i <= n; i++) {
+      q1k[i]  = q[my_iindx[1] - i];
+      qln[i]  = q[my_iindx[i] - n];
+    }
+    q1k[0]      = 1.0;
+    qln[n + 1]  = 1.0;
+  }
+}
+
+
+PRIVATE void
+store_structure(const char  *structure,
+                void        *data)
+{
+  char **s = (char **)data;
+
+  *s = strdup(structure);
+}
+
+
 /* backtrack one external */
 PRIVATE int
 backtrack_ext_loop(int                              init_val,
@@ -424,7 +889,7 @@ backtrack_ext_loop(int                              init_val,
   unsigned char             *hard_constraints;
   short                     *S1, *S2, **S, **S5, **S3;
   unsigned int              **a2s, s, n_seq;
-  int                       ret, i, j, ij, n, k, u, type, *my_iindx, hc_decompose, *hc_up_ext;
+  int                       ret, i, j, ij, n, k, u, type, *my_iindx, *jindx, hc_decompose, *hc_up_ext;
   FLT_OR_DBL                r, fbd, fbds, qt, q_temp, qkl, *q, *qb, *q1k, *qln, *scale;
   double                    *q_remain;
   vrna_mx_pf_t              *matrices;
@@ -461,6 +926,7 @@ backtrack_ext_loop(int                              init_val,
   pf_params = vc->exp_params;
   md        = &(vc->exp_params->model_details);
   my_iindx  = vc->iindx;
+  jindx     = vc->jindx;
   matrices  = vc->exp_matrices;
 
   hc = vc->hc;
@@ -482,7 +948,7 @@ backtrack_ext_loop(int                              init_val,
     a2s   = vc->a2s;
   }
 
-  hard_constraints  = hc->mx;
+  hard_constraints  = hc->matrix;
   hc_up_ext         = hc->up_ext;
   sc_wrapper_ext    = &(sc_wrap->sc_wrapper_ext);
 
@@ -498,7 +964,7 @@ backtrack_ext_loop(int                              init_val,
 #ifndef VRNA_NR_SAMPLING_HASH
   if (current_node) {
     memorized_node_prev = NULL;
-    memorized_node_cur  = (*current_node)->head;
+    memorized_node_cur  = get_ll_head(*current_node);
   }
 
 #endif
@@ -582,7 +1048,7 @@ backtrack_ext_loop(int                              init_val,
       i = (int)(1 + (u - 1) * ((k - 1) % 2)) +
           (int)((1 - (2 * ((k - 1) % 2))) * ((k - 1) / 2));
       ij            = my_iindx[i] - j;
-      hc_decompose  = hard_constraints[n * j + i];
+      hc_decompose  = hard_constraints[jindx[j] + i];
       if (hc_decompose & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) {
         qkl = qb[ij] *
               q1k[i - 1];
@@ -724,7 +1190,7 @@ backtrack_ext_loop(int                              init_val,
     r = vrna_urn() * (qln[i] - q_temp - fbd);
     for (qt = 0, j = i + 1; j <= length; j++) {
       ij            = my_iindx[i] - j;
-      hc_decompose  = hard_constraints[n * i + j];
+      hc_decompose  = hard_constraints[jindx[j] + i];
       if (hc_decompose & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) {
         qkl = qb[ij];
         if (vc->type == VRNA_FC_TYPE_SINGLE) {
@@ -873,7 +1339,7 @@ backtrack_qm(int                              i,
 #ifndef VRNA_NR_SAMPLING_HASH
   if (current_node) {
     memorized_node_prev = NULL;
-    memorized_node_cur  = (*current_node)->head;
+    memorized_node_cur  = get_ll_head(*current_node);
   }
 
 #endif
@@ -1041,7 +1507,7 @@ backtrack_qm1(int                             i,
   unsigned char             *hard_constraints;
   char                      *ptype;
   short                     *S1, **S, **S5, **S3;
-  unsigned int              n, s, n_seq;
+  unsigned int              s, n_seq;
   int                       ii, l, il, type, turn, u, *my_iindx, *jindx, *hc_up_ml;
   FLT_OR_DBL                qt, fbd, fbds, r, q_temp, *qm1, *qb, *expMLbase;
   double                    *q_remain;
@@ -1071,7 +1537,6 @@ backtrack_qm1(int                             i,
   NR_NODE *memorized_node_cur   = NULL;           /* remembers actual node in linked list */
 #endif
 
-  n                 = vc->length;
   fbd               = 0.;
   fbds              = 0.;
   pf_params         = vc->exp_params;
@@ -1080,7 +1545,7 @@ backtrack_qm1(int                             i,
   jindx             = vc->jindx;
   hc                = vc->hc;
   hc_up_ml          = hc->up_ml;
-  hard_constraints  = hc->mx;
+  hard_constraints  = hc->matrix;
   sc_wrapper_ml     = &(sc_wrap->sc_wrapper_ml);
 
   matrices  = vc->exp_matrices;
@@ -1108,7 +1573,7 @@ backtrack_qm1(int                             i,
 #ifndef VRNA_NR_SAMPLING_HASH
   if (current_node) {
     memorized_node_prev = NULL;
-    memorized_node_cur  = (*current_node)->head;
+    memorized_node_cur  = get_ll_head(*current_node);
   }
 
 #endif
@@ -1123,7 +1588,7 @@ backtrack_qm1(int                             i,
   ii  = my_iindx[i];
   for (qt = 0., l = j; l > i + turn; l--) {
     il = jindx[l] + i;
-    if (hard_constraints[n * i + l] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
+    if (hard_constraints[il] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
       u = j - l;
       if (hc_up_ml[l + 1] >= u) {
         q_temp = qb[ii - l] *
@@ -1250,7 +1715,7 @@ backtrack(int                             i,
   unsigned char             *hard_constraints, hc_decompose;
   char                      *ptype;
   short                     *S1, **S, **S5, **S3;
-  unsigned int              **a2s, s, n_seq, n, type, type_2, *types, u1_local, u2_local;
+  unsigned int              **a2s, s, n_seq, type, type_2, *types, u1_local, u2_local;
   int                       *my_iindx, *jindx, *hc_up_int, ret, *pscore, turn, *rtype,
                             k, l, kl, u1, u2, max_k, min_l, ii, jj;
   FLT_OR_DBL                *qb, *qm, *qm1, *scale, r, fbd, fbds, qbt1, qbr, qt, q_temp,
@@ -1289,7 +1754,6 @@ backtrack(int                             i,
   qbt1    = 0.;
   q_temp  = 0.;
 
-  n         = vc->length;
   pf_params = vc->exp_params;
   kTn       = pf_params->kT / 10.;
   md        = &(pf_params->model_details);
@@ -1324,7 +1788,7 @@ backtrack(int                             i,
 
   hc                = vc->hc;
   hc_up_int         = hc->up_int;
-  hard_constraints  = hc->mx;
+  hard_constraints  = hc->matrix;
   sc_wrapper_int    = &(sc_wrap->sc_wrapper_int);
   sc_wrapper_ml     = &(sc_wrap->sc_wrapper_ml);
 
@@ -1337,12 +1801,12 @@ backtrack(int                             i,
 #ifndef VRNA_NR_SAMPLING_HASH
   if (current_node) {
     memorized_node_prev = NULL;
-    memorized_node_cur  = (*current_node)->head;
+    memorized_node_cur  = get_ll_head(*current_node);
   }
 
 #endif
 
-  hc_decompose = hard_constraints[n * j + i];
+  hc_decompose = hard_constraints[jindx[j] + i];
 
   do {
     k = i;
@@ -1367,7 +1831,7 @@ backtrack(int                             i,
     r     = vrna_urn() * (qbr - fbd);
     qbt1  = 0.;
 
-    hc_decompose = hard_constraints[n * i + j];
+    hc_decompose = hard_constraints[jindx[j] + i];
 
     /* hairpin contribution */
     q_temp = vrna_exp_E_hp_loop(vc, i, j);
@@ -1423,7 +1887,7 @@ backtrack(int                             i,
           if (hc_up_int[l + 1] < u2)
             break;
 
-          if (hard_constraints[n * k + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+          if (hard_constraints[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
             q_temp = qb[kl]
                      * scale[u1 + u2 + 2];
 
@@ -1513,7 +1977,7 @@ backtrack(int                             i,
   } while (1);
 
   /* backtrack in multi-loop */
-  if (hard_constraints[n * j + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+  if (hard_constraints[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
     closingPair = expMLclosing *
                   scale[2];
 
@@ -1643,21 +2107,22 @@ PRIVATE unsigned int
 pbacktrack_circ(vrna_fold_compound_t              *vc,
                 unsigned int                      num_samples,
                 vrna_boltzmann_sampling_callback  *bs_cb,
-                void                              *data)
+                void                              *data,
+                struct sc_wrappers                *sc_wrap)
 {
   unsigned char             *hc_mx, eval_loop;
   char                      *pstruc;
   short                     *S1, *S2, **S, **S5, **S3;
   unsigned int              type, type2, *tt, s, n_seq, **a2s, u1_local,
                             u2_local, u3_local, count;
-  int                       i, j, k, l, n, u, *hc_up, *my_iindx, turn,
+  int                       i, j, k, l, n, u, *hc_up, *my_iindx, *jindx, turn,
                             ln1, ln2, ln3, lstart;
   FLT_OR_DBL                r, qt, q_temp, qo, qmo, *scale, *qb, *qm, *qm2,
                             qb_ij, expMLclosing;
   vrna_exp_param_t          *pf_params;
   vrna_md_t                 *md;
   vrna_mx_pf_t              *matrices;
-  struct sc_wrappers        *sc_wrap;
+  struct sc_wrappers        *sc_wrap_local;
   struct sc_wrapper_exp_ext *sc_wrapper_ext;
   struct sc_wrapper_exp_int *sc_wrapper_int;
   struct sc_wrapper_exp_ml  *sc_wrapper_ml;
@@ -1667,6 +2132,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
   md            = &(pf_params->model_details);
   matrices      = vc->exp_matrices;
   my_iindx      = vc->iindx;
+  jindx         = vc->jindx;
   expMLclosing  = pf_params->expMLclosing;
   turn          = pf_params->model_details.min_loop_size;
 
@@ -1677,10 +2143,14 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
   qm2   = matrices->qm2;
   scale = matrices->scale;
 
-  hc_mx = vc->hc->mx;
+  hc_mx = vc->hc->matrix;
   hc_up = vc->hc->up_int;
 
-  sc_wrap         = sc_init(vc);
+  sc_wrap_local = NULL;
+
+  if (!sc_wrap)
+    sc_wrap = sc_wrap_local = sc_init(vc);
+
   sc_wrapper_ext  = &(sc_wrap->sc_wrapper_ext);
   sc_wrapper_int  = &(sc_wrap->sc_wrapper_int);
   sc_wrapper_ml   = &(sc_wrap->sc_wrapper_ml);
@@ -1744,7 +2214,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
         }
 
         /* 2. search for (k,l) with which we can close an interior loop  */
-        if (hc_mx[n * i + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+        if (hc_mx[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
           if (vc->type == VRNA_FC_TYPE_SINGLE)
             type = vrna_get_ptype_md(S2[j], S2[i], md);
           else
@@ -1773,7 +2243,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
               if ((ln1 + ln2 + ln3) > MAXLOOP)
                 continue;
 
-              eval_loop = hc_mx[n * k + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP;
+              eval_loop = hc_mx[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP;
 
               if (eval_loop) {
                 q_temp = qb_ij *
@@ -1882,7 +2352,8 @@ pbacktrack_circ_loop_end:
     free(pstruc);
   }
 
-  sc_free(sc_wrap);
+  if (sc_wrap_local)
+    sc_free(sc_wrap_local);
 
   return count;
 }
@@ -15,6 +15,33 @@
  *  @{
  *  @brief  Functions to draw random structure samples from the ensemble according to their
  *          equilibrium probability
+ *
+ *  Random numbers are drawn from the generator bound to the calling thread
+ *  (see vrna_rng_thread_set()), or, if there is none, from the generator attached
+ *  to the #vrna_fold_compound_t (see vrna_fold_compound_rng_seed()). Otherwise,
+ *  the process-wide generator of vrna_urn() is used. Seeding either of the
+ *  former renders stochastic backtracking reproducible.
+ *
+ *  Once vrna_pf() has filled the partition function matrices, stochastic
+ *  backtracking only reads from them. Hence, samples may be drawn by multiple
+ *  threads that share the same #vrna_fold_compound_t. The number of threads is
+ *  taken from #vrna_fold_compound_t.num_threads, i.e. the same setting that
+ *  controls the parallel fill of vrna_pf(). Whenever a seeded random
+ *  number generator is used, or more than one thread is requested, each sample
+ *  draws its random numbers from a separate sub-stream of the generator. For a
+ *  fixed seed, the set of samples is then identical for any number of threads.
+ *  The callback function is always executed by one thread at a time, but not
+ *  necessarily by the calling thread. Samples are delivered in order unless
+ *  #VRNA_PBACKTRACK_UNORDERED is passed.
+ *
+ *  In non-redundant mode, several threads extend the shared memory of previously
+ *  drawn structures (#vrna_pbacktrack_mem_t) simultaneously. Samples are then
+ *  drawn in rounds of one candidate per thread, and candidates that duplicate a
+ *  structure accepted earlier in the same round are discarded. For a fixed seed,
+ *  the samples are reproducible for a fixed number of threads, but differ from
+ *  those of a sequential run. Non-redundant sampling of circular RNAs, or with
+ *  the hash-based memory (configure option @p --enable-NRhash) remains
+ *  sequential.
  */
 
 
@@ -39,6 +66,20 @@
  */
 #define VRNA_PBACKTRACK_NON_REDUNDANT   1
 
+/**
+ *  @brief  Boltzmann sampling flag indicating that samples may be delivered in arbitrary order
+ *
+ *  When samples are drawn by multiple threads (see vrna_fold_compound_num_threads()), the
+ *  callback function receives them in the same order as in a sequential run by
+ *  default. This flag lifts this restriction and passes each sample to the callback
+ *  as soon as it becomes available. The callback is still never executed
+ *  concurrently.
+ *
+ *  @see    vrna_pbacktrack5_cb(), vrna_pbacktrack_cb(), vrna_pbacktrack5_num(),
+ *          vrna_pbacktrack_num()
+ */
+#define VRNA_PBACKTRACK_UNORDERED       2
+
 /**
  *  @brief  Callback for Boltzmann sampling
  *
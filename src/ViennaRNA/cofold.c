@@ -158,13 +158,21 @@ vrna_mfe_dimer(vrna_fold_compound_t *vc,
   if (vc->stat_cb)
     vc->stat_cb(VRNA_STATUS_MFE_PRE, vc->auxdata);
 
+  vrna_timing_start(vc->timing, VRNA_TIMING_FILL);
+
   energy = fill_arrays(vc, 0);
 
+  vrna_timing_stop(vc->timing,
+                   VRNA_TIMING_FILL,
+                   (unsigned long long)length * (length + 1) / 2);
+
   /* call user-defined recursion status callback function */
   if (vc->stat_cb)
     vc->stat_cb(VRNA_STATUS_MFE_POST, vc->auxdata);
 
   if (structure && vc->params->model_details.backtrack) {
+    vrna_timing_start(vc->timing, VRNA_TIMING_BACKTRACK);
+
     bp = (vrna_bp_stack_t *)vrna_alloc(sizeof(vrna_bp_stack_t) * (4 * (1 + length / 2))); /* add a guess of how many G's may be involved in a G quadruplex */
 
     backtrack(bt_stack, bp, vc);
@@ -173,6 +181,8 @@ vrna_mfe_dimer(vrna_fold_compound_t *vc,
     strncpy(structure, s, length + 1);
     free(s);
     free(bp);
+
+    vrna_timing_stop(vc->timing, VRNA_TIMING_BACKTRACK, (unsigned long long)length);
   }
 
   if (vc->params->model_details.backtrack_type == 'C')
@@ -222,7 +232,7 @@ fill_arrays(vrna_fold_compound_t  *vc,
   se                = vc->strand_end;
   so                = vc->strand_order;
   hc                = vc->hc;
-  hard_constraints  = hc->mx;
+  hard_constraints  = hc->matrix;
   matrices          = vc->matrices;
   my_f5             = matrices->f5;
   my_c              = matrices->c;
@@ -263,7 +273,7 @@ fill_arrays(vrna_fold_compound_t  *vc,
       int ij;
       ij            = indx[j] + i;
       type          = vrna_get_ptype(ij, ptype);
-      hc_decompose  = hard_constraints[length * i + j];
+      hc_decompose  = hard_constraints[ij];
       energy        = INF;
 
       no_close = (((type == 3) || (type == 4)) && noGUclosure);
@@ -592,7 +602,7 @@ free_end(int                  *array,
   ggg               = matrices->ggg;
   hc                = vc->hc;
   sc                = vc->sc;
-  hard_constraints  = hc->mx;
+  hard_constraints  = hc->matrix;
 
   if (hc->up_ext[i]) {
     if (i == start)
@@ -634,7 +644,7 @@ free_end(int                  *array,
       jj  = j;
     }                           /* inc<0 */
 
-    if (hard_constraints[length * ii + jj] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) {
+    if (hard_constraints[indx[jj] + ii] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) {
       type    = vrna_get_ptype(indx[jj] + ii, ptype);
       si      = ((ii > 1) && (sn[ii - 1] == sn[ii])) ? S1[ii - 1] : -1;
       sj      = ((jj < length) && (sn[jj] == sn[jj + 1])) ? S1[jj + 1] : -1;
@@ -713,7 +723,7 @@ free_end(int                  *array,
         jj  = j;
       }                             /* inc<0 */
 
-      if (!(hard_constraints[length * ii + jj] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP))
+      if (!(hard_constraints[indx[jj] + ii] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP))
         continue;
 
       type    = vrna_get_ptype(indx[jj] + ii, ptype);
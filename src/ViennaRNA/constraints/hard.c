@@ -44,11 +44,25 @@
  #################################
  */
 
+/*
+ *  Hard constraints are allocated together with some private bookkeeping,
+ *  such that the memory of default hard constraints can be re-used for
+ *  shorter sequences
+ */
+struct hc_private {
+  vrna_hc_t     hc;       /* the public data structure, must be the first member */
+  unsigned int  n_alloc;  /* sequence length the memory has been allocated for */
+};
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
  #################################
  */
+PRIVATE vrna_hc_t *
+hc_alloc(unsigned int n);
+
+
 PRIVATE unsigned char
 default_pair_constraint(vrna_fold_compound_t  *fc,
                         int                   i,
@@ -176,31 +190,42 @@ vrna_hc_init(vrna_fold_compound_t *vc)
 
   n = vc->length;
 
-  /* free previous hard constraints */
-  vrna_hc_free(vc->hc);
-
-  /* allocate memory new hard constraints data structure */
-  hc          = (vrna_hc_t *)vrna_alloc(sizeof(vrna_hc_t));
-  hc->type    = VRNA_HC_DEFAULT;
-  hc->n       = n;
-  hc->matrix  = (unsigned char *)vrna_alloc(sizeof(unsigned char) * ((n * (n + 1)) / 2 + 2));
-  hc->mx      = (unsigned char *)vrna_alloc(sizeof(unsigned char) * ((n + 1) * (n + 1)));
-  hc->up_ext  = (int *)vrna_alloc(sizeof(int) * (n + 2));
-  hc->up_hp   = (int *)vrna_alloc(sizeof(int) * (n + 2));
-  hc->up_int  = (int *)vrna_alloc(sizeof(int) * (n + 2));
-  hc->up_ml   = (int *)vrna_alloc(sizeof(int) * (n + 2));
+  if ((vc->hc) &&
+      (vc->hc->type == VRNA_HC_DEFAULT) &&
+      (((struct hc_private *)vc->hc)->n_alloc >= n)) {
+    /*
+     *  re-use memory of previous hard constraints. Since all entries
+     *  are indexed via jindx, a larger matrix is still valid
+     */
+    hc    = vc->hc;
+    hc->n = n;
+  } else {
+    /* free previous hard constraints */
+    vrna_hc_free(vc->hc);
+
+    /* allocate memory new hard constraints data structure */
+    hc          = hc_alloc(n);
+    hc->type    = VRNA_HC_DEFAULT;
+    hc->n       = n;
+    hc->matrix  = (unsigned char *)vrna_alloc(sizeof(unsigned char) * ((n * (n + 1)) / 2 + 2));
+    hc->mx      = NULL; /* deprecated */
+    hc->up_ext  = (int *)vrna_alloc(sizeof(int) * (n + 2));
+    hc->up_hp   = (int *)vrna_alloc(sizeof(int) * (n + 2));
+    hc->up_int  = (int *)vrna_alloc(sizeof(int) * (n + 2));
+    hc->up_ml   = (int *)vrna_alloc(sizeof(int) * (n + 2));
+
+    /* add null pointers for the generalized hard constraint feature */
+    hc->f         = NULL;
+    hc->data      = NULL;
+    hc->free_data = NULL;
 
-  /* set new hard constraints */
-  vc->hc = hc;
+    /* set new hard constraints */
+    vc->hc = hc;
+  }
 
-  /* prefill default values  */
+  /* prefill default values, this also removes generalized hard constraints */
   hc_reset_to_default(vc);
 
-  /* add null pointers for the generalized hard constraint feature */
-  hc->f         = NULL;
-  hc->data      = NULL;
-  hc->free_data = NULL;
-
   /* update */
   hc_update_up(vc);
 }
@@ -218,7 +243,7 @@ vrna_hc_init_window(vrna_fold_compound_t *vc)
   vrna_hc_free(vc->hc);
 
   /* allocate memory new hard constraints data structure */
-  hc                = (vrna_hc_t *)vrna_alloc(sizeof(vrna_hc_t));
+  hc                = hc_alloc(n);
   hc->type          = VRNA_HC_WINDOW;
   hc->n             = n;
   hc->matrix_local  = (unsigned char **)vrna_alloc(sizeof(unsigned char *) * (n + 2));
@@ -368,31 +393,18 @@ vrna_hc_add_bp_nonspecific(vrna_fold_compound_t *vc,
       } else {
         if (option & VRNA_CONSTRAINT_CONTEXT_NO_REMOVE) {
           /* only allow for possibly non-canonical pairs, do not enforce them */
-          for (p = 1; p < i; p++) {
+          for (p = 1; p < i; p++)
             hc->matrix[vc->jindx[i] + p]  |= t1;
-            hc->mx[n * i + p]             |= t1;
-            hc->mx[n * p + i]             |= t1;
-          }
-          for (p = i + 1; p <= vc->length; p++) {
+          for (p = i + 1; p <= vc->length; p++)
             hc->matrix[vc->jindx[p] + i]  |= t2;
-            hc->mx[n * i + p]             |= t2;
-            hc->mx[n * p + i]             |= t2;
-          }
         } else {
           /* force pairing direction */
-          for (p = 1; p < i; p++) {
+          for (p = 1; p < i; p++)
             hc->matrix[vc->jindx[i] + p]  &= t1;
-            hc->mx[n * i + p]             &= t1;
-            hc->mx[n * p + i]             &= t1;
-          }
-          for (p = i + 1; p <= vc->length; p++) {
+          for (p = i + 1; p <= vc->length; p++)
             hc->matrix[vc->jindx[p] + i]  &= t2;
-            hc->mx[n * i + p]             &= t2;
-            hc->mx[n * p + i]             &= t2;
-          }
           /* nucleotide mustn't be unpaired */
           hc->matrix[vc->jindx[i] + i]  = VRNA_CONSTRAINT_CONTEXT_NONE;
-          hc->mx[n * i + i]             = VRNA_CONSTRAINT_CONTEXT_NONE;
         }
 
         hc_update_up(vc);
@@ -408,7 +420,6 @@ vrna_hc_add_bp(vrna_fold_compound_t *vc,
                int                  j,
                unsigned char        option)
 {
-  unsigned int  n;
   int           k, l;
   vrna_hc_t     *hc;
 
@@ -426,8 +437,7 @@ vrna_hc_add_bp(vrna_fold_compound_t *vc,
         return;
       }
 
-      hc  = vc->hc;
-      n   = hc->n;
+      hc = vc->hc;
 
       if (hc->type == VRNA_HC_WINDOW) {
         hc_init_bp_storage(hc);
@@ -463,15 +473,9 @@ vrna_hc_add_bp(vrna_fold_compound_t *vc,
           if (hc->matrix[vc->jindx[j] + i])
             if (vc->ptype[vc->jindx[j] + i] == 0)
               vc->ptype[vc->jindx[j] + i] = 7;
-
-          if (hc->mx[n * i + j])
-            if (vc->ptype[vc->jindx[j] + i] == 0)
-              vc->ptype[vc->jindx[j] + i] = 7;
         }
 
         hc->matrix[vc->jindx[j] + i]  = option & VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
-        hc->mx[n * i + j]             = option & VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
-        hc->mx[n * j + i]             = option & VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
 
         if (!(option & VRNA_CONSTRAINT_CONTEXT_NO_REMOVE)) {
           /*
@@ -481,43 +485,18 @@ vrna_hc_add_bp(vrna_fold_compound_t *vc,
           for (k = 1; k < i; k++) {
             hc->matrix[vc->jindx[i] + k]  = VRNA_CONSTRAINT_CONTEXT_NONE;
             hc->matrix[vc->jindx[j] + k]  = VRNA_CONSTRAINT_CONTEXT_NONE;
-
-            hc->mx[n * i + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            hc->mx[n * k + i] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            hc->mx[n * j + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            hc->mx[n * k + j] = VRNA_CONSTRAINT_CONTEXT_NONE;
-
-            for (l = i + 1; l < j; l++) {
+            for (l = i + 1; l < j; l++)
               hc->matrix[vc->jindx[l] + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-
-              hc->mx[n * k + l] = VRNA_CONSTRAINT_CONTEXT_NONE;
-              hc->mx[n * l + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            }
           }
           for (k = i + 1; k < j; k++) {
             hc->matrix[vc->jindx[k] + i]  = VRNA_CONSTRAINT_CONTEXT_NONE;
             hc->matrix[vc->jindx[j] + k]  = VRNA_CONSTRAINT_CONTEXT_NONE;
-
-            hc->mx[n * i + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            hc->mx[n * k + i] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            hc->mx[n * j + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            hc->mx[n * k + j] = VRNA_CONSTRAINT_CONTEXT_NONE;
-
-            for (l = j + 1; l <= vc->length; l++) {
+            for (l = j + 1; l <= vc->length; l++)
               hc->matrix[vc->jindx[l] + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-
-              hc->mx[n * k + l] = VRNA_CONSTRAINT_CONTEXT_NONE;
-              hc->mx[n * l + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            }
           }
           for (k = j + 1; k <= vc->length; k++) {
             hc->matrix[vc->jindx[k] + i]  = VRNA_CONSTRAINT_CONTEXT_NONE;
             hc->matrix[vc->jindx[k] + j]  = VRNA_CONSTRAINT_CONTEXT_NONE;
-
-            hc->mx[n * i + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            hc->mx[n * k + i] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            hc->mx[n * j + k] = VRNA_CONSTRAINT_CONTEXT_NONE;
-            hc->mx[n * k + j] = VRNA_CONSTRAINT_CONTEXT_NONE;
           }
         }
 
@@ -526,9 +505,6 @@ vrna_hc_add_bp(vrna_fold_compound_t *vc,
           hc->matrix[vc->jindx[i] + i]  = VRNA_CONSTRAINT_CONTEXT_NONE;
           hc->matrix[vc->jindx[j] + j]  = VRNA_CONSTRAINT_CONTEXT_NONE;
 
-          hc->mx[n * i + i] = VRNA_CONSTRAINT_CONTEXT_NONE;
-          hc->mx[n * j + j] = VRNA_CONSTRAINT_CONTEXT_NONE;
-
           hc_update_up(vc);
         }
       }
@@ -543,7 +519,6 @@ vrna_hc_free(vrna_hc_t *hc)
   if (hc) {
     if (hc->type == VRNA_HC_DEFAULT) {
       free(hc->matrix);
-      free(hc->mx);
     } else if (hc->type == VRNA_HC_WINDOW) {
       unsigned int i;
       free(hc->matrix_local);
@@ -645,6 +620,18 @@ vrna_hc_add_from_db(vrna_fold_compound_t  *vc,
  # BEGIN OF STATIC HELPER FUNCTIONS  #
  #####################################
  */
+PRIVATE vrna_hc_t *
+hc_alloc(unsigned int n)
+{
+  struct hc_private *hcp;
+
+  hcp           = (struct hc_private *)vrna_alloc(sizeof(struct hc_private));
+  hcp->n_alloc  = n;
+
+  return &(hcp->hc);
+}
+
+
 PRIVATE unsigned char
 default_pair_constraint(vrna_fold_compound_t  *fc,
                         int                   i,
@@ -924,9 +911,6 @@ populate_hc_bp(vrna_fold_compound_t *fc,
       hc->matrix_local[i][j - i] = constraint;
     } else {
       hc->matrix[fc->jindx[j] + i] = constraint;
-
-      hc->mx[n * i + j] = constraint;
-      hc->mx[n * j + i] = constraint;
     }
   }
 }
@@ -981,47 +965,28 @@ hc_add_up(vrna_fold_compound_t  *vc,
       /* force nucleotide to appear unpaired within a certain type of loop */
       /* do not allow i to be paired with any other nucleotide */
       if (!(option & VRNA_CONSTRAINT_CONTEXT_NO_REMOVE)) {
-        for (j = 1; j < i; j++) {
+        for (j = 1; j < i; j++)
           hc->matrix[vc->jindx[i] + j] = VRNA_CONSTRAINT_CONTEXT_NONE;
-
-          hc->mx[n * i + j] = VRNA_CONSTRAINT_CONTEXT_NONE;
-          hc->mx[n * j + i] = VRNA_CONSTRAINT_CONTEXT_NONE;
-        }
-        for (j = i + 1; j <= n; j++) {
+        for (j = i + 1; j <= n; j++)
           hc->matrix[vc->jindx[j] + i] = VRNA_CONSTRAINT_CONTEXT_NONE;
-
-          hc->mx[n * i + j] = VRNA_CONSTRAINT_CONTEXT_NONE;
-          hc->mx[n * j + i] = VRNA_CONSTRAINT_CONTEXT_NONE;
-        }
       }
 
       type = option & VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
 
       hc->matrix[vc->jindx[i] + i] = type;
 
-      hc->mx[n * i + i] = type;
     } else {
       type = option & VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
 
       /* do not allow i to be paired with any other nucleotide (in context type) */
       if (!(option & VRNA_CONSTRAINT_CONTEXT_NO_REMOVE)) {
-        for (j = 1; j < i; j++) {
+        for (j = 1; j < i; j++)
           hc->matrix[vc->jindx[i] + j] &= ~type;
-
-          hc->mx[n * i + j] &= ~type;
-          hc->mx[n * j + i] &= ~type;
-        }
-        for (j = i + 1; j <= n; j++) {
+        for (j = i + 1; j <= n; j++)
           hc->matrix[vc->jindx[j] + i] &= ~type;
-
-          hc->mx[n * i + j] &= ~type;
-          hc->mx[n * j + i] &= ~type;
-        }
       }
 
       hc->matrix[vc->jindx[i] + i] = VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
-
-      hc->mx[n * i + i] = VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
     }
   }
 }
@@ -1399,21 +1364,14 @@ hc_reset_to_default(vrna_fold_compound_t *vc)
   /* ######################### */
 
   /* 1. unpaired nucleotides are allowed in all contexts */
-  for (i = 1; i <= n; i++) {
+  for (i = 1; i <= n; i++)
     hc->matrix[idx[i] + i] = VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
 
-    hc->mx[n * i + i] = VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
-  }
-
   /* 2. base pairs follow default rules, i.e. canonical pairs, maybe without isolated pairs (if noLP) */
   for (j = n; j > 1; j--) {
     ij = idx[j] + 1;
-    for (i = 1; i < j; i++, ij++) {
+    for (i = 1; i < j; i++, ij++)
       hc->matrix[ij] = default_pair_constraint(vc, i, j);
-
-      hc->mx[n * i + j] = default_pair_constraint(vc, i, j);
-      hc->mx[n * j + i] = hc->mx[n * i + j];
-    }
   }
 
   /* should we reset the generalized hard constraint feature here? */
@@ -1462,19 +1420,19 @@ hc_update_up(vrna_fold_compound_t *vc)
     }
   } else {
     for (hc->up_ext[n + 1] = 0, i = n; i > 0; i--) /* unpaired stretch in exterior loop */
-      hc->up_ext[i] = (hc->mx[n * i + i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) ? 1 +
+      hc->up_ext[i] = (hc->matrix[vc->jindx[i] + i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) ? 1 +
                       hc->up_ext[i + 1] : 0;
 
     for (hc->up_hp[n + 1] = 0, i = n; i > 0; i--)  /* unpaired stretch in hairpin loop */
-      hc->up_hp[i] = (hc->mx[n * i + i] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP) ? 1 +
+      hc->up_hp[i] = (hc->matrix[vc->jindx[i] + i] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP) ? 1 +
                      hc->up_hp[i + 1] : 0;
 
     for (hc->up_int[n + 1] = 0, i = n; i > 0; i--) /* unpaired stretch in interior loop */
-      hc->up_int[i] = (hc->mx[n * i + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) ? 1 +
+      hc->up_int[i] = (hc->matrix[vc->jindx[i] + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) ? 1 +
                       hc->up_int[i + 1] : 0;
 
     for (hc->up_ml[n + 1] = 0, i = n; i > 0; i--)  /* unpaired stretch in multibranch loop */
-      hc->up_ml[i] = (hc->mx[n * i + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) ? 1 +
+      hc->up_ml[i] = (hc->matrix[vc->jindx[i] + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) ? 1 +
                      hc->up_ml[i + 1] : 0;
 
     /*
@@ -1482,40 +1440,40 @@ hc_update_up(vrna_fold_compound_t *vc)
      *  be unpaired (needed for circular folding)
      */
 
-    if (hc->mx[n + 1] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) {
+    if (hc->matrix[vc->jindx[1] + 1] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) {
       hc->up_ext[n + 1] = hc->up_ext[1];
       for (i = n; i > 0; i--) {
-        if (hc->mx[n * i + i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP)
+        if (hc->matrix[vc->jindx[i] + i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP)
           hc->up_ext[i] = MIN2(n, 1 + hc->up_ext[i + 1]);
         else
           break;
       }
     }
 
-    if (hc->mx[n + 1] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP) {
+    if (hc->matrix[vc->jindx[1] + 1] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP) {
       hc->up_hp[n + 1] = hc->up_hp[1];
       for (i = n; i > 0; i--) {
-        if (hc->mx[n * i + i] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP)
+        if (hc->matrix[vc->jindx[i] + i] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP)
           hc->up_hp[i] = MIN2(n, 1 + hc->up_hp[i + 1]);
         else
           break;
       }
     }
 
-    if (hc->mx[n + 1] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+    if (hc->matrix[vc->jindx[1] + 1] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
       hc->up_int[n + 1] = hc->up_int[1];
       for (i = n; i > 0; i--) {
-        if (hc->mx[n * i + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP)
+        if (hc->matrix[vc->jindx[i] + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP)
           hc->up_int[i] = MIN2(n, 1 + hc->up_int[i + 1]);
         else
           break;
       }
     }
 
-    if (hc->mx[n + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+    if (hc->matrix[vc->jindx[1] + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
       hc->up_ml[n + 1] = hc->up_ml[1];
       for (i = n; i > 0; i--) {
-        if (hc->mx[n * i + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP)
+        if (hc->matrix[vc->jindx[i] + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP)
           hc->up_ml[i] = MIN2(n, 1 + hc->up_ml[i + 1]);
         else
           break;
@@ -359,6 +359,12 @@ typedef struct {
  *  - enclosing a multi branch loop (#VRNA_CONSTRAINT_CONTEXT_MB_LOOP)
  *  - enclosed by a multi branch loop (#VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC)
  *
+ *  For the default (global) hard constraints, 'matrix' only stores the upper
+ *  triangle, i.e. the constraint for the pair (i,j) with @f$ i \le j @f$ is
+ *  found at matrix[jindx[j] + i] where jindx is the column index array of the
+ *  corresponding #vrna_fold_compound_t, and the diagonal entries matrix[jindx[i] + i]
+ *  hold the constraints for unpaired nucleotides.
+ *
  *  The four linear arrays 'up_xxx' provide the number of available unpaired
  *  nucleotides (including position i) 3' of each position in the sequence.
  *
@@ -380,7 +386,10 @@ struct vrna_hc_s {
       unsigned char *matrix;     /**<  @brief  Upper triangular matrix that encodes where a
                                   *            base pair or unpaired nucleotide is allowed
                                   */
-      unsigned char *mx;
+      unsigned char *mx;         /**<  @brief  Square matrix of hard constraints (always @em NULL)
+                                  *    @deprecated This redundant copy of #vrna_hc_t.matrix is
+                                  *                not allocated anymore. Use #vrna_hc_t.matrix instead!
+                                  */
 #ifndef VRNA_DISABLE_C11_FEATURES
     };
     struct {
@@ -482,6 +491,8 @@ void vrna_message_constraint_options_all(void);
  *  all positions may be unpaired in all contexts, and base pairs are
  *  allowed in all contexts, if they resemble canonical pairs.
  *  Previously set hard constraints will be removed before initialization.
+ *  If the fold compound already holds default hard constraints whose memory
+ *  suffices for the current sequence length, the memory is re-used.
  *
  *  @ingroup  hard_constraints
  *
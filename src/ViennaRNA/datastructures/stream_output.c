@@ -27,41 +27,143 @@ struct vrna_ordered_stream_s {
   unsigned int                end;        /* last element index in queue */
   unsigned int                size;       /* available memory size for 'data' and 'provided' */
   unsigned int                shift;      /* pointer offset for 'data' and 'provided' */
+  unsigned int                done;       /* all elements before this index have been processed by the callback */
+  unsigned int                capacity;   /* maximum number of elements in flight, 0 for unbounded */
 
   vrna_callback_stream_output *output;    /* callback to execute if consecutive elements from head are available */
   void                        **data;     /* actual data passed to the callback */
   unsigned char               *provided;  /* for simplicity we use unsigned char instead of single bits per element */
   void                        *auxdata;   /* auxiliary data passed to the callback */
+
+  void                        **batch;    /* consecutive data handed over to the callback outside the lock */
+  unsigned int                batch_size; /* available memory size for 'batch' */
+  int                         flushing;   /* 1 if some thread is currently processing the callback */
 #if VRNA_WITH_PTHREADS
   pthread_mutex_t             mtx;        /* semaphore to provide concurrent access */
+  pthread_cond_t              window;     /* signals that 'done' has advanced */
+  pthread_cond_t              ready;      /* signals that data at the start of queue became available */
+  pthread_t                   writer;     /* dedicated thread that executes the callback */
+  int                         has_writer;
+  int                         terminate;  /* ask writer thread to exit */
 #endif
 };
 
 
 PRIVATE INLINE void
-flush_output(struct vrna_ordered_stream_s *queue)
+lock_queue(struct vrna_ordered_stream_s *queue)
 {
-  unsigned int j;
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&queue->mtx);
+#endif
+}
 
-  /* flush all consecutive blocks available from the start of queue */
 
-  /* 1. process output callback */
-  if (queue->output)
-    for (j = queue->start; (j <= queue->end) && (queue->provided[j]); j++)
-      queue->output(queue->auxdata, j, queue->data[j]);
+PRIVATE INLINE void
+unlock_queue(struct vrna_ordered_stream_s *queue)
+{
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&queue->mtx);
+#endif
+}
 
-  /* 2. move start of queue */
-  while ((queue->start <= queue->end) && (queue->provided[queue->start]))
-    queue->start++;
 
-  /* 3. set empty queue condition if necessary */
+/*
+ *  Move all consecutive blocks available from the start of the queue
+ *  to the batch buffer and return their number. Must be called with
+ *  the queue locked.
+ */
+PRIVATE INLINE unsigned int
+take_batch(struct vrna_ordered_stream_s *queue)
+{
+  unsigned int j, n;
+
+  for (n = 0, j = queue->start; (j <= queue->end) && (queue->provided[j]); j++, n++);
+
+  if (n > queue->batch_size) {
+    queue->batch_size = n + QUEUE_OVERHEAD;
+    queue->batch      = (void **)vrna_realloc(queue->batch, sizeof(void *) * queue->batch_size);
+  }
+
+  for (j = 0; j < n; j++)
+    queue->batch[j] = queue->data[queue->start + j];
+
+  /* move start of queue */
+  queue->start += n;
+
+  /* set empty queue condition if necessary */
   if (queue->end < queue->start) {
     queue->provided[queue->start] = 0;
     queue->end                    = queue->start;
   }
+
+  return n;
+}
+
+
+/*
+ *  Process the output callback for all consecutive blocks available from
+ *  the start of the queue. Must be called with the queue locked. The lock
+ *  is released while the callback is executed, so other threads may continue
+ *  to provide data. The 'flushing' flag ensures that only one thread at a
+ *  time processes the callback, which keeps the output in order.
+ */
+PRIVATE void
+flush_output(struct vrna_ordered_stream_s *queue)
+{
+  unsigned int j, first, n;
+
+  if (queue->flushing)
+    return;
+
+  queue->flushing = 1;
+
+  while ((n = take_batch(queue)) > 0) {
+    first = queue->start - n;
+
+    unlock_queue(queue);
+
+    if (queue->output)
+      for (j = 0; j < n; j++)
+        queue->output(queue->auxdata, first + j, queue->batch[j]);
+
+    lock_queue(queue);
+
+    queue->done = queue->start;
+#if VRNA_WITH_PTHREADS
+    pthread_cond_broadcast(&queue->window);
+#endif
+  }
+
+  queue->flushing = 0;
+}
+
+
+#if VRNA_WITH_PTHREADS
+PRIVATE void *
+writer_thread(void *arg)
+{
+  struct vrna_ordered_stream_s *queue = (struct vrna_ordered_stream_s *)arg;
+
+  pthread_mutex_lock(&queue->mtx);
+
+  while (1) {
+    flush_output(queue);
+
+    if (queue->terminate)
+      break;
+
+    pthread_cond_wait(&queue->ready, &queue->mtx);
+  }
+
+  pthread_mutex_unlock(&queue->mtx);
+
+  return NULL;
 }
 
 
+#endif
+
+
 PUBLIC struct vrna_ordered_stream_s *
 vrna_ostream_init(vrna_callback_stream_output *output,
                   void                        *auxdata)
@@ -70,17 +172,50 @@ vrna_ostream_init(vrna_callback_stream_output *output,
 
   queue = (struct vrna_ordered_stream_s *)vrna_alloc(sizeof(struct vrna_ordered_stream_s));
 
-  queue->start    = 0;
-  queue->end      = 0;
-  queue->size     = QUEUE_OVERHEAD;
-  queue->shift    = 0;
-  queue->output   = output;
-  queue->auxdata  = auxdata;
-  queue->data     = (void **)vrna_alloc(sizeof(void *) * QUEUE_OVERHEAD);
-  queue->provided = (unsigned char *)vrna_alloc(sizeof(unsigned char) * QUEUE_OVERHEAD);
+  queue->start      = 0;
+  queue->end        = 0;
+  queue->size       = QUEUE_OVERHEAD;
+  queue->shift      = 0;
+  queue->done       = 0;
+  queue->capacity   = 0;
+  queue->output     = output;
+  queue->auxdata    = auxdata;
+  queue->data       = (void **)vrna_alloc(sizeof(void *) * QUEUE_OVERHEAD);
+  queue->provided   = (unsigned char *)vrna_alloc(sizeof(unsigned char) * QUEUE_OVERHEAD);
+  queue->batch      = (void **)vrna_alloc(sizeof(void *) * QUEUE_OVERHEAD);
+  queue->batch_size = QUEUE_OVERHEAD;
+  queue->flushing   = 0;
 
 #if VRNA_WITH_PTHREADS
   pthread_mutex_init(&queue->mtx, NULL);
+  pthread_cond_init(&queue->window, NULL);
+  pthread_cond_init(&queue->ready, NULL);
+  queue->has_writer = 0;
+  queue->terminate  = 0;
+#endif
+
+  return queue;
+}
+
+
+PUBLIC struct vrna_ordered_stream_s *
+vrna_ostream_init_bounded(vrna_callback_stream_output *output,
+                          void                        *auxdata,
+                          unsigned int                capacity)
+{
+  struct vrna_ordered_stream_s *queue;
+
+  queue = vrna_ostream_init(output, auxdata);
+
+#if VRNA_WITH_PTHREADS
+  queue->capacity = capacity;
+
+  if (pthread_create(&queue->writer, NULL, &writer_thread, (void *)queue) == 0)
+    queue->has_writer = 1;
+  else
+    vrna_message_warning("vrna_ostream_init_bounded(): "
+                         "Failed to start writer thread, falling back to synchronous output");
+
 #endif
 
   return queue;
@@ -92,13 +227,27 @@ vrna_ostream_free(struct vrna_ordered_stream_s *queue)
 {
   if (queue) {
 #if VRNA_WITH_PTHREADS
-    pthread_mutex_lock(&queue->mtx);
+    if (queue->has_writer) {
+      pthread_mutex_lock(&queue->mtx);
+      queue->terminate = 1;
+      pthread_cond_signal(&queue->ready);
+      pthread_mutex_unlock(&queue->mtx);
+
+      pthread_join(queue->writer, NULL);
+    }
+
 #endif
 
+    lock_queue(queue);
+
     flush_output(queue);
 
+    unlock_queue(queue);
+
 #if VRNA_WITH_PTHREADS
-    pthread_mutex_unlock(&queue->mtx);
+    pthread_cond_destroy(&queue->window);
+    pthread_cond_destroy(&queue->ready);
+    pthread_mutex_destroy(&queue->mtx);
 #endif
 
     /* free remaining memory */
@@ -106,6 +255,7 @@ vrna_ostream_free(struct vrna_ordered_stream_s *queue)
     queue->provided += queue->shift;
     free(queue->data);
     free(queue->provided);
+    free(queue->batch);
 
     /* free ostream itself */
     free(queue);
@@ -131,9 +281,16 @@ vrna_ostream_request(struct vrna_ordered_stream_s *queue,
   unsigned int i;
 
   if (queue) {
+    lock_queue(queue);
+
 #if VRNA_WITH_PTHREADS
-    pthread_mutex_lock(&queue->mtx);
+    /* wait until the callback has caught up if the reorder window is full */
+    if (queue->capacity)
+      while (num >= queue->done + queue->capacity)
+        pthread_cond_wait(&queue->window, &queue->mtx);
+
 #endif
+
     if (num >= queue->end) {
       /* check whether we have to increase memory */
       unsigned int new_size = num - queue->shift + 1;
@@ -190,9 +347,7 @@ vrna_ostream_request(struct vrna_ordered_stream_s *queue,
       queue->end = num;
     }
 
-#if VRNA_WITH_PTHREADS
-    pthread_mutex_unlock(&queue->mtx);
-#endif
+    unlock_queue(queue);
   }
 }
 
@@ -203,15 +358,15 @@ vrna_ostream_provide(struct vrna_ordered_stream_s *queue,
                      void                         *data)
 {
   if (queue) {
-#if VRNA_WITH_PTHREADS
-    pthread_mutex_lock(&queue->mtx);
-#endif
+    lock_queue(queue);
+
     if ((queue->end < i) || (i < queue->start)) {
       vrna_message_warning(
         "vrna_ostream_provide(): data position (%d) out of range [%d:%d]!",
         i,
         queue->start,
         queue->end);
+      unlock_queue(queue);
       return;
     }
 
@@ -220,11 +375,15 @@ vrna_ostream_provide(struct vrna_ordered_stream_s *queue,
     queue->provided[i]  = 1;
 
     /* process all consecutive blocks available from the start */
-    if (i == queue->start)
-      flush_output(queue);
-
+    if (i == queue->start) {
 #if VRNA_WITH_PTHREADS
-    pthread_mutex_unlock(&queue->mtx);
+      if (queue->has_writer)
+        pthread_cond_signal(&queue->ready);
+      else
 #endif
+      flush_output(queue);
+    }
+
+    unlock_queue(queue);
   }
 }
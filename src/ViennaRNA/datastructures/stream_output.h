@@ -21,7 +21,8 @@ typedef struct vrna_ordered_stream_s *vrna_ostream_t;
  *  @brief  Ordered stream processing callback
  *
  *  This callback will be processed in sequential order as soon as sequential
- *  data in the output stream becomes available.
+ *  data in the output stream becomes available. It is never executed
+ *  concurrently, and the stream is not locked while it is running.
  *
  *  @note The callback must also release the memory occupied by the
  *        data passed since the stream will lose any reference to it
@@ -49,6 +50,40 @@ vrna_ostream_init(vrna_callback_stream_output *output,
                   void                        *auxdata);
 
 
+/**
+ *  @brief  Get an initialized ordered output stream with bounded capacity
+ *
+ *  In contrast to vrna_ostream_init(), the @p output callback is executed by
+ *  a dedicated writer thread, i.e. threads that provide data never have to
+ *  wait for the callback to finish. Moreover, vrna_ostream_request() blocks
+ *  as long as requesting the index would result in more than @p capacity
+ *  elements that have not yet been processed by the callback. This limits
+ *  the memory occupied by the stream whenever the element at the start of the
+ *  queue takes considerably longer to become available than the ones that
+ *  follow.
+ *
+ *  @note Without POSIX threads support, this function is equivalent to
+ *        vrna_ostream_init().
+ *
+ *  @warning  Since vrna_ostream_request() may block, the data for the elements
+ *            at the start of the queue must be provided by a different thread
+ *            than the one that requests indices, or before further indices
+ *            are requested.
+ *
+ *  @see  vrna_ostream_init(), vrna_ostream_free(), vrna_ostream_request(),
+ *        vrna_ostream_provide()
+ *
+ *  @param  output    A callback function that processes and releases data in the stream
+ *  @param  auxdata   A pointer to auxiliary data passed as first argument to the @p output callback
+ *  @param  capacity  The maximum number of elements in the stream (0 for unlimited)
+ *  @return           An initialized ordered output stream
+ */
+vrna_ostream_t
+vrna_ostream_init_bounded(vrna_callback_stream_output *output,
+                          void                        *auxdata,
+                          unsigned int                capacity);
+
+
 /**
  *  @brief  Free an initialized ordered output stream
  *
@@ -71,6 +106,9 @@ vrna_ostream_threadsafe(void);
  *  indicate that data associted with a certain index number is expected
  *  to be inserted into the stream in the future.
  *
+ *  For streams created with vrna_ostream_init_bounded(), this function
+ *  blocks until the index is within the capacity of the stream.
+ *
  *  @see vrna_ostream_init(), vrna_ostream_provide(), vrna_ostream_free()
  *
  *  @param  dat   The output stream for which the index is requested
@@ -18,6 +18,7 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include "ViennaRNA/datastructures/basic.h"
@@ -92,6 +93,10 @@ PRIVATE void            mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
 PRIVATE void            mfe_matrices_free_default(vrna_mx_mfe_t *self);
 
 
+PRIVATE void            mfe_matrices_reset_default(vrna_mx_mfe_t  *self,
+                                                   unsigned int   n);
+
+
 PRIVATE void            mfe_matrices_alloc_window(vrna_mx_mfe_t *vars,
                                                   unsigned int  m,
                                                   unsigned int  alloc_vector);
@@ -121,6 +126,10 @@ PRIVATE void            pf_matrices_alloc_default(vrna_mx_pf_t  *vars,
 PRIVATE void            pf_matrices_free_default(vrna_mx_pf_t *self);
 
 
+PRIVATE void            pf_matrices_reset_default(vrna_mx_pf_t  *self,
+                                                  unsigned int  n);
+
+
 PRIVATE void            pf_matrices_alloc_window(vrna_mx_pf_t *vars,
                                                  unsigned int m,
                                                  unsigned int alloc_vector);
@@ -380,6 +389,47 @@ vrna_mx_prepare(vrna_fold_compound_t  *vc,
 }
 
 
+PUBLIC void
+vrna_mx_reset(vrna_fold_compound_t *vc)
+{
+  if (vc) {
+    if (vc->matrices && (vc->matrices->type == VRNA_MX_DEFAULT)) {
+      if (vc->matrices->length < vc->length) {
+        vrna_mx_mfe_free(vc);
+      } else {
+        mfe_matrices_reset_default(vc->matrices, vc->length);
+
+        if ((vc->params) && (vc->params->model_details.gquad)) {
+          switch (vc->type) {
+            case VRNA_FC_TYPE_SINGLE:
+              vc->matrices->ggg = get_gquad_matrix(vc->sequence_encoding2, vc->params);
+              break;
+
+            case VRNA_FC_TYPE_COMPARATIVE:
+              vc->matrices->ggg = get_gquad_ali_matrix(vc->S_cons,
+                                                       vc->S,
+                                                       vc->a2s,
+                                                       vc->n_seq,
+                                                       vc->params);
+              break;
+
+            default:
+              break;
+          }
+        }
+      }
+    }
+
+    if (vc->exp_matrices && (vc->exp_matrices->type == VRNA_MX_DEFAULT)) {
+      if (vc->exp_matrices->length < vc->length)
+        vrna_mx_pf_free(vc);
+      else
+        pf_matrices_reset_default(vc->exp_matrices, vc->length);
+    }
+  }
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
@@ -733,6 +783,44 @@ mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
 }
 
 
+PRIVATE void
+mfe_matrices_reset_default(vrna_mx_mfe_t  *self,
+                           unsigned int   n)
+{
+  size_t size, lin_size;
+
+  /* only the part that is accessed for a sequence of length n */
+  size      = sizeof(int) * (((n + 1) * (n + 2)) / 2);
+  lin_size  = sizeof(int) * (n + 2);
+
+  if (self->f5)
+    memset(self->f5, 0, lin_size);
+
+  if (self->f3)
+    memset(self->f3, 0, lin_size);
+
+  if (self->fc)
+    memset(self->fc, 0, lin_size);
+
+  if (self->c)
+    memset(self->c, 0, size);
+
+  if (self->fML)
+    memset(self->fML, 0, size);
+
+  if (self->fM1)
+    memset(self->fM1, 0, size);
+
+  if (self->fM2)
+    memset(self->fM2, 0, lin_size);
+
+  free(self->ggg);
+  self->ggg = NULL;
+
+  self->FcH = self->FcI = self->FcM = self->Fc = INF;
+}
+
+
 PRIVATE void
 mfe_matrices_free_default(vrna_mx_mfe_t *self)
 {
@@ -1323,6 +1411,52 @@ pf_matrices_alloc_default(vrna_mx_pf_t  *vars,
 }
 
 
+PRIVATE void
+pf_matrices_reset_default(vrna_mx_pf_t  *self,
+                          unsigned int  n)
+{
+  size_t size, lin_size;
+
+  /* only the part that is accessed for a sequence of length n */
+  size      = sizeof(FLT_OR_DBL) * (((n + 1) * (n + 2)) / 2);
+  lin_size  = sizeof(FLT_OR_DBL) * (n + 2);
+
+  if (self->q)
+    memset(self->q, 0, size);
+
+  if (self->qb)
+    memset(self->qb, 0, size);
+
+  if (self->qm)
+    memset(self->qm, 0, size);
+
+  if (self->qm1)
+    memset(self->qm1, 0, size);
+
+  if (self->qm2)
+    memset(self->qm2, 0, lin_size);
+
+  if (self->probs)
+    memset(self->probs, 0, size);
+
+  /* q1k may have been allocated on demand with n + 1 entries only */
+  if (self->q1k)
+    memset(self->q1k, 0, sizeof(FLT_OR_DBL) * (n + 1));
+
+  if (self->qln)
+    memset(self->qln, 0, lin_size);
+
+  /* G-quadruplex contributions are re-computed for each partition function */
+  free(self->G);
+  self->G = NULL;
+
+  self->qo  = self->qho = self->qio = self->qmo = 0.;
+
+  memset(self->scale, 0, lin_size);
+  memset(self->expMLbase, 0, lin_size);
+}
+
+
 PRIVATE void
 pf_matrices_free_default(vrna_mx_pf_t *self)
 {
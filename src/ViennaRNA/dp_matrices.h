@@ -409,6 +409,23 @@ vrna_mx_prepare(vrna_fold_compound_t  *vc,
                 unsigned int          options);
 
 
+/**
+ *  @brief  Re-initialize the Dynamic Programming (DP) matrices after the sequence of a fold compound changed
+ *
+ *  Default type DP matrices whose memory suffices for the current sequence length of
+ *  @p vc are kept, and re-initialized as if they were freshly allocated. Any sequence
+ *  dependent auxiliary data, such as G-quadruplex contributions, is re-computed. DP
+ *  matrices that are too small for the current sequence are released, and will be
+ *  re-allocated on demand by subsequent predictions.
+ *
+ *  @see vrna_fold_compound_recycle(), vrna_mx_prepare()
+ *
+ *  @param  vc  The #vrna_fold_compound_t that holds pointers to the DP matrices
+ */
+void
+vrna_mx_reset(vrna_fold_compound_t *vc);
+
+
 /**
  *  @brief  Free memory occupied by the Minimum Free Energy (MFE) Dynamic Programming (DP) matrices
  *
@@ -29,6 +29,10 @@
 #include "ViennaRNA/part_func.h"
 #include "ViennaRNA/equilibrium_probs.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/loops/external_hc.inc"
 
 /*
@@ -117,6 +121,7 @@ typedef struct {
   FLT_OR_DBL  *prm_l;
   FLT_OR_DBL  *prm_l1;
   FLT_OR_DBL  *prml;
+  FLT_OR_DBL  *prm_MLb;
 
   int         ud_max_size;
   FLT_OR_DBL  **pmlu;
@@ -283,10 +288,16 @@ vrna_pairing_probs(vrna_fold_compound_t *vc,
   int ret = 0;
 
   if (vc) {
+    vrna_timing_start(vc->timing, VRNA_TIMING_OUTSIDE);
+
     if (vc->strands > 1)
       ret = pf_co_bppm(vc, structure);
     else
       ret = pf_create_bppm(vc, structure);
+
+    vrna_timing_stop(vc->timing,
+                     VRNA_TIMING_OUTSIDE,
+                     (unsigned long long)vc->length * (vc->length + 1) / 2);
   }
 
   return ret;
@@ -700,7 +711,7 @@ pf_create_bppm(vrna_fold_compound_t *vc,
             /*  search for possible auxiliary base pairs in hairpin loop motifs to store
              *  the corresponding probability corrections
              */
-            if (hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP) {
+            if (hc->matrix[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP) {
               vrna_basepair_t *ptr, *aux_bps;
               aux_bps = sc->bt(i, j, i, j, VRNA_DECOMP_PAIR_HP, sc->data);
               if (aux_bps) {
@@ -799,6 +810,7 @@ get_ml_helper_arrays(vrna_fold_compound_t *fc)
   ml_helpers->prm_l   = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
   ml_helpers->prm_l1  = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
   ml_helpers->prml    = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+  ml_helpers->prm_MLb = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
 
   ml_helpers->ud_max_size = 0;
   ml_helpers->pmlu        = NULL;
@@ -835,6 +847,7 @@ free_ml_helper_arrays(helper_arrays *ml_helpers)
   free(ml_helpers->prm_l);
   free(ml_helpers->prm_l1);
   free(ml_helpers->prml);
+  free(ml_helpers->prm_MLb);
 
   if (ml_helpers->pmlu) {
     for (u = 0; u <= ml_helpers->ud_max_size; u++)
@@ -1034,8 +1047,8 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
   short             *S1;
   unsigned int      *sn;
   int               i, j, k, n, ij, kl, u1, u2, *my_iindx, *jindx, *rtype,
-                    turn, with_ud, *hc_up_int;
-  FLT_OR_DBL        temp, tmp2, *qb, *probs, *scale;
+                    turn, with_ud, *hc_up_int, num_threads, ov_cnt;
+  FLT_OR_DBL        temp, tmp2, *qb, *probs, *scale, qmax;
   double            max_real;
   vrna_exp_param_t  *pf_params;
   vrna_md_t         *md;
@@ -1063,8 +1076,25 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
   probs = fc->exp_matrices->probs;
   scale = fc->exp_matrices->scale;
 
-  max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  qmax      = *Qmax;
+  ov_cnt    = 0;
 
+  /*
+   *  all pairs (k,l) only depend on probabilities of enclosing pairs (i,j) with j > l,
+   *  so we may process them concurrently unless we need to collect probability
+   *  corrections or evaluate unstructured domain callbacks
+   */
+  num_threads = 1;
+#ifdef _OPENMP
+  if ((fc->num_threads != 1) &&
+      (!with_ud) &&
+      (!(sc && sc->exp_f && sc->bt)))
+    num_threads = (fc->num_threads > 1) ? fc->num_threads : omp_get_max_threads();
+
+#pragma omp parallel for if (num_threads > 1) num_threads(num_threads) schedule(dynamic, 8) \
+  private(type, type_2, i, j, ij, kl, u1, u2, temp, tmp2) reduction(max: qmax) reduction(+: ov_cnt)
+#endif
   /* 2. bonding k,l as substem of 2:loop enclosed by i,j */
   for (k = 1; k < l - turn; k++) {
     kl = my_iindx[k] - l;
@@ -1072,7 +1102,7 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
     if (qb[kl] == 0.)
       continue;
 
-    if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+    if (hc->matrix[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
       type_2 = rtype[vrna_get_ptype(jindx[l] + k, ptype)];
 
       for (i = MAX2(1, k - MAXLOOP - 1); i <= k - 1; i++) {
@@ -1091,7 +1121,7 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
           if (hc_up_int[l + 1] < u2)
             break;
 
-          if (hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+          if (hc->matrix[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
             int jij = jindx[j] + i;
             type = vrna_get_ptype(jij, ptype);
 
@@ -1179,19 +1209,22 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
       }
     }
 
-    if (probs[kl] > (*Qmax)) {
-      (*Qmax) = probs[kl];
-      if ((*Qmax) > max_real / 10.)
+    if (probs[kl] > qmax) {
+      qmax = probs[kl];
+      if (qmax > max_real / 10.)
         vrna_message_warning("P close to overflow: %d %d %g %g\n",
                              k, l, probs[kl], qb[kl]);
     }
 
     if (probs[kl] >= max_real) {
-      (*ov)++;
+      ov_cnt++;
       probs[kl] = FLT_MAX;
     }
   }
 
+  (*Qmax) = qmax;
+  (*ov)   += ov_cnt;
+
   if (md->gquad)
     compute_gquad_prob_internal(fc, l);
 }
@@ -1246,7 +1279,7 @@ compute_bpp_internal_comparative(vrna_fold_compound_t *fc,
     if (qb[kl] == 0.)
       continue;
 
-    if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+    if (hc->matrix[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
       temp = 0.;
 
       for (s = 0; s < n_seq; s++)
@@ -1268,7 +1301,7 @@ compute_bpp_internal_comparative(vrna_fold_compound_t *fc,
           if (hc->up_int[k + 1] < u2)
             continue;
 
-          if (hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+          if (hc->matrix[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
             q_temp = 1.;
 
             for (s = 0; s < n_seq; s++) {
@@ -1354,9 +1387,9 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
   short             *S, *S1, s5, s3;
   unsigned int      *sn;
   int               cnt, i, j, k, n, u, ii, ij, kl, lj, turn, *my_iindx, *jindx,
-                    *rtype, with_gquad, with_ud;
+                    *rtype, with_gquad, with_ud, num_threads, ov_cnt;
   FLT_OR_DBL        temp, ppp, prm_MLb, prmt, prmt1, *qb, *probs, *qm, *G, *scale,
-                    *expMLbase, expMLclosing, expMLstem;
+                    *expMLbase, expMLclosing, expMLstem, qmax;
   double            max_real;
   vrna_exp_param_t  *pf_params;
   vrna_md_t         *md;
@@ -1391,14 +1424,33 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
 
   prm_MLb   = 0.;
   max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  qmax      = *Qmax;
+  ov_cnt    = 0;
+
+  /*
+   *  The recursions below are split into three stages. The first and the last
+   *  stage are independent for each k and may be processed concurrently. Only
+   *  the contributions where i is unpaired require a linear scan over k.
+   */
+  num_threads = 1;
+#ifdef _OPENMP
+  if ((fc->num_threads != 1) &&
+      (!with_ud))
+    num_threads = (fc->num_threads > 1) ? fc->num_threads : omp_get_max_threads();
+
+#endif
 
   if (sn[l + 1] != sn[l]) {
     /* set prm_l to 0 to get prm_l1 in the next round to be 0 */
     for (i = 0; i <= n; i++)
       ml_helpers->prm_l[i] = 0;
   } else {
+    /* 1. contributions of multibranch loops closed by (i, j) with i = k - 1 */
+#ifdef _OPENMP
+#pragma omp parallel for if (num_threads > 1) num_threads(num_threads) schedule(dynamic, 8) \
+  private(tt, s3, i, j, u, cnt, ii, ij, lj, temp, ppp, prmt, prmt1)
+#endif
     for (k = 2; k < l - turn; k++) {
-      kl    = my_iindx[k] - l;
       i     = k - 1;
       prmt  = prmt1 = 0.0;
 
@@ -1407,7 +1459,7 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
       s3  = S1[i + 1];
       if (sn[k] == sn[i]) {
         for (j = l + 2; j <= n; j++, ij--, lj--) {
-          if ((hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) &&
+          if ((hc->matrix[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) &&
               (sn[j] == sn[j - 1])) {
             tt = vrna_get_ptype_md(S[j], S[i], md);
 
@@ -1439,7 +1491,7 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
         ii  = my_iindx[i];  /* ii-j=[i,j]     */
         tt  = vrna_get_ptype(jindx[l + 1] + i, ptype);
         tt  = rtype[tt];
-        if (hc->mx[(l + 1) * n + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+        if (hc->matrix[jindx[l + 1] + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
           prmt1 = probs[ii - (l + 1)]
                   *expMLclosing
                   *exp_E_MLstem(tt,
@@ -1511,8 +1563,12 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
         if (with_ud)
           ml_helpers->pmlu[0][i] = prmt1;
       }
+    }
+
+    /* 2. contributions where i is unpaired */
+    for (k = 2; k < l - turn; k++) {
+      i = k - 1;
 
-      /* i is unpaired */
       if (hc->up_ml[i]) {
         ppp = prm_MLb * expMLbase[1];
         if (sc) {
@@ -1558,9 +1614,27 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
           ml_helpers->prm_MLbu[0] = ml_helpers->prml[i];
       }
 
-      ml_helpers->prml[i] = ml_helpers->prml[i] + ml_helpers->prm_l[i];
+      ml_helpers->prm_MLb[k]  = prm_MLb;
+      ml_helpers->prml[i]     = ml_helpers->prml[i] + ml_helpers->prm_l[i];
+
+      /* rotate prm_MLbu entries required for unstructured domain feature */
+      if (with_ud) {
+        kl  = my_iindx[k] - l;
+        tt  = ptype[jindx[l] + k];
 
-      tt = ptype[jindx[l] + k];
+        if ((with_gquad) ? ((tt) || (G[kl] != 0.)) : (qb[kl] != 0.))
+          rotate_ml_helper_arrays_inner(ml_helpers);
+      }
+    }
+
+    /* 3. bonding k,l as substem of multi-loop enclosed by i,j */
+#ifdef _OPENMP
+#pragma omp parallel for if (num_threads > 1) num_threads(num_threads) schedule(dynamic, 8) \
+  private(tt, s5, s3, i, kl, temp) reduction(max: qmax) reduction(+: ov_cnt)
+#endif
+    for (k = 2; k < l - turn; k++) {
+      kl  = my_iindx[k] - l;
+      tt  = ptype[jindx[l] + k];
 
       if (with_gquad) {
         if ((!tt) && (G[kl] == 0.))
@@ -1570,8 +1644,8 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
           continue;
       }
 
-      if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
-        temp = prm_MLb;
+      if (hc->matrix[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
+        temp = ml_helpers->prm_MLb[k];
 
         if (sn[k] == sn[k - 1]) {
           for (i = 1; i <= k - 2; i++)
@@ -1602,23 +1676,23 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
         probs[kl] += temp;
       }
 
-      if (probs[kl] > (*Qmax)) {
-        (*Qmax) = probs[kl];
-        if ((*Qmax) > max_real / 10.)
+      if (probs[kl] > qmax) {
+        qmax = probs[kl];
+        if (qmax > max_real / 10.)
           vrna_message_warning("P close to overflow: %d %d %g %g\n",
                                k, l, probs[kl], qb[kl]);
       }
 
       if (probs[kl] >= max_real) {
-        (*ov)++;
+        ov_cnt++;
         probs[kl] = FLT_MAX;
       }
-
-      /* rotate prm_MLbu entries required for unstructured domain feature */
-      rotate_ml_helper_arrays_inner(ml_helpers);
     } /* end for (k=..) */
   }
 
+  (*Qmax) = qmax;
+  (*ov)   += ov_cnt;
+
   rotate_ml_helper_arrays_outer(ml_helpers);
 }
 
@@ -1678,10 +1752,10 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
     i     = k - 1;
     prmt  = prmt1 = 0.;
 
-    if (1 /* hard_constraints[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC */) {
+    if (1 /* hard_constraints[jindx[k] + l] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC */) {
       ii  = my_iindx[i];      /* ii-j=[i,j]     */
       ll  = my_iindx[l + 1];  /* ll-j=[l+1,j-1] */
-      if (hc->mx[(l + 1) * n + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+      if (hc->matrix[jindx[l + 1] + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
         prmt1 = probs[ii - (l + 1)];
         for (s = 0; s < n_seq; s++) {
           tt    = vrna_get_ptype_md(S[s][l + 1], S[s][i], md);
@@ -1702,7 +1776,7 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
         if (probs[ii - j] == 0)
           continue;
 
-        if (!(hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP))
+        if (!(hc->matrix[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP))
           continue;
 
         for (s = 0; s < n_seq; s++) {
@@ -2696,7 +2770,7 @@ PRIVATE INLINE void
 ud_outside_int_loops2(vrna_fold_compound_t *vc)
 {
   unsigned char *hard_constraints;
-  int           i, j, k, l, p, q, pq, kl, u, n, *my_iindx, pmax, qmin, turn,
+  int           i, j, k, l, p, q, pq, kl, u, n, *my_iindx, *jindx, pmax, qmin, turn,
                 u1, u2, uu1, uu2, u2_max, m;
   FLT_OR_DBL    temp, q5, q3, exp_motif_en, outside,
                 *probs, *qb, qq1, qq2, *qqk, *qql, *qqp, **qq_ud, **pp_ud, temp5,
@@ -2705,9 +2779,10 @@ ud_outside_int_loops2(vrna_fold_compound_t *vc)
 
   n                 = vc->length;
   my_iindx          = vc->iindx;
+  jindx             = vc->jindx;
   qb                = vc->exp_matrices->qb;
   probs             = vc->exp_matrices->probs;
-  hard_constraints  = vc->hc->mx;
+  hard_constraints  = vc->hc->matrix;
   domains_up        = vc->domains_up;
   turn              = vc->exp_params->model_details.min_loop_size;
 
@@ -2744,7 +2819,7 @@ ud_outside_int_loops2(vrna_fold_compound_t *vc)
       if (probs[kl] == 0.)
         continue;
 
-      if (hard_constraints[k * n + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+      if (hard_constraints[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
         for (i = l - 1; i > MAX2(k, l - MAXLOOP - 1); i--) {
           qql[i] = domains_up->exp_energy_cb(vc,
                                              i, l - 1,
@@ -2773,7 +2848,7 @@ ud_outside_int_loops2(vrna_fold_compound_t *vc)
           for (q = qmin; q < l; q++) {
             pq = my_iindx[p] - q;
 
-            if (hard_constraints[p * n + q] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+            if (hard_constraints[jindx[q] + p] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
               u2              = l - q - 1;
               ud_bak          = vc->domains_up;
               vc->domains_up  = NULL;
@@ -3241,7 +3316,7 @@ ud_outside_mb_loops2(vrna_fold_compound_t *vc)
                 kl = my_iindx[k] - l;
                 if (probs[kl] > 0.) {
                   jkl = jindx[l] + k;
-                  if (hc[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+                  if (hc[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
                     /* respect hard constraints */
                     FLT_OR_DBL qqq;
                     tt  = rtype[vrna_get_ptype(jkl, ptype)];
@@ -3279,7 +3354,7 @@ ud_outside_mb_loops2(vrna_fold_compound_t *vc)
               for (k = i - 1; k > 0; k--) {
                 up  = i - k - 1;
                 kl  = my_iindx[k] - l;
-                if ((hc[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) && (probs[kl] > 0.) &&
+                if ((hc[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) && (probs[kl] > 0.) &&
                     (hc_up[k + 1] >= up)) {
                   int jkl = jindx[l] + k;
                   tt    = rtype[vrna_get_ptype(jkl, ptype)];
@@ -3336,7 +3411,7 @@ ud_outside_mb_loops2(vrna_fold_compound_t *vc)
 
                 /* 3rd, l - 1 pairs with u */
                 int ul = my_iindx[u] - (l - 1);
-                if (hc[(l - 1) * n + u] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
+                if (hc[jindx[l - 1] + u] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
                   tt    = vrna_get_ptype(jindx[l - 1] + u, ptype);
                   temp  = qb[ul]
                           * exp_E_MLstem(tt, S[u - 1], S[l], pf_params);
@@ -3376,7 +3451,7 @@ ud_outside_mb_loops2(vrna_fold_compound_t *vc)
               for (qmli[k] = 0., u = k + turn + 1; u < i; u++) {
                 int ku = my_iindx[k] - u;
                 /* respect hard constraints */
-                if (hc[k * n + u] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
+                if (hc[jindx[u] + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
                   up = (i - 1) - (u + 1) + 1;
                   if (hc_up[u + 1] >= up) {
                     temp = qb[ku]
@@ -3402,7 +3477,7 @@ ud_outside_mb_loops2(vrna_fold_compound_t *vc)
 
               for (l = j + 1; l <= n; l++) {
                 kl = my_iindx[k] - l;
-                if (hc[k * n + l] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+                if (hc[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
                   int up, jkl;
                   jkl = jindx[l] + k;
                   tt  = rtype[vrna_get_ptype(jkl, ptype)];
@@ -3522,7 +3597,7 @@ bppm_circ(vrna_fold_compound_t *vc)
   scale             = matrices->scale;
   expMLbase         = matrices->expMLbase;
   qo                = matrices->qo;
-  hard_constraints  = hc->mx;
+  hard_constraints  = hc->matrix;
 
   expMLclosing  = pf_params->expMLclosing;
   rtype         = &(pf_params->model_details.rtype[0]);
@@ -3556,7 +3631,7 @@ bppm_circ(vrna_fold_compound_t *vc)
         /* 1.1. Exterior Hairpin Contribution */
         tmp2 = vrna_exp_E_hp_loop(vc, j, i);
 
-        if (hard_constraints[i * n + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+        if (hard_constraints[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
           /* 1.2. Exterior Interior Loop Contribution                     */
           /* 1.2.1. i,j  delimtis the "left" part of the interior loop    */
           /* (j,i) is "outer pair"                                        */
@@ -3585,7 +3660,7 @@ bppm_circ(vrna_fold_compound_t *vc)
               if ((ln1 + ln2 + ln3) > MAXLOOP)
                 continue;
 
-              eval = (hard_constraints[k * n + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) ? 1 : 0;
+              eval = (hard_constraints[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) ? 1 : 0;
               if (hc->f)
                 eval = hc->f(k, l, i, j, VRNA_DECOMP_PAIR_IL, hc->data);
 
@@ -3652,7 +3727,7 @@ bppm_circ(vrna_fold_compound_t *vc)
               if ((ln1 + ln2 + ln3) > MAXLOOP)
                 continue;
 
-              eval = (hard_constraints[k * n + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) ? 1 : 0;
+              eval = (hard_constraints[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) ? 1 : 0;
               if (hc->f)
                 eval = hc->f(i, j, k, l, VRNA_DECOMP_PAIR_IL, hc->data) ? eval : 0;
 
@@ -3694,7 +3769,7 @@ bppm_circ(vrna_fold_compound_t *vc)
         }
 
         /* 1.3 Exterior multiloop decomposition */
-        if (hard_constraints[i * n + j] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+        if (hard_constraints[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
           /* 1.3.1 Middle part                    */
           if ((i > turn + 2) && (j < n - turn - 1)) {
             tmp = 0;
@@ -3965,7 +4040,7 @@ bppm_circ_comparative(vrna_fold_compound_t *vc)
   kTn               = pf_params->kT / 10.;   /* kT in cal/mol  */
   hc                = vc->hc;
   scs               = vc->scs;
-  hard_constraints  = hc->mx;
+  hard_constraints  = hc->matrix;
 
   type = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
 
@@ -3985,7 +4060,7 @@ bppm_circ_comparative(vrna_fold_compound_t *vc)
         tmp2 += vrna_exp_E_hp_loop(vc, j, i);
         /* 1.2. Exterior Interior Loop Contribution */
         /* recycling of k and l... */
-        if (hard_constraints[i * n + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+        if (hard_constraints[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
           /* 1.2.1. first we calc exterior loop energy with constraint, that i,j  */
           /* delimtis the "right" part of the interior loop                       */
           /* (l,k) is "outer pair"                                                */
@@ -4012,7 +4087,7 @@ bppm_circ_comparative(vrna_fold_compound_t *vc)
               if (hc->up_int[l + 1] < ln2)
                 continue;
 
-              if (!(hard_constraints[k * n + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP))
+              if (!(hard_constraints[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP))
                 continue;
 
               FLT_OR_DBL qloop = 1.;
@@ -4092,7 +4167,7 @@ bppm_circ_comparative(vrna_fold_compound_t *vc)
               if (hc->up_int[l + 1] < ln2)
                 continue;
 
-              if (!(hard_constraints[k * n + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP))
+              if (!(hard_constraints[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP))
                 continue;
 
               FLT_OR_DBL qloop = 1.;
@@ -4144,7 +4219,7 @@ bppm_circ_comparative(vrna_fold_compound_t *vc)
         }
 
         /* 1.3 Exterior multiloop decomposition */
-        if (hard_constraints[i * n + j] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+        if (hard_constraints[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
           /* 1.3.1 Middle part                    */
           if ((i > turn + 2) && (j < n - turn - 1)) {
             for (tmp3 = 1, s = 0; s < n_seq; s++)
@@ -257,7 +257,9 @@ vrna_eval_structure_pt_v(vrna_fold_compound_t *vc,
     }
 
     vrna_cstr_t output_stream = vrna_cstr(vc->length, (file) ? file : stdout);
-    e = eval_pt(vc, pt, output_stream, verbosity_level);
+    e = (vc->params->model_details.circ) ?
+        eval_circ_pt(vc, pt, output_stream, verbosity_level) :
+        eval_pt(vc, pt, output_stream, verbosity_level);
     vrna_cstr_fflush(output_stream);
     vrna_cstr_free(output_stream);
   }
@@ -429,10 +431,10 @@ vrna_eval_move_pt(vrna_fold_compound_t  *vc,
 
       p++;
     }
-    if (m1 < 0 && c == 1) /* First and only inserted basepair */
+    if (m1 < 0 && c == 1) /* Deletion of the only inter-strand base pair */
       return en_post - en_pre - P->DuplexInit;
     else
-    if (c == 0) /* Must have been a delete move */
+    if (c == 0) /* Must have been an insertion of the first inter-strand base pair */
       return en_post - en_pre + P->DuplexInit;
   }
 
@@ -954,6 +954,13 @@ vrna_eval_move(vrna_fold_compound_t *vc,
  *  If the parameters m1 and m2 are negative, it is deletion (opening)
  *  of a base pair, otherwise it is insertion (opening).
  *
+ *  Only the loops affected by the move are re-evaluated, including a change
+ *  of the duplex initiation penalty when the move creates the first, or
+ *  removes the last base pair between two strands.
+ *
+ *  @note Circular RNAs and comparative structure prediction (alignments)
+ *        are not supported. Use vrna_eval_structure_pt() for those instead.
+ *
  *  @see              vrna_eval_move()
  *  @param vc         A vrna_fold_compound_t containing the energy parameters and model details
  *  @param pt         the pair table of the secondary structure
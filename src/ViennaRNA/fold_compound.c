@@ -100,6 +100,17 @@ PRIVATE INLINE void
 nullify(vrna_fold_compound_t *fc);
 
 
+PRIVATE int
+is_recyclable(vrna_fold_compound_t  *fc,
+              const char            *sequence,
+              unsigned int          options);
+
+
+PRIVATE int
+same_energy_model(vrna_md_t *md1,
+                  vrna_md_t *md2);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -179,6 +190,9 @@ vrna_fold_compound_free(vrna_fold_compound_t *fc)
     if (fc->free_auxdata)
       fc->free_auxdata(fc->auxdata);
 
+    vrna_rng_free(fc->rng);
+    vrna_timing_free(fc->timing);
+
     free(fc);
   }
 }
@@ -257,6 +271,9 @@ vrna_fold_compound_free_param(vrna_fold_compound_t *fc)
     if (fc->free_auxdata)
       fc->free_auxdata(fc->auxdata);
 
+    vrna_rng_free(fc->rng);
+    vrna_timing_free(fc->timing);
+
     free(fc);
   }
 }
@@ -422,6 +439,99 @@ vrna_fold_compound(const char   *sequence,
 }
 
 
+PUBLIC vrna_fold_compound_t *
+vrna_fold_compound_recycle(vrna_fold_compound_t *fc,
+                           const char           *sequence,
+                           vrna_md_t            *md_p,
+                           unsigned int         options)
+{
+  unsigned int  aux_options;
+  vrna_md_t     md;
+
+  if (!is_recyclable(fc, sequence, options)) {
+    vrna_fold_compound_free(fc);
+    return vrna_fold_compound(sequence, md_p, options);
+  }
+
+  /* get a copy of the model details */
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /* release sequence dependent data */
+  vrna_sequence_remove_all(fc);
+  vrna_sc_free(fc->sc);
+  free(fc->sequence);
+  free(fc->ptype);
+  free(fc->ptype_pf_compat);
+  free(fc->iindx);
+  free(fc->jindx);
+
+  fc->sc              = NULL;
+  fc->ptype           = NULL;
+  fc->ptype_pf_compat = NULL;
+  fc->iindx           = NULL;
+  fc->jindx           = NULL;
+  fc->cutpoint        = -1;
+
+  fc->length    = strlen(sequence);
+  fc->sequence  = strdup(sequence);
+
+  /*
+   *  The model details stored along with the energy parameters are adapted
+   *  to the sequence, e.g. the window size. Keep the parameters if this is
+   *  the only difference, and reset the Boltzmann factor scaling
+   */
+  if (same_energy_model(&md, &(fc->params->model_details)))
+    fc->params->model_details = md;
+
+  if (fc->exp_params) {
+    if (same_energy_model(&md, &(fc->exp_params->model_details))) {
+      fc->exp_params->model_details = md;
+      fc->exp_params->pf_scale      = -1.;
+    } else {
+      free(fc->exp_params);
+      fc->exp_params = NULL;
+    }
+  }
+
+  vrna_timing_start(fc->timing, VRNA_TIMING_PARAMS);
+
+  add_params(fc, &md, options);
+
+  sanitize_bp_span(fc, options);
+
+  aux_options = WITH_PTYPE;
+
+  if (options & VRNA_OPTION_PF)
+    aux_options |= WITH_PTYPE_COMPAT;
+
+  set_fold_compound(fc, options, aux_options);
+
+  /* synchronize model details of re-used Boltzmann factors */
+  if (fc->exp_params)
+    fc->exp_params->model_details = fc->params->model_details;
+
+  vrna_timing_stop(fc->timing, VRNA_TIMING_PARAMS, 0);
+
+  /* reset hard constraints and DP matrices, re-using their memory if possible */
+  vrna_timing_start(fc->timing, VRNA_TIMING_CONSTRAINTS);
+  vrna_hc_init(fc);
+  vrna_timing_stop(fc->timing, VRNA_TIMING_CONSTRAINTS, 0);
+
+  vrna_timing_start(fc->timing, VRNA_TIMING_FILL);
+  vrna_mx_reset(fc);
+
+  if (options & (VRNA_OPTION_MFE | VRNA_OPTION_PF))
+    vrna_mx_prepare(fc, options);
+
+  vrna_timing_stop(fc->timing, VRNA_TIMING_FILL, 0);
+
+  return fc;
+}
+
+
 PUBLIC vrna_fold_compound_t *
 vrna_fold_compound_comparative(const char   **sequences,
                                vrna_md_t    *md_p,
@@ -659,6 +769,55 @@ vrna_fold_compound_add_callback(vrna_fold_compound_t            *fc,
 }
 
 
+PUBLIC void
+vrna_fold_compound_rng_seed(vrna_fold_compound_t  *fc,
+                            uint64_t              seed,
+                            uint64_t              stream)
+{
+  if (fc) {
+    if (fc->rng)
+      vrna_rng_seed(fc->rng, seed, stream);
+    else
+      fc->rng = vrna_rng_init(seed, stream);
+  }
+}
+
+
+PUBLIC int
+vrna_fold_compound_num_threads(vrna_fold_compound_t *fc,
+                               int                  num_threads)
+{
+  if ((!fc) ||
+      (num_threads < 0))
+    return 0;
+
+  fc->num_threads = num_threads;
+
+  return 1;
+}
+
+
+PUBLIC int
+vrna_fold_compound_timing(vrna_fold_compound_t  *fc,
+                          int                   status)
+{
+  if (!fc)
+    return 0;
+
+  if (status) {
+    if (fc->timing)
+      vrna_timing_reset(fc->timing);
+    else
+      fc->timing = vrna_timing_init();
+  } else {
+    vrna_timing_free(fc->timing);
+    fc->timing = NULL;
+  }
+
+  return (fc->timing) ? 1 : 0;
+}
+
+
 PUBLIC int
 vrna_fold_compound_prepare(vrna_fold_compound_t *fc,
                            unsigned int         options)
@@ -673,12 +832,17 @@ vrna_fold_compound_prepare(vrna_fold_compound_t *fc,
     return 0;
   }
 
+  vrna_timing_start(fc->timing, VRNA_TIMING_PARAMS);
+
   /* prepare Boltzmann factors if required */
   vrna_params_prepare(fc, options);
 
   /* prepare ptype array(s) */
   vrna_ptypes_prepare(fc, options);
 
+  vrna_timing_stop(fc->timing, VRNA_TIMING_PARAMS, 0);
+  vrna_timing_start(fc->timing, VRNA_TIMING_CONSTRAINTS);
+
   if (options & VRNA_OPTION_MFE) {
     /* prepare for MFE computation */
     switch (fc->type) {
@@ -722,9 +886,14 @@ vrna_fold_compound_prepare(vrna_fold_compound_t *fc,
   /* prepare soft constraints data structure, if required */
   vrna_sc_prepare(fc, options);
 
+  vrna_timing_stop(fc->timing, VRNA_TIMING_CONSTRAINTS, 0);
+  vrna_timing_start(fc->timing, VRNA_TIMING_FILL);
+
   /* Add DP matrices, if not they are not present or do not fit current settings */
   vrna_mx_prepare(fc, options);
 
+  vrna_timing_stop(fc->timing, VRNA_TIMING_FILL, 0);
+
   return ret;
 }
 
@@ -1077,6 +1246,8 @@ nullify(vrna_fold_compound_t *fc)
     fc->stat_cb       = NULL;
     fc->auxdata       = NULL;
     fc->free_auxdata  = NULL;
+    fc->rng           = NULL;
+    fc->timing        = NULL;
 
     fc->domains_struc = NULL;
     fc->domains_up    = NULL;
@@ -1124,5 +1295,98 @@ nullify(vrna_fold_compound_t *fc)
 
     fc->window_size = -1;
     fc->ptype_local = NULL;
+
+    fc->num_threads = 1;
   }
 }
+
+
+PRIVATE int
+is_recyclable(vrna_fold_compound_t  *fc,
+              const char            *sequence,
+              unsigned int          options)
+{
+  size_t length;
+
+  if ((!fc) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (!sequence) ||
+      (options & (VRNA_OPTION_WINDOW | VRNA_OPTION_EVAL_ONLY)))
+    return 0;
+
+  length = strlen(sequence);
+  if ((length == 0) ||
+      (length > vrna_sequence_length_max(options)))
+    return 0;
+
+  /* only plain fold compounds with default hard constraints and DP matrices */
+  if ((!fc->params) ||
+      (!fc->hc) ||
+      (fc->hc->type != VRNA_HC_DEFAULT) ||
+      ((fc->matrices) && (fc->matrices->type != VRNA_MX_DEFAULT)) ||
+      ((fc->exp_matrices) && (fc->exp_matrices->type != VRNA_MX_DEFAULT)))
+    return 0;
+
+  /* no auxiliary data that might depend on the sequence */
+  if ((fc->stat_cb) ||
+      (fc->auxdata) ||
+      (fc->free_auxdata) ||
+      (fc->rng) ||
+      (fc->domains_struc) ||
+      (fc->domains_up) ||
+      (fc->aux_grammar) ||
+      (fc->reference_pt1) ||
+      (fc->reference_pt2) ||
+      (fc->referenceBPs1) ||
+      (fc->referenceBPs2) ||
+      (fc->bpdist) ||
+      (fc->mm1) ||
+      (fc->mm2) ||
+      (fc->ptype_local))
+    return 0;
+
+  return 1;
+}
+
+
+/*
+ *  Check whether two sets of model details only differ in attributes
+ *  that do not affect the energy parameters, but are adapted to the
+ *  sequence, or the DP matrices by the fold compound itself, i.e.
+ *  window_size, max_bp_span, min_loop_size, and uniq_ML
+ */
+PRIVATE int
+same_energy_model(vrna_md_t *md1,
+                  vrna_md_t *md2)
+{
+  if ((md1->temperature != md2->temperature) ||
+      (md1->betaScale != md2->betaScale) ||
+      (md1->pf_smooth != md2->pf_smooth) ||
+      (md1->dangles != md2->dangles) ||
+      (md1->special_hp != md2->special_hp) ||
+      (md1->noLP != md2->noLP) ||
+      (md1->noGU != md2->noGU) ||
+      (md1->noGUclosure != md2->noGUclosure) ||
+      (md1->logML != md2->logML) ||
+      (md1->circ != md2->circ) ||
+      (md1->gquad != md2->gquad) ||
+      (md1->energy_set != md2->energy_set) ||
+      (md1->backtrack != md2->backtrack) ||
+      (md1->backtrack_type != md2->backtrack_type) ||
+      (md1->compute_bpp != md2->compute_bpp) ||
+      (md1->oldAliEn != md2->oldAliEn) ||
+      (md1->ribo != md2->ribo) ||
+      (md1->cv_fact != md2->cv_fact) ||
+      (md1->nc_fact != md2->nc_fact) ||
+      (md1->sfact != md2->sfact))
+    return 0;
+
+  /* arrays do not contain any padding, so we may compare them as a whole */
+  if ((strncmp(md1->nonstandards, md2->nonstandards, sizeof(md1->nonstandards)) != 0) ||
+      (memcmp(md1->rtype, md2->rtype, sizeof(md1->rtype)) != 0) ||
+      (memcmp(md1->alias, md2->alias, sizeof(md1->alias)) != 0) ||
+      (memcmp(md1->pair, md2->pair, sizeof(md1->pair)) != 0))
+    return 0;
+
+  return 1;
+}
@@ -105,6 +105,8 @@ typedef void (vrna_callback_recursion_status)(unsigned char status,
 #include <ViennaRNA/constraints/hard.h>
 #include <ViennaRNA/constraints/soft.h>
 #include <ViennaRNA/grammar.h>
+#include <ViennaRNA/utils/rng.h>
+#include <ViennaRNA/utils/timing.h>
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 
@@ -335,6 +337,41 @@ struct {
   /**
    *  @}
    */
+
+  /**
+   *  @name Parallel processing
+   *  @{
+   */
+  int   num_threads;              /**<  @brief  Number of threads used to fill the DP matrices (1 = serial, 0 = OpenMP default)
+                                   *    @note   Any user-supplied hard/soft constraint callbacks must be thread-safe
+                                   *            if this value is not 1
+                                   *    @see    vrna_fold_compound_num_threads()
+                                   */
+  /**
+   *  @}
+   */
+
+  /**
+   *  @name Random number generation
+   *  @{
+   */
+  vrna_rng_t  *rng;               /**<  @brief  A random number generator used by stochastic algorithms, e.g. stochastic backtracking
+                                   *    @see  vrna_fold_compound_rng_seed(), vrna_rng_thread_set()
+                                   */
+  /**
+   *  @}
+   */
+
+  /**
+   *  @name Instrumentation
+   *  @{
+   */
+  vrna_timing_t *timing;          /**<  @brief  Per-phase timing and memory measurements, or @em NULL if disabled
+                                   *    @see  vrna_fold_compound_timing(), vrna_timing_to_json()
+                                   */
+  /**
+   *  @}
+   */
 };
 
 
@@ -511,6 +548,53 @@ void
 vrna_fold_compound_free_param(vrna_fold_compound_t *fc);
 
 
+/**
+ *  @brief  Load a new sequence into an existing #vrna_fold_compound_t, re-using its memory
+ *
+ *  This function is meant for high-throughput applications that predict structures
+ *  for a large number of (short) sequences in a row. Instead of releasing the
+ *  fold compound of the previous sequence and creating a new one, the already
+ *  allocated DP matrices, hard constraints, and energy parameters are re-used
+ *  whenever possible, i.e. if the new sequence is not longer than the capacity of
+ *  the DP matrices, and the model details did not change in a way that affects the
+ *  energy parameters. Only sequence dependent data is re-initialized. The resulting
+ *  fold compound is indistinguishable from one obtained via vrna_fold_compound().
+ *
+ *  Fold compounds with auxiliary data, e.g. unstructured or structured domains,
+ *  distance class partitioning data, user-defined auxiliary data, callbacks, or
+ *  random number generators, as well as fold compounds for local folding (#VRNA_OPTION_WINDOW),
+ *  and comparative fold compounds are not recycled. In this case, @p fc is
+ *  released, and a new fold compound is created instead. Soft constraints are
+ *  always removed.
+ *
+ *  A typical use case looks like this:
+ *  @code
+ *  vrna_fold_compound_t *fc = NULL;
+ *
+ *  while (next_sequence(&seq)) {
+ *    fc = vrna_fold_compound_recycle(fc, seq, &md, VRNA_OPTION_DEFAULT);
+ *    mfe = vrna_mfe(fc, structure);
+ *  }
+ *
+ *  vrna_fold_compound_free(fc);
+ *  @endcode
+ *
+ *  @see  vrna_fold_compound(), vrna_fold_compound_free(), vrna_mx_reset(), vrna_hc_init()
+ *
+ *  @param    fc          The fold compound to recycle (may be @p NULL)
+ *  @param    sequence    A single sequence, or two concatenated sequences seperated by an '&' character
+ *  @param    md_p        An optional set of model details
+ *  @param    options     The options for DP matrices memory allocation
+ *  @return               A prefilled vrna_fold_compound_t ready to be used for computations (may be @p NULL on error,
+ *                        in which case @p fc has been released)
+ */
+vrna_fold_compound_t *
+vrna_fold_compound_recycle(vrna_fold_compound_t *fc,
+                           const char           *sequence,
+                           vrna_md_t            *md_p,
+                           unsigned int         options);
+
+
 /**
  *  @brief  Add auxiliary data to the #vrna_fold_compound_t
  *
@@ -554,6 +638,84 @@ vrna_fold_compound_add_callback(vrna_fold_compound_t            *fc,
                                 vrna_callback_recursion_status  *f);
 
 
+/**
+ *  @brief  Seed the random number generator of a #vrna_fold_compound_t
+ *
+ *  Stochastic algorithms that operate on a #vrna_fold_compound_t, such as
+ *  stochastic backtracking with vrna_pbacktrack() and friends, or random
+ *  walks with vrna_path(), draw their random numbers from the generator
+ *  attached to the fold compound, if any. This allows for reproducible results
+ *  per fold compound, independent of other computations taking place
+ *  in the same process. A random number generator bound to the calling thread
+ *  via vrna_rng_thread_set() takes precedence over the one attached to @p fc.
+ *
+ *  If @p fc does not yet have a random number generator attached, a new one
+ *  will be created and released together with @p fc in vrna_fold_compound_free().
+ *
+ *  @note   The generator of a fold compound must not be used by multiple threads
+ *          simultaneously. Use separate streams bound to each thread instead.
+ *
+ *  @see  #vrna_fold_compound_t.rng, vrna_rng_init(), vrna_rng_thread_set()
+ *
+ *  @param  fc      The fold_compound the random number generator should be attached to
+ *  @param  seed    The seed of the random number generator
+ *  @param  stream  The stream identifier of the random number generator
+ */
+void
+vrna_fold_compound_rng_seed(vrna_fold_compound_t  *fc,
+                            uint64_t              seed,
+                            uint64_t              stream);
+
+
+/**
+ *  @brief  Set the number of threads used by the prediction algorithms of a #vrna_fold_compound_t
+ *
+ *  If @p num_threads differs from 1, vrna_mfe(), vrna_pf(), vrna_pairing_probs(),
+ *  stochastic backtracking, and vrna_path_findpath_saddle_matrix() distribute their work
+ *  among that many OpenMP threads. A value of 0 leaves the choice to the OpenMP runtime.
+ *  Results are identical to the serial computations. Newly created fold compounds use a
+ *  single thread. Without OpenMP support, this setting is ignored.
+ *
+ *  @note   Any user-supplied hard/soft constraint callbacks must be thread-safe if
+ *          @p num_threads is not 1.
+ *
+ *  @note   While filling the MFE matrices in parallel, vrna_mfe() keeps a row-major
+ *          copy of the multibranch loop matrix, i.e. an additional (n+1)(n+2)/2
+ *          integers for a sequence of length n (about 1.8 GB for 30,000 nt). The
+ *          copy is released before backtracking.
+ *
+ *  @see  #vrna_fold_compound_t.num_threads
+ *
+ *  @param  fc          The fold_compound
+ *  @param  num_threads The number of threads (1 = serial, 0 = OpenMP default)
+ *  @return             Non-zero on success, 0 otherwise
+ */
+int
+vrna_fold_compound_num_threads(vrna_fold_compound_t *fc,
+                               int                  num_threads);
+
+
+/**
+ *  @brief  Enable or disable per-phase timing and memory instrumentation
+ *
+ *  With instrumentation enabled, the prediction algorithms that operate on
+ *  @p fc, e.g. vrna_mfe(), vrna_pf(), vrna_pairing_probs(), or vrna_pbacktrack(),
+ *  accumulate wall clock time, processed DP cells, and allocated memory of
+ *  each phase of the computation in #vrna_fold_compound_t.timing.
+ *  Enabling instrumentation for a fold compound that already has it enabled
+ *  resets all measurements.
+ *
+ *  @see  #vrna_fold_compound_t.timing, vrna_timing_to_json(), vrna_timing_reset()
+ *
+ *  @param  fc      The fold_compound to instrument
+ *  @param  status  Non-zero to enable, zero to disable instrumentation
+ *  @return         Non-zero if instrumentation is enabled for @p fc after the call
+ */
+int
+vrna_fold_compound_timing(vrna_fold_compound_t  *fc,
+                          int                   status);
+
+
 /**
  *  @}
  */
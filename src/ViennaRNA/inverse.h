@@ -37,6 +37,10 @@ extern  int   inv_verbose;
  *  If #give_up is set to 1, the function will return as soon as it is
  *  clear that the search will be unsuccessful, this speeds up the algorithm
  *  if you are only interested in exact solutions.
+ *
+ *  Random mutations are drawn with vrna_urn(). Bind a seeded random number
+ *  generator to the calling thread with vrna_rng_thread_set() to obtain
+ *  reproducible designs.
  * 
  *  \param  start   The start sequence
  *  \param  target  The target secondary structure in dot-bracket notation
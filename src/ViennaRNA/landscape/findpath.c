@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <stdint.h>
 
 #include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/model.h"
@@ -21,15 +22,14 @@
 #include "ViennaRNA/landscape/findpath.h"
 
 
-#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
-
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
-#endif
-
-#define LOOP_EN
+/* modes to obtain the energies of neighboring structures */
+#define   FINDPATH_EVAL_FULL            0
+#define   FINDPATH_EVAL_INCREMENTAL     1
+#define   FINDPATH_EVAL_VERIFY          2
 
 #define   PATH_DIRECT_FINDPATH     1U
 
@@ -44,19 +44,41 @@ typedef struct move {
 } move_t;
 
 /**
- *  @brief
+ *  @brief  A structure of the current distance class, i.e. a survivor of the last selection step
  */
 typedef struct intermediate {
-  short   *pt;      /**<  @brief  pair table */
-  int     Sen;      /**<  @brief  saddle energy so far */
-  int     curr_en;  /**<  @brief  current energy */
-  move_t  *moves;   /**<  @brief  remaining moves to target */
+  short     *pt;      /**<  @brief  pair table */
+  int       Sen;      /**<  @brief  saddle energy so far */
+  int       curr_en;  /**<  @brief  current energy */
+  uint64_t  key;      /**<  @brief  Zobrist key, i.e. XOR of the keys of all moves applied so far */
 } intermediate_t;
 
+/**
+ *  @brief  A candidate for the next distance class, stored as delta to its predecessor
+ */
+typedef struct candidate {
+  int           parent;   /**<  @brief  index of the predecessor in the current distance class */
+  int           Sen;      /**<  @brief  saddle energy so far */
+  int           curr_en;  /**<  @brief  current energy */
+  uint64_t      key;      /**<  @brief  Zobrist key of the resulting structure */
+  const short   *ppt;     /**<  @brief  pair table of the predecessor */
+  const move_t  *mv;      /**<  @brief  move that leads from the predecessor to this candidate */
+} candidate_t;
+
+/**
+ *  @brief  Trace of the selected moves that allows for path reconstruction
+ */
+typedef struct step {
+  int parent;
+  int move;
+  int E;
+} step_t;
+
 
 struct vrna_path_options_s {
   unsigned int  type;
   unsigned int  method;
+  unsigned int  options;
 
   int           width;
 };
@@ -96,27 +118,56 @@ PRIVATE vrna_fold_compound_t  *backward_compat_compound = NULL;
  # PRIVATE FUNCTION DECLARATIONS #
  #################################
  */
-PRIVATE move_t *
-copy_moves(move_t *mvs);
+PRIVATE void
+apply_move(short        *pt,
+           const move_t *mv);
+
+
+PRIVATE void
+revert_move(short         *pt,
+            const move_t  *mv);
 
 
 PRIVATE int
-compare_ptable(const void *A,
-               const void *B);
+eval_move(vrna_fold_compound_t  *fc,
+          short                 *pt,
+          const move_t          *mv,
+          int                   curr_en,
+          int                   mode);
 
 
 PRIVATE int
-compare_energy(const void *A,
-               const void *B);
+eval_mode(vrna_fold_compound_t  *fc,
+          unsigned int          options);
+
+
+PRIVATE uint64_t
+zobrist_key(unsigned int m);
 
 
 PRIVATE int
-compare_moves_when(const void *A,
+move_applied(const short  *pt,
+             const move_t *mv);
+
+
+PRIVATE int
+same_structure(const candidate_t  *a,
+               const candidate_t  *b);
+
+
+PRIVATE short
+candidate_pt(const candidate_t  *c,
+             int                k);
+
+
+PRIVATE int
+compare_candidates(const void *A,
                    const void *B);
 
 
-PRIVATE void
-free_intermediate(intermediate_t *i);
+PRIVATE int
+compare_moves_when(const void *A,
+                   const void *B);
 
 
 #ifdef TEST_FINDPATH
@@ -133,15 +184,45 @@ find_path_once(vrna_fold_compound_t *vc,
                short                *pt1,
                short                *pt2,
                int                  maxl,
-               int                  maxE);
+               int                  maxE,
+               move_t               **route,
+               int                  *bp_dist,
+               unsigned int         options);
+
+
+PRIVATE int
+findpath_saddle(vrna_fold_compound_t  *fc,
+                short                 *pt1,
+                short                 *pt2,
+                int                   width,
+                int                   maxE,
+                move_t                **route,
+                int                   *fwd,
+                int                   *bp_dist,
+                unsigned int          options);
+
+
+PRIVATE int
+findpath_saddle_ub(vrna_fold_compound_t *fc,
+                   const char           *s1,
+                   const char           *s2,
+                   int                  width,
+                   int                  maxE,
+                   unsigned int         options);
 
 
 PRIVATE int
 try_moves(vrna_fold_compound_t  *vc,
-          intermediate_t        c,
+          const intermediate_t  *current,
+          int                   c,
+          const move_t          *mlist,
+          const uint64_t        *keys,
           int                   maxE,
-          intermediate_t        *next,
-          int                   dist);
+          candidate_t           *next,
+          int                   num_next,
+          int                   *table,
+          unsigned int          mask,
+          int                   mode);
 
 
 /*
@@ -189,53 +270,94 @@ vrna_path_findpath_saddle_ub(vrna_fold_compound_t *vc,
                              int                  width,
                              int                  maxE)
 {
-  int     maxl;
-  short   *ptr, *pt1, *pt2;
-  move_t  *bestpath = NULL;
-  int     dir;
+  return findpath_saddle_ub(vc, s1, s2, width, maxE, 0U);
+}
 
-  path_fwd  = dir = 0;
-  pt1       = vrna_ptable(s1);
-  pt2       = vrna_ptable(s2);
 
-  maxl = 1;
-  do {
-    int saddleE;
-    path_fwd = !path_fwd;
-    if (maxl > width)
-      maxl = width;
+PUBLIC int *
+vrna_path_findpath_saddle_matrix(vrna_fold_compound_t *fc,
+                                 const char           **structures,
+                                 int                  width,
+                                 int                  maxE,
+                                 unsigned int         options)
+{
+  short **pts;
+  int   i, j, k, d, n, ub, b, *matrix, num_threads;
 
-    if (path)
-      free(path);
+  if ((!fc) || (!structures))
+    return NULL;
 
-    saddleE = find_path_once(vc, pt1, pt2, maxl, maxE);
-    if (saddleE < maxE) {
-      maxE = saddleE;
-      if (bestpath)
-        free(bestpath);
+  for (n = 0; structures[n]; n++);
 
-      bestpath  = path;
-      path      = NULL;
-      dir       = path_fwd;
-    } else {
-      free(path);
-      path = NULL;
-    }
+  matrix  = (int *)vrna_alloc(sizeof(int) * n * n);
+  pts     = (short **)vrna_alloc(sizeof(short *) * n);
 
-    ptr   = pt1;
-    pt1   = pt2;
-    pt2   = ptr;
-    maxl  *= 2;
-  } while (maxl < 2 * width);
+  /*
+   *  evaluate all structures before we fan out, this also takes care of
+   *  any lazy initialization within the fold compound
+   */
+  for (i = 0; i < n; i++) {
+    pts[i]            = vrna_ptable(structures[i]);
+    matrix[n * i + i] = vrna_eval_structure_pt(fc, pts[i]);
+  }
 
-  /* (re)set some globals */
-  path      = bestpath;
-  path_fwd  = dir;
+  num_threads = fc->num_threads;
 
-  free(pt1);
-  free(pt2);
+#ifdef _OPENMP
+  if (num_threads < 1)
+    num_threads = omp_get_max_threads();
 
-  return maxE;
+#else
+  num_threads = 1;
+#endif
+
+  /*
+   *  Process pairs (i, j) in order of increasing index distance d = j - i,
+   *  such that the saddles of all pairs (i, k) and (k, j) with i < k < j are
+   *  already known. Each of these intermediate structures k yields a
+   *  refolding path with saddle max(S(i, k), S(k, j)) and thus an upper
+   *  bound for S(i, j) that prunes the search. As the bounds only depend on
+   *  previous distance classes, the resulting matrix is independent of the
+   *  number of threads.
+   */
+  for (d = 1; d < n; d++) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads) \
+  private(j, k, ub, b)
+#endif
+    for (i = 0; i < n - d; i++) {
+      j   = i + d;
+      ub  = maxE;
+
+      /*
+       *  the matrix is symmetric, so S(k, j) is read from row j
+       *  to scan both rows with unit stride
+       */
+      if (!(options & VRNA_PATH_SADDLE_MATRIX_NO_BOUNDS))
+        for (k = i + 1; k < j; k++) {
+          b = MAX2(matrix[n * i + k], matrix[n * j + k]);
+          if (b < ub)
+            ub = b;
+        }
+
+      matrix[n * i + j] = matrix[n * j + i] = findpath_saddle(fc,
+                                                              pts[i],
+                                                              pts[j],
+                                                              width,
+                                                              ub,
+                                                              NULL,
+                                                              NULL,
+                                                              NULL,
+                                                              options);
+    }
+  }
+
+  for (i = 0; i < n; i++)
+    free(pts[i]);
+
+  free(pts);
+
+  return matrix;
 }
 
 
@@ -291,9 +413,10 @@ vrna_path_options_findpath(int          width,
   struct vrna_path_options_s *options =
     (struct vrna_path_options_s *)vrna_alloc(sizeof(struct vrna_path_options_s));
 
-  options->type   = type;
-  options->method = PATH_DIRECT_FINDPATH;
-  options->width  = width;
+  options->type    = type & (VRNA_PATH_TYPE_DOT_BRACKET | VRNA_PATH_TYPE_MOVES);
+  options->method  = PATH_DIRECT_FINDPATH;
+  options->options = type & VRNA_PATH_VERIFY_ENERGIES;
+  options->width   = width;
 
   return options;
 }
@@ -312,13 +435,14 @@ findpath_method(vrna_fold_compound_t  *fc,
                 const char            *s2,
                 int                   width,
                 int                   maxE,
-                unsigned int          return_type)
+                unsigned int          return_type,
+                unsigned int          options)
 {
   int         E, d;
   float       last_E;
   vrna_path_t *route = NULL;
 
-  E = vrna_path_findpath_saddle_ub(fc, s1, s2, width, maxE);
+  E = findpath_saddle_ub(fc, s1, s2, width, maxE, options);
 
   /* did we find a better path than one with saddle maxE? */
   if (E < maxE) {
@@ -460,7 +584,7 @@ vrna_path_direct_ub(vrna_fold_compound_t        *fc,
     case PATH_DIRECT_FINDPATH:
     /* fall through */
     default:
-      route = findpath_method(fc, s1, s2, o->width, maxE, o->type);
+      route = findpath_method(fc, s1, s2, o->width, maxE, o->type, o->options);
       break;
   }
 
@@ -604,61 +728,152 @@ usage(void)
  # STATIC helper functions below #
  #################################
  */
+PRIVATE int
+findpath_saddle_ub(vrna_fold_compound_t *fc,
+                   const char           *s1,
+                   const char           *s2,
+                   int                  width,
+                   int                  maxE,
+                   unsigned int         options)
+{
+  short *pt1, *pt2;
+
+  pt1 = vrna_ptable(s1);
+  pt2 = vrna_ptable(s2);
+
+  if (path)
+    free(path);
+
+  maxE = findpath_saddle(fc, pt1, pt2, width, maxE, &path, &path_fwd, &BP_dist, options);
+
+  free(pt1);
+  free(pt2);
+
+  return maxE;
+}
+
+
+PRIVATE int
+findpath_saddle(vrna_fold_compound_t  *fc,
+                short                 *pt1,
+                short                 *pt2,
+                int                   width,
+                int                   maxE,
+                move_t                **route,
+                int                   *fwd,
+                int                   *bp_dist,
+                unsigned int          options)
+{
+  int     maxl, dir, saddleE, dist;
+  short   *ptr;
+  move_t  *bestpath, *p, **pp;
+
+  bestpath  = p = NULL;
+  pp        = (route) ? &p : NULL;
+  dir       = 0;
+  dist      = 0;
+
+  /* alternate between both directions while doubling the search width */
+  maxl = 1;
+  do {
+    dir = !dir;
+    if (maxl > width)
+      maxl = width;
+
+    saddleE = find_path_once(fc, pt1, pt2, maxl, maxE, pp, &dist, options);
+    if (saddleE < maxE) {
+      maxE = saddleE;
+      if (route) {
+        free(bestpath);
+        bestpath = p;
+        if (fwd)
+          *fwd = dir;
+      }
+    } else if (route) {
+      free(p);
+    }
+
+    p     = NULL;
+    ptr   = pt1;
+    pt1   = pt2;
+    pt2   = ptr;
+    maxl  *= 2;
+  } while (maxl < 2 * width);
+
+  if (route) {
+    *route = bestpath;
+    if ((fwd) && (!bestpath))
+      *fwd = 0;
+  }
+
+  if (bp_dist)
+    *bp_dist = dist;
+
+  return maxE;
+}
+
+
 PRIVATE int
 try_moves(vrna_fold_compound_t  *vc,
-          intermediate_t        c,
+          const intermediate_t  *current,
+          int                   c,
+          const move_t          *mlist,
+          const uint64_t        *keys,
           int                   maxE,
-          intermediate_t        *next,
-          int                   dist)
+          candidate_t           *next,
+          int                   num_next,
+          int                   *table,
+          unsigned int          mask,
+          int                   mode)
 {
-  int     *loopidx, len, num_next = 0, en, oldE;
-  move_t  *mv;
-  short   *pt;
-
-  len     = c.pt[0];
-  loopidx = vrna_loopidx_from_ptable(c.pt);
-  oldE    = c.Sen;
-  for (mv = c.moves; mv->i != 0; mv++) {
+  int           *loopidx, en, oldE, m, idx;
+  unsigned int  h;
+  short         *pt;
+  const move_t  *mv;
+  candidate_t   cand;
+
+  pt      = current[c].pt;
+  loopidx = vrna_loopidx_from_ptable(pt);
+  oldE    = current[c].Sen;
+
+  for (m = 0, mv = mlist; mv->i != 0; mv++, m++) {
     int i, j;
-    if (mv->when > 0)
+
+    if (move_applied(pt, mv))
       continue;
 
-    i   = mv->i;
-    j   = mv->j;
-    pt  = (short *)vrna_alloc(sizeof(short) * (len + 1));
-    memcpy(pt, c.pt, (len + 1) * sizeof(short));
-    if (j < 0) {
-      /*it's a delete move */
-      pt[-i]  = 0;
-      pt[-j]  = 0;
-    } else {
-      /* insert move */
-      if ((loopidx[i] == loopidx[j]) && /* i and j belong to same loop */
-          (pt[i] == 0) && (pt[j] == 0)  /* ... and are unpaired */
-          ) {
-        pt[i] = j;
-        pt[j] = i;
-      } else {
-        free(pt);
-        continue; /* llegal move, try next; */
-      }
-    }
+    i = mv->i;
+    j = mv->j;
 
-#ifdef LOOP_EN
-    en = c.curr_en + vrna_eval_move_pt(vc, c.pt, i, j);
-#else
-    en = vrna_eval_structure_pt(vc, pt);
-#endif
-    if (en < maxE) {
-      next[num_next].Sen      = (en > oldE) ? en : oldE;
-      next[num_next].curr_en  = en;
-      next[num_next].pt       = pt;
-      mv->when                = dist;
-      mv->E                   = en;
-      next[num_next++].moves  = copy_moves(c.moves);
-      mv->when                = 0;
-    } else {
-      free(pt);
+    /* insert moves are only legal if i and j belong to the same loop and are unpaired */
+    if ((j > 0) &&
+        ((loopidx[i] != loopidx[j]) || (pt[i] != 0) || (pt[j] != 0)))
+      continue;
+
+    en = eval_move(vc, pt, mv, current[c].curr_en, mode);
+    if (en >= maxE)
+      continue;
+
+    cand.parent   = c;
+    cand.Sen      = (en > oldE) ? en : oldE;
+    cand.curr_en  = en;
+    cand.key      = current[c].key ^ keys[m];
+    cand.ppt      = pt;
+    cand.mv       = mv;
+
+    /* look-up the resulting structure among the candidates we've already seen */
+    for (h = (unsigned int)cand.key & mask; (idx = table[h]) != -1; h = (h + 1) & mask)
+      if ((next[idx].key == cand.key) &&
+          (same_structure(next + idx, &cand)))
+        break;
+
+    if (idx == -1) {
+      table[h]          = num_next;
+      next[num_next++]  = cand;
+    } else if ((cand.Sen < next[idx].Sen) ||
+               ((cand.Sen == next[idx].Sen) && (cand.curr_en < next[idx].curr_en))) {
+      /* keep the better path to this structure only */
+      next[idx] = cand;
     }
   }
   free(loopidx);
@@ -671,24 +886,30 @@ find_path_once(vrna_fold_compound_t *vc,
                short                *pt1,
                short                *pt2,
                int                  maxl,
-               int                  maxE)
+               int                  maxE,
+               move_t               **route,
+               int                  *bp_dist,
+               unsigned int         options)
 {
   move_t          *mlist;
-  int             i, len, d, dist = 0, result;
-  short           *pt;
-  intermediate_t  *current, *next;
-
-  len = (int)pt1[0];
-  pt  = vrna_ptable_copy(pt1);
-
+  int             i, len, d, c, u, dist, result, num_curr, num_next, mode, *table;
+  unsigned int    size, max_size;
+  uint64_t        *keys;
+  short           *arena, *arena_next, *ptr;
+  intermediate_t  *current, *survivors, *tmp;
+  candidate_t     *next;
+  step_t          *steps, *s;
+
+  len   = (int)pt1[0];
+  dist  = 0;
   mlist = (move_t *)vrna_alloc(sizeof(move_t) * len); /* bp_dist < n */
 
   for (i = 1; i <= len; i++) {
-    if (pt[i] != pt2[i]) {
-      if (i < pt[i]) {
+    if (pt1[i] != pt2[i]) {
+      if (i < pt1[i]) {
         /* need to delete this pair */
         mlist[dist].i       = -i;
-        mlist[dist].j       = -pt[i];
+        mlist[dist].j       = -pt1[i];
         mlist[dist++].when  = 0;
       }
 
@@ -701,101 +922,329 @@ find_path_once(vrna_fold_compound_t *vc,
     }
   }
 
-  BP_dist           = dist;
-  current           = (intermediate_t *)vrna_alloc(sizeof(intermediate_t) * (maxl + 1));
-  current[0].pt     = pt;
-  current[0].Sen    = current[0].curr_en = vrna_eval_structure_pt(vc, pt);
-  current[0].moves  = mlist;
-  next              = (intermediate_t *)vrna_alloc(sizeof(intermediate_t) * (dist * maxl + 1));
+  *bp_dist = dist;
+
+  /*
+   *  Each structure is identified by the set of moves applied to the start
+   *  structure. Assigning a random key to each move, the XOR of all applied
+   *  keys (Zobrist hashing) can be updated in constant time per move.
+   */
+  keys = (uint64_t *)vrna_alloc(sizeof(uint64_t) * (dist + 1));
+  for (i = 0; i < dist; i++)
+    keys[i] = zobrist_key(i);
+
+  /*
+   *  Only the (at most maxl) survivors of each distance class are stored
+   *  explicitly, in two alternating arenas. All candidates of the next class
+   *  are kept as (predecessor, move) deltas.
+   */
+  arena       = (short *)vrna_alloc(sizeof(short) * (len + 1) * maxl);
+  arena_next  = (short *)vrna_alloc(sizeof(short) * (len + 1) * maxl);
+  current     = (intermediate_t *)vrna_alloc(sizeof(intermediate_t) * maxl);
+  survivors   = (intermediate_t *)vrna_alloc(sizeof(intermediate_t) * maxl);
+  next        = (candidate_t *)vrna_alloc(sizeof(candidate_t) * (dist * maxl + 1));
+  steps       = (step_t *)vrna_alloc(sizeof(step_t) * (dist + 1) * maxl);
+
+  for (max_size = 2; max_size < 2 * (unsigned int)(dist * maxl + 1); max_size <<= 1);
+  table = (int *)vrna_alloc(sizeof(int) * max_size);
+
+  current[0].pt = arena;
+  memcpy(current[0].pt, pt1, sizeof(short) * (len + 1));
+  current[0].Sen  = current[0].curr_en = vrna_eval_structure_pt(vc, current[0].pt);
+  current[0].key  = 0;
+  num_curr        = 1;
+  mode            = eval_mode(vc, options);
 
   for (d = 1; d <= dist; d++) {
     /* go through the distance classes */
-    int             c, u, num_next = 0;
-    intermediate_t  *cc;
 
-    for (c = 0; current[c].pt != NULL; c++)
-      num_next += try_moves(vc, current[c], maxE, next + num_next, d);
+    /* each structure has at most dist - d + 1 moves left, keep the load factor below 1/2 */
+    for (size = 2; size < 2 * (unsigned int)(num_curr * (dist - d + 1)); size <<= 1);
+    memset(table, -1, sizeof(int) * size);
+
+    num_next = 0;
+    for (c = 0; c < num_curr; c++)
+      num_next = try_moves(vc,
+                           current,
+                           c,
+                           mlist,
+                           keys,
+                           maxE,
+                           next,
+                           num_next,
+                           table,
+                           size - 1,
+                           mode);
+
     if (num_next == 0) {
-      for (cc = current; cc->pt != NULL; cc++)
-        free_intermediate(cc);
-      current[0].Sen = INT_MAX;
+      num_curr = 0;
       break;
     }
 
-    /* remove duplicates via sort|uniq
-     * if this becomes a bottleneck we can use a hash instead */
-    qsort(next, num_next, sizeof(intermediate_t), compare_ptable);
-    for (u = 0, c = 1; c < num_next; c++) {
-      if (memcmp(next[u].pt, next[c].pt, sizeof(short) * len) != 0)
-        next[++u] = next[c];
-      else
-        free_intermediate(next + c);
+    qsort(next, num_next, sizeof(candidate_t), compare_candidates);
+
+    /* materialize the best maxl candidates */
+    for (u = 0; (u < maxl) && (u < num_next); u++) {
+      ptr = arena_next + u * (len + 1);
+      memcpy(ptr, next[u].ppt, sizeof(short) * (len + 1));
+      apply_move(ptr, next[u].mv);
+
+      survivors[u].pt       = ptr;
+      survivors[u].Sen      = next[u].Sen;
+      survivors[u].curr_en  = next[u].curr_en;
+      survivors[u].key      = next[u].key;
+
+      s         = steps + d * maxl + u;
+      s->parent = next[u].parent;
+      s->move   = (int)(next[u].mv - mlist);
+      s->E      = next[u].curr_en;
+    }
+
+    num_curr    = u;
+    tmp         = current;
+    current     = survivors;
+    survivors   = tmp;
+    ptr         = arena;
+    arena       = arena_next;
+    arena_next  = ptr;
+  }
+
+  if (num_curr > 0) {
+    /* trace back the moves that lead to the best structure of the last distance class */
+    for (u = 0, d = dist; d > 0; d--) {
+      s                   = steps + d * maxl + u;
+      mlist[s->move].when = d;
+      mlist[s->move].E    = s->E;
+      u                   = s->parent;
     }
-    num_next = u + 1;
-    qsort(next, num_next, sizeof(intermediate_t), compare_energy);
-    /* free the old stuff */
-    for (cc = current; cc->pt != NULL; cc++)
-      free_intermediate(cc);
-    for (u = 0; u < maxl && u < num_next; u++)
-      current[u] = next[u];
-    for (; u < num_next; u++)
-      free_intermediate(next + u);
-    num_next = 0;
+
+    result = current[0].Sen;
+  } else {
+    free(mlist);
+    mlist   = NULL;
+    result  = INT_MAX;
   }
+
+  if (route)
+    *route = mlist;
+  else
+    free(mlist);
+
+  free(table);
+  free(steps);
   free(next);
-  path    = current[0].moves;
-  result  = current[0].Sen;
-  free(current[0].pt);
+  free(survivors);
   free(current);
+  free(arena_next);
+  free(arena);
+  free(keys);
+
   return result;
 }
 
 
 PRIVATE void
-free_intermediate(intermediate_t *i)
+apply_move(short        *pt,
+           const move_t *mv)
+{
+  if (mv->i < 0) {
+    /* delete move */
+    pt[-mv->i]  = 0;
+    pt[-mv->j]  = 0;
+  } else {
+    /* insert move */
+    pt[mv->i] = mv->j;
+    pt[mv->j] = mv->i;
+  }
+}
+
+
+PRIVATE void
+revert_move(short         *pt,
+            const move_t  *mv)
 {
-  free(i->pt);
-  free(i->moves);
-  i->pt     = NULL;
-  i->moves  = NULL;
-  i->Sen    = INT_MAX;
+  if (mv->i < 0) {
+    pt[-mv->i]  = -mv->j;
+    pt[-mv->j]  = -mv->i;
+  } else {
+    pt[mv->i] = 0;
+    pt[mv->j] = 0;
+  }
 }
 
 
 PRIVATE int
-compare_ptable(const void *A,
-               const void *B)
+eval_move(vrna_fold_compound_t  *fc,
+          short                 *pt,
+          const move_t          *mv,
+          int                   curr_en,
+          int                   mode)
 {
-  intermediate_t  *a, *b;
-  int             c;
+  int en, en_full;
 
-  a = (intermediate_t *)A;
-  b = (intermediate_t *)B;
+  en = INT_MAX;
 
-  c = memcmp(a->pt, b->pt, a->pt[0] * sizeof(short));
-  if (c != 0)
-    return c;
+  if (mode != FINDPATH_EVAL_FULL)
+    en = curr_en + vrna_eval_move_pt(fc, pt, mv->i, mv->j);
+
+  if (mode != FINDPATH_EVAL_INCREMENTAL) {
+    apply_move(pt, mv);
+    en_full = vrna_eval_structure_pt(fc, pt);
+    revert_move(pt, mv);
+
+    if ((mode == FINDPATH_EVAL_VERIFY) && (en != en_full))
+      vrna_message_warning("findpath: "
+                           "Energy change of move (%d,%d) differs from full evaluation (%d vs. %d)",
+                           mv->i, mv->j,
+                           en,
+                           en_full);
+
+    en = en_full;
+  }
+
+  return en;
+}
+
+
+PRIVATE int
+eval_mode(vrna_fold_compound_t  *fc,
+          unsigned int          options)
+{
+  /*
+   *  the loop decomposition of vrna_eval_move_pt() is exact for single
+   *  sequences with linear exterior loop (and any number of strands) only
+   */
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->params->model_details.circ) ||
+      (fc->params->model_details.backtrack_type == 'M'))
+    return FINDPATH_EVAL_FULL;
+
+  if (options & VRNA_PATH_VERIFY_ENERGIES)
+    return FINDPATH_EVAL_VERIFY;
+
+  return FINDPATH_EVAL_INCREMENTAL;
+}
+
+
+PRIVATE int
+move_applied(const short  *pt,
+             const move_t *mv)
+{
+  if (mv->i < 0)
+    return pt[-mv->i] != -mv->j;
+
+  return pt[mv->i] == mv->j;
+}
+
+
+PRIVATE uint64_t
+zobrist_key(unsigned int m)
+{
+  /* splitmix64 finalizer, i.e. a fixed pseudo-random key for each move */
+  uint64_t z = ((uint64_t)m + 1) * 0x9E3779B97F4A7C15ULL;
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+  return z ^ (z >> 31);
+}
 
-  if ((a->Sen - b->Sen) != 0)
-    return a->Sen - b->Sen;
 
-  return a->curr_en - b->curr_en;
+PRIVATE int
+same_structure(const candidate_t  *a,
+               const candidate_t  *b)
+{
+  /*
+   *  Both candidates stem from structures with the same number of moves
+   *  applied. Apart from having the same key, they can only be equal if
+   *  each one's move was already applied to the other's predecessor
+   */
+  if (a->parent == b->parent)
+    return a->mv == b->mv;
+
+  return (move_applied(a->ppt, b->mv)) &&
+         (move_applied(b->ppt, a->mv));
+}
+
+
+PRIVATE short
+candidate_pt(const candidate_t  *c,
+             int                k)
+{
+  const move_t *mv = c->mv;
+
+  if (mv->i < 0) {
+    if ((k == -mv->i) || (k == -mv->j))
+      return 0;
+  } else if (k == mv->i) {
+    return mv->j;
+  } else if (k == mv->j) {
+    return mv->i;
+  }
+
+  return c->ppt[k];
 }
 
 
 PRIVATE int
-compare_energy(const void *A,
-               const void *B)
+compare_candidates(const void *A,
+                   const void *B)
 {
-  intermediate_t *a, *b;
+  const candidate_t *a, *b;
+  int               c, k, p, lo, hi, len, pos[4];
+  short             va, vb;
 
-  a = (intermediate_t *)A;
-  b = (intermediate_t *)B;
+  a = (const candidate_t *)A;
+  b = (const candidate_t *)B;
 
   if ((a->Sen - b->Sen) != 0)
     return a->Sen - b->Sen;
 
-  return a->curr_en - b->curr_en;
+  if ((a->curr_en - b->curr_en) != 0)
+    return a->curr_en - b->curr_en;
+
+  /*
+   *  break ties by the memcmp() order of the resulting pair tables, as the
+   *  previous sort|uniq implementation did. Both pair tables differ from
+   *  their predecessors at the positions of the moves only, so we compare
+   *  the predecessors piecewise in between.
+   */
+  len     = a->ppt[0];
+  pos[0]  = abs(a->mv->i);
+  pos[1]  = abs(a->mv->j);
+  pos[2]  = abs(b->mv->i);
+  pos[3]  = abs(b->mv->j);
+
+  for (p = 1; p < 4; p++)
+    for (k = p; (k > 0) && (pos[k - 1] > pos[k]); k--) {
+      c           = pos[k];
+      pos[k]      = pos[k - 1];
+      pos[k - 1]  = c;
+    }
+
+  for (lo = 0, p = 0; lo < len; p++) {
+    hi = (p < 4) ? MIN2(pos[p], len) : len;
+
+    if (hi < lo)
+      continue; /* position already compared */
+
+    if ((hi > lo) &&
+        (a->ppt != b->ppt) &&
+        ((c = memcmp(a->ppt + lo, b->ppt + lo, sizeof(short) * (hi - lo))) != 0))
+      return c;
+
+    if (hi == len)
+      break;
+
+    va  = candidate_pt(a, hi);
+    vb  = candidate_pt(b, hi);
+    if (va != vb)
+      return memcmp(&va, &vb, sizeof(short));
+
+    lo = hi + 1;
+  }
+
+  return 0;
 }
 
 
@@ -812,17 +1261,6 @@ compare_moves_when(const void *A,
 }
 
 
-PRIVATE move_t *
-copy_moves(move_t *mvs)
-{
-  move_t *new;
-
-  new = (move_t *)vrna_alloc(sizeof(move_t) * (BP_dist + 1));
-  memcpy(new, mvs, sizeof(move_t) * (BP_dist + 1));
-  return new;
-}
-
-
 /*
  *###########################################
  *# deprecated functions below              #
@@ -25,6 +25,10 @@
  *
  *  @brief Heuristics to explore direct, optimal (re-)folding paths between two secondary structures
  *
+ *  Energies of the intermediate structures are obtained incrementally, i.e. by re-evaluating
+ *  only the loops that are affected by a move. For debugging purposes, pass the
+ *  #VRNA_PATH_VERIFY_ENERGIES flag to cross-check each of them against a full evaluation
+ *  of the respective structure.
  */
 
 #include <ViennaRNA/fold_compound.h>
@@ -155,6 +159,66 @@ vrna_path_findpath_ub(vrna_fold_compound_t  *fc,
                       int                   maxE);
 
 
+/**
+ *  @brief  Option flag for vrna_path_findpath_saddle_matrix() to use the default settings
+ *  @see    vrna_path_findpath_saddle_matrix(), #VRNA_PATH_SADDLE_MATRIX_NO_BOUNDS
+ */
+#define VRNA_PATH_SADDLE_MATRIX_DEFAULT     0U
+
+/**
+ *  @brief  Option flag for vrna_path_findpath_saddle_matrix() to not derive upper bounds from already computed saddles
+ *
+ *  With this flag set, each entry of the saddle matrix is obtained from an
+ *  independent call to vrna_path_findpath_saddle_ub() with the global upper bound only.
+ *  Use it whenever the entries must be saddles of direct paths, e.g. to derive
+ *  transition rates between pairs of structures.
+ *
+ *  @see    vrna_path_findpath_saddle_matrix(), #VRNA_PATH_SADDLE_MATRIX_DEFAULT
+ */
+#define VRNA_PATH_SADDLE_MATRIX_NO_BOUNDS   1U
+
+
+/**
+ *  @brief Find energies of the saddle points between all pairs of a set of structures (search only direct paths)
+ *
+ *  This function computes the saddle point energies for all pairs of the
+ *  @em NULL terminated list of @p structures with the @em findpath heuristic,
+ *  e.g. to construct barrier trees or rate matrices for a set of local minima.
+ *  Pairs are processed in order of increasing distance of their indices in
+ *  @p structures, where all pairs of the same distance are independent and
+ *  processed in parallel according to #vrna_fold_compound_t.num_threads.
+ *
+ *  Unless #VRNA_PATH_SADDLE_MATRIX_NO_BOUNDS is passed in @p options, the
+ *  saddles @f$S(i,k)@f$ and @f$S(k,j)@f$ already known for any @f$i < k < j@f$
+ *  tighten the upper bound for the saddle between structures @f$i@f$ and @f$j@f$ to
+ *  @f$\min_k \max(S(i,k), S(k,j))@f$, i.e. the saddle of the refolding path
+ *  via structure @f$k@f$. Since this prunes the search of the remaining
+ *  pairs, ordering the input such that similar structures are close to each other
+ *  pays off. In any case, the resulting matrix does not depend on the number of threads.
+ *
+ *  @warning  Similar to vrna_path_findpath_saddle_ub(), an entry equals its upper bound if
+ *            no direct path with lower saddle point energy was found. In particular, pairs
+ *            without any path below @p maxE obtain @p maxE.
+ *
+ *  @see  vrna_path_findpath_saddle_ub(), #VRNA_PATH_SADDLE_MATRIX_DEFAULT, #VRNA_PATH_SADDLE_MATRIX_NO_BOUNDS
+ *
+ *  @param fc         The #vrna_fold_compound_t with precomputed sequence encoding and model details
+ *  @param structures A @em NULL terminated list of @f$n@f$ structures in dot-bracket notation
+ *  @param width      A number specifying how many strutures are being kept at each step during the search
+ *  @param maxE       An upper bound for the saddle point energies in 10cal/mol
+ *  @param options    Options, i.e. #VRNA_PATH_SADDLE_MATRIX_DEFAULT or #VRNA_PATH_SADDLE_MATRIX_NO_BOUNDS,
+ *                    optionally combined with #VRNA_PATH_VERIFY_ENERGIES
+ *  @returns          A symmetric @f$n \times n@f$ matrix in row-major order with saddle energies in 10cal/mol
+ *                    and the free energies of the structures on the diagonal, or @em NULL on error
+ */
+int *
+vrna_path_findpath_saddle_matrix(vrna_fold_compound_t *fc,
+                                 const char           **structures,
+                                 int                  width,
+                                 int                  maxE,
+                                 unsigned int         options);
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 /**
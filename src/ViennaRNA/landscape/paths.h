@@ -76,6 +76,20 @@ DEPRECATED(typedef struct vrna_path_s path_t,
  */
 #define   VRNA_PATH_TYPE_MOVES          2U
 
+/**
+ *  @brief  Flag to cross-check the energies of intermediate structures of the findpath heuristic
+ *
+ *  The <em>findpath</em> heuristic obtains the energies of intermediate structures by
+ *  re-evaluating only the loops affected by a move. Combined with the path type passed to
+ *  vrna_path_options_findpath(), or with the options of vrna_path_findpath_saddle_matrix(),
+ *  this flag additionally evaluates each structure from scratch. Deviations are reported as
+ *  warnings and the fully evaluated energy is used instead. This is meant for debugging and
+ *  slows down the search considerably.
+ *
+ *  @see    vrna_path_options_findpath(), vrna_path_findpath_saddle_matrix()
+ */
+#define   VRNA_PATH_VERIFY_ENERGIES     4U
+
 /**
  *  @brief  An element of a refolding path list
  *
@@ -167,7 +181,8 @@ vrna_path_options_free(vrna_path_options_t options);
  *            vrna_path_direct(), vrna_path_direct_ub()
  *
  *  @param    width   Width of the breath-first search strategy
- *  @param    type    Setting that specifies how the return (re-)folding path should be encoded
+ *  @param    type    Setting that specifies how the return (re-)folding path should be encoded,
+ *                    optionally combined with #VRNA_PATH_VERIFY_ENERGIES
  *  @returns          An options data structure with settings for the findpath direct path heuristic
  */
 vrna_path_options_t
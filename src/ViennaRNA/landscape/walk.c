@@ -115,10 +115,23 @@ vrna_path(vrna_fold_compound_t  *vc,
           unsigned int          steps,
           unsigned int          options)
 {
-  if ((vc) && (ptStartAndResultStructure))
-    return do_path(vc, ptStartAndResultStructure, steps, options);
+  vrna_move_t *moves;
+  vrna_rng_t  *rng_prev;
 
-  return NULL;
+  moves = NULL;
+
+  if ((vc) && (ptStartAndResultStructure)) {
+    /* draw random moves from the generator attached to vc, if any */
+    rng_prev = vrna_rng_thread_get();
+    if ((!rng_prev) && (vc->rng))
+      vrna_rng_thread_set(vc->rng);
+
+    moves = do_path(vc, ptStartAndResultStructure, steps, options);
+
+    vrna_rng_thread_set(rng_prev);
+  }
+
+  return moves;
 }
 
 
@@ -271,7 +284,7 @@ do_path(vrna_fold_compound_t  *vc,
       int length = 0;
       for (vrna_move_t *moveNeighbor = moveset; moveNeighbor->pos_5 != 0; moveNeighbor++)
         length++;
-      int index = rand() % length;
+      int index = vrna_int_urn(0, length - 1);
       m               = moveset[index];
       energyNeighbor  = vrna_eval_move_shift_pt(vc, &m, ptStartAndResultStructure);
       iterations--;
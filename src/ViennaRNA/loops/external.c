@@ -323,6 +323,70 @@ vrna_E_ext_loop_5(vrna_fold_compound_t *fc)
 }
 
 
+PUBLIC int
+vrna_E_ext_loop_5_column(vrna_fold_compound_t *fc,
+                         int                  j)
+{
+  if ((fc) && (j > 0) && (j <= (int)fc->length)) {
+    int                       e, en, *f5, dangle_model, turn;
+    vrna_param_t              *P;
+    vrna_callback_hc_evaluate *evaluate;
+    struct default_data       hc_dat_local;
+    struct sc_wrapper_f5      sc_wrapper;
+    vrna_gr_aux_t             *grammar;
+
+    f5            = fc->matrices->f5;
+    P             = fc->params;
+    dangle_model  = P->model_details.dangles;
+    turn          = P->model_details.min_loop_size;
+    grammar       = fc->aux_grammar;
+    evaluate      = prepare_hc_default(fc, &hc_dat_local);
+
+    init_sc_wrapper(fc, &sc_wrapper);
+
+    /* extend previous solution(s) by adding an unpaired region */
+    e = reduce_f5_up(fc, j, evaluate, &hc_dat_local, &sc_wrapper);
+
+    if (j > turn + 1) {
+      /* decompose into exterior loop part followed by a stem */
+      switch (dangle_model) {
+        case 2:
+          en = decompose_f5_ext_stem_d2(fc, j, evaluate, &hc_dat_local, &sc_wrapper);
+          break;
+
+        case 0:
+          en = decompose_f5_ext_stem_d0(fc, j, evaluate, &hc_dat_local, &sc_wrapper);
+          break;
+
+        default:
+          en = decompose_f5_ext_stem_d1(fc, j, evaluate, &hc_dat_local, &sc_wrapper);
+          break;
+      }
+
+      e = MIN2(e, en);
+
+      if (P->model_details.gquad) {
+        en  = add_f5_gquad(fc, j, evaluate, &hc_dat_local, &sc_wrapper);
+        e   = MIN2(e, en);
+      }
+    }
+
+    if ((grammar) && (grammar->cb_aux_f)) {
+      en  = grammar->cb_aux_f(fc, 1, j, grammar->data);
+      e   = MIN2(e, en);
+    }
+
+    free_sc_wrapper(&sc_wrapper);
+
+    f5[j] = e;
+
+    return e;
+  }
+
+  return INF;
+}
+
+
 PUBLIC int
 vrna_E_ext_loop_3(vrna_fold_compound_t  *fc,
                   int                   i)
@@ -92,6 +92,25 @@ int
 vrna_E_ext_loop_5(vrna_fold_compound_t *fc);
 
 
+/**
+ *  @brief  Evaluate a single entry of the 5' exterior loop array
+ *
+ *  Computes @f$ f5[j] @f$ from the already filled entries @f$ f5[0], \ldots, f5[j - 1] @f$
+ *  and the pair matrix, stores it in the fold compound, and returns it. Decompositions
+ *  that involve nucleotide @f$ j + 1 @f$ (i.e. dangling ends and mismatches) follow the
+ *  current length of @p fc.
+ *
+ *  @see vrna_E_ext_loop_5()
+ *
+ *  @param  fc    Fold compound to work on (defines the model, parameters, and DP matrices)
+ *  @param  j     The position of the entry to compute
+ *  @return       The free energy of the 5' fragment @f$ [1, j] @f$ in dcal/mol
+ */
+int
+vrna_E_ext_loop_5_column(vrna_fold_compound_t *fc,
+                         int                  j);
+
+
 int
 vrna_E_ext_loop_3(vrna_fold_compound_t  *fc,
                   int                   i);
@@ -159,6 +178,39 @@ vrna_exp_E_ext_fast(vrna_fold_compound_t        *fc,
                     struct vrna_mx_pf_aux_el_s  *aux_mx);
 
 
+/**
+ *  @brief  Compute the exterior loop parts of segment @f$[i,j]@f$ with exactly one stem starting at @f$i@f$
+ *
+ *  This is the first stage of vrna_exp_E_ext_fast(). The result is stored in the helper
+ *  arrays of the current column @f$j@f$ and only depends on previous columns and the
+ *  pair matrix entries of column @f$j@f$. Thus, it may be called for all @f$i@f$ of a column
+ *  concurrently.
+ *
+ *  @see vrna_exp_E_ext_fast_split(), vrna_exp_E_ext_fast()
+ */
+FLT_OR_DBL
+vrna_exp_E_ext_fast_stem(vrna_fold_compound_t       *fc,
+                         int                        i,
+                         int                        j,
+                         struct vrna_mx_pf_aux_el_s *aux_mx);
+
+
+/**
+ *  @brief  Complete the exterior loop decomposition of segment @f$[i,j]@f$
+ *
+ *  This is the second stage of vrna_exp_E_ext_fast() and yields the same result. It
+ *  requires that vrna_exp_E_ext_fast_stem() has been called for all @f$k@f$ with
+ *  @f$i \le k \le j@f$ of the current column @f$j@f$ before.
+ *
+ *  @see vrna_exp_E_ext_fast_stem(), vrna_exp_E_ext_fast()
+ */
+FLT_OR_DBL
+vrna_exp_E_ext_fast_split(vrna_fold_compound_t        *fc,
+                          int                         i,
+                          int                         j,
+                          struct vrna_mx_pf_aux_el_s  *aux_mx);
+
+
 void
 vrna_exp_E_ext_fast_update(vrna_fold_compound_t       *fc,
                            int                        j,
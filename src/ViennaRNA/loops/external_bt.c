@@ -12,6 +12,7 @@
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 #include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/constraints/hard.h"
 #include "ViennaRNA/constraints/soft.h"
@@ -85,6 +86,14 @@ BT_ext_loop_f3_pp_comparative(vrna_fold_compound_t  *fc,
                               int                   maxj);
 
 
+PRIVATE int
+BT_f5_split(vrna_fold_compound_t      *fc,
+            int                       j,
+            int                       e,
+            vrna_callback_hc_evaluate *evaluate,
+            struct default_data       *hc_dat_local);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -301,41 +310,10 @@ BT_ext_loop_f5(vrna_fold_compound_t *fc,
   /* must have found a decomposition */
   switch (dangle_model) {
     case 0:   /* j is paired. Find pairing partner */
-      for (u = jj - turn - 1; u >= 1; u--) {
-        if (with_gquad) {
-          if (fij == my_f5[u - 1] + my_ggg[idx[jj] + u]) {
-            *i  = *j = -1;
-            *k  = u - 1;
-            return vrna_BT_gquad_mfe(fc, u, jj, bp_stack, stack_count);
-          }
-        }
-
-        if (evaluate(1, jj, u - 1, u, VRNA_DECOMP_EXT_EXT_STEM, &hc_dat_local)) {
-          type = vrna_get_ptype(idx[jj] + u, ptype);
-
-          en = my_c[idx[jj] + u];
-          if (sc)
-            if (sc->f)
-              en += sc->f(1, jj, u - 1, u, VRNA_DECOMP_EXT_EXT_STEM, sc->data);
-
-          if (sn[jj] != sn[u])
-            en += P->DuplexInit;
-
-          if (fij == vrna_E_ext_stem(type, -1, -1, P) + en + my_f5[u - 1]) {
-            *i                            = u;
-            *j                            = jj;
-            *k                            = u - 1;
-            bp_stack[++(*stack_count)].i  = u;
-            bp_stack[(*stack_count)].j    = jj;
-            return 1;
-          }
-        }
-      }
-      break;
-
+    /* fall through */
     case 2:
-      mm3 = ((jj < length) && (sn[jj + 1] == sn[jj])) ? S1[jj + 1] : -1;
-      for (u = jj - turn - 1; u >= 1; u--) {
+      u = BT_f5_split(fc, jj, fij, evaluate, &hc_dat_local);
+      if (u > 0) {
         if (with_gquad) {
           if (fij == my_f5[u - 1] + my_ggg[idx[jj] + u]) {
             *i  = *j = -1;
@@ -344,28 +322,14 @@ BT_ext_loop_f5(vrna_fold_compound_t *fc,
           }
         }
 
-        if (evaluate(1, jj, u - 1, u, VRNA_DECOMP_EXT_EXT_STEM, &hc_dat_local)) {
-          mm5   = ((u > 1) && (sn[u] == sn[u - 1])) ? S1[u - 1] : -1;
-          type  = vrna_get_ptype(idx[jj] + u, ptype);
-
-          en = my_c[idx[jj] + u];
-          if (sc)
-            if (sc->f)
-              en += sc->f(1, jj, u - 1, u, VRNA_DECOMP_EXT_EXT_STEM, sc->data);
-
-          if (sn[jj] != sn[u])
-            en += P->DuplexInit;
-
-          if (fij == vrna_E_ext_stem(type, mm5, mm3, P) + en + my_f5[u - 1]) {
-            *i                            = u;
-            *j                            = jj;
-            *k                            = u - 1;
-            bp_stack[++(*stack_count)].i  = u;
-            bp_stack[(*stack_count)].j    = jj;
-            return 1;
-          }
-        }
+        *i                            = u;
+        *j                            = jj;
+        *k                            = u - 1;
+        bp_stack[++(*stack_count)].i  = u;
+        bp_stack[(*stack_count)].j    = jj;
+        return 1;
       }
+
       break;
 
     default:
@@ -763,6 +727,9 @@ BT_ext_loop_f3(vrna_fold_compound_t *fc,
     return 1;
   }
 
+  /* pairs (ii, u) must not exceed the window, e.g. for global banded backtracking */
+  maxdist = MIN2(maxdist, ii + fc->window_size);
+
   /*
    *  must have found a decomposition
    *  i is paired. Find pairing partner
@@ -1076,6 +1043,9 @@ BT_ext_loop_f3_comparative(vrna_fold_compound_t *fc,
     return 1;
   }
 
+  /* pairs (ii, u) must not exceed the window, e.g. for global banded backtracking */
+  maxdist = MIN2(maxdist, ii + fc->window_size);
+
   /*
    *  must have found a decomposition
    *  i is paired. Find pairing partner
@@ -1553,3 +1523,98 @@ BT_ext_loop_f3_pp_comparative(vrna_fold_compound_t  *fc,
 
   return j;
 }
+
+
+/*
+ *  Find the largest u such that f5[j] == e decomposes into f5[u - 1] and
+ *  a stem or G-quadruplex (u, j), i.e. the first hit of a downward scan,
+ *  or 0 if there is none. Only used for dangle models 0 and 2, where the
+ *  contribution of each split point is a single value.
+ */
+PRIVATE int
+BT_f5_split(vrna_fold_compound_t      *fc,
+            int                       j,
+            int                       e,
+            vrna_callback_hc_evaluate *evaluate,
+            struct default_data       *hc_dat_local)
+{
+  char          *ptype;
+  short         mm5, mm3, *S1;
+  unsigned int  *sn, type;
+  int           length, t, u, count, pos, en, turn, dangle_model, with_gquad,
+                *idx, *my_f5, *my_c, *my_ggg, *f5_rev, *stems;
+  vrna_param_t  *P;
+  vrna_sc_t     *sc;
+
+  length        = fc->length;
+  P             = fc->params;
+  sn            = fc->strand_number;
+  sc            = fc->sc;
+  S1            = fc->sequence_encoding;
+  ptype         = fc->ptype;
+  idx           = fc->jindx;
+  my_f5         = fc->matrices->f5;
+  my_c          = fc->matrices->c;
+  my_ggg        = fc->matrices->ggg;
+  turn          = P->model_details.min_loop_size;
+  dangle_model  = P->model_details.dangles;
+  with_gquad    = P->model_details.gquad;
+  count         = j - turn - 1;
+  pos           = -1;
+
+  if (count < 1)
+    return 0;
+
+  mm3 = ((dangle_model == 2) && (j < length) && (sn[j + 1] == sn[j])) ? S1[j + 1] : -1;
+
+  f5_rev  = (int *)vrna_alloc(sizeof(int) * count);
+  stems   = (int *)vrna_alloc(sizeof(int) * count);
+
+  /* store candidates with decreasing u to keep the tie breaking of the downward scan */
+  for (t = 0; t < count; t++) {
+    u         = j - turn - 1 - t;
+    f5_rev[t] = my_f5[u - 1];
+    stems[t]  = INF;
+
+    if ((my_c[idx[j] + u] != INF) &&
+        (evaluate(1, j, u - 1, u, VRNA_DECOMP_EXT_EXT_STEM, hc_dat_local))) {
+      mm5   = ((dangle_model == 2) && (u > 1) && (sn[u] == sn[u - 1])) ? S1[u - 1] : -1;
+      type  = vrna_get_ptype(idx[j] + u, ptype);
+      en    = my_c[idx[j] + u] +
+              vrna_E_ext_stem(type, mm5, mm3, P);
+
+      if (sc)
+        if (sc->f)
+          en += sc->f(1, j, u - 1, u, VRNA_DECOMP_EXT_EXT_STEM, sc->data);
+
+      if (sn[j] != sn[u])
+        en += P->DuplexInit;
+
+      stems[t] = en;
+    }
+
+    if ((with_gquad) && (my_ggg[idx[j] + u] != INF))
+      stems[t] = MIN2(stems[t], my_ggg[idx[j] + u]);
+  }
+
+  en = vrna_fun_zip_add_min_idx(f5_rev, stems, count, &pos);
+
+  if (en < e) {
+    /* not the optimal decomposition, fall back to a linear scan */
+    for (pos = 0; pos < count; pos++)
+      if ((f5_rev[pos] != INF) &&
+          (stems[pos] != INF) &&
+          (f5_rev[pos] + stems[pos] == e))
+        break;
+
+    if (pos == count)
+      pos = -1;
+  } else if (en > e) {
+    pos = -1;
+  }
+
+  free(f5_rev);
+  free(stems);
+
+  return (pos == -1) ? 0 : j - turn - 1 - pos;
+}
@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/external.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -39,6 +40,11 @@ struct vrna_mx_pf_aux_el_s {
   FLT_OR_DBL  **qqu;
 };
 
+/* decomposition stages of exp_E_ext_fast() */
+#define EXT_STAGE_STEM    1U  /* exterior loop parts [i,j] with exactly one stem starting at i */
+#define EXT_STAGE_SPLIT   2U  /* unpaired stretch [i,j] and split into two exterior loop parts */
+#define EXT_STAGE_ALL     (EXT_STAGE_STEM | EXT_STAGE_SPLIT)
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -89,7 +95,8 @@ PRIVATE FLT_OR_DBL
 exp_E_ext_fast(vrna_fold_compound_t       *fc,
                int                        i,
                int                        j,
-               struct vrna_mx_pf_aux_el_s *aux_mx);
+               struct vrna_mx_pf_aux_el_s *aux_mx,
+               unsigned int               stages);
 
 
 /*
@@ -277,13 +284,39 @@ vrna_exp_E_ext_fast(vrna_fold_compound_t        *fc,
       return 0.;
     }
 
-    return exp_E_ext_fast(fc, i, j, aux_mx);
+    return exp_E_ext_fast(fc, i, j, aux_mx, EXT_STAGE_ALL);
   }
 
   return 0.;
 }
 
 
+PUBLIC FLT_OR_DBL
+vrna_exp_E_ext_fast_stem(vrna_fold_compound_t       *fc,
+                         int                        i,
+                         int                        j,
+                         struct vrna_mx_pf_aux_el_s *aux_mx)
+{
+  if ((fc) && (aux_mx))
+    return exp_E_ext_fast(fc, i, j, aux_mx, EXT_STAGE_STEM);
+
+  return 0.;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_exp_E_ext_fast_split(vrna_fold_compound_t        *fc,
+                          int                         i,
+                          int                         j,
+                          struct vrna_mx_pf_aux_el_s  *aux_mx)
+{
+  if ((fc) && (aux_mx))
+    return exp_E_ext_fast(fc, i, j, aux_mx, EXT_STAGE_SPLIT);
+
+  return 0.;
+}
+
+
 PUBLIC void
 vrna_exp_E_ext_fast_update(vrna_fold_compound_t       *fc,
                            int                        j,
@@ -546,11 +579,18 @@ split_ext_fast(vrna_fold_compound_t       *fc,
    *  strands in hard constraints, we have to think of something else...
    */
   if ((evaluate == &hc_default) || (evaluate == &hc_default_window)) {
-    for (k = j; k > i; k--) {
-      qbt += q[ij1] *
-             qqq[k];
-      ij1 -= factor;
-    }
+    /*
+     *  for local structure prediction, q and qqq run in parallel,
+     *  otherwise q is stored in opposite direction
+     */
+    if (factor == 1)
+      qbt = vrna_fun_zip_mult_sum(q + i,
+                                  qqq + i + 1,
+                                  j - i);
+    else
+      qbt = vrna_fun_zip_mult_sum_rev(qqq + i + 1,
+                                      q - (j - 1),
+                                      j - i);
   } else {
     for (k = j; k > i; k--)
       if (evaluate(i, j, k - 1, k, VRNA_DECOMP_EXT_EXT_EXT, hc_dat_local)) {
@@ -583,7 +623,8 @@ PRIVATE FLT_OR_DBL
 exp_E_ext_fast(vrna_fold_compound_t       *fc,
                int                        i,
                int                        j,
-               struct vrna_mx_pf_aux_el_s *aux_mx)
+               struct vrna_mx_pf_aux_el_s *aux_mx,
+               unsigned int               stages)
 {
   int                       *iidx, ij, with_ud, with_gquad;
   FLT_OR_DBL                qbt1, *qq, **qqu, *G, **G_local;
@@ -609,29 +650,38 @@ exp_E_ext_fast(vrna_fold_compound_t       *fc,
 
   init_sc_wrapper_ext(fc, &sc_wrapper);
 
-  qbt1 = 0.;
+  if (stages & EXT_STAGE_STEM) {
+    qbt1 = 0.;
+
+    /* all exterior loop parts [i, j] with exactly one stem (i, u) i < u < j */
+    qbt1 += reduce_ext_ext_fast(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
+    /* exterior loop part with stem (i, j) */
+    qbt1 += reduce_ext_stem_fast(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
+
+    if (with_gquad) {
+      if (fc->hc->type == VRNA_HC_WINDOW) {
+        G_local = fc->exp_matrices->G_local;
+        qbt1    += G_local[i][j];
+      } else {
+        G     = fc->exp_matrices->G;
+        iidx  = fc->iindx;
+        ij    = iidx[i] - j;
+        qbt1  += G[ij];
+      }
+    }
 
-  /* all exterior loop parts [i, j] with exactly one stem (i, u) i < u < j */
-  qbt1 += reduce_ext_ext_fast(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
-  /* exterior loop part with stem (i, j) */
-  qbt1 += reduce_ext_stem_fast(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
+    qq[i] = qbt1;
 
-  if (with_gquad) {
-    if (fc->hc->type == VRNA_HC_WINDOW) {
-      G_local = fc->exp_matrices->G_local;
-      qbt1    += G_local[i][j];
-    } else {
-      G     = fc->exp_matrices->G;
-      iidx  = fc->iindx;
-      ij    = iidx[i] - j;
-      qbt1  += G[ij];
-    }
+    if (with_ud)
+      qqu[0][i] = qbt1;
   }
 
-  qq[i] = qbt1;
+  qbt1 = qq[i];
 
-  if (with_ud)
-    qqu[0][i] = qbt1;
+  if (!(stages & EXT_STAGE_SPLIT)) {
+    free_sc_wrapper_ext(&sc_wrapper);
+    return qbt1;
+  }
 
   /* the entire stretch [i,j] is unpaired */
   qbt1 += reduce_ext_up_fast(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
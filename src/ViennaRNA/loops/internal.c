@@ -28,6 +28,43 @@
 #include "internal_hc.inc"
 #include "internal_sc.inc"
 
+/*
+ *  Number of rows of the rolling window, i.e. all enclosed pairs (k,l) of
+ *  an interior loop closed by (i,j) satisfy i < k <= i + IL_WINDOW_ROWS
+ */
+#define IL_WINDOW_ROWS  (MAXLOOP + 2)
+
+struct vrna_mx_mfe_aux_il_s;
+
+typedef int (il_window_decomposition)(vrna_fold_compound_t        *fc,
+                                      int                         i,
+                                      int                         j,
+                                      struct vrna_mx_mfe_aux_il_s *aux);
+
+struct vrna_mx_mfe_aux_il_s {
+  int                     *c;         /* two consecutive copies of the last IL_WINDOW_ROWS rows of c for each column l */
+  unsigned char           *type;      /* reversed type of pair (k,l), or 0 if it must not be enclosed by an interior loop */
+  il_window_decomposition *decompose; /* decomposition variant specialized for the constraints in use */
+};
+
+/* generic variant for arbitrary hard and soft constraints */
+#define IL_WINDOW_FN      E_internal_loop_window
+#define IL_WINDOW_HC_USER 1
+#define IL_WINDOW_SC      1
+#include "internal_window.inc"
+
+/* default hard constraints only, no soft constraints */
+#define IL_WINDOW_FN      E_internal_loop_window_default
+#define IL_WINDOW_HC_USER 0
+#define IL_WINDOW_SC      0
+#include "internal_window.inc"
+
+/* default hard constraints and soft constraints without callback, e.g. SHAPE data */
+#define IL_WINDOW_FN      E_internal_loop_window_sc_arrays
+#define IL_WINDOW_HC_USER 0
+#define IL_WINDOW_SC      2
+#include "internal_window.inc"
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -89,6 +126,95 @@ vrna_E_int_loop(vrna_fold_compound_t  *fc,
 }
 
 
+PUBLIC struct vrna_mx_mfe_aux_il_s *
+vrna_E_int_loop_fast_init(vrna_fold_compound_t *fc)
+{
+  struct vrna_mx_mfe_aux_il_s *aux = NULL;
+
+  if ((fc) &&
+      (fc->type == VRNA_FC_TYPE_SINGLE) &&
+      (fc->hc->type != VRNA_HC_WINDOW)) {
+    size_t size = (size_t)(fc->length + 1) * 2 * IL_WINDOW_ROWS;
+
+    aux       = (struct vrna_mx_mfe_aux_il_s *)vrna_alloc(sizeof(struct vrna_mx_mfe_aux_il_s));
+    aux->c    = (int *)vrna_alloc(sizeof(int) * size);
+    aux->type = (unsigned char *)vrna_alloc(sizeof(unsigned char) * size);
+
+    /* select the decomposition variant once for the entire fill */
+    if (fc->hc->f)
+      aux->decompose = &E_internal_loop_window;
+    else if (!fc->sc)
+      aux->decompose = &E_internal_loop_window_default;
+    else if (!fc->sc->f)
+      aux->decompose = &E_internal_loop_window_sc_arrays;
+    else
+      aux->decompose = &E_internal_loop_window;
+  }
+
+  return aux;
+}
+
+
+PUBLIC void
+vrna_E_int_loop_fast_update(vrna_fold_compound_t        *fc,
+                            int                         i,
+                            struct vrna_mx_mfe_aux_il_s *aux)
+{
+  unsigned char *hc_mx;
+  char          *ptype;
+  int           l, n, kl, s, *c, *idx, *rtype, *cw;
+  unsigned char t, *tw;
+
+  if ((fc) && (aux)) {
+    n     = (int)fc->length;
+    idx   = fc->jindx;
+    c     = fc->matrices->c;
+    hc_mx = fc->hc->matrix;
+    ptype = fc->ptype;
+    rtype = &(fc->params->model_details.rtype[0]);
+    s     = i % IL_WINDOW_ROWS;
+
+    for (l = i + 1; l <= n; l++) {
+      kl  = idx[l] + i;
+      cw  = aux->c + (size_t)l * 2 * IL_WINDOW_ROWS + s;
+      tw  = aux->type + (size_t)l * 2 * IL_WINDOW_ROWS + s;
+      t   = (hc_mx[kl] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) ?
+            (unsigned char)rtype[vrna_get_ptype(kl, ptype)] :
+            0;
+
+      cw[0] = cw[IL_WINDOW_ROWS] = c[kl];
+      tw[0] = tw[IL_WINDOW_ROWS] = t;
+    }
+  }
+}
+
+
+PUBLIC void
+vrna_E_int_loop_fast_free(struct vrna_mx_mfe_aux_il_s *aux)
+{
+  if (aux) {
+    free(aux->c);
+    free(aux->type);
+    free(aux);
+  }
+}
+
+
+PUBLIC int
+vrna_E_int_loop_fast(vrna_fold_compound_t         *fc,
+                     int                          i,
+                     int                          j,
+                     struct vrna_mx_mfe_aux_il_s  *aux)
+{
+  int e = INF;
+
+  if (fc)
+    e = (aux) ? aux->decompose(fc, i, j, aux) : E_internal_loop(fc, i, j);
+
+  return e;
+}
+
+
 PUBLIC int
 vrna_E_ext_int_loop(vrna_fold_compound_t  *fc,
                     int                   i,
@@ -365,7 +491,7 @@ E_internal_loop(vrna_fold_compound_t  *fc,
   unsigned char         sliding_window, hc_decompose, *hc_mx, **hc_mx_local;
   char                  *ptype, **ptype_local;
   short                 *S, **SS, **S5, **S3;
-  unsigned int          *sn, *ss, **a2s, n_seq, s, n;
+  unsigned int          *sn, *ss, **a2s, n_seq, s;
   int                   e, eee, *idx, ij, *c, *ggg, *rtype, with_ud, with_gquad, noclose,
                         *hc_up, **c_local, **ggg_local;
   vrna_param_t          *P;
@@ -380,14 +506,13 @@ E_internal_loop(vrna_fold_compound_t  *fc,
 
   e = INF;
 
-  n               = fc->length;
   sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
   sn              = fc->strand_number;
   ss              = fc->strand_start;
   n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   idx             = fc->jindx;
   ij              = (sliding_window) ? 0 : idx[j] + i;
-  hc_mx           = (sliding_window) ? NULL : fc->hc->mx;
+  hc_mx           = (sliding_window) ? NULL : fc->hc->matrix;
   hc_mx_local     = (sliding_window) ? fc->hc->matrix_local : NULL;
   hc_up           = fc->hc->up_int;
   ptype           = (fc->type == VRNA_FC_TYPE_SINGLE) ? (sliding_window ? NULL : fc->ptype) : NULL;
@@ -409,7 +534,7 @@ E_internal_loop(vrna_fold_compound_t  *fc,
   with_ud     = ((domains_up) && (domains_up->energy_cb)) ? 1 : 0;
   with_gquad  = md->gquad;
 
-  hc_decompose = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[n * i + j];
+  hc_decompose = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[ij];
 
   if (hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
     unsigned int  type, type2, has_nick, *tt;
@@ -439,7 +564,7 @@ E_internal_loop(vrna_fold_compound_t  *fc,
     l = j - 1;
     if (k < l) {
       kl            = (sliding_window) ? 0 : idx[l] + k;
-      hc_decompose  = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[n * k + l];
+      hc_decompose  = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[kl];
 
       if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
           (evaluate(i, j, k, l, &hc_dat_local))) {
@@ -506,10 +631,8 @@ E_internal_loop(vrna_fold_compound_t  *fc,
         k   = i + 2;
         kl  = (sliding_window) ? 0 : idx[l] + k;
 
-        hc_mx += n * l;
-
         for (; k <= last_k; k++, u1++, kl++) {
-          hc_decompose = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[k];
+          hc_decompose = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[kl];
 
           if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
               (evaluate(i, j, k, l, &hc_dat_local))) {
@@ -567,8 +690,6 @@ E_internal_loop(vrna_fold_compound_t  *fc,
             }
           }
         }
-
-        hc_mx -= n * l;
       }
 
       /* handle bulges in 3' side */
@@ -578,15 +699,13 @@ E_internal_loop(vrna_fold_compound_t  *fc,
         if (first_l < j - 1 - MAXLOOP)
           first_l = j - 1 - MAXLOOP;
 
-        u2    = 1;
-        hc_mx += n * k;
-
+        u2 = 1;
         for (l = j - 2; l >= first_l; l--, u2++) {
           if (u2 > hc_up[l + 1])
             break;
 
           kl            = (sliding_window) ? 0 : idx[l] + k;
-          hc_decompose  = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[l];
+          hc_decompose  = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[kl];
 
           if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
               (evaluate(i, j, k, l, &hc_dat_local))) {
@@ -644,8 +763,6 @@ E_internal_loop(vrna_fold_compound_t  *fc,
             }
           }
         }
-
-        hc_mx -= n * k;
       }
 
       /* last but not least, all other internal loops */
@@ -670,10 +787,8 @@ E_internal_loop(vrna_fold_compound_t  *fc,
         k   = i + 2;
         kl  = (sliding_window) ? 0 : idx[l] + k;
 
-        hc_mx += n * l;
-
         for (; k <= last_k; k++, u1++, kl++) {
-          hc_decompose = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[k];
+          hc_decompose = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[kl];
 
           if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
               (evaluate(i, j, k, l, &hc_dat_local))) {
@@ -748,8 +863,6 @@ E_internal_loop(vrna_fold_compound_t  *fc,
             }
           }
         }
-
-        hc_mx -= n * l;
       }
 
       if (with_gquad) {
@@ -829,7 +942,7 @@ E_ext_internal_loop(vrna_fold_compound_t  *fc,
   SS    = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S;
   indx  = fc->jindx;
   c     = fc->matrices->c;
-  hc    = fc->hc->mx;
+  hc    = fc->hc->matrix;
   hc_up = fc->hc->up_int;
   P     = fc->params;
   md    = &(P->model_details);
@@ -841,7 +954,7 @@ E_ext_internal_loop(vrna_fold_compound_t  *fc,
   evaluate = prepare_hc_default(fc, &hc_dat_local);
 
   /* CONSTRAINED INTERIOR LOOP start */
-  if (hc[n * i + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+  if (hc[indx[j] + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
     /* prepare necessary variables */
     if (fc->type == VRNA_FC_TYPE_COMPARATIVE) {
       tt = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
@@ -872,7 +985,7 @@ E_ext_internal_loop(vrna_fold_compound_t  *fc,
 
         int pq = indx[q] + p;
 
-        eval_loop = hc[n * p + q] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP;
+        eval_loop = hc[pq] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP;
 
         if (eval_loop && evaluate(i, j, p, q, &hc_dat_local)) {
           energy = c[pq];
@@ -907,7 +1020,7 @@ E_stack(vrna_fold_compound_t  *fc,
                         *hc_mx, **hc_mx_local, eval_loop;
   char                  *ptype, **ptype_local;
   short                 *S, **SS;
-  unsigned int          n, *sn, *ss, type, type_2;
+  unsigned int          *sn, *ss, type, type_2;
   int                   e, ij, pq, p, q, s, n_seq, *rtype, *indx;
   vrna_param_t          *P;
   vrna_md_t             *md;
@@ -917,7 +1030,6 @@ E_stack(vrna_fold_compound_t  *fc,
 
   e               = INF;
   sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
-  n               = fc->length;
   p               = i + 1;
   q               = j - 1;
   n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
@@ -935,7 +1047,7 @@ E_stack(vrna_fold_compound_t  *fc,
   md          = &(P->model_details);
   rtype       = &(md->rtype[0]);
   indx        = (sliding_window) ? NULL : fc->jindx;
-  hc_mx       = (sliding_window) ? NULL : fc->hc->mx;
+  hc_mx       = (sliding_window) ? NULL : fc->hc->matrix;
   hc_mx_local = (sliding_window) ? fc->hc->matrix_local : NULL;
   ij          = (sliding_window) ? 0 : indx[j] + i;
   pq          = (sliding_window) ? 0 : indx[q] + p;
@@ -943,8 +1055,8 @@ E_stack(vrna_fold_compound_t  *fc,
 
   init_sc_wrapper(fc, &sc_wrapper);
 
-  hc_decompose_ij = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[n * i + j];
-  hc_decompose_pq = (sliding_window) ? hc_mx_local[p][q - p] : hc_mx[n * p + q];
+  hc_decompose_ij = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[ij];
+  hc_decompose_pq = (sliding_window) ? hc_mx_local[p][q - p] : hc_mx[pq];
 
   eval_loop = (hc_decompose_ij & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
               (hc_decompose_pq & VRNA_CONSTRAINT_CONTEXT_INT_LOOP);
@@ -53,6 +53,57 @@ vrna_E_int_loop(vrna_fold_compound_t  *fc,
                 int                   j);
 
 
+/**
+ *  @brief  Auxiliary helper arrays for fast interior loop computations
+ *
+ *  @see vrna_E_int_loop_fast_init(), vrna_E_int_loop_fast_update(),
+ *  vrna_E_int_loop_fast_free(), vrna_E_int_loop_fast()
+ */
+typedef struct vrna_mx_mfe_aux_il_s *vrna_mx_mfe_aux_il_t;
+
+
+/**
+ *  @brief  Initialize a rolling window of the pair matrix for fast interior loop computations
+ *
+ *  The window keeps the last @f$MAXLOOP + 2@f$ rows of the pair matrix in contiguous
+ *  memory, for each column together with the (reversed) pair type and the hard
+ *  constraints for enclosed pairs of interior loops. It is only available for single
+ *  sequences without sliding window. Otherwise, this function returns @em NULL.
+ *
+ *  @see vrna_E_int_loop_fast_update(), vrna_E_int_loop_fast(), vrna_E_int_loop_fast_free()
+ */
+vrna_mx_mfe_aux_il_t
+vrna_E_int_loop_fast_init(vrna_fold_compound_t *fc);
+
+
+/**
+ *  @brief  Add a row of the pair matrix to the rolling window
+ *
+ *  Row @f$i@f$ must be added after all its entries have been computed and before any
+ *  pair @f$(i - 1,j)@f$ is decomposed with vrna_E_int_loop_fast().
+ */
+void
+vrna_E_int_loop_fast_update(vrna_fold_compound_t  *fc,
+                            int                   i,
+                            vrna_mx_mfe_aux_il_t  aux);
+
+
+void
+vrna_E_int_loop_fast_free(vrna_mx_mfe_aux_il_t aux);
+
+
+/**
+ *  @brief  Evaluate all interior loops closed by @f$(i,j)@f$ using the rolling window
+ *
+ *  Same as vrna_E_int_loop(), which is also used as fall-back if @p aux is @em NULL.
+ */
+int
+vrna_E_int_loop_fast(vrna_fold_compound_t *fc,
+                     int                  i,
+                     int                  j,
+                     vrna_mx_mfe_aux_il_t aux);
+
+
 /**
  *  @brief Evaluate the free energy contribution of an interior loop with delimiting
  *  base pairs @f$(i,j)@f$ and @f$(k,l)@f$
@@ -99,6 +150,58 @@ vrna_exp_E_int_loop(vrna_fold_compound_t  *fc,
                     int                   j);
 
 
+/**
+ *  @brief  Auxiliary helper arrays for fast interior loop computations (Boltzmann factor version)
+ *
+ *  @see vrna_exp_E_int_loop_fast_init(), vrna_exp_E_int_loop_fast_update(),
+ *  vrna_exp_E_int_loop_fast_free(), vrna_exp_E_int_loop_fast()
+ */
+typedef struct vrna_mx_pf_aux_il_s *vrna_mx_pf_aux_il_t;
+
+
+/**
+ *  @brief  Initialize a rolling window of the pair matrix for fast interior loop computations
+ *
+ *  This is the partition function counterpart of vrna_E_int_loop_fast_init(). Here, the
+ *  window keeps the last @f$MAXLOOP + 2@f$ columns of @f$Q^B@f$, since the partition
+ *  function matrices are filled column-wise. Returns @em NULL for alignments and sliding
+ *  window computations.
+ *
+ *  @see vrna_exp_E_int_loop_fast_update(), vrna_exp_E_int_loop_fast(),
+ *  vrna_exp_E_int_loop_fast_free()
+ */
+vrna_mx_pf_aux_il_t
+vrna_exp_E_int_loop_fast_init(vrna_fold_compound_t *fc);
+
+
+/**
+ *  @brief  Add a column of the pair matrix to the rolling window
+ *
+ *  Column @f$j@f$ must be added after all its entries have been computed and before any
+ *  pair @f$(i,j + 1)@f$ is decomposed with vrna_exp_E_int_loop_fast().
+ */
+void
+vrna_exp_E_int_loop_fast_update(vrna_fold_compound_t  *fc,
+                                int                   j,
+                                vrna_mx_pf_aux_il_t   aux);
+
+
+void
+vrna_exp_E_int_loop_fast_free(vrna_mx_pf_aux_il_t aux);
+
+
+/**
+ *  @brief  Compute the Boltzmann weighted interior loops closed by @f$(i,j)@f$ using the rolling window
+ *
+ *  Same as vrna_exp_E_int_loop(), which is also used as fall-back if @p aux is @em NULL.
+ */
+FLT_OR_DBL
+vrna_exp_E_int_loop_fast(vrna_fold_compound_t *fc,
+                         int                  i,
+                         int                  j,
+                         vrna_mx_pf_aux_il_t  aux);
+
+
 FLT_OR_DBL
 vrna_exp_E_interior_loop(vrna_fold_compound_t *fc,
                          int                  i,
@@ -28,6 +28,43 @@
 #include "internal_hc.inc"
 #include "internal_sc_pf.inc"
 
+/*
+ *  Number of columns of the rolling window, i.e. all enclosed pairs (k,l) of
+ *  an interior loop closed by (i,j) satisfy j - IL_WINDOW_COLUMNS < l < j
+ */
+#define IL_WINDOW_COLUMNS (MAXLOOP + 2)
+
+struct vrna_mx_pf_aux_il_s;
+
+typedef FLT_OR_DBL (il_window_decomposition)(vrna_fold_compound_t       *fc,
+                                             int                        i,
+                                             int                        j,
+                                             struct vrna_mx_pf_aux_il_s *aux);
+
+struct vrna_mx_pf_aux_il_s {
+  FLT_OR_DBL              *qb;        /* two consecutive copies of the last IL_WINDOW_COLUMNS columns of qb for each row k */
+  unsigned char           *type;      /* reversed type of pair (k,l), or 0 if it must not be enclosed by an interior loop */
+  il_window_decomposition *decompose; /* decomposition variant specialized for the constraints in use */
+};
+
+/* generic variant for arbitrary hard and soft constraints */
+#define IL_WINDOW_FN      exp_E_int_loop_window
+#define IL_WINDOW_HC_USER 1
+#define IL_WINDOW_SC      1
+#include "internal_window_pf.inc"
+
+/* default hard constraints only, no soft constraints */
+#define IL_WINDOW_FN      exp_E_int_loop_window_default
+#define IL_WINDOW_HC_USER 0
+#define IL_WINDOW_SC      0
+#include "internal_window_pf.inc"
+
+/* default hard constraints and soft constraints without callback, e.g. SHAPE data */
+#define IL_WINDOW_FN      exp_E_int_loop_window_sc_arrays
+#define IL_WINDOW_HC_USER 0
+#define IL_WINDOW_SC      2
+#include "internal_window_pf.inc"
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -86,6 +123,95 @@ vrna_exp_E_int_loop(vrna_fold_compound_t  *fc,
 }
 
 
+PUBLIC struct vrna_mx_pf_aux_il_s *
+vrna_exp_E_int_loop_fast_init(vrna_fold_compound_t *fc)
+{
+  struct vrna_mx_pf_aux_il_s *aux = NULL;
+
+  if ((fc) &&
+      (fc->type == VRNA_FC_TYPE_SINGLE) &&
+      (fc->hc->type != VRNA_HC_WINDOW)) {
+    size_t size = (size_t)(fc->length + 1) * 2 * IL_WINDOW_COLUMNS;
+
+    aux       = (struct vrna_mx_pf_aux_il_s *)vrna_alloc(sizeof(struct vrna_mx_pf_aux_il_s));
+    aux->qb   = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+    aux->type = (unsigned char *)vrna_alloc(sizeof(unsigned char) * size);
+
+    /* select the decomposition variant once for the entire fill */
+    if (fc->hc->f)
+      aux->decompose = &exp_E_int_loop_window;
+    else if (!fc->sc)
+      aux->decompose = &exp_E_int_loop_window_default;
+    else if (!fc->sc->exp_f)
+      aux->decompose = &exp_E_int_loop_window_sc_arrays;
+    else
+      aux->decompose = &exp_E_int_loop_window;
+  }
+
+  return aux;
+}
+
+
+PUBLIC void
+vrna_exp_E_int_loop_fast_update(vrna_fold_compound_t        *fc,
+                                int                         j,
+                                struct vrna_mx_pf_aux_il_s  *aux)
+{
+  unsigned char *hc_mx, t, *tw;
+  char          *ptype;
+  int           k, kl, s, *my_iindx, *jindx, *rtype;
+  FLT_OR_DBL    *qb, *qw;
+
+  if ((fc) && (aux)) {
+    my_iindx  = fc->iindx;
+    jindx     = fc->jindx;
+    qb        = fc->exp_matrices->qb;
+    hc_mx     = fc->hc->matrix;
+    ptype     = fc->ptype;
+    rtype     = &(fc->exp_params->model_details.rtype[0]);
+    s         = j % IL_WINDOW_COLUMNS;
+
+    for (k = 1; k < j; k++) {
+      kl  = jindx[j] + k;
+      qw  = aux->qb + (size_t)k * 2 * IL_WINDOW_COLUMNS + s;
+      tw  = aux->type + (size_t)k * 2 * IL_WINDOW_COLUMNS + s;
+      t   = (hc_mx[kl] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) ?
+            (unsigned char)rtype[vrna_get_ptype(kl, ptype)] :
+            0;
+
+      qw[0] = qw[IL_WINDOW_COLUMNS] = qb[my_iindx[k] - j];
+      tw[0] = tw[IL_WINDOW_COLUMNS] = t;
+    }
+  }
+}
+
+
+PUBLIC void
+vrna_exp_E_int_loop_fast_free(struct vrna_mx_pf_aux_il_s *aux)
+{
+  if (aux) {
+    free(aux->qb);
+    free(aux->type);
+    free(aux);
+  }
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_exp_E_int_loop_fast(vrna_fold_compound_t       *fc,
+                         int                        i,
+                         int                        j,
+                         struct vrna_mx_pf_aux_il_s *aux)
+{
+  FLT_OR_DBL q = 0.;
+
+  if ((fc) && (i > 0) && (j > i))
+    q = (aux) ? aux->decompose(fc, i, j, aux) : exp_E_int_loop(fc, i, j);
+
+  return q;
+}
+
+
 PUBLIC FLT_OR_DBL
 vrna_exp_E_interior_loop(vrna_fold_compound_t *fc,
                          int                  i,
@@ -109,7 +235,7 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
   char                      *ptype, **ptype_local;
   unsigned char             *hc_mx, **hc_mx_local;
   short                     *S1, **SS, **S5, **S3;
-  unsigned int              *sn, *se, *ss, n_seq, s, **a2s, n;
+  unsigned int              *sn, *se, *ss, n_seq, s, **a2s;
   int                       *rtype, noclose, *my_iindx, *jindx, *hc_up, ij,
                             with_gquad, with_ud;
   FLT_OR_DBL                qbt1, q_temp, *qb, **qb_local, *G, *scale;
@@ -121,7 +247,6 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
   struct sc_wrapper_exp_int sc_wrapper;
 
   sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
-  n               = fc->length;
   n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   sn              = fc->strand_number;
   se              = fc->strand_end;
@@ -140,7 +265,7 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
   scale       = fc->exp_matrices->scale;
   my_iindx    = fc->iindx;
   jindx       = fc->jindx;
-  hc_mx       = (sliding_window) ? NULL : fc->hc->mx;
+  hc_mx       = (sliding_window) ? NULL : fc->hc->matrix;
   hc_mx_local = (sliding_window) ? fc->hc->matrix_local : NULL;
   hc_up       = fc->hc->up_int;
   pf_params   = fc->exp_params;
@@ -156,7 +281,7 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
 
   ij = (sliding_window) ? 0 : jindx[j] + i;
 
-  hc_decompose_ij = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[n * i + j];
+  hc_decompose_ij = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[ij];
 
   /* CONSTRAINED INTERIOR LOOP start */
   if (hc_decompose_ij & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
@@ -186,7 +311,7 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
     l = j - 1;
     if ((k < l) && (sn[i] == sn[k]) && (sn[l] == sn[j])) {
       kl              = (sliding_window) ? 0 : jindx[l] + k;
-      hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[n * k + l];
+      hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[kl];
 
       if ((hc_decompose_kl & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
           (evaluate(i, j, k, l, &hc_dat_local))) {
@@ -255,10 +380,9 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
 
         k     = i + 2;
         kl    = (sliding_window) ? 0 : jindx[l] + k;
-        hc_mx += n * l;
 
         for (; k <= last_k; k++, u1++, kl++) {
-          hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[k];
+          hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[kl];
 
           if ((hc_decompose_kl & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
               (evaluate(i, j, k, l, &hc_dat_local))) {
@@ -318,8 +442,6 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
             }
           }
         }
-
-        hc_mx -= n * l;
       }
 
       /* handle bulges in 3' side */
@@ -332,15 +454,13 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
         if (first_l < ss[sn[j]])
           first_l = ss[sn[j]];
 
-        u2    = 1;
-        hc_mx += n * k;
-
+        u2 = 1;
         for (l = j - 2; l >= first_l; l--, u2++) {
           if (u2 > hc_up[l + 1])
             break;
 
           kl              = (sliding_window) ? 0 : jindx[l] + k;
-          hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[l];
+          hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[kl];
 
           if ((hc_decompose_kl & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
               (evaluate(i, j, k, l, &hc_dat_local))) {
@@ -400,8 +520,6 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
             }
           }
         }
-
-        hc_mx -= n * k;
       }
 
       /* last but not least, all other internal loops */
@@ -429,14 +547,12 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
 
         u2 = 1;
 
-        hc_mx += n * k;
-
         for (l = j - 2; l >= first_l; l--, u2++) {
           if (hc_up[l + 1] < u2)
             break;
 
           kl              = (sliding_window) ? 0 : jindx[l] + k;
-          hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[l];
+          hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[kl];
 
           if ((hc_decompose_kl & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
               (evaluate(i, j, k, l, &hc_dat_local))) {
@@ -513,8 +629,6 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
             }
           }
         }
-
-        hc_mx -= n * k;
       }
 
       if ((with_gquad) && (!noclose)) {
@@ -566,7 +680,7 @@ exp_E_ext_int_loop(vrna_fold_compound_t *fc,
   short                     *S, *S2, **SS, **S5, **S3;
   unsigned int              *tt, n_seq, s, **a2s, type, type2;
   int                       k, l, u1, u2, u3, qmin, with_ud,
-                            n, *my_iindx, *hc_up, turn,
+                            n, *my_iindx, *jindx, *hc_up, turn,
                             u1_local, u2_local, u3_local;
   FLT_OR_DBL                q, q_temp, *qb, *scale;
   vrna_exp_param_t          *pf_params;
@@ -585,9 +699,10 @@ exp_E_ext_int_loop(vrna_fold_compound_t *fc,
   S3          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
   a2s         = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->a2s;
   my_iindx    = fc->iindx;
+  jindx       = fc->jindx;
   qb          = fc->exp_matrices->qb;
   scale       = fc->exp_matrices->scale;
-  hc_mx       = fc->hc->mx;
+  hc_mx       = fc->hc->matrix;
   hc_up       = fc->hc->up_int;
   pf_params   = fc->exp_params;
   md          = &(pf_params->model_details);
@@ -604,7 +719,7 @@ exp_E_ext_int_loop(vrna_fold_compound_t *fc,
   init_sc_wrapper_int(fc, &sc_wrapper);
 
   /* CONSTRAINED INTERIOR LOOP start */
-  if (hc_mx[n * i + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+  if (hc_mx[jindx[j] + i] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
     /* prepare necessary variables */
     if (fc->type == VRNA_FC_TYPE_SINGLE) {
       type = vrna_get_ptype_md(S2[j], S2[i], md);
@@ -636,7 +751,7 @@ exp_E_ext_int_loop(vrna_fold_compound_t *fc,
         if (u1 + u2 + u3 > MAXLOOP)
           continue;
 
-        eval_loop = hc_mx[n * k + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP;
+        eval_loop = hc_mx[jindx[l] + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP;
 
         if (eval_loop && evaluate(i, j, k, l, &hc_dat_local)) {
           q_temp = qb[my_iindx[k] - l];
@@ -739,7 +854,7 @@ exp_E_interior_loop(vrna_fold_compound_t  *fc,
   char                      *ptype, **ptype_local;
   unsigned char             *hc_mx, **hc_mx_local, eval_loop, hc_decompose_ij, hc_decompose_kl;
   short                     *S1, **SS, **S5, **S3;
-  unsigned int              n, *sn, n_seq, s, **a2s;
+  unsigned int              *sn, n_seq, s, **a2s;
   int                       u1, u2, *rtype, *jindx, *hc_up;
   FLT_OR_DBL                qbt1, q_temp, *scale;
   vrna_exp_param_t          *pf_params;
@@ -750,7 +865,6 @@ exp_E_interior_loop(vrna_fold_compound_t  *fc,
   struct sc_wrapper_exp_int sc_wrapper;
 
   sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
-  n               = fc->length;
   n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   ptype           = (fc->type == VRNA_FC_TYPE_SINGLE) ? (sliding_window ? NULL : fc->ptype) : NULL;
   ptype_local     =
@@ -761,7 +875,7 @@ exp_E_interior_loop(vrna_fold_compound_t  *fc,
   S3          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
   a2s         = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->a2s;
   jindx       = fc->jindx;
-  hc_mx       = (sliding_window) ? NULL : fc->hc->mx;
+  hc_mx       = (sliding_window) ? NULL : fc->hc->matrix;
   hc_mx_local = (sliding_window) ? fc->hc->matrix_local : NULL;
   hc_up       = fc->hc->up_int;
   pf_params   = fc->exp_params;
@@ -787,8 +901,8 @@ exp_E_interior_loop(vrna_fold_compound_t  *fc,
 
   init_sc_wrapper_int(fc, &sc_wrapper);
 
-  hc_decompose_ij = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[n * i + j];
-  hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[n * k + l];
+  hc_decompose_ij = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[jindx[j] + i];
+  hc_decompose_kl = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[jindx[l] + k];
   eval_loop       = ((hc_decompose_ij & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) &&
                      (hc_decompose_kl & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC)) ?
                     1 : 0;
@@ -132,6 +132,39 @@ vrna_exp_E_ml_fast(vrna_fold_compound_t *fc,
                    vrna_mx_pf_aux_ml_t  aux_mx);
 
 
+/**
+ *  @brief  Compute the multibranch loop parts of segment @f$[i,j]@f$ with exactly one stem starting at @f$i@f$
+ *
+ *  This is the first stage of vrna_exp_E_ml_fast(). The result is stored in the helper
+ *  array of the current column @f$j@f$ (see vrna_exp_E_ml_fast_qqm()) and only depends on
+ *  previous columns and the pair matrix entries of column @f$j@f$. Thus, it may be called
+ *  for all @f$i@f$ of a column concurrently.
+ *
+ *  @see vrna_exp_E_ml_fast_split(), vrna_exp_E_ml_fast()
+ */
+FLT_OR_DBL
+vrna_exp_E_ml_fast_stem(vrna_fold_compound_t  *fc,
+                        int                   i,
+                        int                   j,
+                        vrna_mx_pf_aux_ml_t   aux_mx);
+
+
+/**
+ *  @brief  Complete the multibranch loop decomposition of segment @f$[i,j]@f$
+ *
+ *  This is the second stage of vrna_exp_E_ml_fast() and yields the same result. It
+ *  requires that vrna_exp_E_ml_fast_stem() has been called for all @f$k@f$ with
+ *  @f$i \le k \le j@f$ of the current column @f$j@f$ before.
+ *
+ *  @see vrna_exp_E_ml_fast_stem(), vrna_exp_E_ml_fast()
+ */
+FLT_OR_DBL
+vrna_exp_E_ml_fast_split(vrna_fold_compound_t *fc,
+                         int                  i,
+                         int                  j,
+                         vrna_mx_pf_aux_ml_t  aux_mx);
+
+
 /* End partition function interface */
 /**@}*/
 
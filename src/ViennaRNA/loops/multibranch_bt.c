@@ -9,6 +9,7 @@
 #include <ctype.h>
 #include <string.h>
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/params/default.h"
@@ -56,6 +57,16 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
                  int                  *stack_count);
 
 
+PRIVATE int
+BT_ml_split(vrna_fold_compound_t      *fc,
+            int                       i,
+            int                       j,
+            int                       e,
+            vrna_callback_hc_evaluate *evaluate,
+            struct default_data       *hc_dat_local,
+            struct sc_wrapper_ml      *sc_wrapper);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -926,26 +937,13 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
   }
 
   /* 2. Test for possible split point */
-  for (u = ii + 1 + turn; u <= jj - 2 - turn; u++) {
-    if (evaluate(ii, jj, u, u + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
-      if (sliding_window)
-        en = fML_local[ii][u - ii] +
-             fML_local[u + 1][jj - (u + 1)];
-      else
-        en = my_fML[idx[u] + ii] +
-             my_fML[idx[jj] + u + 1];
-
-      if (sc_wrapper.decomp_ml)
-        en += sc_wrapper.decomp_ml(ii, jj, u, u + 1, &sc_wrapper);
-
-      if (fij == en) {
-        *i  = ii;
-        *j  = u;
-        *k  = u + 1;
-        *l  = jj;
-        return 1;
-      }
-    }
+  u = BT_ml_split(fc, ii, jj, fij, evaluate, &hc_dat_local, &sc_wrapper);
+  if (u != -1) {
+    *i  = ii;
+    *j  = u;
+    *k  = u + 1;
+    *l  = jj;
+    return 1;
   }
 
   /* 3. last chance! Maybe coax stack */
@@ -1015,7 +1013,7 @@ BT_mb_loop(vrna_fold_compound_t *fc,
   char                      *ptype, **ptype_local;
   short                     s5, s3, *S1, **SS, **S5, **S3;
   unsigned int              *sn, *se, n_seq, s, *tt;
-  int                       ij, p, q, r, e, tmp_en, *idx, turn, dangle_model,
+  int                       ij, p, q, r, u, e, tmp_en, *idx, turn, dangle_model,
                             *my_c, *my_fML, *my_fc, *rtype, type, type_2, **c_local, **fML_local;
   vrna_param_t              *P;
   vrna_md_t                 *md;
@@ -1211,21 +1209,10 @@ BT_mb_loop(vrna_fold_compound_t *fc,
     if (sc_wrapper.pair)
       e -= sc_wrapper.pair(*i, *j, &sc_wrapper);
 
-    for (r = *i + 2 + turn; r < *j - 2 - turn; ++r) {
-      if (evaluate(p, q, r, r + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
-        if (sliding_window)
-          tmp_en = fML_local[p][r - p] +
-                   fML_local[r + 1][q - (r + 1)];
-        else
-          tmp_en = my_fML[idx[r] + p] +
-                   my_fML[idx[q] + r + 1];
-
-        if (sc_wrapper.decomp_ml)
-          tmp_en += sc_wrapper.decomp_ml(p, q, r, r + 1, &sc_wrapper);
-
-        if (e == tmp_en)
-          goto odd_dangles_exit;
-      }
+    u = BT_ml_split(fc, p, q, e, evaluate, &hc_dat_local, &sc_wrapper);
+    if (u != -1) {
+      r = u;
+      goto odd_dangles_exit;
     }
   }
 
@@ -1249,23 +1236,11 @@ BT_mb_loop(vrna_fold_compound_t *fc,
           break;
       }
 
-      for (r = p + turn + 1; r < q - turn - 1; ++r) {
-        if (evaluate(p + 1, q, r, r + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
-          if (sliding_window)
-            tmp_en = fML_local[p + 1][r - (p + 1)] +
-                     fML_local[r + 1][q - (r + 1)];
-          else
-            tmp_en = my_fML[idx[r] + p + 1] +
-                     my_fML[idx[q] + r + 1];
-
-          if (sc_wrapper.decomp_ml)
-            tmp_en += sc_wrapper.decomp_ml(p + 1, q, r, r + 1, &sc_wrapper);
-
-          if (e == tmp_en) {
-            p += 1;
-            goto odd_dangles_exit;
-          }
-        }
+      u = BT_ml_split(fc, p + 1, q, e, evaluate, &hc_dat_local, &sc_wrapper);
+      if (u != -1) {
+        r = u;
+        p += 1;
+        goto odd_dangles_exit;
       }
     }
 
@@ -1288,25 +1263,11 @@ BT_mb_loop(vrna_fold_compound_t *fc,
           break;
       }
 
-      for (r = p + turn + 1; r < q - turn - 1; ++r) {
-        if (evaluate(p, q - 1, r, r + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
-          if (sliding_window)
-            tmp_en = fML_local[p][r - p] +
-                     fML_local[r + 1][q - 1 - (r + 1)];
-          else
-            tmp_en = my_fML[idx[r] + p] +
-                     my_fML[idx[q - 1] + r + 1];
-
-          if (sc_wrapper.decomp_ml)
-            tmp_en += sc_wrapper.decomp_ml(p, q - 1, r, r + 1, &sc_wrapper);
-
-          ;
-
-          if (e == tmp_en) {
-            q -= 1;
-            goto odd_dangles_exit;
-          }
-        }
+      u = BT_ml_split(fc, p, q - 1, e, evaluate, &hc_dat_local, &sc_wrapper);
+      if (u != -1) {
+        r = u;
+        q -= 1;
+        goto odd_dangles_exit;
       }
     }
 
@@ -1329,24 +1290,12 @@ BT_mb_loop(vrna_fold_compound_t *fc,
           break;
       }
 
-      for (r = p + turn + 1; r < q - turn - 1; ++r) {
-        if (evaluate(p + 1, q - 1, r, r + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
-          if (sliding_window)
-            tmp_en = fML_local[p + 1][r - (p + 1)] +
-                     fML_local[r + 1][q - 1 - (r + 1)];
-          else
-            tmp_en = my_fML[idx[r] + p + 1] +
-                     my_fML[idx[q - 1] + r + 1];
-
-          if (sc_wrapper.decomp_ml)
-            tmp_en += sc_wrapper.decomp_ml(p + 1, q - 1, r, r + 1, &sc_wrapper);
-
-          if (e == tmp_en) {
-            p += 1;
-            q -= 1;
-            goto odd_dangles_exit;
-          }
-        }
+      u = BT_ml_split(fc, p + 1, q - 1, e, evaluate, &hc_dat_local, &sc_wrapper);
+      if (u != -1) {
+        r = u;
+        p += 1;
+        q -= 1;
+        goto odd_dangles_exit;
       }
     }
 
@@ -1477,3 +1426,75 @@ odd_dangles_exit:
 
   return 0;
 }
+
+
+/*
+ *  Find the first split point u of the multibranch loop segment [i, j]
+ *  with fML[i][u] + fML[u + 1][j] == e, or -1 if there is none. The
+ *  candidates are gathered in the order of the forward recursions, such
+ *  that the vectorized argmin resolves ties exactly like a linear scan.
+ */
+PRIVATE int
+BT_ml_split(vrna_fold_compound_t      *fc,
+            int                       i,
+            int                       j,
+            int                       e,
+            vrna_callback_hc_evaluate *evaluate,
+            struct default_data       *hc_dat_local,
+            struct sc_wrapper_ml      *sc_wrapper)
+{
+  unsigned char sliding_window;
+  int           u, start, count, pos, en, turn, *idx, *my_fML, **fML_local,
+                *fmi, *fmj;
+
+  sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
+  turn            = fc->params->model_details.min_loop_size;
+  idx             = (sliding_window) ? NULL : fc->jindx;
+  my_fML          = (sliding_window) ? NULL : fc->matrices->fML;
+  fML_local       = (sliding_window) ? fc->matrices->fML_local : NULL;
+  start           = i + turn + 1;
+  count           = j - turn - 2 - start + 1;
+  pos             = -1;
+
+  if (count < 1)
+    return -1;
+
+  fmi = (int *)vrna_alloc(sizeof(int) * count);
+  fmj = (int *)vrna_alloc(sizeof(int) * count);
+
+  for (u = start; u < start + count; u++) {
+    if (sliding_window) {
+      fmi[u - start]  = fML_local[i][u - i];
+      fmj[u - start]  = fML_local[u + 1][j - (u + 1)];
+    } else {
+      fmi[u - start]  = my_fML[idx[u] + i];
+      fmj[u - start]  = my_fML[idx[j] + u + 1];
+    }
+
+    if (!evaluate(i, j, u, u + 1, VRNA_DECOMP_ML_ML_ML, hc_dat_local))
+      fmi[u - start] = INF;
+    else if ((sc_wrapper->decomp_ml) && (fmi[u - start] != INF))
+      fmi[u - start] += sc_wrapper->decomp_ml(i, j, u, u + 1, sc_wrapper);
+  }
+
+  en = vrna_fun_zip_add_min_idx(fmi, fmj, count, &pos);
+
+  if (en < e) {
+    /* not the optimal decomposition, fall back to a linear scan */
+    for (pos = 0; pos < count; pos++)
+      if ((fmi[pos] != INF) &&
+          (fmj[pos] != INF) &&
+          (fmi[pos] + fmj[pos] == e))
+        break;
+
+    if (pos == count)
+      pos = -1;
+  } else if (en > e) {
+    pos = -1;
+  }
+
+  free(fmi);
+  free(fmj);
+
+  return (pos == -1) ? -1 : start + pos;
+}
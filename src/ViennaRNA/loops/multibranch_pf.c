@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/multibranch.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -37,6 +38,11 @@ struct vrna_mx_pf_aux_ml_s {
   FLT_OR_DBL  **qqmu;
 };
 
+/* decomposition stages of exp_E_ml_fast() */
+#define ML_STAGE_STEM     1U  /* multibranch loop parts [i,j] with exactly one stem starting at i */
+#define ML_STAGE_SPLIT    2U  /* unpaired stretch [i,u] and split into two multibranch loop parts */
+#define ML_STAGE_ALL      (ML_STAGE_STEM | ML_STAGE_SPLIT)
+
 
 /*
  #################################
@@ -55,7 +61,8 @@ PRIVATE FLT_OR_DBL
 exp_E_ml_fast(vrna_fold_compound_t        *fc,
               int                         i,
               int                         j,
-              struct vrna_mx_pf_aux_ml_s  *aux_mx);
+              struct vrna_mx_pf_aux_ml_s  *aux_mx,
+              unsigned int                stages);
 
 
 /*
@@ -87,7 +94,37 @@ vrna_exp_E_ml_fast(vrna_fold_compound_t       *fc,
   FLT_OR_DBL q = 0.;
 
   if ((fc) && (aux_mx))
-    q = exp_E_ml_fast(fc, i, j, aux_mx);
+    q = exp_E_ml_fast(fc, i, j, aux_mx, ML_STAGE_ALL);
+
+  return q;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_exp_E_ml_fast_stem(vrna_fold_compound_t        *fc,
+                        int                         i,
+                        int                         j,
+                        struct vrna_mx_pf_aux_ml_s  *aux_mx)
+{
+  FLT_OR_DBL q = 0.;
+
+  if ((fc) && (aux_mx))
+    q = exp_E_ml_fast(fc, i, j, aux_mx, ML_STAGE_STEM);
+
+  return q;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_exp_E_ml_fast_split(vrna_fold_compound_t       *fc,
+                         int                        i,
+                         int                        j,
+                         struct vrna_mx_pf_aux_ml_s *aux_mx)
+{
+  FLT_OR_DBL q = 0.;
+
+  if ((fc) && (aux_mx))
+    q = exp_E_ml_fast(fc, i, j, aux_mx, ML_STAGE_SPLIT);
 
   return q;
 }
@@ -337,9 +374,9 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
     k = i + 2;
 
     if (sliding_window) {
-      for (; k <= j - 1; k++, kl--)
-        temp += qm_local[i + 1][k - 1] *
-                qqm1_tmp[k];
+      temp += vrna_fun_zip_mult_sum(qm_local[i + 1] + k - 1,
+                                    qqm1_tmp + k,
+                                    j - k);
     } else {
       kl = my_iindx[i + 1] - (i + 1);
       /*
@@ -351,9 +388,18 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
         /* limit for-loop to last nucleotide of 5' part strand */
         int stop = MIN2(j - 1, se[sn[k - 1]]);
 
-        for (; k <= stop; k++, kl--)
-          temp += qm[kl] *
-                  qqm1_tmp[k];
+        /*
+         *  qm[kl] is stored in reverse order with respect to k, so we
+         *  use the reverse dot-product that processes the entire segment
+         *  k, ..., stop at once
+         */
+        if (stop >= k) {
+          temp  += vrna_fun_zip_mult_sum_rev(qqm1_tmp + k,
+                                             qm + kl - (stop - k),
+                                             stop - k + 1);
+          kl    -= stop - k + 1;
+          k     = stop + 1;
+        }
 
         k++;
         kl--;
@@ -382,7 +428,8 @@ PRIVATE FLT_OR_DBL
 exp_E_ml_fast(vrna_fold_compound_t        *fc,
               int                         i,
               int                         j,
-              struct vrna_mx_pf_aux_ml_s  *aux_mx)
+              struct vrna_mx_pf_aux_ml_s  *aux_mx,
+              unsigned int                stages)
 {
   unsigned char             sliding_window;
   short                     *S1, *S2, **SS, **S5, **S3;
@@ -435,90 +482,97 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   qbt1    = 0;
   q_temp  = 0.;
 
-  qqm[i] = 0.;
+  if (stages & ML_STAGE_STEM) {
+    qqm[i] = 0.;
 
-  if (evaluate(i, j, i, j - 1, VRNA_DECOMP_ML_ML, &hc_dat_local)) {
-    q_temp = qqm1[i] *
-             expMLbase[1];
+    if (evaluate(i, j, i, j - 1, VRNA_DECOMP_ML_ML, &hc_dat_local)) {
+      q_temp = qqm1[i] *
+               expMLbase[1];
 
-    if (sc_wrapper.red_ml)
-      q_temp *= sc_wrapper.red_ml(i, j, i, j - 1, &sc_wrapper);
+      if (sc_wrapper.red_ml)
+        q_temp *= sc_wrapper.red_ml(i, j, i, j - 1, &sc_wrapper);
 
-    qqm[i] += q_temp;
-  }
+      qqm[i] += q_temp;
+    }
 
-  if (with_ud) {
-    q_temp = 0.;
-
-    int cnt;
-    for (cnt = 0; cnt < domains_up->uniq_motif_count; cnt++) {
-      u = domains_up->uniq_motif_size[cnt];
-      if (j - u >= i) {
-        if (evaluate(i, j, i, j - u, VRNA_DECOMP_ML_ML, &hc_dat_local)) {
-          q_temp2 = qqmu[u][i] *
-                    domains_up->exp_energy_cb(fc,
-                                              j - u + 1,
-                                              j,
-                                              VRNA_UNSTRUCTURED_DOMAIN_MB_LOOP |
-                                              VRNA_UNSTRUCTURED_DOMAIN_MOTIF,
-                                              domains_up->data) *
-                    expMLbase[u];
-
-          if (sc_wrapper.red_ml)
-            q_temp2 *= sc_wrapper.red_ml(i, j, i, j - u, &sc_wrapper);
-
-          q_temp += q_temp2;
+    if (with_ud) {
+      q_temp = 0.;
+
+      int cnt;
+      for (cnt = 0; cnt < domains_up->uniq_motif_count; cnt++) {
+        u = domains_up->uniq_motif_size[cnt];
+        if (j - u >= i) {
+          if (evaluate(i, j, i, j - u, VRNA_DECOMP_ML_ML, &hc_dat_local)) {
+            q_temp2 = qqmu[u][i] *
+                      domains_up->exp_energy_cb(fc,
+                                                j - u + 1,
+                                                j,
+                                                VRNA_UNSTRUCTURED_DOMAIN_MB_LOOP |
+                                                VRNA_UNSTRUCTURED_DOMAIN_MOTIF,
+                                                domains_up->data) *
+                      expMLbase[u];
+
+            if (sc_wrapper.red_ml)
+              q_temp2 *= sc_wrapper.red_ml(i, j, i, j - u, &sc_wrapper);
+
+            q_temp += q_temp2;
+          }
         }
       }
+
+      qqm[i] += q_temp;
     }
 
-    qqm[i] += q_temp;
-  }
+    if (evaluate(i, j, i, j, VRNA_DECOMP_ML_STEM, &hc_dat_local)) {
+      qbt1 = (sliding_window) ? qb_local[i][j] : qb[ij];
 
-  if (evaluate(i, j, i, j, VRNA_DECOMP_ML_STEM, &hc_dat_local)) {
-    qbt1 = (sliding_window) ? qb_local[i][j] : qb[ij];
+      switch (fc->type) {
+        case VRNA_FC_TYPE_SINGLE:
+          S1    = fc->sequence_encoding;
+          S2    = fc->sequence_encoding2;
+          type  = vrna_get_ptype_md(S2[i], S2[j], md);
 
-    switch (fc->type) {
-      case VRNA_FC_TYPE_SINGLE:
-        S1    = fc->sequence_encoding;
-        S2    = fc->sequence_encoding2;
-        type  = vrna_get_ptype_md(S2[i], S2[j], md);
+          qbt1 *= exp_E_MLstem(type,
+                               ((i > 1) || circular) ? S1[i - 1] : -1,
+                               ((j < n) || circular) ? S1[j + 1] : -1,
+                               pf_params);
 
-        qbt1 *= exp_E_MLstem(type,
-                             ((i > 1) || circular) ? S1[i - 1] : -1,
-                             ((j < n) || circular) ? S1[j + 1] : -1,
-                             pf_params);
+          break;
 
-        break;
+        case VRNA_FC_TYPE_COMPARATIVE:
+          q_temp = 1.;
+          for (s = 0; s < n_seq; s++) {
+            type    = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
+            q_temp  *= exp_E_MLstem(type,
+                                    ((i > 1) || circular) ? S5[s][i] : -1,
+                                    ((j < n) || circular) ? S3[s][j] : -1,
+                                    pf_params);
+          }
+          qbt1 *= q_temp;
+          break;
+      }
 
-      case VRNA_FC_TYPE_COMPARATIVE:
-        q_temp = 1.;
-        for (s = 0; s < n_seq; s++) {
-          type    = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
-          q_temp  *= exp_E_MLstem(type,
-                                  ((i > 1) || circular) ? S5[s][i] : -1,
-                                  ((j < n) || circular) ? S3[s][j] : -1,
-                                  pf_params);
-        }
-        qbt1 *= q_temp;
-        break;
+      if (sc_wrapper.red_stem)
+        qbt1 *= sc_wrapper.red_stem(i, j, i, j, &sc_wrapper);
+
+      qqm[i] += qbt1;
     }
 
-    if (sc_wrapper.red_stem)
-      qbt1 *= sc_wrapper.red_stem(i, j, i, j, &sc_wrapper);
+    if (with_gquad) {
+      q_temp  = (sliding_window) ? G_local[i][j] : G[ij];
+      qqm[i]  += q_temp *
+                 pow(exp_E_MLstem(0, -1, -1, pf_params), (double)n_seq);
+    }
 
-    qqm[i] += qbt1;
+    if (with_ud)
+      qqmu[0][i] = qqm[i];
   }
 
-  if (with_gquad) {
-    q_temp  = (sliding_window) ? G_local[i][j] : G[ij];
-    qqm[i]  += q_temp *
-               pow(exp_E_MLstem(0, -1, -1, pf_params), (double)n_seq);
+  if (!(stages & ML_STAGE_SPLIT)) {
+    free_sc_wrapper_ml(&sc_wrapper);
+    return qqm[i];
   }
 
-  if (with_ud)
-    qqmu[0][i] = qqm[i];
-
   /*
    *  construction of qm matrix containing multiple loop
    *  partition function contributions from segment i,j
@@ -556,18 +610,24 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   k     = j;
 
   if (sliding_window) {
-    for (; k > i; k--)
-      temp += qm_local[i][k - 1] *
-              qqm_tmp[k];
+    temp += vrna_fun_zip_mult_sum(qm_local[i] + i,
+                                  qqm_tmp + i + 1,
+                                  k - i);
   } else {
     kl = iidx[i] - j + 1; /* ii-k=[i,k-1] */
 
     while (1) {
       /* limit for-loop to first nucleotide of 3' part strand */
       int stop = MAX2(i, ss[sn[k]]);
-      for (; k > stop; k--, kl++)
-        temp += qm[kl] *
-                qqm_tmp[k];
+
+      /* qm[kl] runs in opposite direction of qqm_tmp[k], see above */
+      if (k > stop) {
+        temp  += vrna_fun_zip_mult_sum_rev(qqm_tmp + stop + 1,
+                                           qm + kl,
+                                           k - stop);
+        kl    += k - stop;
+        k     = stop;
+      }
 
       k--;
       kl++;
@@ -626,9 +686,10 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   ii = maxk - i; /* length of unpaired stretch */
 
   /* finally, decompose segment */
-  for (k = maxk; k > i; k--, ii--)
-    temp += expMLbase[ii] *
-            qqm_tmp[k];
+  if (maxk > i)
+    temp += vrna_fun_zip_mult_sum(expMLbase + 1,
+                                  qqm_tmp + i + 1,
+                                  ii);
 
   if (with_ud) {
     ii = maxk - i; /* length of unpaired stretch */
@@ -22,6 +22,10 @@
 #include <string.h>
 #include <limits.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/structures.h"
 #include "ViennaRNA/params/default.h"
@@ -36,6 +40,7 @@
 #include "ViennaRNA/loops/all.h"
 #include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/mfe.h"
+#include "ViennaRNA/mfe_window.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -52,6 +57,8 @@ struct aux_arrays {
   int *DMLi;  /* DMLi[j] holds  MIN(fML[i,k]+fML[k+1,j])      */
   int *DMLi1; /*                MIN(fML[i+1,k]+fML[k+1,j])    */
   int *DMLi2; /*                MIN(fML[i+2,k]+fML[k+1,j])    */
+
+  vrna_mx_mfe_aux_il_t il; /* rolling window of the last rows of c for interior loops */
 };
 
 
@@ -77,6 +84,38 @@ PRIVATE int
 fill_arrays(vrna_fold_compound_t *fc);
 
 
+#ifdef _OPENMP
+PRIVATE void
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   num_threads);
+
+
+PRIVATE INLINE void
+decompose_cell_wavefront(vrna_fold_compound_t *fc,
+                         int                  i,
+                         int                  j,
+                         int                  **fml_rows,
+                         int                  **dml,
+                         int                  **cc);
+
+
+#endif
+
+
+PRIVATE int
+mfe_prefixes(vrna_fold_compound_t     *fc,
+             vrna_mfe_prefix_callback *cb,
+             void                     *data,
+             int                      with_structures);
+
+
+PRIVATE void
+store_prefix_mfe(unsigned int length,
+                 const char   *structure,
+                 float        en,
+                 void         *data);
+
+
 PRIVATE int
 postprocess_circular(vrna_fold_compound_t *fc,
                      sect                 bt_stack[],
@@ -141,6 +180,10 @@ vrna_mfe(vrna_fold_compound_t *fc,
   if (fc) {
     length = (int)fc->length;
 
+    /* sliding window fold compounds keep banded DP matrices only */
+    if ((fc->hc) && (fc->hc->type == VRNA_HC_WINDOW))
+      return vrna_mfe_banded(fc, structure);
+
     if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE)) {
       vrna_message_warning("vrna_mfe@mfe.c: Failed to prepare vrna_fold_compound");
       return mfe;
@@ -154,12 +197,20 @@ vrna_mfe(vrna_fold_compound_t *fc,
     if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
       fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_PRE, fc->aux_grammar->data);
 
+    vrna_timing_start(fc->timing, VRNA_TIMING_FILL);
+
     energy = fill_arrays(fc);
 
     if (fc->params->model_details.circ)
       energy = postprocess_circular(fc, bt_stack, &s);
 
+    vrna_timing_stop(fc->timing,
+                     VRNA_TIMING_FILL,
+                     (unsigned long long)length * (length + 1) / 2);
+
     if (structure && fc->params->model_details.backtrack) {
+      vrna_timing_start(fc->timing, VRNA_TIMING_BACKTRACK);
+
       /* add a guess of how many G's may be involved in a G quadruplex */
       bp = (vrna_bp_stack_t *)vrna_alloc(sizeof(vrna_bp_stack_t) * (4 * (1 + length / 2)));
 
@@ -172,6 +223,8 @@ vrna_mfe(vrna_fold_compound_t *fc,
       }
 
       free(bp);
+
+      vrna_timing_stop(fc->timing, VRNA_TIMING_BACKTRACK, (unsigned long long)length);
     }
 
     /* call user-defined recursion status callback function */
@@ -265,12 +318,136 @@ vrna_backtrack5(vrna_fold_compound_t  *fc,
 }
 
 
+PUBLIC float *
+vrna_mfe_prefix(vrna_fold_compound_t *fc)
+{
+  float *mfes = NULL;
+
+  if (fc) {
+    mfes = (float *)vrna_alloc(sizeof(float) * (fc->length + 1));
+
+    if (!mfe_prefixes(fc, &store_prefix_mfe, (void *)mfes, 0)) {
+      free(mfes);
+      mfes = NULL;
+    }
+  }
+
+  return mfes;
+}
+
+
+PUBLIC int
+vrna_mfe_prefix_cb(vrna_fold_compound_t     *fc,
+                   vrna_mfe_prefix_callback *cb,
+                   void                     *data)
+{
+  if ((fc) && (cb))
+    return mfe_prefixes(fc, cb, data, 1);
+
+  return 0;
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
  #####################################
  */
 
+/*
+ *  MFE of all 5' prefixes [1, k] of the sequence. For a linear RNA, the pair and
+ *  multibranch matrix entries of segments [i, j] with j <= k do not depend on
+ *  nucleotides downstream of k. Thus, we fill the DP matrices only once, and
+ *  for each k merely re-evaluate the exterior loop entry f5[k] as if the
+ *  sequence ended at position k, i.e. without any 3' dangle/mismatch
+ *  contribution of nucleotide k + 1
+ */
+PRIVATE int
+mfe_prefixes(vrna_fold_compound_t     *fc,
+             vrna_mfe_prefix_callback *cb,
+             void                     *data,
+             int                      with_structures)
+{
+  char          *structure;
+  unsigned int  k, length;
+  float         mfe;
+
+  if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE)) {
+    vrna_message_warning("vrna_mfe_prefix@mfe.c: Failed to prepare vrna_fold_compound");
+    return 0;
+  }
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands > 1) ||
+      (fc->params->model_details.circ) ||
+      (fc->hc->type == VRNA_HC_WINDOW)) {
+    vrna_message_warning("vrna_mfe_prefix@mfe.c: "
+                         "Prefix predictions are only available for single, linear RNA sequences");
+    return 0;
+  }
+
+  length    = fc->length;
+  structure = ((with_structures) && (fc->params->model_details.backtrack)) ?
+              (char *)vrna_alloc(sizeof(char) * (length + 1)) :
+              NULL;
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_MFE_PRE, fc->auxdata);
+
+  /* call user-defined grammar pre-condition callback function */
+  if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+    fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_PRE, fc->aux_grammar->data);
+
+  vrna_timing_start(fc->timing, VRNA_TIMING_FILL);
+
+  (void)fill_arrays(fc);
+
+  vrna_timing_stop(fc->timing,
+                   VRNA_TIMING_FILL,
+                   (unsigned long long)length * (length + 1) / 2);
+
+  fc->matrices->f5[0] = 0;
+
+  for (k = 1; k <= length; k++) {
+    /* pretend the sequence ends at nucleotide k */
+    fc->length  = k;
+    mfe         = (float)vrna_E_ext_loop_5_column(fc, (int)k) / 100.;
+
+    if (structure)
+      (void)vrna_backtrack5(fc, k, structure);
+
+    /* restore the regular exterior loop entry for the following prefixes */
+    fc->length = length;
+    (void)vrna_E_ext_loop_5_column(fc, (int)k);
+
+    cb(k, structure, mfe, data);
+  }
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_MFE_POST, fc->auxdata);
+
+  /* call user-defined grammar post-condition callback function */
+  if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+    fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_POST, fc->aux_grammar->data);
+
+  free(structure);
+
+  return 1;
+}
+
+
+PRIVATE void
+store_prefix_mfe(unsigned int length,
+                 const char   *structure,
+                 float        en,
+                 void         *data)
+{
+  ((float *)data)[length] = en;
+}
+
+
 /* fill DP matrices */
 PRIVATE int
 fill_arrays(vrna_fold_compound_t *fc)
@@ -293,9 +470,6 @@ fill_arrays(vrna_fold_compound_t *fc)
   fM1         = matrices->fM1;
   domains_up  = fc->domains_up;
 
-  /* allocate memory for all helper arrays */
-  helper_arrays = get_aux_arrays(length);
-
   if ((turn < 0) || (turn > length))
     turn = length; /* does this make any sense? */
 
@@ -313,13 +487,32 @@ fill_arrays(vrna_fold_compound_t *fc)
 
   /* start recursion */
   if (length <= turn) {
-    /* clean up memory */
-    free_aux_arrays(helper_arrays);
-
     /* return free energy of unfolded chain */
     return 0;
   }
 
+#ifdef _OPENMP
+  /*
+   *  fill the matrices diagonal-by-diagonal in parallel if requested. Auxiliary
+   *  grammar extensions and unstructured domains keep state of their own, so
+   *  we stick to the serial recursions for them
+   */
+  if ((fc->num_threads != 1) &&
+      (!fc->aux_grammar) &&
+      (!domains_up)) {
+    fill_arrays_wavefront(fc, fc->num_threads);
+
+    (void)vrna_E_ext_loop_5(fc);
+
+    return f5[length];
+  }
+
+#endif
+
+  /* allocate memory for all helper arrays */
+  helper_arrays     = get_aux_arrays(length);
+  helper_arrays->il = vrna_E_int_loop_fast_init(fc);
+
   for (i = length - turn - 1; i >= 1; i--) {
     for (j = i + turn + 1; j <= length; j++) {
       ij = indx[j] + i;
@@ -338,6 +531,8 @@ fill_arrays(vrna_fold_compound_t *fc)
         fc->aux_grammar->cb_aux(fc, i, j, fc->aux_grammar->data);
     } /* end of j-loop */
 
+    vrna_E_int_loop_fast_update(fc, i, helper_arrays->il);
+
     rotate_aux_arrays(helper_arrays, length);
   } /*
      * end of i-loop
@@ -352,6 +547,130 @@ fill_arrays(vrna_fold_compound_t *fc)
 }
 
 
+#ifdef _OPENMP
+
+/*
+ *  Number of diagonals we keep for the DMLi, DMLi1, and DMLi2 arrays, and
+ *  for the cc, cc1 arrays of the serial recursions, respectively
+ */
+#define WAVEFRONT_DML_DIAGONALS   5
+#define WAVEFRONT_CC_DIAGONALS    3
+
+/*
+ *  Fill the DP matrices along anti-diagonals d = j - i. All cells on the same
+ *  diagonal only depend on cells of shorter diagonals, so they can be
+ *  decomposed concurrently. The row-wise auxiliary arrays of the serial
+ *  recursions are replaced by a row-major copy of fML, that each cell updates
+ *  right after its decomposition, and small rings of diagonals for DML and cc.
+ *  The copy requires as much memory as fML itself, but lets every cell read
+ *  row i of fML contiguously. The result is identical to the serial fill.
+ */
+PRIVATE void
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   num_threads)
+{
+  int     i, d, k, length, turn, *fml, **fml_rows,
+          *dml[WAVEFRONT_DML_DIAGONALS], *cc[WAVEFRONT_CC_DIAGONALS];
+  size_t  size, offset;
+
+  length  = (int)fc->length;
+  turn    = fc->params->model_details.min_loop_size;
+
+  if (num_threads < 1)
+    num_threads = omp_get_max_threads();
+
+  /* row i of the copy holds fML[i, k] for i <= k <= length */
+  size      = ((size_t)(length + 1) * (length + 2)) / 2;
+  fml       = (int *)vrna_alloc(sizeof(int) * size);
+  fml_rows  = (int **)vrna_alloc(sizeof(int *) * (length + 2));
+
+  for (offset = 0; offset < size; offset++)
+    fml[offset] = INF;
+
+  for (offset = 0, i = 1; i <= length; offset += length - i + 1, i++)
+    fml_rows[i] = fml + offset - i;
+
+  for (d = 0; d < WAVEFRONT_DML_DIAGONALS; d++) {
+    dml[d] = (int *)vrna_alloc(sizeof(int) * (length + 3));
+    for (k = 0; k <= length + 2; k++)
+      dml[d][k] = INF;
+  }
+
+  for (d = 0; d < WAVEFRONT_CC_DIAGONALS; d++) {
+    cc[d] = (int *)vrna_alloc(sizeof(int) * (length + 3));
+    for (k = 0; k <= length + 2; k++)
+      cc[d][k] = INF;
+  }
+
+#pragma omp parallel num_threads(num_threads) private(d, i)
+  {
+    for (d = turn + 1; d < length; d++) {
+#pragma omp for schedule(dynamic, 8)
+      for (i = 1; i <= length - d; i++)
+        decompose_cell_wavefront(fc, i, i + d, fml_rows, dml, cc);
+    }
+  }
+
+  for (d = 0; d < WAVEFRONT_DML_DIAGONALS; d++)
+    free(dml[d]);
+
+  for (d = 0; d < WAVEFRONT_CC_DIAGONALS; d++)
+    free(cc[d]);
+
+  free(fml_rows);
+  free(fml);
+}
+
+
+PRIVATE INLINE void
+decompose_cell_wavefront(vrna_fold_compound_t *fc,
+                         int                  i,
+                         int                  j,
+                         int                  **fml_rows,
+                         int                  **dml,
+                         int                  **cc)
+{
+  int               d, ij, dml1[2], dml2[2], dml_ij, cc1, cc_ij;
+  vrna_mx_mfe_t     *matrices;
+  struct aux_arrays aux;
+
+  d         = j - i;
+  ij        = fc->jindx[j] + i;
+  matrices  = fc->matrices;
+
+  /* DML[i + 1, j - 2], DML[i + 1, j - 1], DML[i + 2, j - 2], and DML[i + 2, j - 1] */
+  dml1[0] = (d >= 3) ? dml[(d - 3) % WAVEFRONT_DML_DIAGONALS][i + 1] : INF;
+  dml1[1] = (d >= 2) ? dml[(d - 2) % WAVEFRONT_DML_DIAGONALS][i + 1] : INF;
+  dml2[0] = (d >= 4) ? dml[(d - 4) % WAVEFRONT_DML_DIAGONALS][i + 2] : INF;
+  dml2[1] = (d >= 3) ? dml[(d - 3) % WAVEFRONT_DML_DIAGONALS][i + 2] : INF;
+  /* cc[i + 1, j - 1] */
+  cc1     = (d >= 2) ? cc[(d - 2) % WAVEFRONT_CC_DIAGONALS][i + 1] : INF;
+  dml_ij  = INF;
+  cc_ij   = INF;
+
+  /* mimic the row-wise helper arrays of the serial recursions */
+  aux.Fmi   = fml_rows[i];
+  aux.DMLi  = &dml_ij - j;
+  aux.DMLi1 = dml1 - (j - 2);
+  aux.DMLi2 = dml2 - (j - 2);
+  aux.cc    = &cc_ij - j;
+  aux.cc1   = &cc1 - (j - 1);
+  aux.il    = NULL;
+
+  matrices->c[ij] = decompose_pair(fc, i, j, &aux);
+
+  matrices->fML[ij] = vrna_E_ml_stems_fast(fc, i, j, aux.Fmi, aux.DMLi);
+
+  if (fc->params->model_details.uniq_ML)
+    matrices->fM1[ij] = E_ml_rightmost_stem(i, j, fc);
+
+  dml[d % WAVEFRONT_DML_DIAGONALS][i] = dml_ij;
+  cc[d % WAVEFRONT_CC_DIAGONALS][i]   = cc_ij;
+}
+
+
+#endif
+
 /* post-processing step for circular RNAs */
 PRIVATE int
 postprocess_circular(vrna_fold_compound_t *fc,
@@ -396,7 +715,7 @@ postprocess_circular(vrna_fold_compound_t *fc,
   scs               = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->scs;
   dangle_model      = md->dangles;
   turn              = md->min_loop_size;
-  hard_constraints  = hc->mx;
+  hard_constraints  = hc->matrix;
   my_c              = fc->matrices->c;
   my_fML            = fc->matrices->fML;
   fM2               = fc->matrices->fM2;
@@ -447,7 +766,7 @@ postprocess_circular(vrna_fold_compound_t *fc,
 
       ij = indx[j] + i;
 
-      if (!hard_constraints[length * i + j])
+      if (!hard_constraints[ij])
         continue;
 
       /* exterior hairpin case */
@@ -710,7 +1029,7 @@ postprocess_circular(vrna_fold_compound_t *fc,
       for (i = 2 * turn + 1; i < length - turn; i++) {
         if (c_tmp[i + 1] != INF) {
           /* obey internal hard constraints */
-          if (hard_constraints[length * length + i + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+          if (hard_constraints[indx[length] + i + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
             tmp = 0;
             switch (fc->type) {
               case VRNA_FC_TYPE_SINGLE:
@@ -810,7 +1129,7 @@ postprocess_circular(vrna_fold_compound_t *fc,
       for (i = 2 * turn + 1; i < length - turn; i++) {
         if (c_tmp[i + 1] != INF) {
           /* obey internal hard constraints */
-          if ((hard_constraints[length * length + i + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) &&
+          if ((hard_constraints[indx[length] + i + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) &&
               (hc->up_ml[i])) {
             tmp = 0;
             switch (fc->type) {
@@ -900,7 +1219,7 @@ postprocess_circular(vrna_fold_compound_t *fc,
       /* add contributions for enclosing pair */
       for (i = turn + 1; i < length - turn; i++) {
         if (fmd5_tmp[i + 1] != INF) {
-          if (hard_constraints[length + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+          if (hard_constraints[indx[i] + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
             tmp = 0;
             switch (fc->type) {
               case VRNA_FC_TYPE_SINGLE:
@@ -998,7 +1317,7 @@ postprocess_circular(vrna_fold_compound_t *fc,
       for (i = turn + 1; i < length - turn; i++) {
         if (fmd5_tmp[i + 2] != INF) {
           /* obey internal hard constraints */
-          if ((hard_constraints[length + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) &&
+          if ((hard_constraints[indx[i] + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) &&
               (hc->up_ml[i + 1])) {
             tmp = 0;
             switch (fc->type) {
@@ -1733,15 +2052,13 @@ decompose_pair(vrna_fold_compound_t *fc,
                struct aux_arrays    *aux)
 {
   unsigned char hc_decompose;
-  unsigned int  n;
   int           e, new_c, energy, stackEnergy, ij, dangle_model, noLP,
                 *DMLi1, *DMLi2, *cc, *cc1;
 
-  n             = fc->length;
   ij            = fc->jindx[j] + i;
   dangle_model  = fc->params->model_details.dangles;
   noLP          = fc->params->model_details.noLP;
-  hc_decompose  = fc->hc->mx[n * i + j];
+  hc_decompose  = fc->hc->matrix[ij];
   DMLi1         = aux->DMLi1;
   DMLi2         = aux->DMLi2;
   cc            = aux->cc;
@@ -1767,7 +2084,7 @@ decompose_pair(vrna_fold_compound_t *fc,
     }
 
     /* check for interior loops */
-    energy  = vrna_E_int_loop(fc, i, j);
+    energy  = vrna_E_int_loop_fast(fc, i, j, aux->il);
     new_c   = MIN2(new_c, energy);
 
     /* remember stack energy for --noLP option */
@@ -1846,5 +2163,6 @@ free_aux_arrays(struct aux_arrays *aux)
   free(aux->DMLi);
   free(aux->DMLi1);
   free(aux->DMLi2);
+  vrna_E_int_loop_fast_free(aux->il);
   free(aux);
 }
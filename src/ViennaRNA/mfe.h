@@ -71,8 +71,14 @@
  *  @note This function is polymorphic. It accepts #vrna_fold_compound_t of type
  *        #VRNA_FC_TYPE_SINGLE, and #VRNA_FC_TYPE_COMPARATIVE.
  *
+ *  @note For single sequences, whose #vrna_fold_compound_t has been created with option
+ *        #VRNA_OPTION_WINDOW, the global MFE with a maximum base pair span of
+ *        #vrna_md_t.window_size is computed in banded DP matrices by vrna_mfe_banded().
+ *        This requires memory linear in the sequence length only.
+ *
  *  @see #vrna_fold_compound_t, vrna_fold_compound(), vrna_fold(), vrna_circfold(),
- *        vrna_fold_compound_comparative(), vrna_alifold(), vrna_circalifold()
+ *        vrna_fold_compound_comparative(), vrna_alifold(), vrna_circalifold(),
+ *        vrna_mfe_banded()
  *
  *  @param vc             fold compound
  *  @param structure      A pointer to the character array where the
@@ -246,6 +252,130 @@ vrna_cofold(const char  *sequence,
  * @}
  */
 
+/**
+ *  @name Batched global MFE prediction for many short sequences
+ *  @{
+ */
+
+/**
+ *  @brief  Compute the Minimum Free Energy (MFE), and corresponding secondary structures for
+ *          a large set of (short) RNA sequences
+ *
+ *  This function predicts the MFE of each of the @p num RNA sequences in @p sequences
+ *  independently, as if vrna_mfe() was called for each of them. Instead of processing
+ *  one sequence after another, sequences of equal length are grouped and their dynamic
+ *  programming matrices are stored interleaved, such that the recursions are evaluated
+ *  for several sequences at once. This allows the compiler to use SIMD instructions
+ *  across sequences and drastically reduces the per-sequence overhead, which usually
+ *  dominates the total run time for large numbers of short sequences, e.g. oligos,
+ *  probes, or reads.
+ *
+ *  The batched recursions cover the default energy model for linear sequences without
+ *  constraints, where @p dangles is either 0 or 2. Sequences that require any other
+ *  model settings (see #vrna_md_t), e.g. circular RNAs, G-Quadruplexes, or lonely pair
+ *  restrictions, are processed by the regular implementation instead. The same applies
+ *  to sequences longer than 500 nt, and to sequences whose length is not shared by any
+ *  other sequence of the input.
+ *
+ *  @note If @p structures is not @em NULL, each of its non-@em NULL entries must provide
+ *  enough memory to hold the secondary structure of the corresponding sequence in
+ *  dot-bracket notation, i.e. @f$ n + 1 @f$ characters. Structures are only computed if
+ *  backtracking is enabled in the model details.
+ *
+ *  @see vrna_mfe(), vrna_fold()
+ *
+ *  @param  sequences   The RNA sequences
+ *  @param  num         The number of sequences
+ *  @param  md_p        The model details to use for all sequences (Maybe @em NULL for default settings)
+ *  @param  structures  An array of @p num pointers to character arrays where the MFE structures will be written to (Maybe @em NULL)
+ *  @return             An array of @p num minimum free energies in kcal/mol, or @em NULL on error
+ */
+float *
+vrna_mfe_batch(const char   **sequences,
+               unsigned int num,
+               vrna_md_t    *md_p,
+               char         **structures);
+
+
+/**
+ * End batched global MFE interface
+ * @}
+ */
+
+/**
+ *  @name MFE prediction for all 5' prefixes of a sequence
+ *  @{
+ */
+
+/**
+ *  @brief  Callback for MFE predictions of 5' prefixes
+ *
+ *  @callback
+ *  @parblock
+ *  This function will be called for each 5' prefix of the sequence in a prefix MFE
+ *  prediction, in order of increasing prefix length.
+ *  @endparblock
+ *  @see vrna_mfe_prefix_cb()
+ *
+ *  @param length     The length of the prefix, i.e. the number of transcribed nucleotides
+ *  @param structure  The MFE structure of the prefix in dot-bracket notation (Maybe @em NULL if backtracking is turned off)
+ *  @param en         The minimum free energy of the prefix in kcal/mol
+ *  @param data       Some arbitrary data pointer passed through by the function executing the callback
+ */
+typedef void (vrna_mfe_prefix_callback)(unsigned int  length,
+                                        const char    *structure,
+                                        float         en,
+                                        void          *data);
+
+
+/**
+ *  @brief  Compute the minimum free energy of each 5' prefix of an RNA sequence
+ *
+ *  This function computes the MFE of each prefix @f$ [1, k] @f$, @f$ 1 \leq k \leq n @f$,
+ *  of the RNA sequence stored in @p fc, as if it was folded individually, e.g. to follow the
+ *  structure formation during transcription. Since the pair and multibranch loop decompositions
+ *  of segments @f$ [i, j] @f$ do not depend on nucleotides downstream of @f$ j @f$, the DP
+ *  matrices are filled only once, and each prefix adds nothing but the evaluation of a single
+ *  exterior loop entry. This reduces the overall complexity from @f$ \mathcal{O}(n^4) @f$ for
+ *  individual predictions to @f$ \mathcal{O}(n^3) @f$.
+ *
+ *  @note Only single, linear RNA sequences are supported. After return, the DP matrices of
+ *  @p fc are identical to those of vrna_mfe().
+ *
+ *  @see vrna_mfe_prefix_cb(), vrna_pf_prefix()
+ *
+ *  @param  fc  The fold compound
+ *  @return     An array of @f$ n + 1 @f$ minimum free energies in kcal/mol, where entry
+ *              @f$ k @f$ corresponds to the prefix of length @f$ k @f$, or @em NULL on error
+ */
+float *
+vrna_mfe_prefix(vrna_fold_compound_t *fc);
+
+
+/**
+ *  @brief  Compute the minimum free energy and MFE structure of each 5' prefix of an RNA sequence
+ *
+ *  Same as vrna_mfe_prefix() but passes the MFE and, if backtracking is enabled in the model
+ *  details, the MFE structure of each prefix to the callback @p cb as soon as it is available.
+ *
+ *  @see vrna_mfe_prefix(), #vrna_mfe_prefix_callback
+ *
+ *  @param  fc    The fold compound
+ *  @param  cb    The callback that receives the prefix predictions
+ *  @param  data  An arbitrary data pointer passed through to the callback
+ *  @return       1 on success, 0 otherwise
+ */
+int
+vrna_mfe_prefix_cb(vrna_fold_compound_t     *fc,
+                   vrna_mfe_prefix_callback *cb,
+                   void                     *data);
+
+
+/**
+ * End prefix MFE interface
+ * @}
+ */
+
 /**
  * End group mfe_global
  * @}
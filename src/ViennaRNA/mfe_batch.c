@@ -0,0 +1,796 @@
+/*
+ *                minimum free energy
+ *                batched prediction for many short RNA sequences
+ *
+ *                The DP matrices of several sequences of equal length
+ *                are stored interleaved (structure-of-arrays), such that
+ *                the recursions are evaluated for all of them in lockstep
+ *                and the minimizations vectorize across sequences
+ *
+ *                Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/params/default.h"
+#include "ViennaRNA/datastructures/basic.h"
+#include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/constraints/hard.h"
+#include "ViennaRNA/alphabet.h"
+#include "ViennaRNA/loops/all.h"
+#include "ViennaRNA/mfe.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/* number of sequences that are processed in lockstep */
+#define BATCH_LANES       8
+
+/*
+ *  maximum sequence length for batched predictions. The interleaved
+ *  matrices require BATCH_LANES times the memory of a single prediction,
+ *  so longer sequences are processed by vrna_mfe() instead
+ */
+#define BATCH_LENGTH_MAX  500
+
+/*
+ *  Use the compiler's generic vector extensions for the lane-wise
+ *  operations. They are lowered to whatever SIMD instruction set the
+ *  library has been compiled for (or to plain scalar code otherwise)
+ */
+#if defined(__GNUC__) || defined(__clang__)
+# define VRNA_WITH_VECTOR_EXTENSION 1
+typedef int vrna_v8si __attribute__ ((vector_size(BATCH_LANES * sizeof(int))));
+#endif
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+
+/*
+ *  All matrices hold BATCH_LANES consecutive entries per cell, i.e.
+ *  the energy of cell ij for sequence (lane) l is stored at
+ *  mx[ij * BATCH_LANES + l]
+ */
+struct batch_mx {
+  unsigned int  length;   /* the maximum sequence length memory has been allocated for */
+  int           *idx;
+  unsigned char *type;    /* pair types, 0 if (i,j) is not allowed to pair */
+  int           *c;
+  int           *fML;
+  int           *f5;
+  int           *c_int;   /* c[kl] + inner mismatch of generic interior loops */
+  int           *c_int1n; /* c[kl] + inner mismatch of 1xn interior loops */
+  int           *c_int23; /* c[kl] + inner mismatch of 2x3 interior loops */
+  int           *c_bulge; /* c[kl] + inner terminal AU penalty of bulge loops */
+  int           *fmi;     /* holds row i of fML (avoids jumps in memory) */
+  int           *dmli;    /* DMLi[j] holds  MIN(fML[i,k]+fML[k+1,j]) */
+  int           *dmli1;   /*                MIN(fML[i+1,k]+fML[k+1,j]) */
+};
+
+
+struct seq_order {
+  unsigned int  i;
+  unsigned int  length;
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE int
+batch_supported(vrna_md_t *md);
+
+
+PRIVATE struct batch_mx *
+batch_mx_init(unsigned int length);
+
+
+PRIVATE void
+batch_mx_free(struct batch_mx *mx);
+
+
+PRIVATE void
+fill_batch(struct batch_mx      *mx,
+           unsigned int         length,
+           vrna_fold_compound_t **fc);
+
+
+PRIVATE INLINE void
+decompose_pair_batch(struct batch_mx      *mx,
+                     vrna_fold_compound_t **fc,
+                     int                  i,
+                     int                  j);
+
+
+PRIVATE INLINE void
+ml_stems_batch(struct batch_mx      *mx,
+               vrna_fold_compound_t **fc,
+               int                  i,
+               int                  j);
+
+
+PRIVATE void
+ext_loop_batch(struct batch_mx      *mx,
+               vrna_fold_compound_t **fc);
+
+
+PRIVATE void
+backtrack_lane(struct batch_mx      *mx,
+               vrna_fold_compound_t *fc,
+               unsigned int         lane,
+               char                 *structure);
+
+
+PRIVATE INLINE void
+lanes_set(int *a,
+          int v);
+
+
+PRIVATE INLINE void
+lanes_min_add(int       *e,
+              const int *a,
+              const int *b);
+
+
+PRIVATE INLINE void
+lanes_min_add_finite(int        *e,
+                     const int  *a,
+                     const int  *b);
+
+
+PRIVATE int
+compare_length(const void *a,
+               const void *b);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC float *
+vrna_mfe_batch(const char   **sequences,
+               unsigned int num,
+               vrna_md_t    *md_p,
+               char         **structures)
+{
+  char                  *structure;
+  int                   batched;
+  unsigned int          s, e, l, lanes, n;
+  float                 *mfe;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc[BATCH_LANES], *lane_fc[BATCH_LANES];
+  struct seq_order      *order;
+  struct batch_mx       *mx;
+
+  if ((!sequences) || (num == 0))
+    return NULL;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  mfe     = (float *)vrna_alloc(sizeof(float) * num);
+  order   = (struct seq_order *)vrna_alloc(sizeof(struct seq_order) * num);
+  mx      = NULL;
+  batched = batch_supported(&md);
+
+  /* process sequences grouped by their length */
+  for (s = 0; s < num; s++) {
+    order[s].i      = s;
+    order[s].length = (sequences[s]) ? (unsigned int)strlen(sequences[s]) : 0;
+  }
+
+  qsort(order, num, sizeof(struct seq_order), &compare_length);
+
+  memset(fc, 0, sizeof(fc));
+
+  for (s = 0; s < num; s = e) {
+    n = order[s].length;
+
+    /* collect up to BATCH_LANES sequences of equal length */
+    for (e = s + 1; (e < num) && (e - s < BATCH_LANES) && (order[e].length == n); e++);
+
+    /*
+     *  sequences without any partner of equal length, or that are too
+     *  short or too long for batched recursions, are predicted one by one
+     */
+    if ((!batched) ||
+        (e - s < 2) ||
+        (n <= (unsigned int)md.min_loop_size + 1) ||
+        (n > BATCH_LENGTH_MAX)) {
+      /* fall back to regular MFE prediction */
+      for (; s < e; s++) {
+        structure = (structures) ? structures[order[s].i] : NULL;
+        fc[0]     = vrna_fold_compound_recycle(fc[0],
+                                               sequences[order[s].i],
+                                               &md,
+                                               VRNA_OPTION_MFE);
+        mfe[order[s].i] = (fc[0]) ? vrna_mfe(fc[0], structure) : (float)(INF / 100.);
+      }
+
+      continue;
+    }
+
+    lanes = e - s;
+
+    /*
+     *  sequences are sorted by length, so the matrices only grow up to
+     *  the longest length that is actually processed in batches
+     */
+    if ((!mx) || (mx->length < n)) {
+      batch_mx_free(mx);
+      mx = batch_mx_init(n);
+    }
+
+    for (l = 0; l < lanes; l++)
+      fc[l] = vrna_fold_compound_recycle(fc[l],
+                                         sequences[order[s + l].i],
+                                         &md,
+                                         VRNA_OPTION_MFE);
+
+    /* unused lanes simply repeat the first sequence of this batch */
+    for (l = 0; l < BATCH_LANES; l++)
+      lane_fc[l] = (l < lanes) ? fc[l] : fc[0];
+
+    fill_batch(mx, n, lane_fc);
+
+    for (l = 0; l < lanes; l++) {
+      mfe[order[s + l].i] = (float)mx->f5[n * BATCH_LANES + l] / 100.;
+
+      if ((structures) && (structures[order[s + l].i]) && (md.backtrack))
+        backtrack_lane(mx, fc[l], l, structures[order[s + l].i]);
+    }
+  }
+
+  for (l = 0; l < BATCH_LANES; l++)
+    vrna_fold_compound_free(fc[l]);
+
+  batch_mx_free(mx);
+  free(order);
+
+  return mfe;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE int
+batch_supported(vrna_md_t *md)
+{
+  /*
+   *  the batched recursions implement the plain nearest neighbor model for
+   *  linear sequences without any constraints, i.e. the model that is used
+   *  for the vast majority of short sequence predictions
+   */
+  if ((md->circ) ||
+      (md->gquad) ||
+      (md->noLP) ||
+      (md->noGUclosure) ||
+      ((md->dangles != 0) && (md->dangles != 2)) ||
+      (md->min_loop_size < TURN) ||
+      (md->backtrack_type != 'F'))
+    return 0;
+
+  return 1;
+}
+
+
+PRIVATE struct batch_mx *
+batch_mx_init(unsigned int length)
+{
+  size_t          cells, lin;
+  struct batch_mx *mx;
+
+  cells = ((size_t)(length + 1) * (length + 2)) / 2 + 1;
+  lin   = length + 2;
+
+  mx          = (struct batch_mx *)vrna_alloc(sizeof(struct batch_mx));
+  mx->length  = length;
+  mx->idx     = vrna_idx_col_wise(length);
+  mx->type    = (unsigned char *)vrna_alloc(sizeof(unsigned char) * cells * BATCH_LANES);
+  mx->c       = (int *)vrna_alloc(sizeof(int) * cells * BATCH_LANES);
+  mx->fML     = (int *)vrna_alloc(sizeof(int) * cells * BATCH_LANES);
+  mx->c_int   = (int *)vrna_alloc(sizeof(int) * cells * BATCH_LANES);
+  mx->c_int1n = (int *)vrna_alloc(sizeof(int) * cells * BATCH_LANES);
+  mx->c_int23 = (int *)vrna_alloc(sizeof(int) * cells * BATCH_LANES);
+  mx->c_bulge = (int *)vrna_alloc(sizeof(int) * cells * BATCH_LANES);
+  mx->f5      = (int *)vrna_alloc(sizeof(int) * lin * BATCH_LANES);
+  mx->fmi     = (int *)vrna_alloc(sizeof(int) * lin * BATCH_LANES);
+  mx->dmli    = (int *)vrna_alloc(sizeof(int) * lin * BATCH_LANES);
+  mx->dmli1   = (int *)vrna_alloc(sizeof(int) * lin * BATCH_LANES);
+
+  return mx;
+}
+
+
+PRIVATE void
+batch_mx_free(struct batch_mx *mx)
+{
+  if (mx) {
+    free(mx->idx);
+    free(mx->type);
+    free(mx->c);
+    free(mx->fML);
+    free(mx->c_int);
+    free(mx->c_int1n);
+    free(mx->c_int23);
+    free(mx->c_bulge);
+    free(mx->f5);
+    free(mx->fmi);
+    free(mx->dmli);
+    free(mx->dmli1);
+    free(mx);
+  }
+}
+
+
+PRIVATE void
+fill_batch(struct batch_mx      *mx,
+           unsigned int         length,
+           vrna_fold_compound_t **fc)
+{
+  unsigned char *hc_mx;
+  char          *ptype;
+  int           i, j, ij, n, l, turn, *idx, *tmp;
+  size_t        cells, lin;
+
+  n     = (int)length;
+  idx   = mx->idx;
+  turn  = fc[0]->params->model_details.min_loop_size;
+  cells = ((size_t)(n + 1) * (n + 2)) / 2 + 1;
+  lin   = n + 2;
+
+  /* pair types of all lanes */
+  for (l = 0; l < BATCH_LANES; l++) {
+    hc_mx = fc[l]->hc->matrix;
+    ptype = fc[l]->ptype;
+
+    for (j = 1; j <= n; j++)
+      for (i = 1; i <= j; i++) {
+        ij                            = idx[j] + i;
+        mx->type[ij * BATCH_LANES + l] = ((j - i > turn) && (hc_mx[ij])) ?
+                                         (unsigned char)vrna_get_ptype(ij, ptype) :
+                                         0;
+      }
+  }
+
+  /* prefill matrices */
+  for (ij = 0; ij < (int)(cells * BATCH_LANES); ij++)
+    mx->c[ij] = mx->fML[ij] = mx->c_int[ij] = mx->c_int1n[ij] = mx->c_int23[ij] =
+                                                                  mx->c_bulge[ij] = INF;
+
+  for (j = 0; j < (int)(lin * BATCH_LANES); j++)
+    mx->fmi[j] = mx->dmli[j] = mx->dmli1[j] = INF;
+
+  for (i = n - turn - 1; i >= 1; i--) {
+    for (j = i + turn + 1; j <= n; j++) {
+      decompose_pair_batch(mx, fc, i, j);
+      ml_stems_batch(mx, fc, i, j);
+    }
+
+    /* rotate auxiliary arrays */
+    tmp       = mx->dmli1;
+    mx->dmli1 = mx->dmli;
+    mx->dmli  = tmp;
+
+    for (j = 0; j < (int)(lin * BATCH_LANES); j++)
+      mx->fmi[j] = mx->dmli[j] = INF;
+  }
+
+  ext_loop_batch(mx, fc);
+}
+
+
+PRIVATE INLINE void
+decompose_pair_batch(struct batch_mx      *mx,
+                     vrna_fold_compound_t **fc,
+                     int                  i,
+                     int                  j)
+{
+  unsigned char tt, t2;
+  short         *S, *S2;
+  int           ij, kl, k, l, u1, u2, ns, nl, e, en, turn, dangles, *rtype, *c,
+                lane, e_c[BATCH_LANES], o_int[BATCH_LANES], o_int1n[BATCH_LANES],
+                o_int23[BATCH_LANES], o_bulge[BATCH_LANES], base[BATCH_LANES];
+  vrna_param_t  *P;
+  vrna_md_t     *md;
+
+  P       = fc[0]->params;
+  md      = &(P->model_details);
+  rtype   = &(md->rtype[0]);
+  turn    = md->min_loop_size;
+  dangles = md->dangles;
+  ij      = mx->idx[j] + i;
+  c       = mx->c;
+
+  /* hairpin, multibranch, and the interior loops with sequence dependent tables */
+  for (lane = 0; lane < BATCH_LANES; lane++) {
+    tt = mx->type[ij * BATCH_LANES + lane];
+
+    o_int[lane] = o_int1n[lane] = o_int23[lane] = o_bulge[lane] = 0;
+
+    if (!tt) {
+      e_c[lane] = INF;
+      continue;
+    }
+
+    S   = fc[lane]->sequence_encoding;
+    S2  = fc[lane]->sequence_encoding2;
+
+    /* hairpin loop */
+    e = E_Hairpin(j - i - 1, tt, S[i + 1], S[j - 1], fc[lane]->sequence + i - 1, P);
+
+    /* multibranch loop */
+    en = mx->dmli1[(j - 1) * BATCH_LANES + lane];
+    if (en != INF) {
+      int tt2 = vrna_get_ptype_md(S2[j], S2[i], md);
+
+      if (dangles == 2)
+        en += E_MLstem(tt2, S[j - 1], S[i + 1], P);
+      else
+        en += E_MLstem(tt2, -1, -1, P);
+
+      en  += P->MLclosing;
+      e   = MIN2(e, en);
+    }
+
+    /* stacked pairs */
+    kl = mx->idx[j - 1] + i + 1;
+    t2 = mx->type[kl * BATCH_LANES + lane];
+    if ((t2) && (c[kl * BATCH_LANES + lane] != INF)) {
+      en  = c[kl * BATCH_LANES + lane] + P->stack[tt][rtype[t2]];
+      e   = MIN2(e, en);
+    }
+
+    /* small bulges and interior loops that use their own energy tables */
+    for (u2 = 0; u2 <= 2; u2++)
+      for (u1 = 0; u1 <= 2; u1++) {
+        if ((u1 == 0) && (u2 == 0))
+          continue;
+
+        k = i + 1 + u1;
+        l = j - 1 - u2;
+
+        if (l - k < turn + 1)
+          continue;
+
+        kl  = mx->idx[l] + k;
+        t2  = mx->type[kl * BATCH_LANES + lane];
+        if ((t2) && (c[kl * BATCH_LANES + lane] != INF)) {
+          en = c[kl * BATCH_LANES + lane] +
+               E_IntLoop(u1, u2, tt, rtype[t2], S[i + 1], S[j - 1], S[k - 1], S[l + 1], P);
+          e = MIN2(e, en);
+        }
+      }
+
+    e_c[lane] = e;
+
+    /* outer contributions of the enclosing pair (i,j) for the remaining loops */
+    o_int[lane]   = P->mismatchI[tt][S[i + 1]][S[j - 1]];
+    o_int1n[lane] = P->mismatch1nI[tt][S[i + 1]][S[j - 1]];
+    o_int23[lane] = P->mismatch23I[tt][S[i + 1]][S[j - 1]];
+    o_bulge[lane] = (tt > 2) ? P->TerminalAU : 0;
+  }
+
+  /*
+   *  all remaining bulge and interior loops only differ in their sequence
+   *  dependent contributions of the enclosing and the enclosed pair. The latter
+   *  have been pre-computed together with c[kl], so these loops reduce to
+   *  plain vector additions and minimizations across all lanes
+   */
+  for (u2 = 0; u2 <= MAXLOOP; u2++) {
+    l = j - 1 - u2;
+
+    for (u1 = (u2 > 2) ? 0 : 3; u1 <= MAXLOOP - u2; u1++) {
+      const int *inner;
+
+      k = i + 1 + u1;
+
+      if (l - k < turn + 1)
+        break;
+
+      ns  = MIN2(u1, u2);
+      nl  = MAX2(u1, u2);
+      kl  = mx->idx[l] + k;
+
+      if (ns == 0) {
+        /* bulge loop with more than one unpaired nucleotide */
+        en    = P->bulge[nl];
+        inner = mx->c_bulge + kl * BATCH_LANES;
+        for (lane = 0; lane < BATCH_LANES; lane++)
+          base[lane] = en + o_bulge[lane];
+      } else if (ns == 1) {
+        /* 1xn interior loop */
+        en    = P->internal_loop[nl + 1] + MIN2(MAX_NINIO, (nl - ns) * P->ninio[2]);
+        inner = mx->c_int1n + kl * BATCH_LANES;
+        for (lane = 0; lane < BATCH_LANES; lane++)
+          base[lane] = en + o_int1n[lane];
+      } else if ((ns == 2) && (nl == 3)) {
+        /* 2x3 interior loop */
+        en    = P->internal_loop[5] + P->ninio[2];
+        inner = mx->c_int23 + kl * BATCH_LANES;
+        for (lane = 0; lane < BATCH_LANES; lane++)
+          base[lane] = en + o_int23[lane];
+      } else {
+        /* generic interior loop */
+        en    = P->internal_loop[nl + ns] + MIN2(MAX_NINIO, (nl - ns) * P->ninio[2]);
+        inner = mx->c_int + kl * BATCH_LANES;
+        for (lane = 0; lane < BATCH_LANES; lane++)
+          base[lane] = en + o_int[lane];
+      }
+
+      lanes_min_add(e_c, inner, base);
+    }
+  }
+
+  /* store results and pre-compute inner loop contributions of (i,j) */
+  for (lane = 0; lane < BATCH_LANES; lane++) {
+    tt = mx->type[ij * BATCH_LANES + lane];
+
+    if (!tt)
+      continue;
+
+    S   = fc[lane]->sequence_encoding;
+    t2  = rtype[tt];
+    e   = e_c[lane];
+
+    c[ij * BATCH_LANES + lane]            = e;
+    mx->c_int[ij * BATCH_LANES + lane]    = e + P->mismatchI[t2][S[j + 1]][S[i - 1]];
+    mx->c_int1n[ij * BATCH_LANES + lane]  = e + P->mismatch1nI[t2][S[j + 1]][S[i - 1]];
+    mx->c_int23[ij * BATCH_LANES + lane]  = e + P->mismatch23I[t2][S[j + 1]][S[i - 1]];
+    mx->c_bulge[ij * BATCH_LANES + lane]  = e + ((t2 > 2) ? P->TerminalAU : 0);
+  }
+}
+
+
+PRIVATE INLINE void
+ml_stems_batch(struct batch_mx      *mx,
+               vrna_fold_compound_t **fc,
+               int                  i,
+               int                  j)
+{
+  short         *S;
+  int           ij, k, n, e, en, turn, dangles, *idx, lane, decomp[BATCH_LANES];
+  vrna_param_t  *P;
+
+  P       = fc[0]->params;
+  turn    = P->model_details.min_loop_size;
+  dangles = P->model_details.dangles;
+  n       = (int)fc[0]->length;
+  idx     = mx->idx;
+  ij      = idx[j] + i;
+
+  /* modular decomposition */
+  lanes_set(decomp, INF);
+
+  for (k = i + turn + 1; k <= j - turn - 2; k++)
+    lanes_min_add_finite(decomp,
+                         mx->fmi + k * BATCH_LANES,
+                         mx->fML + (idx[j] + k + 1) * BATCH_LANES);
+
+  for (lane = 0; lane < BATCH_LANES; lane++) {
+    e = INF;
+
+    /* stem (i,j) */
+    en = mx->c[ij * BATCH_LANES + lane];
+    if (en != INF) {
+      S = fc[lane]->sequence_encoding;
+
+      if (dangles == 2)
+        en += E_MLstem(mx->type[ij * BATCH_LANES + lane],
+                       (i == 1) ? S[n] : S[i - 1],
+                       S[j + 1],
+                       P);
+      else
+        en += E_MLstem(mx->type[ij * BATCH_LANES + lane], -1, -1, P);
+
+      e = MIN2(e, en);
+    }
+
+    /* extension with one unpaired nucleotide at the 3' site */
+    en = mx->fML[(idx[j - 1] + i) * BATCH_LANES + lane];
+    if (en != INF)
+      e = MIN2(e, en + P->MLbase);
+
+    /* extension with one unpaired nucleotide at the 5' site */
+    en = mx->fML[(ij + 1) * BATCH_LANES + lane];
+    if (en != INF)
+      e = MIN2(e, en + P->MLbase);
+
+    mx->dmli[j * BATCH_LANES + lane] = decomp[lane];
+
+    e = MIN2(e, decomp[lane]);
+
+    mx->fmi[j * BATCH_LANES + lane]       = e;
+    mx->fML[ij * BATCH_LANES + lane]  = e;
+  }
+}
+
+
+PRIVATE void
+ext_loop_batch(struct batch_mx      *mx,
+               vrna_fold_compound_t **fc)
+{
+  short         *S;
+  int           i, j, ij, n, turn, dangles, *idx, *f5, *c, e, en, sj1, lane;
+  vrna_param_t  *P;
+
+  P       = fc[0]->params;
+  turn    = P->model_details.min_loop_size;
+  dangles = P->model_details.dangles;
+  n       = (int)fc[0]->length;
+  idx     = mx->idx;
+  f5      = mx->f5;
+  c       = mx->c;
+
+  for (lane = 0; lane < BATCH_LANES; lane++) {
+    S = fc[lane]->sequence_encoding;
+
+    f5[lane] = 0;
+    for (j = 1; j <= turn + 1; j++)
+      f5[j * BATCH_LANES + lane] = f5[(j - 1) * BATCH_LANES + lane];
+
+    for (j = turn + 2; j <= n; j++) {
+      /* extend previous solution by adding an unpaired nucleotide */
+      e   = f5[(j - 1) * BATCH_LANES + lane];
+      sj1 = ((dangles == 2) && (j < n)) ? S[j + 1] : -1;
+
+      /* decompose into exterior loop part followed by a stem */
+      for (i = j - turn - 1; i > 1; i--) {
+        ij = idx[j] + i;
+        if ((c[ij * BATCH_LANES + lane] != INF) &&
+            (f5[(i - 1) * BATCH_LANES + lane] != INF)) {
+          en = f5[(i - 1) * BATCH_LANES + lane] +
+               c[ij * BATCH_LANES + lane] +
+               vrna_E_ext_stem(mx->type[ij * BATCH_LANES + lane],
+                               (dangles == 2) ? S[i - 1] : -1,
+                               sj1,
+                               P);
+          e = MIN2(e, en);
+        }
+      }
+
+      /* reduce to a single stem */
+      ij = idx[j] + 1;
+      if (c[ij * BATCH_LANES + lane] != INF) {
+        en = c[ij * BATCH_LANES + lane] +
+             vrna_E_ext_stem(mx->type[ij * BATCH_LANES + lane], -1, sj1, P);
+        e = MIN2(e, en);
+      }
+
+      f5[j * BATCH_LANES + lane] = e;
+    }
+  }
+}
+
+
+PRIVATE void
+backtrack_lane(struct batch_mx      *mx,
+               vrna_fold_compound_t *fc,
+               unsigned int         lane,
+               char                 *structure)
+{
+  int           i, j, ij, n, *idx;
+  vrna_mx_mfe_t *matrices;
+
+  n         = (int)fc->length;
+  idx       = fc->jindx;
+  matrices  = fc->matrices;
+
+  /* move the DP matrices of this lane into the fold compound and use the regular backtracking */
+  for (j = 1; j <= n; j++)
+    for (i = 1; i <= j; i++) {
+      ij                = idx[j] + i;
+      matrices->c[ij]   = mx->c[(mx->idx[j] + i) * BATCH_LANES + lane];
+      matrices->fML[ij] = mx->fML[(mx->idx[j] + i) * BATCH_LANES + lane];
+    }
+
+  for (j = 0; j <= n; j++)
+    matrices->f5[j] = mx->f5[j * BATCH_LANES + lane];
+
+  (void)vrna_backtrack5(fc, (unsigned int)n, structure);
+}
+
+
+PRIVATE INLINE void
+lanes_set(int *a,
+          int v)
+{
+  int l;
+
+  for (l = 0; l < BATCH_LANES; l++)
+    a[l] = v;
+}
+
+
+/* e[l] = MIN2(e[l], a[l] + b[l]) */
+PRIVATE INLINE void
+lanes_min_add(int       *e,
+              const int *a,
+              const int *b)
+{
+#if VRNA_WITH_VECTOR_EXTENSION
+  vrna_v8si va, vb, ve, mask;
+
+  memcpy(&va, a, sizeof(vrna_v8si));
+  memcpy(&vb, b, sizeof(vrna_v8si));
+  memcpy(&ve, e, sizeof(vrna_v8si));
+
+  va    += vb;
+  mask  = va < ve;
+  ve    = (va & mask) | (ve & ~mask);
+
+  memcpy(e, &ve, sizeof(vrna_v8si));
+#else
+  int l;
+
+  for (l = 0; l < BATCH_LANES; l++)
+    e[l] = MIN2(e[l], a[l] + b[l]);
+
+#endif
+}
+
+
+/* e[l] = MIN2(e[l], a[l] + b[l]), but only where both, a[l] and b[l], are finite */
+PRIVATE INLINE void
+lanes_min_add_finite(int        *e,
+                     const int  *a,
+                     const int  *b)
+{
+#if VRNA_WITH_VECTOR_EXTENSION
+  vrna_v8si va, vb, ve, inf, mask;
+
+  memcpy(&va, a, sizeof(vrna_v8si));
+  memcpy(&vb, b, sizeof(vrna_v8si));
+  memcpy(&ve, e, sizeof(vrna_v8si));
+
+  inf   = va - va + INF;
+  mask  = (va < inf) & (vb < inf);
+  va    = ((va + vb) & mask) | (inf & ~mask);
+  mask  = va < ve;
+  ve    = (va & mask) | (ve & ~mask);
+
+  memcpy(e, &ve, sizeof(vrna_v8si));
+#else
+  int l;
+
+  for (l = 0; l < BATCH_LANES; l++)
+    if ((a[l] != INF) && (b[l] != INF))
+      e[l] = MIN2(e[l], a[l] + b[l]);
+
+#endif
+}
+
+
+PRIVATE int
+compare_length(const void *a,
+               const void *b)
+{
+  const struct seq_order  *s1 = (const struct seq_order *)a;
+  const struct seq_order  *s2 = (const struct seq_order *)b;
+
+  if (s1->length != s2->length)
+    return (s1->length < s2->length) ? -1 : 1;
+
+  return (s1->i < s2->i) ? -1 : ((s1->i > s2->i) ? 1 : 0);
+}
@@ -104,6 +104,21 @@ fill_arrays(vrna_fold_compound_t            *vc,
             void                            *data);
 
 
+PRIVATE int
+fill_arrays_banded(vrna_fold_compound_t *fc);
+
+
+PRIVATE INLINE void
+fill_row(vrna_fold_compound_t *fc,
+         int                  i,
+         int                  *cc,
+         int                  *cc1,
+         int                  *Fmi,
+         int                  *DMLi,
+         int                  *DMLi1,
+         int                  *DMLi2);
+
+
 PRIVATE void
 default_callback(int        start,
                  int        end,
@@ -148,6 +163,14 @@ PRIVATE INLINE void
 free_dp_matrices(vrna_fold_compound_t *fc);
 
 
+PRIVATE INLINE void
+allocate_dp_matrices_banded(vrna_fold_compound_t *fc);
+
+
+PRIVATE INLINE void
+free_dp_matrices_banded(vrna_fold_compound_t *fc);
+
+
 PRIVATE INLINE void
 rotate_dp_matrices(vrna_fold_compound_t *fc,
                    int                  i);
@@ -227,6 +250,9 @@ vrna_mfe_window_cb(vrna_fold_compound_t     *vc,
     return (float)(INF / 100.);
   }
 
+  /* local structures are backtracked during the fill, so both are accounted for together */
+  vrna_timing_start(vc->timing, VRNA_TIMING_FILL);
+
   if (vc->type == VRNA_FC_TYPE_COMPARATIVE) {
     n_seq   = vc->n_seq;
     energy  = fill_arrays_comparative(vc, &underflow, cb, data) / 100.;
@@ -245,10 +271,86 @@ vrna_mfe_window_cb(vrna_fold_compound_t     *vc,
     mfe_local += (float)energy / 100.;
   }
 
+  vrna_timing_stop(vc->timing,
+                   VRNA_TIMING_FILL,
+                   (unsigned long long)vc->length * vc->window_size);
+
   return mfe_local;
 }
 
 
+PUBLIC float
+vrna_mfe_banded(vrna_fold_compound_t  *fc,
+                char                  *structure)
+{
+  char      *ss;
+  int       length, energy;
+  vrna_md_t *md;
+
+  if ((!fc) || (fc->type != VRNA_FC_TYPE_SINGLE) || (fc->window_size <= 0))
+    return (float)(INF / 100.);
+
+  length  = (int)fc->length;
+  md      = &(fc->params->model_details);
+
+  if ((md->circ) || (md->gquad) || (fc->domains_up) || (fc->aux_grammar)) {
+    vrna_message_warning("vrna_mfe_banded@mfe_window.c: "
+                         "Circular RNAs, G-Quadruplexes, unstructured domains, and "
+                         "auxiliary grammar extensions are not supported");
+    return (float)(INF / 100.);
+  }
+
+  if (md->dangles % 2) {
+    vrna_message_warning("vrna_mfe_banded@mfe_window.c: "
+                         "Odd dangle models (-d1, -d3) are not supported");
+    return (float)(INF / 100.);
+  }
+
+  if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW)) {
+    vrna_message_warning("vrna_mfe_banded@mfe_window.c: Failed to prepare vrna_fold_compound");
+    return (float)(INF / 100.);
+  }
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_MFE_PRE, fc->auxdata);
+
+  vrna_timing_start(fc->timing, VRNA_TIMING_FILL);
+
+  allocate_dp_matrices_banded(fc);
+
+  energy = fill_arrays_banded(fc);
+
+  vrna_timing_stop(fc->timing,
+                   VRNA_TIMING_FILL,
+                   (unsigned long long)length * MIN2(md->max_bp_span, length));
+
+  if (structure && md->backtrack) {
+    vrna_timing_start(fc->timing, VRNA_TIMING_BACKTRACK);
+
+    memset(structure, '.', sizeof(char) * length);
+    structure[length] = '\0';
+
+    if (energy < INF) {
+      /* backtrack through the 3' fragments of the entire sequence */
+      ss = backtrack(fc, 1, length);
+      memcpy(structure, ss, sizeof(char) * MIN2(strlen(ss), length));
+      free(ss);
+    }
+
+    vrna_timing_stop(fc->timing, VRNA_TIMING_BACKTRACK, (unsigned long long)length);
+  }
+
+  free_dp_matrices_banded(fc);
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_MFE_POST, fc->auxdata);
+
+  return (float)energy / 100.;
+}
+
+
 #ifdef VRNA_WITH_SVM
 
 PUBLIC float
@@ -447,6 +549,87 @@ free_dp_matrices(vrna_fold_compound_t *fc)
 }
 
 
+/*
+ *  Banded storage for global predictions with limited base pair span,
+ *  i.e. keep all rows of the sliding window matrices instead of rotating
+ *  them, such that backtracking of the entire sequence remains possible
+ */
+PRIVATE INLINE void
+allocate_dp_matrices_banded(vrna_fold_compound_t *fc)
+{
+  int       i, j, length, maxdist, **c, **fML;
+  vrna_hc_t *hc;
+  vrna_sc_t *sc;
+
+  length  = fc->length;
+  maxdist = MIN2(fc->window_size, length);
+  hc      = fc->hc;
+  sc      = fc->sc;
+  c       = fc->matrices->c_local;
+  fML     = fc->matrices->fML_local;
+
+  for (i = length; i >= 0; i--) {
+    c[i]                = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+    fML[i]              = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+    hc->matrix_local[i] = (unsigned char *)vrna_alloc(sizeof(unsigned char) * (maxdist + 5));
+    fc->ptype_local[i]  = (char *)vrna_alloc(sizeof(char) * (maxdist + 5));
+
+    for (j = 0; j < maxdist + 5; j++)
+      c[i][j] = fML[i][j] = INF;
+
+    if (sc) {
+      if (sc->energy_bp_local)
+        sc->energy_bp_local[i] = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+
+      if (sc->energy_up)
+        sc->energy_up[i] = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+    }
+  }
+
+  for (i = length; i > 0; i--) {
+    make_ptypes(fc, i);
+    vrna_hc_update(fc, i);
+    vrna_sc_update(fc, i, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW);
+  }
+}
+
+
+PRIVATE INLINE void
+free_dp_matrices_banded(vrna_fold_compound_t *fc)
+{
+  int       i, length;
+  vrna_hc_t *hc;
+  vrna_sc_t *sc;
+
+  length  = fc->length;
+  hc      = fc->hc;
+  sc      = fc->sc;
+
+  for (i = 0; i <= length; i++) {
+    free(fc->matrices->c_local[i]);
+    fc->matrices->c_local[i] = NULL;
+    free(fc->matrices->fML_local[i]);
+    fc->matrices->fML_local[i] = NULL;
+    free(hc->matrix_local[i]);
+    hc->matrix_local[i] = NULL;
+    free(fc->ptype_local[i]);
+    fc->ptype_local[i] = NULL;
+
+    if (sc) {
+      if (sc->energy_bp_local) {
+        free(sc->energy_bp_local[i]);
+        sc->energy_bp_local[i] = NULL;
+      }
+
+      if (sc->energy_up) {
+        free(sc->energy_up[i]);
+        sc->energy_up[i] = NULL;
+      }
+    }
+  }
+}
+
+
 PRIVATE INLINE void
 rotate_dp_matrices(vrna_fold_compound_t *fc,
                    int                  i)
@@ -592,31 +775,24 @@ fill_arrays(vrna_fold_compound_t            *vc,
 {
   /* fill "c", "fML" and "f3" arrays and return  optimal energy */
 
-  char          **ptype, *prev;
-  unsigned char hc_decompose;
-  int           i, j, length, energy, maxdist, **c, **fML, *f3, no_close,
-                type, with_gquad, dangle_model, noLP, noGUclosure, turn,
+  char          *prev;
+  int           i, j, length, maxdist, *f3, with_gquad, dangle_model, turn,
                 *cc, *cc1, *Fmi, *DMLi, *DMLi1, *DMLi2, prev_i, prev_j,
-                prev_end, prev_en, new_c, stackEnergy;
+                prev_end, prev_en;
 
 #ifdef VRNA_WITH_SVM
   double        prevz;
 #endif
   vrna_param_t  *P;
   vrna_md_t     *md;
-  vrna_hc_t     *hc;
 
   length        = vc->length;
-  ptype         = vc->ptype_local;
   maxdist       = vc->window_size;
   P             = vc->params;
   md            = &(P->model_details);
   dangle_model  = md->dangles;
   with_gquad    = md->gquad;
-  noLP          = md->noLP;
-  noGUclosure   = md->noGUclosure;
   turn          = md->min_loop_size;
-  hc            = vc->hc;
   do_backtrack  = 0;
   prev_i        = 0;
   prev_j        = 0;
@@ -627,9 +803,7 @@ fill_arrays(vrna_fold_compound_t            *vc,
   prevz = 0.;
 #endif
 
-  c   = vc->matrices->c_local;
-  fML = vc->matrices->fML_local;
-  f3  = vc->matrices->f3_local;
+  f3 = vc->matrices->f3_local;
 
   cc    = (int *)vrna_alloc(sizeof(int) * (maxdist + 5)); /* linear array for calculating canonical structures */
   cc1   = (int *)vrna_alloc(sizeof(int) * (maxdist + 5)); /*   "     "        */
@@ -650,58 +824,7 @@ fill_arrays(vrna_fold_compound_t            *vc,
     vrna_gquad_mx_local_update(vc, length - maxdist - 4);
 
   for (i = length - turn - 1; i >= 1; i--) {
-    /* i,j in [1..length] */
-    for (j = i + turn + 1; j <= length && j <= i + maxdist; j++) {
-      hc_decompose  = hc->matrix_local[i][j - i];
-      type          = vrna_get_ptype_window(i, j, ptype);
-
-      no_close = (((type == 3) || (type == 4)) && noGUclosure);
-
-      if (hc_decompose) {
-        /* we have a pair */
-        new_c       = INF;
-        stackEnergy = INF;
-
-        if (!no_close) {
-          /* check for hairpin loop */
-          energy  = vrna_E_hp_loop(vc, i, j);
-          new_c   = MIN2(new_c, energy);
-
-          /* check for multibranch loops */
-          energy  = vrna_E_mb_loop_fast(vc, i, j, DMLi1, DMLi2);
-          new_c   = MIN2(new_c, energy);
-        }
-
-        if (dangle_model == 3) {
-          /* coaxial stacking */
-          energy  = vrna_E_mb_loop_stack(vc, i, j);
-          new_c   = MIN2(new_c, energy);
-        }
-
-        /* check for interior loops */
-        energy  = vrna_E_int_loop(vc, i, j);
-        new_c   = MIN2(new_c, energy);
-
-        /* remember stack energy for --noLP option */
-        if (noLP) {
-          stackEnergy = vrna_E_stack(vc, i, j);
-          new_c       = MIN2(new_c, cc1[j - 1 - (i + 1)] + stackEnergy);
-          cc[j - i]   = new_c;
-          c[i][j - i] = cc1[j - 1 - (i + 1)] + stackEnergy;
-        } else {
-          c[i][j - i] = new_c;
-        }
-      } /* end >> if (pair) << */
-      else {
-        c[i][j - i] = INF;
-      }
-
-      /*
-       * done with c[i,j], now compute fML[i,j]
-       * free ends ? -----------------------------------------
-       */
-      fML[i][j - i] = vrna_E_ml_stems_fast(vc, i, j, Fmi, DMLi);
-    } /* for (j...) */
+    fill_row(vc, i, cc, cc1, Fmi, DMLi, DMLi1, DMLi2);
 
     /* calculate energies of 5' and 3' fragments */
     f3[i] = vrna_E_ext_loop_3(vc, i);
@@ -842,6 +965,145 @@ fill_arrays(vrna_fold_compound_t            *vc,
 }
 
 
+PRIVATE INLINE void
+fill_row(vrna_fold_compound_t *fc,
+         int                  i,
+         int                  *cc,
+         int                  *cc1,
+         int                  *Fmi,
+         int                  *DMLi,
+         int                  *DMLi1,
+         int                  *DMLi2)
+{
+  char          **ptype;
+  unsigned char hc_decompose;
+  int           j, length, maxdist, turn, energy, type, no_close, new_c,
+                stackEnergy, dangle_model, noLP, noGUclosure, **c, **fML;
+  vrna_md_t     *md;
+  vrna_hc_t     *hc;
+  length        = fc->length;
+  ptype         = fc->ptype_local;
+  maxdist       = fc->window_size;
+  md            = &(fc->params->model_details);
+  dangle_model  = md->dangles;
+  noLP          = md->noLP;
+  noGUclosure   = md->noGUclosure;
+  turn          = md->min_loop_size;
+  hc            = fc->hc;
+  c             = fc->matrices->c_local;
+  fML           = fc->matrices->fML_local;
+
+  /* i,j in [1..length] */
+  for (j = i + turn + 1; j <= length && j <= i + maxdist; j++) {
+    hc_decompose  = hc->matrix_local[i][j - i];
+    type          = vrna_get_ptype_window(i, j, ptype);
+
+    no_close = (((type == 3) || (type == 4)) && noGUclosure);
+
+    if (hc_decompose) {
+      /* we have a pair */
+      new_c       = INF;
+      stackEnergy = INF;
+
+      if (!no_close) {
+        /* check for hairpin loop */
+        energy  = vrna_E_hp_loop(fc, i, j);
+        new_c   = MIN2(new_c, energy);
+
+        /* check for multibranch loops */
+        energy  = vrna_E_mb_loop_fast(fc, i, j, DMLi1, DMLi2);
+        new_c   = MIN2(new_c, energy);
+      }
+
+      if (dangle_model == 3) {
+        /* coaxial stacking */
+        energy  = vrna_E_mb_loop_stack(fc, i, j);
+        new_c   = MIN2(new_c, energy);
+      }
+
+      /* check for interior loops */
+      energy  = vrna_E_int_loop(fc, i, j);
+      new_c   = MIN2(new_c, energy);
+
+      /* remember stack energy for --noLP option */
+      if (noLP) {
+        stackEnergy = vrna_E_stack(fc, i, j);
+        new_c       = MIN2(new_c, cc1[j - 1 - (i + 1)] + stackEnergy);
+        cc[j - i]   = new_c;
+        c[i][j - i] = cc1[j - 1 - (i + 1)] + stackEnergy;
+      } else {
+        c[i][j - i] = new_c;
+      }
+    } /* end >> if (pair) << */
+    else {
+      c[i][j - i] = INF;
+    }
+
+    /*
+     * done with c[i,j], now compute fML[i,j]
+     * free ends ? -----------------------------------------
+     */
+    fML[i][j - i] = vrna_E_ml_stems_fast(fc, i, j, Fmi, DMLi);
+  } /* for (j...) */
+}
+
+
+/* fill "c", "fML" and "f3" arrays of the entire sequence, stored as bands of width maxdist */
+PRIVATE int
+fill_arrays_banded(vrna_fold_compound_t *fc)
+{
+  int i, j, length, maxdist, turn, *f3, *cc, *cc1, *Fmi, *DMLi, *DMLi1, *DMLi2, *FF;
+
+  length  = fc->length;
+  maxdist = fc->window_size;
+  turn    = fc->params->model_details.min_loop_size;
+  f3      = fc->matrices->f3_local;
+
+  cc    = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+  cc1   = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+  Fmi   = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+  DMLi  = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+  DMLi1 = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+  DMLi2 = (int *)vrna_alloc(sizeof(int) * (maxdist + 5));
+
+  for (j = 0; j < maxdist + 5; j++)
+    Fmi[j] = DMLi[j] = DMLi1[j] = DMLi2[j] = INF;
+
+  /*
+   *  the 3'-most nucleotides can not pair but may still carry
+   *  soft constraint contributions for being unpaired
+   */
+  for (i = length; (i >= 1) && (i > length - turn - 1); i--)
+    f3[i] = vrna_E_ext_loop_3(fc, i);
+
+  for (i = length - turn - 1; i >= 1; i--) {
+    fill_row(fc, i, cc, cc1, Fmi, DMLi, DMLi1, DMLi2);
+
+    f3[i] = vrna_E_ext_loop_3(fc, i);
+
+    /* rotate the auxilliary arrays */
+    FF    = DMLi2;
+    DMLi2 = DMLi1;
+    DMLi1 = DMLi;
+    DMLi  = FF;
+    FF    = cc1;
+    cc1   = cc;
+    cc    = FF;
+    for (j = 0; j < maxdist + 5; j++)
+      cc[j] = Fmi[j] = DMLi[j] = INF;
+  }
+
+  free(cc);
+  free(cc1);
+  free(Fmi);
+  free(DMLi);
+  free(DMLi1);
+  free(DMLi2);
+
+  return f3[1];
+}
+
+
 #ifdef VRNA_WITH_SVM
 PRIVATE int
 want_backtrack(vrna_fold_compound_t *vc,
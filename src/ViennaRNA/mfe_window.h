@@ -114,6 +114,35 @@ vrna_mfe_window_cb(vrna_fold_compound_t     *vc,
                    void                     *data);
 
 
+/**
+ *  @brief Global MFE prediction with limited base pair span using banded DP matrices
+ *
+ *  Computes the globally optimal secondary structure of the entire sequence,
+ *  where no base pair spans more than #vrna_md_t.window_size nucleotides,
+ *  i.e. the same structure as vrna_mfe() with #vrna_md_t.max_bp_span set
+ *  accordingly. In contrast to vrna_mfe(), which stores full triangular DP
+ *  matrices, this function keeps all rows of the (banded) sliding window
+ *  matrices in memory. Thus, it requires @f$ \mathcal{O}(n \cdot w) @f$ instead
+ *  of @f$ \mathcal{O}(n^2) @f$ memory for a sequence of length @f$ n @f$ and
+ *  window size @f$ w @f$.
+ *
+ *  The #vrna_fold_compound_t must be created with option #VRNA_OPTION_WINDOW.
+ *  vrna_mfe() automatically calls this function for such fold compounds.
+ *  Circular RNAs, G-Quadruplexes, unstructured domains, and the odd dangle models
+ *  (#vrna_md_t.dangles = 1 or 3) are not supported.
+ *
+ *  @see  vrna_mfe(), vrna_mfe_window(), #VRNA_OPTION_WINDOW, #vrna_md_t.window_size
+ *
+ *  @param  fc        The #vrna_fold_compound_t created with option #VRNA_OPTION_WINDOW
+ *  @param  structure A pointer to the character array where the secondary structure in
+ *                    dot-bracket notation will be written to (Maybe NULL)
+ *  @return           The minimum free energy (MFE) in kcal/mol
+ */
+float
+vrna_mfe_banded(vrna_fold_compound_t  *fc,
+                char                  *structure);
+
+
 #ifdef VRNA_WITH_SVM
 /**
  *  @brief Local MFE prediction using a sliding window approach (with z-score cut-off)
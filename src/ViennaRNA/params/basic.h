@@ -162,7 +162,11 @@ struct vrna_exp_param_s {
  *  If a NULL pointer is passed for the model details parameter, the default
  *  model parameters are stored within the requested #vrna_param_t structure.
  *
- *  @see #vrna_md_t, vrna_md_set_default(), vrna_exp_params()
+ *  Parameter sets are computed only once for each distinct set of model details
+ *  and kept in a process-wide cache. Subsequent requests with identical model
+ *  details merely receive a copy of the cached data.
+ *
+ *  @see #vrna_md_t, vrna_md_set_default(), vrna_exp_params(), vrna_params_cache_clear()
  *
  *  @param  md  A pointer to the model details to store inside the structure (Maybe NULL)
  *  @return     A pointer to the memory location where the requested parameters are stored
@@ -174,6 +178,19 @@ void
 vrna_params_free(vrna_param_t *param);
 
 
+/**
+ *  @brief  Remove all pre-computed parameter sets from the process-wide parameter cache
+ *
+ *  The cache is cleared automatically whenever a new energy parameter set is loaded,
+ *  e.g. via vrna_params_load(). Call this function only if you modified the global
+ *  energy parameter tables by any other means.
+ *
+ *  @see vrna_params(), vrna_exp_params(), vrna_exp_params_comparative()
+ */
+void
+vrna_params_cache_clear(void);
+
+
 /**
  *  @brief Get a copy of the provided free energy parameters
  *
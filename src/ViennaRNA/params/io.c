@@ -20,6 +20,7 @@
 #include "ViennaRNA/params/constants.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/params/io.h"
+#include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/static/energy_parameter_sets.h"
 
 
@@ -667,6 +668,10 @@ set_parameters_from_string(char       **file_content,
   }
 
   check_symmetry();
+
+  /* previously computed parameter sets are outdated now */
+  vrna_params_cache_clear();
+
   return 1;
 }
 
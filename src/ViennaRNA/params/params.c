@@ -13,6 +13,11 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+
+#if VRNA_WITH_PTHREADS
+# include <pthread.h>
+#endif
+
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/utils/basic.h"
@@ -46,6 +51,14 @@
 
 /* #define SMOOTH(X) ((X)<0 ? 0 : (X)) */
 
+/* maximum number of distinct parameter sets kept in the process-wide cache */
+#define PARAMS_CACHE_SIZE     16
+
+/* kinds of parameter sets stored in the cache */
+#define PARAMS_CACHE_MFE      1U
+#define PARAMS_CACHE_PF       2U
+#define PARAMS_CACHE_PF_ALI   3U
+
 /*
  * If the global use_mfelike_energies flag is set, truncate doubles to int
  * values and cast back to double. This makes the energy parameters of the
@@ -96,6 +109,34 @@ PRIVATE int               pf_id = -1;
 #pragma omp threadprivate(id, pf_id)
 #endif
 
+/*
+ *  Process-wide cache of pristine parameter sets. Entries are immutable once
+ *  inserted and kept in most-recently-used order. Callers always receive a
+ *  private copy, so modifications of the returned data never leak into the
+ *  cache.
+ */
+struct params_cache_key {
+  unsigned int  type;         /* kind of parameter set, i.e. PARAMS_CACHE_* */
+  unsigned int  n_seq;        /* number of sequences (comparative Boltzmann factors only) */
+  double        temperature;  /* model details the energy parameters are derived from */
+  double        betaScale;
+  int           pf_smooth;
+  int           dangles;
+};
+
+struct params_cache_entry {
+  struct params_cache_key key;  /* energy relevant attributes of the parameter set */
+  size_t                  size; /* size of the parameter set in bytes */
+  void                    *data; /* the parameter set */
+};
+
+PRIVATE struct params_cache_entry params_cache[PARAMS_CACHE_SIZE];
+PRIVATE unsigned int              params_cache_num = 0;
+
+#if VRNA_WITH_PTHREADS
+PRIVATE pthread_mutex_t params_cache_mtx = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -121,6 +162,34 @@ PRIVATE void
 rescale_params(vrna_fold_compound_t *vc);
 
 
+PRIVATE void *
+params_cache_fetch(unsigned int type,
+                   unsigned int n_seq,
+                   vrna_md_t    *md);
+
+
+PRIVATE void *
+params_cache_fetch_unlocked(unsigned int  type,
+                            unsigned int  n_seq,
+                            vrna_md_t     *md);
+
+
+PRIVATE void
+params_cache_clear_unlocked(void);
+
+
+PRIVATE void
+params_cache_key_init(struct params_cache_key *key,
+                      unsigned int            type,
+                      unsigned int            n_seq,
+                      vrna_md_t               *md);
+
+
+PRIVATE int
+params_cache_key_equal(const struct params_cache_key  *key1,
+                       const struct params_cache_key  *key2);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -129,13 +198,18 @@ rescale_params(vrna_fold_compound_t *vc);
 PUBLIC vrna_param_t *
 vrna_params(vrna_md_t *md)
 {
-  if (md) {
-    return get_scaled_params(md);
-  } else {
-    vrna_md_t md;
-    vrna_md_set_default(&md);
-    return get_scaled_params(&md);
+  vrna_param_t  *P;
+  vrna_md_t     md_default;
+
+  if (!md) {
+    vrna_md_set_default(&md_default);
+    md = &md_default;
   }
+
+  P     = (vrna_param_t *)params_cache_fetch(PARAMS_CACHE_MFE, 0, md);
+  P->id = ++id;
+
+  return P;
 }
 
 PUBLIC void
@@ -148,13 +222,14 @@ vrna_params_free(vrna_param_t *param)
 PUBLIC vrna_exp_param_t *
 vrna_exp_params(vrna_md_t *md)
 {
-  if (md) {
-    return get_scaled_exp_params(md, -1.);
-  } else {
-    vrna_md_t md;
-    vrna_md_set_default(&md);
-    return get_scaled_exp_params(&md, -1.);
+  vrna_md_t md_default;
+
+  if (!md) {
+    vrna_md_set_default(&md_default);
+    md = &md_default;
   }
+
+  return (vrna_exp_param_t *)params_cache_fetch(PARAMS_CACHE_PF, 0, md);
 }
 
 
@@ -162,13 +237,30 @@ PUBLIC vrna_exp_param_t *
 vrna_exp_params_comparative(unsigned int  n_seq,
                             vrna_md_t     *md)
 {
-  if (md) {
-    return get_exp_params_ali(md, n_seq, -1.);
-  } else {
-    vrna_md_t md;
-    vrna_md_set_default(&md);
-    return get_exp_params_ali(&md, n_seq, -1.);
+  vrna_md_t md_default;
+
+  if (!md) {
+    vrna_md_set_default(&md_default);
+    md = &md_default;
   }
+
+  return (vrna_exp_param_t *)params_cache_fetch(PARAMS_CACHE_PF_ALI, n_seq, md);
+}
+
+
+PUBLIC void
+vrna_params_cache_clear(void)
+{
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&params_cache_mtx);
+  params_cache_clear_unlocked();
+  pthread_mutex_unlock(&params_cache_mtx);
+#elif defined(_OPENMP)
+#pragma omp critical (vrna_params_cache)
+  params_cache_clear_unlocked();
+#else
+  params_cache_clear_unlocked();
+#endif
 }
 
 
@@ -402,6 +494,144 @@ vrna_params_prepare(vrna_fold_compound_t  *fc,
  # BEGIN OF STATIC HELPER FUNCTIONS  #
  #####################################
  */
+PRIVATE void *
+params_cache_fetch(unsigned int type,
+                   unsigned int n_seq,
+                   vrna_md_t    *md)
+{
+  void *copy;
+
+  /*
+   *  Parameter sets are computed while holding the lock. This serializes
+   *  concurrent cache misses but also guarantees that each distinct set is
+   *  computed only once, no matter how many threads request it at the same time
+   */
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&params_cache_mtx);
+  copy = params_cache_fetch_unlocked(type, n_seq, md);
+  pthread_mutex_unlock(&params_cache_mtx);
+#elif defined(_OPENMP)
+#pragma omp critical (vrna_params_cache)
+  copy = params_cache_fetch_unlocked(type, n_seq, md);
+#else
+  copy = params_cache_fetch_unlocked(type, n_seq, md);
+#endif
+
+  return copy;
+}
+
+
+PRIVATE void *
+params_cache_fetch_unlocked(unsigned int  type,
+                            unsigned int  n_seq,
+                            vrna_md_t     *md)
+{
+  unsigned int              i;
+  void                      *copy;
+  struct params_cache_key   key;
+  struct params_cache_entry hit;
+
+  params_cache_key_init(&key, type, n_seq, md);
+
+  for (i = 0; i < params_cache_num; i++)
+    if (params_cache_key_equal(&(params_cache[i].key), &key))
+      break;
+
+  if (i < params_cache_num) {
+    hit = params_cache[i];
+  } else {
+    /* cache miss, drop least recently used entry if necessary */
+    if (params_cache_num == PARAMS_CACHE_SIZE)
+      free(params_cache[--params_cache_num].data);
+
+    hit.key = key;
+
+    switch (type) {
+      case PARAMS_CACHE_MFE:
+        hit.data  = (void *)get_scaled_params(md);
+        hit.size  = sizeof(vrna_param_t);
+        break;
+
+      case PARAMS_CACHE_PF:
+        hit.data  = (void *)get_scaled_exp_params(md, -1.);
+        hit.size  = sizeof(vrna_exp_param_t);
+        break;
+
+      default:
+        hit.data  = (void *)get_exp_params_ali(md, n_seq, -1.);
+        hit.size  = sizeof(vrna_exp_param_t);
+        break;
+    }
+
+    i = params_cache_num++;
+  }
+
+  /* move entry to the front */
+  memmove(params_cache + 1, params_cache, sizeof(struct params_cache_entry) * i);
+  params_cache[0] = hit;
+
+  copy = vrna_alloc(hit.size);
+  memcpy(copy, hit.data, hit.size);
+
+  /*
+   *  the cached set may stem from model details that differ in attributes
+   *  which are irrelevant for the energy parameters, e.g. the maximum base
+   *  pair span. So we hand out the model details of the caller instead
+   */
+  if (type == PARAMS_CACHE_MFE)
+    ((vrna_param_t *)copy)->model_details = *md;
+  else
+    ((vrna_exp_param_t *)copy)->model_details = *md;
+
+  return copy;
+}
+
+
+/*
+ *  Extract the attributes of the model details that the energy parameters
+ *  (and Boltzmann factors) are actually derived from. All other attributes
+ *  are simply copied into the parameter set.
+ */
+PRIVATE void
+params_cache_key_init(struct params_cache_key *key,
+                      unsigned int            type,
+                      unsigned int            n_seq,
+                      vrna_md_t               *md)
+{
+  key->type         = type;
+  key->n_seq        = n_seq;
+  key->temperature  = md->temperature;
+  key->betaScale    = md->betaScale;
+  key->pf_smooth    = md->pf_smooth;
+  key->dangles      = md->dangles;
+}
+
+
+PRIVATE int
+params_cache_key_equal(const struct params_cache_key  *key1,
+                       const struct params_cache_key  *key2)
+{
+  return (key1->type == key2->type) &&
+         (key1->n_seq == key2->n_seq) &&
+         (key1->temperature == key2->temperature) &&
+         (key1->betaScale == key2->betaScale) &&
+         (key1->pf_smooth == key2->pf_smooth) &&
+         (key1->dangles == key2->dangles);
+}
+
+
+PRIVATE void
+params_cache_clear_unlocked(void)
+{
+  unsigned int i;
+
+  for (i = 0; i < params_cache_num; i++)
+    free(params_cache[i].data);
+
+  params_cache_num = 0;
+}
+
+
 PRIVATE vrna_param_t *
 get_scaled_params(vrna_md_t *md)
 {
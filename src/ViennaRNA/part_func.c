@@ -19,6 +19,7 @@
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
+#include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/loops/all.h"
 #include "ViennaRNA/gquad.h"
 #include "ViennaRNA/constraints/hard.h"
@@ -30,6 +31,12 @@
 #include <omp.h>
 #endif
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -48,7 +55,60 @@
  #################################
  */
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc);
+fill_arrays(vrna_fold_compound_t    *fc,
+            vrna_pf_prefix_callback *cb,
+            void                    *data);
+
+
+PRIVATE int
+fill_arrays_columns(vrna_fold_compound_t    *fc,
+                    vrna_mx_pf_aux_el_t     aux_mx_el,
+                    vrna_mx_pf_aux_ml_t     aux_mx_ml,
+                    vrna_mx_pf_aux_il_t     aux_mx_il,
+                    vrna_pf_prefix_callback *cb,
+                    void                    *data);
+
+
+PRIVATE void
+prefix_column(vrna_fold_compound_t    *fc,
+              int                     j,
+              vrna_mx_pf_aux_el_t     aux_mx_el,
+              vrna_pf_prefix_callback *cb,
+              void                    *data);
+
+
+PRIVATE int
+pf_prefixes(vrna_fold_compound_t    *fc,
+            vrna_pf_prefix_callback *cb,
+            void                    *data);
+
+
+PRIVATE void
+store_prefix_energy(unsigned int  length,
+                    float         en,
+                    void          *data);
+
+
+#ifdef _OPENMP
+PRIVATE int
+fill_arrays_concurrent(vrna_fold_compound_t    *fc,
+                       int                     num_threads,
+                       vrna_mx_pf_aux_el_t     aux_mx_el,
+                       vrna_mx_pf_aux_ml_t     aux_mx_ml,
+                       vrna_mx_pf_aux_il_t     aux_mx_il,
+                       vrna_pf_prefix_callback *cb,
+                       void                    *data);
+
+
+#endif
+
+PRIVATE INLINE FLT_OR_DBL
+decompose_segment(vrna_fold_compound_t  *fc,
+                  int                   i,
+                  int                   j,
+                  vrna_mx_pf_aux_el_t   aux_mx_el,
+                  vrna_mx_pf_aux_ml_t   aux_mx_ml,
+                  vrna_mx_pf_aux_il_t   aux_mx_il);
 
 
 PRIVATE void
@@ -59,7 +119,26 @@ PRIVATE FLT_OR_DBL
 decompose_pair(vrna_fold_compound_t *fc,
                int                  i,
                int                  j,
-               vrna_mx_pf_aux_ml_t  aux_mx_ml);
+               vrna_mx_pf_aux_ml_t  aux_mx_ml,
+               vrna_mx_pf_aux_il_t  aux_mx_il);
+
+
+PRIVATE int
+fill_arrays_banded(vrna_fold_compound_t *fc,
+                   FLT_OR_DBL           *q5);
+
+
+PRIVATE INLINE void
+allocate_dp_matrices_banded(vrna_fold_compound_t *fc);
+
+
+PRIVATE INLINE void
+free_dp_matrices_banded(vrna_fold_compound_t *fc);
+
+
+PRIVATE INLINE void
+make_ptypes_banded(vrna_fold_compound_t  *fc,
+                   int                   i);
 
 
 /*
@@ -81,6 +160,10 @@ vrna_pf(vrna_fold_compound_t  *fc,
   free_energy = (float)(INF / 100.);
 
   if (fc) {
+    /* sliding window fold compounds keep banded DP matrices only */
+    if ((fc->hc) && (fc->hc->type == VRNA_HC_WINDOW))
+      return vrna_pf_banded(fc, structure);
+
     /* make sure, everything is set up properly to start partition function computations */
     if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_PF)) {
       vrna_message_warning("vrna_pf@part_func.c: Failed to prepare vrna_fold_compound");
@@ -111,7 +194,10 @@ vrna_pf(vrna_fold_compound_t  *fc,
     if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
       fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_PRE, fc->aux_grammar->data);
 
-    if (!fill_arrays(fc)) {
+    vrna_timing_start(fc->timing, VRNA_TIMING_FILL);
+
+    if (!fill_arrays(fc, NULL, NULL)) {
+      vrna_timing_stop(fc->timing, VRNA_TIMING_FILL, 0);
 #ifdef SUN4
       standard_arithmetic();
 #elif defined(HP9)
@@ -124,6 +210,10 @@ vrna_pf(vrna_fold_compound_t  *fc,
       /* do post processing step for circular RNAs */
       postprocess_circular(fc);
 
+    vrna_timing_stop(fc->timing,
+                     VRNA_TIMING_FILL,
+                     (unsigned long long)n * (n + 1) / 2);
+
     /* calculate base pairing probability matrix (bppm)  */
     if (md->compute_bpp) {
       vrna_pairing_probs(fc, structure);
@@ -184,6 +274,72 @@ vrna_pf(vrna_fold_compound_t  *fc,
 }
 
 
+PUBLIC float
+vrna_pf_banded(vrna_fold_compound_t  *fc,
+               char                  *structure)
+{
+  int               n;
+  double            free_energy;
+  FLT_OR_DBL        *q5;
+  vrna_md_t         *md;
+  vrna_exp_param_t  *params;
+
+  free_energy = (float)(INF / 100.);
+
+  if ((!fc) || (fc->type != VRNA_FC_TYPE_SINGLE) || (fc->window_size <= 0))
+    return free_energy;
+
+  n   = (int)fc->length;
+  md  = (fc->exp_params) ? &(fc->exp_params->model_details) : &(fc->params->model_details);
+
+  if ((md->circ) || (md->gquad) || (fc->domains_up) || (fc->aux_grammar) ||
+      ((fc->hc) && (fc->hc->f)) || ((fc->sc) && (fc->sc->exp_f))) {
+    vrna_message_warning("vrna_pf_banded@part_func.c: "
+                         "Circular RNAs, G-Quadruplexes, unstructured domains, auxiliary "
+                         "grammar extensions, and constraint callbacks are not supported");
+    return free_energy;
+  }
+
+  if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_PF | VRNA_OPTION_WINDOW)) {
+    vrna_message_warning("vrna_pf_banded@part_func.c: Failed to prepare vrna_fold_compound");
+    return free_energy;
+  }
+
+  params  = fc->exp_params;
+  q5      = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_PF_PRE, fc->auxdata);
+
+  vrna_timing_start(fc->timing, VRNA_TIMING_FILL);
+
+  allocate_dp_matrices_banded(fc);
+
+  if (fill_arrays_banded(fc, q5)) {
+    if (q5[n] <= FLT_MIN)
+      vrna_message_warning("pf_scale too large");
+
+    free_energy = (-log(q5[n]) - n * log(params->pf_scale)) *
+                  params->kT /
+                  1000.0;
+  }
+
+  vrna_timing_stop(fc->timing,
+                   VRNA_TIMING_FILL,
+                   (unsigned long long)n * MIN2(fc->window_size, n));
+
+  free_dp_matrices_banded(fc);
+  free(q5);
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_PF_POST, fc->auxdata);
+
+  return free_energy;
+}
+
+
 PUBLIC vrna_dimer_pf_t
 vrna_pf_dimer(vrna_fold_compound_t  *fc,
               char                  *structure)
@@ -231,7 +387,11 @@ vrna_pf_dimer(vrna_fold_compound_t  *fc,
   if (fc->stat_cb)
     fc->stat_cb(VRNA_STATUS_PF_PRE, fc->auxdata);
 
-  if (!fill_arrays(fc)) {
+  vrna_timing_start(fc->timing, VRNA_TIMING_FILL);
+
+  if (!fill_arrays(fc, NULL, NULL)) {
+    vrna_timing_stop(fc->timing, VRNA_TIMING_FILL, 0);
+
     X.FA    = X.FB = X.FAB = X.F0AB = (float)(INF / 100.);
     X.FcAB  = 0;
 
@@ -244,6 +404,10 @@ vrna_pf_dimer(vrna_fold_compound_t  *fc,
     return X;
   }
 
+  vrna_timing_stop(fc->timing,
+                   VRNA_TIMING_FILL,
+                   (unsigned long long)n * (n + 1) / 2);
+
   /* call user-defined recursion status callback function */
   if (fc->stat_cb)
     fc->stat_cb(VRNA_STATUS_PF_POST, fc->auxdata);
@@ -326,6 +490,36 @@ vrna_pf_dimer(vrna_fold_compound_t  *fc,
 }
 
 
+PUBLIC float *
+vrna_pf_prefix(vrna_fold_compound_t *fc)
+{
+  float *energies = NULL;
+
+  if (fc) {
+    energies = (float *)vrna_alloc(sizeof(float) * (fc->length + 1));
+
+    if (!pf_prefixes(fc, &store_prefix_energy, (void *)energies)) {
+      free(energies);
+      energies = NULL;
+    }
+  }
+
+  return energies;
+}
+
+
+PUBLIC int
+vrna_pf_prefix_cb(vrna_fold_compound_t    *fc,
+                  vrna_pf_prefix_callback *cb,
+                  void                    *data)
+{
+  if ((fc) && (cb))
+    return pf_prefixes(fc, cb, data);
+
+  return 0;
+}
+
+
 PUBLIC int
 vrna_pf_float_precision(void)
 {
@@ -339,39 +533,47 @@ vrna_pf_float_precision(void)
  #################################
  */
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc)
+fill_arrays(vrna_fold_compound_t    *fc,
+            vrna_pf_prefix_callback *cb,
+            void                    *data)
 {
-  int                 n, i, j, k, ij, d, *my_iindx, *jindx, with_gquad, turn,
-                      with_ud;
-  FLT_OR_DBL          temp, Qmax, *q, *qb, *qm, *qm1, *q1k, *qln;
-  double              max_real;
+  int                 n, i, j, k, ij, d, *my_iindx, with_gquad, turn, with_ud, concurrent,
+                      status;
+  FLT_OR_DBL          *q, *qb, *q1k, *qln;
   vrna_ud_t           *domains_up;
   vrna_md_t           *md;
   vrna_mx_pf_t        *matrices;
   vrna_mx_pf_aux_el_t aux_mx_el;
   vrna_mx_pf_aux_ml_t aux_mx_ml;
+  vrna_mx_pf_aux_il_t aux_mx_il;
   vrna_exp_param_t    *pf_params;
 
   n           = fc->length;
   my_iindx    = fc->iindx;
-  jindx       = fc->jindx;
   matrices    = fc->exp_matrices;
   pf_params   = fc->exp_params;
   domains_up  = fc->domains_up;
   q           = matrices->q;
   qb          = matrices->qb;
-  qm          = matrices->qm;
-  qm1         = matrices->qm1;
   q1k         = matrices->q1k;
   qln         = matrices->qln;
   md          = &(pf_params->model_details);
   with_gquad  = md->gquad;
   turn        = md->min_loop_size;
+  concurrent  = 0;
 
   with_ud = (domains_up && domains_up->exp_energy_cb && (!(fc->type == VRNA_FC_TYPE_COMPARATIVE)));
-  Qmax    = 0;
 
-  max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+#ifdef _OPENMP
+  /*
+   *  decompose the segments of each column in parallel if requested. Auxiliary
+   *  grammar extensions and unstructured domains keep state of their own, so
+   *  we stick to the serial recursions for them
+   */
+  concurrent = ((fc->num_threads != 1) &&
+                (!fc->aux_grammar) &&
+                (!(domains_up && domains_up->exp_energy_cb))) ? 1 : 0;
+#endif
 
   if (with_ud && domains_up->exp_prod_cb)
     domains_up->exp_prod_cb(fc, domains_up->data);
@@ -399,9 +601,10 @@ fill_arrays(vrna_fold_compound_t *fc)
     }
   }
 
-  /* init auxiliary arrays for fast exterior/multibranch loops */
+  /* init auxiliary arrays for fast exterior/multibranch/interior loops */
   aux_mx_el = vrna_exp_E_ext_fast_init(fc);
   aux_mx_ml = vrna_exp_E_ml_fast_init(fc);
+  aux_mx_il = vrna_exp_E_int_loop_fast_init(fc);
 
   /*array initialization ; qb,qm,q
    * qb,qm,q (i,j) are stored as ((n+1-i)*(n-i) div 2 + n+1-j */
@@ -412,69 +615,371 @@ fill_arrays(vrna_fold_compound_t *fc)
       qb[ij]  = 0.0;
     }
 
-  for (j = turn + 2; j <= n; j++) {
-    for (i = j - turn - 1; i >= 1; i--) {
-      ij = my_iindx[i] - j;
+#ifdef _OPENMP
+  if (concurrent)
+    status = fill_arrays_concurrent(fc, fc->num_threads, aux_mx_el, aux_mx_ml, aux_mx_il, cb, data);
+  else
+#endif
+  status = fill_arrays_columns(fc, aux_mx_el, aux_mx_ml, aux_mx_il, cb, data);
+
+  /* prefill linear qln, q1k arrays */
+  if ((status) && (q1k && qln)) {
+    for (k = 1; k <= n; k++) {
+      q1k[k]  = q[my_iindx[1] - k];
+      qln[k]  = q[my_iindx[k] - n];
+    }
+    q1k[0]      = 1.0;
+    qln[n + 1]  = 1.0;
+  }
+
+  /* free memory occupied by auxiliary arrays for fast exterior/multibranch/interior loops */
+  vrna_exp_E_int_loop_fast_free(aux_mx_il);
+  vrna_exp_E_ml_fast_free(aux_mx_ml);
+  vrna_exp_E_ext_fast_free(aux_mx_el);
 
-      qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
+  return status;
+}
 
-      /* Multibranch loop */
-      qm[ij] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
 
-      if (qm1) {
-        temp = vrna_exp_E_ml_fast_qqm(aux_mx_ml)[i]; /* for stochastic backtracking and circfold */
+/* fill DP matrices column-wise, i.e. in the order that requires a single rotation of helper arrays per column */
+PRIVATE int
+fill_arrays_columns(vrna_fold_compound_t    *fc,
+                    vrna_mx_pf_aux_el_t     aux_mx_el,
+                    vrna_mx_pf_aux_ml_t     aux_mx_ml,
+                    vrna_mx_pf_aux_il_t     aux_mx_il,
+                    vrna_pf_prefix_callback *cb,
+                    void                    *data)
+{
+  int         n, i, j, turn;
+  FLT_OR_DBL  qij, Qmax;
+  double      max_real;
 
-        /* apply auxiliary grammar rule for multibranch loop (M1) case */
-        if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp_m1))
-          temp += fc->aux_grammar->cb_aux_exp_m1(fc, i, j, fc->aux_grammar->data);
+  n     = fc->length;
+  turn  = fc->exp_params->model_details.min_loop_size;
+  Qmax  = 0;
 
-        qm1[jindx[j] + i] = temp;
-      }
+  max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
 
-      /* Exterior loop */
-      q[ij] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+  /* prefixes that are too short to form any base pair */
+  if (cb)
+    for (j = 1; (j <= turn + 1) && (j <= n); j++)
+      cb(j,
+         (-log(fc->exp_matrices->q[fc->iindx[1] - j]) - j * log(fc->exp_params->pf_scale)) *
+         fc->exp_params->kT / 1000.,
+         data);
 
-      /* apply auxiliary grammar rule (storage takes place in user-defined data structure */
-      if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp))
-        fc->aux_grammar->cb_aux_exp(fc, i, j, fc->aux_grammar->data);
+  for (j = turn + 2; j <= n; j++) {
+    for (i = j - turn - 1; i >= 1; i--) {
+      qij = decompose_segment(fc, i, j, aux_mx_el, aux_mx_ml, aux_mx_il);
 
-      if (q[ij] > Qmax) {
-        Qmax = q[ij];
+      if (qij > Qmax) {
+        Qmax = qij;
         if (Qmax > max_real / 10.)
-          vrna_message_warning("Q close to overflow: %d %d %g", i, j, q[ij]);
+          vrna_message_warning("Q close to overflow: %d %d %g", i, j, qij);
       }
 
-      if (q[ij] >= max_real) {
+      if (qij >= max_real) {
         vrna_message_warning("overflow while computing partition function for segment q[%d,%d]\n"
                              "use larger pf_scale", i, j);
 
-        vrna_exp_E_ml_fast_free(aux_mx_ml);
-        vrna_exp_E_ext_fast_free(aux_mx_el);
-
         return 0; /* failure */
       }
     }
 
+    if (cb)
+      prefix_column(fc, j, aux_mx_el, cb, data);
+
+    vrna_exp_E_int_loop_fast_update(fc, j, aux_mx_il);
+
     /* rotate auxiliary arrays */
     vrna_exp_E_ext_fast_rotate(aux_mx_el);
     vrna_exp_E_ml_fast_rotate(aux_mx_ml);
   }
 
-  /* prefill linear qln, q1k arrays */
-  if (q1k && qln) {
-    for (k = 1; k <= n; k++) {
-      q1k[k]  = q[my_iindx[1] - k];
-      qln[k]  = q[my_iindx[k] - n];
+  return 1;
+}
+
+
+/*
+ *  Report the ensemble free energy of the prefix [1, j]. All entries of column j,
+ *  except for the exterior loop ones, do not depend on nucleotides downstream of j.
+ *  Hence, we only re-evaluate the exterior loop part of column j as if the sequence
+ *  ended at position j, and restore the regular entries afterwards
+ */
+PRIVATE void
+prefix_column(vrna_fold_compound_t    *fc,
+              int                     j,
+              vrna_mx_pf_aux_el_t     aux_mx_el,
+              vrna_pf_prefix_callback *cb,
+              void                    *data)
+{
+  short         *S2;
+  unsigned int  length;
+  int           i, turn, *my_iindx;
+  FLT_OR_DBL    *q, *qb, *qb_lonely;
+  double        G;
+  vrna_md_t     *md;
+
+  length    = fc->length;
+  my_iindx  = fc->iindx;
+  q         = fc->exp_matrices->q;
+  qb        = fc->exp_matrices->qb;
+  md        = &(fc->exp_params->model_details);
+  turn      = md->min_loop_size;
+  S2        = fc->sequence_encoding2;
+  qb_lonely = NULL;
+
+  /*
+   *  without lonely pairs, pairs (i, j) that can only be stacked by an
+   *  enclosing pair (i - 1, j + 1) are not possible in the prefix
+   */
+  if (md->noLP) {
+    qb_lonely = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (j + 1));
+
+    for (i = j - turn - 1; i >= 1; i--)
+      if (!((i + 2 < j) && ((j - i - 2) > turn) && (md->pair[S2[i + 1]][S2[j - 1]]))) {
+        qb_lonely[i]        = qb[my_iindx[i] - j];
+        qb[my_iindx[i] - j] = 0.;
+      }
+  }
+
+  fc->length = j;
+
+  for (i = j - turn - 1; i >= 1; i--)
+    q[my_iindx[i] - j] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+
+  if (qb_lonely) {
+    for (i = j - turn - 1; i >= 1; i--)
+      if (qb_lonely[i] != 0.)
+        qb[my_iindx[i] - j] = qb_lonely[i];
+
+    free(qb_lonely);
+  }
+
+  G = (-log(q[my_iindx[1] - j]) - j * log(fc->exp_params->pf_scale)) *
+      fc->exp_params->kT /
+      1000.;
+
+  fc->length = length;
+
+  for (i = j - turn - 1; i >= 1; i--)
+    q[my_iindx[i] - j] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+
+  cb(j, (float)G, data);
+}
+
+
+PRIVATE int
+pf_prefixes(vrna_fold_compound_t    *fc,
+            vrna_pf_prefix_callback *cb,
+            void                    *data)
+{
+  int status;
+
+  if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_PF)) {
+    vrna_message_warning("vrna_pf_prefix@part_func.c: Failed to prepare vrna_fold_compound");
+    return 0;
+  }
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands > 1) ||
+      (fc->exp_params->model_details.circ) ||
+      (fc->hc->type == VRNA_HC_WINDOW)) {
+    vrna_message_warning("vrna_pf_prefix@part_func.c: "
+                         "Prefix predictions are only available for single, linear RNA sequences");
+    return 0;
+  }
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_PF_PRE, fc->auxdata);
+
+  /* call user-defined grammar pre-condition callback function */
+  if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+    fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_PRE, fc->aux_grammar->data);
+
+  vrna_timing_start(fc->timing, VRNA_TIMING_FILL);
+
+  status = fill_arrays(fc, cb, data);
+
+  vrna_timing_stop(fc->timing,
+                   VRNA_TIMING_FILL,
+                   (unsigned long long)fc->length * (fc->length + 1) / 2);
+
+  /* call user-defined recursion status callback function */
+  if (fc->stat_cb)
+    fc->stat_cb(VRNA_STATUS_PF_POST, fc->auxdata);
+
+  /* call user-defined grammar post-condition callback function */
+  if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+    fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_POST, fc->aux_grammar->data);
+
+  return status;
+}
+
+
+PRIVATE void
+store_prefix_energy(unsigned int  length,
+                    float         en,
+                    void          *data)
+{
+  ((float *)data)[length] = en;
+}
+
+
+#ifdef _OPENMP
+
+/*
+ *  Fill DP matrices column-by-column, but decompose all segments [i, j] of a
+ *  column concurrently. Each column is processed in three stages separated by
+ *  barriers: (i) the pair matrix entries that only depend on previous columns,
+ *  (ii) the exterior and multibranch loop parts with exactly one stem starting
+ *  at i, and (iii) the remaining decompositions that split [i, j] into two parts.
+ *  Apart from the column-wise helper arrays of the serial fill, no additional
+ *  memory is required. Each matrix entry is computed by exactly the same sequence
+ *  of floating point operations as in the serial fill, hence the result does not
+ *  depend on the number of threads.
+ */
+PRIVATE int
+fill_arrays_concurrent(vrna_fold_compound_t    *fc,
+                       int                     num_threads,
+                       vrna_mx_pf_aux_el_t     aux_mx_el,
+                       vrna_mx_pf_aux_ml_t     aux_mx_ml,
+                       vrna_mx_pf_aux_il_t     aux_mx_il,
+                       vrna_pf_prefix_callback *cb,
+                       void                    *data)
+{
+  int           n, i, j, ij, turn, *my_iindx, *jindx, status;
+  FLT_OR_DBL    qij, Qmax, *q, *qb, *qm, *qm1;
+  double        max_real;
+  vrna_mx_pf_t  *matrices;
+
+  n         = fc->length;
+  my_iindx  = fc->iindx;
+  jindx     = fc->jindx;
+  matrices  = fc->exp_matrices;
+  q         = matrices->q;
+  qb        = matrices->qb;
+  qm        = matrices->qm;
+  qm1       = matrices->qm1;
+  turn      = fc->exp_params->model_details.min_loop_size;
+  status    = 1;
+  Qmax      = 0;
+  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+
+  if (num_threads < 1)
+    num_threads = omp_get_max_threads();
+
+  /* prefixes that are too short to form any base pair */
+  if (cb)
+    for (j = 1; (j <= turn + 1) && (j <= n); j++)
+      cb(j,
+         (-log(q[my_iindx[1] - j]) - j * log(fc->exp_params->pf_scale)) *
+         fc->exp_params->kT / 1000.,
+         data);
+
+#pragma omp parallel num_threads(num_threads) private(i, j, ij, qij)
+  {
+    for (j = turn + 2; (j <= n) && (status); j++) {
+#pragma omp for schedule(dynamic, 8)
+      for (i = j - turn - 1; i >= 1; i--)
+        qb[my_iindx[i] - j] = decompose_pair(fc, i, j, aux_mx_ml, aux_mx_il);
+
+#pragma omp for schedule(dynamic, 8)
+      for (i = j - turn - 1; i >= 1; i--) {
+        (void)vrna_exp_E_ml_fast_stem(fc, i, j, aux_mx_ml);
+        (void)vrna_exp_E_ext_fast_stem(fc, i, j, aux_mx_el);
+      }
+
+#pragma omp for schedule(dynamic, 8)
+      for (i = j - turn - 1; i >= 1; i--) {
+        ij      = my_iindx[i] - j;
+        qm[ij]  = vrna_exp_E_ml_fast_split(fc, i, j, aux_mx_ml);
+
+        if (qm1)
+          qm1[jindx[j] + i] = vrna_exp_E_ml_fast_qqm(aux_mx_ml)[i]; /* for stochastic backtracking and circfold */
+
+        q[ij] = vrna_exp_E_ext_fast_split(fc, i, j, aux_mx_el);
+      }
+
+#pragma omp single
+      {
+        for (i = j - turn - 1; i >= 1; i--) {
+          qij = q[my_iindx[i] - j];
+
+          if (qij > Qmax) {
+            Qmax = qij;
+            if (Qmax > max_real / 10.)
+              vrna_message_warning("Q close to overflow: %d %d %g", i, j, qij);
+          }
+
+          if (qij >= max_real) {
+            vrna_message_warning("overflow while computing partition function for segment q[%d,%d]\n"
+                                 "use larger pf_scale", i, j);
+
+            status = 0; /* failure */
+            break;
+          }
+        }
+
+        if (status) {
+          if (cb)
+            prefix_column(fc, j, aux_mx_el, cb, data);
+
+          vrna_exp_E_int_loop_fast_update(fc, j, aux_mx_il);
+
+          /* rotate auxiliary arrays */
+          vrna_exp_E_ext_fast_rotate(aux_mx_el);
+          vrna_exp_E_ml_fast_rotate(aux_mx_ml);
+        }
+      }
     }
-    q1k[0]      = 1.0;
-    qln[n + 1]  = 1.0;
   }
 
-  /* free memory occupied by auxiliary arrays for fast exterior/multibranch loops */
-  vrna_exp_E_ml_fast_free(aux_mx_ml);
-  vrna_exp_E_ext_fast_free(aux_mx_el);
+  return status;
+}
 
-  return 1;
+
+#endif
+
+PRIVATE INLINE FLT_OR_DBL
+decompose_segment(vrna_fold_compound_t  *fc,
+                  int                   i,
+                  int                   j,
+                  vrna_mx_pf_aux_el_t   aux_mx_el,
+                  vrna_mx_pf_aux_ml_t   aux_mx_ml,
+                  vrna_mx_pf_aux_il_t   aux_mx_il)
+{
+  int           ij;
+  FLT_OR_DBL    temp;
+  vrna_mx_pf_t  *matrices;
+
+  ij        = fc->iindx[i] - j;
+  matrices  = fc->exp_matrices;
+
+  matrices->qb[ij] = decompose_pair(fc, i, j, aux_mx_ml, aux_mx_il);
+
+  /* Multibranch loop */
+  matrices->qm[ij] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
+
+  if (matrices->qm1) {
+    temp = vrna_exp_E_ml_fast_qqm(aux_mx_ml)[i]; /* for stochastic backtracking and circfold */
+
+    /* apply auxiliary grammar rule for multibranch loop (M1) case */
+    if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp_m1))
+      temp += fc->aux_grammar->cb_aux_exp_m1(fc, i, j, fc->aux_grammar->data);
+
+    matrices->qm1[fc->jindx[j] + i] = temp;
+  }
+
+  /* Exterior loop */
+  matrices->q[ij] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+
+  /* apply auxiliary grammar rule (storage takes place in user-defined data structure */
+  if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp))
+    fc->aux_grammar->cb_aux_exp(fc, i, j, fc->aux_grammar->data);
+
+  return matrices->q[ij];
 }
 
 
@@ -482,26 +987,25 @@ PRIVATE FLT_OR_DBL
 decompose_pair(vrna_fold_compound_t *fc,
                int                  i,
                int                  j,
-               vrna_mx_pf_aux_ml_t  aux_mx_ml)
+               vrna_mx_pf_aux_ml_t  aux_mx_ml,
+               vrna_mx_pf_aux_il_t  aux_mx_il)
 {
-  unsigned int  n;
   int           *jindx, *pscore;
   FLT_OR_DBL    contribution;
   double        kTn;
   vrna_hc_t     *hc;
 
   contribution  = 0.;
-  n             = fc->length;
   pscore        = (fc->type == VRNA_FC_TYPE_COMPARATIVE) ? fc->pscore : NULL;
   jindx         = fc->jindx;
   kTn           = fc->exp_params->kT / 10.;  /* kT in cal/mol */
   hc            = fc->hc;
 
-  if (hc->mx[j * n + i]) {
+  if (hc->matrix[jindx[j] + i]) {
     /* process hairpin loop(s) */
     contribution += vrna_exp_E_hp_loop(fc, i, j);
     /* process interior loop(s) */
-    contribution += vrna_exp_E_int_loop(fc, i, j);
+    contribution += vrna_exp_E_int_loop_fast(fc, i, j, aux_mx_il);
     /* process multibranch loop(s) */
     contribution += vrna_exp_E_mb_loop_fast(fc, i, j, aux_mx_ml);
 
@@ -828,3 +1332,210 @@ postprocess_circular(vrna_fold_compound_t *fc)
   matrices->qio = qio;
   matrices->qmo = qmo;
 }
+
+
+/*
+ *  Banded storage for global partition functions with limited base pair span,
+ *  i.e. keep all rows of the sliding window matrices instead of rotating them
+ */
+PRIVATE INLINE void
+allocate_dp_matrices_banded(vrna_fold_compound_t *fc)
+{
+  int           i, n, maxdist;
+  vrna_mx_pf_t  *mx;
+  vrna_hc_t     *hc;
+  vrna_sc_t     *sc;
+
+  n       = (int)fc->length;
+  maxdist = MIN2(fc->window_size, n);
+  mx      = fc->exp_matrices;
+  hc      = fc->hc;
+  sc      = fc->sc;
+
+  /* rows are addressed by absolute column index j, i.e. row[i][j] */
+  for (i = n; i > 0; i--) {
+    mx->qb_local[i]     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (maxdist + 2));
+    mx->qb_local[i]     -= i;
+    mx->qm_local[i]     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (maxdist + 2));
+    mx->qm_local[i]     -= i;
+    hc->matrix_local[i] = (unsigned char *)vrna_alloc(sizeof(unsigned char) * (maxdist + 2));
+    fc->ptype_local[i]  = (char *)vrna_alloc(sizeof(char) * (maxdist + 2));
+    fc->ptype_local[i]  -= i;
+
+    if (sc) {
+      if (sc->exp_energy_bp_local)
+        sc->exp_energy_bp_local[i] = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (maxdist + 2));
+
+      if (sc->exp_energy_up)
+        sc->exp_energy_up[i] = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (maxdist + 2));
+    }
+
+    make_ptypes_banded(fc, i);
+    vrna_hc_update(fc, i);
+    vrna_sc_update(fc, i, VRNA_OPTION_PF | VRNA_OPTION_WINDOW);
+  }
+}
+
+
+PRIVATE INLINE void
+free_dp_matrices_banded(vrna_fold_compound_t *fc)
+{
+  int           i, n;
+  vrna_mx_pf_t  *mx;
+  vrna_hc_t     *hc;
+  vrna_sc_t     *sc;
+
+  n   = (int)fc->length;
+  mx  = fc->exp_matrices;
+  hc  = fc->hc;
+  sc  = fc->sc;
+
+  for (i = 1; i <= n; i++) {
+    /* undo the offset of rows addressed by absolute column index */
+    mx->qb_local[i] += i;
+    free(mx->qb_local[i]);
+    mx->qb_local[i] = NULL;
+    mx->qm_local[i] += i;
+    free(mx->qm_local[i]);
+    mx->qm_local[i] = NULL;
+    free(hc->matrix_local[i]);
+    hc->matrix_local[i] = NULL;
+    fc->ptype_local[i] += i;
+    free(fc->ptype_local[i]);
+    fc->ptype_local[i] = NULL;
+
+    if (sc) {
+      if (sc->exp_energy_bp_local) {
+        free(sc->exp_energy_bp_local[i]);
+        sc->exp_energy_bp_local[i] = NULL;
+      }
+
+      if (sc->exp_energy_up) {
+        free(sc->exp_energy_up[i]);
+        sc->exp_energy_up[i] = NULL;
+      }
+    }
+  }
+}
+
+
+PRIVATE INLINE void
+make_ptypes_banded(vrna_fold_compound_t  *fc,
+                   int                   i)
+{
+  char      **ptype;
+  short     *S;
+  int       j, n, maxdist;
+  vrna_md_t *md;
+
+  ptype   = fc->ptype_local;
+  md      = &(fc->exp_params->model_details);
+  S       = fc->sequence_encoding2;
+  n       = (int)fc->length;
+  maxdist = MIN2(fc->window_size, md->max_bp_span);
+
+  for (j = i; j <= MIN2(i + maxdist, n); j++)
+    ptype[i][j] = (char)md->pair[S[i]][S[j]];
+}
+
+
+/*
+ *  fill qb and qm column-wise within the band, and the partition
+ *  functions q5[j] of the prefixes [1:j] of the entire sequence
+ */
+PRIVATE int
+fill_arrays_banded(vrna_fold_compound_t *fc,
+                   FLT_OR_DBL           *q5)
+{
+  short               *S1, *S2, s5, s3;
+  unsigned int        type;
+  int                 n, i, j, k, turn, maxdist, *hc_up;
+  FLT_OR_DBL          qbt1, stem, Qmax, **qb, **qm, *scale;
+  double              max_real;
+  vrna_exp_param_t    *pf_params;
+  vrna_md_t           *md;
+  vrna_hc_t           *hc;
+  vrna_sc_t           *sc;
+  vrna_mx_pf_aux_ml_t aux_mx_ml;
+
+  n         = (int)fc->length;
+  pf_params = fc->exp_params;
+  md        = &(pf_params->model_details);
+  turn      = md->min_loop_size;
+  maxdist   = MIN2(fc->window_size, n);
+  S1        = fc->sequence_encoding;
+  S2        = fc->sequence_encoding2;
+  hc        = fc->hc;
+  sc        = fc->sc;
+  hc_up     = hc->up_ext;
+  qb        = fc->exp_matrices->qb_local;
+  qm        = fc->exp_matrices->qm_local;
+  scale     = fc->exp_matrices->scale;
+  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  Qmax      = 0.;
+
+  aux_mx_ml = vrna_exp_E_ml_fast_init(fc);
+
+  q5[0] = 1.;
+
+  for (j = 1; j <= n; j++) {
+    for (i = j - turn - 1; i >= MAX2(1, j - maxdist + 1); i--) {
+      qbt1 = 0.;
+
+      if (hc->matrix_local[i][j - i]) {
+        qbt1  += vrna_exp_E_hp_loop(fc, i, j);
+        qbt1  += vrna_exp_E_int_loop(fc, i, j);
+        qbt1  += vrna_exp_E_mb_loop_fast(fc, i, j, aux_mx_ml);
+      }
+
+      qb[i][j] = qbt1;
+      qm[i][j] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
+    }
+
+    /* exterior loop of the prefix [1:j], either j is unpaired or pairs with some k */
+    q5[j] = 0.;
+
+    if (hc_up[j]) {
+      qbt1 = q5[j - 1] * scale[1];
+
+      if ((sc) && (sc->exp_energy_up))
+        qbt1 *= sc->exp_energy_up[j][1];
+
+      q5[j] += qbt1;
+    }
+
+    for (k = j - turn - 1; k >= MAX2(1, j - maxdist + 1); k--) {
+      if ((qb[k][j] == 0.) ||
+          (!(hc->matrix_local[k][j - k] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP)))
+        continue;
+
+      type  = vrna_get_ptype_md(S2[k], S2[j], md);
+      s5    = (k > 1) ? S1[k - 1] : -1;
+      s3    = (j < n) ? S1[j + 1] : -1;
+      stem  = qb[k][j] * vrna_exp_E_ext_stem(type, s5, s3, pf_params);
+
+      q5[j] += q5[k - 1] * stem;
+    }
+
+    if (q5[j] > Qmax) {
+      Qmax = q5[j];
+      if (Qmax > max_real / 10.)
+        vrna_message_warning("Q close to overflow: %d %d %g", 1, j, q5[j]);
+    }
+
+    if (q5[j] >= max_real) {
+      vrna_message_warning("overflow while computing partition function for segment q[1,%d]\n"
+                           "use larger pf_scale", j);
+
+      vrna_exp_E_ml_fast_free(aux_mx_ml);
+
+      return 0;
+    }
+
+    vrna_exp_E_ml_fast_rotate(aux_mx_ml);
+  }
+
+  vrna_exp_E_ml_fast_free(aux_mx_ml);
+
+  return 1;
+}
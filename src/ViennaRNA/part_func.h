@@ -127,6 +127,10 @@ struct vrna_dimer_pf_s {
  *        or numerical over-/underflow. In the latter case, a corresponding warning
  *        will be issued to @p stdout.
  *
+ *  @note For single sequences, whose #vrna_fold_compound_t has been created with option
+ *        #VRNA_OPTION_WINDOW, the partition function with a maximum base pair span of
+ *        #vrna_md_t.window_size is computed in banded DP matrices by vrna_pf_banded().
+ *
  *  @see #vrna_fold_compound_t, vrna_fold_compound(), vrna_pf_fold(), vrna_pf_circfold(),
  *        vrna_fold_compound_comparative(), vrna_pf_alifold(), vrna_pf_circalifold(),
  *        vrna_db_from_probs(), vrna_exp_params(), vrna_aln_pinfo()
@@ -141,6 +145,34 @@ vrna_pf(vrna_fold_compound_t  *vc,
         char                  *structure);
 
 
+/**
+ *  @brief Global partition function with limited base pair span using banded DP matrices
+ *
+ *  Computes the partition function of the entire sequence, where no base pair
+ *  spans more than #vrna_md_t.window_size nucleotides, i.e. the same ensemble
+ *  free energy as vrna_pf() with #vrna_md_t.max_bp_span set accordingly. In
+ *  contrast to vrna_pf(), which stores full triangular DP matrices, this function
+ *  keeps all rows of the (banded) sliding window matrices in memory. Thus, it
+ *  requires @f$ \mathcal{O}(n \cdot w) @f$ instead of @f$ \mathcal{O}(n^2) @f$
+ *  memory for a sequence of length @f$ n @f$ and window size @f$ w @f$.
+ *
+ *  The #vrna_fold_compound_t must be created with option #VRNA_OPTION_WINDOW.
+ *  vrna_pf() automatically calls this function for such fold compounds.
+ *  Base pair probabilities are not computed, use vrna_probs_window() instead.
+ *  Circular RNAs, G-Quadruplexes, unstructured domains, and hard or soft
+ *  constraint callbacks are not supported.
+ *
+ *  @see  vrna_pf(), vrna_mfe_banded(), vrna_probs_window(), #VRNA_OPTION_WINDOW
+ *
+ *  @param  fc        The #vrna_fold_compound_t created with option #VRNA_OPTION_WINDOW
+ *  @param  structure Unused, since no base pair probabilities are computed (Maybe NULL)
+ *  @return           The ensemble free energy @f$G = -RT \cdot \log(Q) @f$ in kcal/mol
+ */
+float
+vrna_pf_banded(vrna_fold_compound_t  *fc,
+               char                  *structure);
+
+
 /**
  *  @brief  Calculate partition function and base pair probabilities of
  *          nucleic acid/nucleic acid dimers
@@ -321,6 +353,74 @@ vrna_pf_co_fold(const char  *seq,
 /* End simplified global interface */
 /**@}*/
 
+/**
+ *  @name Partition function for all 5' prefixes of a sequence
+ *  @{
+ */
+
+/**
+ *  @brief  Callback for partition function computations of 5' prefixes
+ *
+ *  @callback
+ *  @parblock
+ *  This function will be called for each 5' prefix of the sequence in a prefix partition
+ *  function computation, in order of increasing prefix length.
+ *  @endparblock
+ *  @see vrna_pf_prefix_cb()
+ *
+ *  @param length   The length of the prefix, i.e. the number of transcribed nucleotides
+ *  @param en       The ensemble free energy of the prefix in kcal/mol
+ *  @param data     Some arbitrary data pointer passed through by the function executing the callback
+ */
+typedef void (vrna_pf_prefix_callback)(unsigned int length,
+                                       float        en,
+                                       void         *data);
+
+
+/**
+ *  @brief  Compute the ensemble free energy of each 5' prefix of an RNA sequence
+ *
+ *  This is the partition function counterpart of vrna_mfe_prefix(). The DP matrices are
+ *  filled column-wise only once, and the exterior loop entries of each new column are
+ *  evaluated a second time as if the sequence ended at that column. Hence, the ensemble
+ *  free energies of all @f$ n @f$ prefixes are obtained in @f$ \mathcal{O}(n^3) @f$.
+ *
+ *  @note Only single, linear RNA sequences are supported. All prefixes are computed with
+ *  the Boltzmann factor scaling (#vrna_exp_param_t.pf_scale) of the entire sequence. Base
+ *  pair probabilities are not computed.
+ *
+ *  @see vrna_pf_prefix_cb(), vrna_mfe_prefix(), vrna_pf()
+ *
+ *  @param  fc  The fold compound
+ *  @return     An array of @f$ n + 1 @f$ ensemble free energies in kcal/mol, where entry
+ *              @f$ k @f$ corresponds to the prefix of length @f$ k @f$, or @em NULL on error
+ */
+float *
+vrna_pf_prefix(vrna_fold_compound_t *fc);
+
+
+/**
+ *  @brief  Compute the ensemble free energy of each 5' prefix of an RNA sequence (callback variant)
+ *
+ *  Same as vrna_pf_prefix() but passes the ensemble free energy of each prefix to the
+ *  callback @p cb as soon as the corresponding column of the DP matrices is filled.
+ *
+ *  @see vrna_pf_prefix(), #vrna_pf_prefix_callback
+ *
+ *  @param  fc    The fold compound
+ *  @param  cb    The callback that receives the prefix ensemble free energies
+ *  @param  data  An arbitrary data pointer passed through to the callback
+ *  @return       1 on success, 0 otherwise
+ */
+int
+vrna_pf_prefix_cb(vrna_fold_compound_t    *fc,
+                  vrna_pf_prefix_callback *cb,
+                  void                    *data);
+
+
+/* End prefix interface */
+/**@}*/
+
 /**@}*/
 
 /*
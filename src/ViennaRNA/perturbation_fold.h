@@ -117,6 +117,7 @@ typedef void (*progress_callback)(int     iteration,
  *  The minimization can be performed by makeing use of a custom gradient descent implementation or using one of the minimizing algorithms provided by the GNU Scientific Library.
  *  All algorithms require the evaluation of the gradient of the objective function, which includes the evaluation of conditional pairing probabilites.
  *  Since an exact evaluation is expensive, the probabilities can also be estimated from sampling by setting an appropriate sample size.
+ *  Samples are drawn from the random number generator attached to @p vc (see vrna_fold_compound_rng_seed()), if any.
  *  The found vector of perturbation energies will be stored in the array epsilon.
  *  The progress of the minimization process can be tracked by implementing and passing a callback function.
  *
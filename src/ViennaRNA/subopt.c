@@ -863,6 +863,9 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
     threshold = INF - EMAX;
   }
 
+  /* enumeration of suboptimal structures is accounted for as backtracking */
+  vrna_timing_start(vc->timing, VRNA_TIMING_BACKTRACK);
+
   /* init env data structure */
   env             = (subopt_env *)vrna_alloc(sizeof(subopt_env));
   env->Stack      = NULL;
@@ -948,6 +951,8 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
     free_state_node(state);                     /* free the current state */
   } /* end of while (1) */
 
+  vrna_timing_stop(vc->timing, VRNA_TIMING_BACKTRACK, (unsigned long long)count * length);
+
   /* cleanup memory */
   free(env);
 }
@@ -1018,7 +1023,7 @@ scan_interval(vrna_fold_compound_t  *vc,
   fM2 = vc->matrices->fM2;
 
   hc                = vc->hc;
-  hard_constraints  = hc->mx;
+  hard_constraints  = hc->matrix;
 
   sc = vc->sc;
 
@@ -1076,7 +1081,7 @@ scan_interval(vrna_fold_compound_t  *vc,
         fork_state(i, j - 1, state, P->MLbase, array_flag, env);
     }
 
-    hc_decompose = hard_constraints[length * i + j];
+    hc_decompose = hard_constraints[indx[j] + i];
 
     if (hc_decompose & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
       /* i,j may pair */
@@ -1152,7 +1157,7 @@ scan_interval(vrna_fold_compound_t  *vc,
 
         k1j = indx[j] + k + 1;
 
-        if ((hard_constraints[length * j + k + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) &&
+        if ((hard_constraints[k1j] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) &&
             (fML[indx[k] + i] != INF) &&
             (c[k1j] != INF)) {
           short s5, s3;
@@ -1223,7 +1228,7 @@ scan_interval(vrna_fold_compound_t  *vc,
             repeat_gquad(vc, k + 1, j, state, element_energy, 0, best_energy, threshold, env);
         }
 
-        if ((hard_constraints[length * j + k + 1] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) &&
+        if ((hard_constraints[k1j] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) &&
             (c[k1j] != INF)) {
           int s5, s3;
 
@@ -1327,7 +1332,7 @@ scan_interval(vrna_fold_compound_t  *vc,
         }
       }
 
-      if ((hard_constraints[length * j + k] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
+      if ((hard_constraints[indx[j] + k] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
           (f5[k - 1] != INF) &&
           (c[kj] != INF)) {
         type = vrna_get_ptype(kj, ptype);
@@ -1375,7 +1380,7 @@ scan_interval(vrna_fold_compound_t  *vc,
         repeat_gquad(vc, 1, j, state, element_energy, 0, best_energy, threshold, env);
     }
 
-    if ((hard_constraints[length + j] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
+    if ((hard_constraints[kj] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
         (c[kj] != INF)) {
       type  = vrna_get_ptype(kj, ptype);
       s5    = -1;
@@ -1470,7 +1475,7 @@ scan_interval(vrna_fold_compound_t  *vc,
 
           kl = indx[l] + k;         /* just confusing these indices ;-) */
 
-          if ((hard_constraints[length * k + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) &&
+          if ((hard_constraints[kl] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) &&
               (c[kl] != INF)) {
             type = rtype[vrna_get_ptype(kl, ptype)];
 
@@ -1493,7 +1498,7 @@ scan_interval(vrna_fold_compound_t  *vc,
                 if (hc->up_int[q + 1] < (j - q + k - 1))
                   break;
 
-                if ((hard_constraints[length * p + q] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) &&
+                if ((hard_constraints[indx[q] + p] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) &&
                     (c[indx[q] + p] != INF)) {
                   type_2 = rtype[vrna_get_ptype(indx[q] + p, ptype)];
 
@@ -1635,7 +1640,7 @@ scan_interval(vrna_fold_compound_t  *vc,
         }
       }
 
-      if ((hard_constraints[length * i + k] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
+      if ((hard_constraints[indx[k] + i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
           (fc[k + 1] != INF) &&
           (c[ik] != INF)) {
         type = vrna_get_ptype(ik, ptype);
@@ -1672,7 +1677,7 @@ scan_interval(vrna_fold_compound_t  *vc,
       if (ggg[ik] + best_energy <= threshold)
         repeat_gquad(vc, i, se[so[0]], state, 0, 0, best_energy, threshold, env);
 
-    if ((hard_constraints[length * i + se[so[0]]] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
+    if ((hard_constraints[ik] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
         (c[ik] != INF)) {
       type  = vrna_get_ptype(ik, ptype);
       s3    = -1;
@@ -1739,7 +1744,7 @@ scan_interval(vrna_fold_compound_t  *vc,
         }
       }
 
-      if ((hard_constraints[length * j + k] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
+      if ((hard_constraints[indx[j] + k] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
           (fc[k - 1] != INF) &&
           (c[kj] != INF)) {
         type            = vrna_get_ptype(kj, ptype);
@@ -1777,7 +1782,7 @@ scan_interval(vrna_fold_compound_t  *vc,
       if (ggg[kj] + best_energy <= threshold)
         repeat_gquad(vc, ss[so[1]], j, state, 0, 0, best_energy, threshold, env);
 
-    if ((hard_constraints[length * ss[so[1]] + j] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
+    if ((hard_constraints[kj] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
         (c[kj] != INF)) {
       type  = vrna_get_ptype(kj, ptype);
       s5    = -1;
@@ -1910,7 +1915,7 @@ repeat(vrna_fold_compound_t *vc,
   register int  mm;
   register int  no_close, type, type_2;
   char          *ptype;
-  unsigned int  n, *sn, *so, *ss, *se;
+  unsigned int  *sn, *so, *ss, *se;
   int           element_energy;
   int           *fc, *c, *fML, *fM1, *ggg;
   int           rt, *indx, *rtype, noGUclosure, noLP, with_gquad, dangle_model, turn;
@@ -1918,7 +1923,6 @@ repeat(vrna_fold_compound_t *vc,
   vrna_hc_t     *hc;
   vrna_sc_t     *sc;
 
-  n     = vc->length;
   S1    = vc->sequence_encoding;
   ptype = vc->ptype;
   indx  = vc->jindx;
@@ -1954,11 +1958,11 @@ repeat(vrna_fold_compound_t *vc,
 
   no_close = (((type == 3) || (type == 4)) && noGUclosure);
 
-  if (hc->mx[n * i + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+  if (hc->matrix[ij] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
     if (noLP) {
       /* always consider the structure with additional stack */
       if (i + turn + 2 < j) {
-        if (hc->mx[n * (i + 1) + j - 1] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+        if (hc->matrix[indx[j - 1] + i + 1] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
           type_2  = rtype[vrna_get_ptype(indx[j - 1] + i + 1, ptype)];
           energy  = 0;
 
@@ -1999,7 +2003,7 @@ repeat(vrna_fold_compound_t *vc,
   best_energy += part_energy; /* energy of current structural element */
   best_energy += temp_energy; /* energy from unpushed interval */
 
-  if (hc->mx[n * i + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+  if (hc->matrix[ij] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
     for (p = i + 1; p <= MIN2(j - 2 - turn, i + MAXLOOP + 1); p++) {
       int minq = j - i + p - MAXLOOP - 2;
       if (minq < p + 1 + turn)
@@ -2016,7 +2020,7 @@ repeat(vrna_fold_compound_t *vc,
         if ((noLP) && (p == i + 1) && (q == j - 1))
           continue;
 
-        if (!(hc->mx[n * p + q] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC))
+        if (!(hc->matrix[indx[q] + p] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC))
           continue;
 
         if (c[indx[q] + p] == INF)
@@ -2070,7 +2074,7 @@ repeat(vrna_fold_compound_t *vc,
 
   if (sn[i] != sn[j]) {
     /*look in fc*/
-    if ((hc->mx[n * i + j] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
+    if ((hc->matrix[ij] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) &&
         (fc[i + 1] != INF) &&
         (fc[j - 1] != INF)) {
       rt = rtype[type];
@@ -2101,7 +2105,7 @@ repeat(vrna_fold_compound_t *vc,
   mm  = P->MLclosing;
   rt  = rtype[type];
 
-  if ((hc->mx[n * i + j] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) &&
+  if ((hc->matrix[ij] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) &&
       ((vc->strands < 2) || ((i != se[so[0]]) && (j != ss[so[1]])))) {
     element_energy = mm;
     switch (dangle_model) {
@@ -2150,7 +2154,7 @@ repeat(vrna_fold_compound_t *vc,
   }
 
   if (sn[i] == sn[j]) {
-    if ((hc->mx[n * i + j] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP) &&
+    if ((hc->matrix[ij] & VRNA_CONSTRAINT_CONTEXT_HP_LOOP) &&
         (!no_close)) {
 
       element_energy = vrna_E_hp_loop(vc, i, j);
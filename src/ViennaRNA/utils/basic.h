@@ -28,6 +28,7 @@
 #include <stdarg.h>
 
 #include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/utils/rng.h>
 
 /* two helper macros to indicate whether a function should be exported in
  * the library or stays hidden */
@@ -157,6 +158,21 @@ vrna_realloc(void     *p,
 
 #endif
 
+/**
+ *  @brief Get the total number of bytes requested by the calling thread
+ *
+ *  This counter is increased by each call to vrna_alloc() and vrna_realloc()
+ *  and never decreases. Thus, the difference of two subsequent calls yields the
+ *  number of bytes that have been requested in between.
+ *
+ *  @see  vrna_timing_start(), vrna_timing_stop()
+ *
+ *  @return   The number of bytes requested by the calling thread so far
+ */
+unsigned long long
+vrna_alloc_bytes(void);
+
+
 /**
  *  @brief  Initialize seed for random number generator
  */
@@ -164,6 +180,16 @@ void
 vrna_init_rand(void);
 
 
+/**
+ *  @brief  Initialize the random number generator with a pre-defined seed
+ *
+ *  @see  vrna_init_rand(), vrna_urn(), vrna_rng_init()
+ *  @param  seed  The seed for the random number generator
+ */
+void
+vrna_init_rand_seed(unsigned int seed);
+
+
 /**
  * @brief Current 48 bit random number
  *
@@ -177,7 +203,11 @@ extern unsigned short xsubi[3];
 /**
  *  @brief get a random number from [0..1]
  *
- *  @see  vrna_int_urn(), vrna_init_rand()
+ *  If a random number generator is bound to the calling thread via
+ *  vrna_rng_thread_set(), the random number is drawn from that generator.
+ *  Otherwise, the process-wide generator is used.
+ *
+ *  @see  vrna_int_urn(), vrna_init_rand(), vrna_rng_thread_set()
  *  @note Usually implemented by calling @e erand48().
  *  @return   A random number in range [0..1]
  */
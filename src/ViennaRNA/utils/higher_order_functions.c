@@ -4,10 +4,22 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
+#include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/cpu.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
+
+/*
+ *  Portable fallback that uses the compiler's generic vector extensions.
+ *  Both, GCC and clang, lower these to whatever SIMD instruction set the
+ *  library has been compiled for (or to plain scalar code otherwise).
+ */
+#if defined(__GNUC__) || defined(__clang__)
+# define VRNA_WITH_VECTOR_EXTENSION 1
+#endif
 
 
 typedef int (proto_fun_zip_reduce)(const int  *a,
@@ -15,6 +27,17 @@ typedef int (proto_fun_zip_reduce)(const int  *a,
                                    int        size);
 
 
+typedef int (proto_fun_zip_reduce_idx)(const int  *a,
+                                       const int  *b,
+                                       int        size,
+                                       int        *idx);
+
+
+typedef FLT_OR_DBL (proto_fun_zip_mult_reduce)(const FLT_OR_DBL *a,
+                                               const FLT_OR_DBL *b,
+                                               int              size);
+
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -25,12 +48,63 @@ static int zip_add_min_dispatcher(const int *a,
                                   int       size);
 
 
+static int zip_add_min_idx_dispatcher(const int *a,
+                                      const int *b,
+                                      int       size,
+                                      int       *idx);
+
+
+static FLT_OR_DBL zip_mult_sum_dispatcher(const FLT_OR_DBL  *a,
+                                          const FLT_OR_DBL  *b,
+                                          int               size);
+
+
+static FLT_OR_DBL zip_mult_sum_rev_dispatcher(const FLT_OR_DBL  *a,
+                                              const FLT_OR_DBL  *b,
+                                              int               size);
+
+
 static int
 fun_zip_add_min_default(const int *e1,
                         const int *e2,
                         int       count);
 
 
+static int
+fun_zip_add_min_idx_default(const int *e1,
+                            const int *e2,
+                            int       count,
+                            int       *idx);
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_default(const FLT_OR_DBL *e1,
+                         const FLT_OR_DBL *e2,
+                         int              count);
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_rev_default(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count);
+
+
+#if VRNA_WITH_VECTOR_EXTENSION
+static int
+fun_zip_add_min_vector(const int  *e1,
+                       const int  *e2,
+                       int        count);
+
+
+static int
+fun_zip_add_min_idx_vector(const int  *e1,
+                           const int  *e2,
+                           int        count,
+                           int        *idx);
+
+
+#endif
+
 #if VRNA_WITH_SIMD_AVX512
 int
 vrna_fun_zip_add_min_avx512(const int *e1,
@@ -38,6 +112,53 @@ vrna_fun_zip_add_min_avx512(const int *e1,
                             int       count);
 
 
+int
+vrna_fun_zip_add_min_idx_avx512(const int *e1,
+                                const int *e2,
+                                int       count,
+                                int       *idx);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx512(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx512(const FLT_OR_DBL *e1,
+                                 const FLT_OR_DBL *e2,
+                                 int              count);
+
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+int
+vrna_fun_zip_add_min_avx2(const int *e1,
+                          const int *e2,
+                          int       count);
+
+
+int
+vrna_fun_zip_add_min_idx_avx2(const int *e1,
+                              const int *e2,
+                              int       count,
+                              int       *idx);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count);
+
+
 #endif
 
 #if VRNA_WITH_SIMD_SSE41
@@ -47,10 +168,35 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
                            int        count);
 
 
+int
+vrna_fun_zip_add_min_idx_sse41(const int  *e1,
+                               const int  *e2,
+                               int        count,
+                               int        *idx);
+
+
 #endif
 
+#if VRNA_WITH_SIMD_SSE2
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_sse2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count);
 
-static proto_fun_zip_reduce *fun_zip_add_min = &zip_add_min_dispatcher;
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_sse2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count);
+
+
+#endif
+
+
+static proto_fun_zip_reduce       *fun_zip_add_min      = &zip_add_min_dispatcher;
+static proto_fun_zip_reduce_idx   *fun_zip_add_min_idx  = &zip_add_min_idx_dispatcher;
+static proto_fun_zip_mult_reduce  *fun_zip_mult_sum     = &zip_mult_sum_dispatcher;
+static proto_fun_zip_mult_reduce  *fun_zip_mult_sum_rev = &zip_mult_sum_rev_dispatcher;
 
 
 /*
@@ -61,14 +207,20 @@ static proto_fun_zip_reduce *fun_zip_add_min = &zip_add_min_dispatcher;
 PUBLIC void
 vrna_fun_dispatch_disable(void)
 {
-  fun_zip_add_min = &fun_zip_add_min_default;
+  fun_zip_add_min       = &fun_zip_add_min_default;
+  fun_zip_add_min_idx   = &fun_zip_add_min_idx_default;
+  fun_zip_mult_sum      = &fun_zip_mult_sum_default;
+  fun_zip_mult_sum_rev  = &fun_zip_mult_sum_rev_default;
 }
 
 
 PUBLIC void
 vrna_fun_dispatch_enable(void)
 {
-  fun_zip_add_min = &zip_add_min_dispatcher;
+  fun_zip_add_min       = &zip_add_min_dispatcher;
+  fun_zip_add_min_idx   = &zip_add_min_idx_dispatcher;
+  fun_zip_mult_sum      = &zip_mult_sum_dispatcher;
+  fun_zip_mult_sum_rev  = &zip_mult_sum_rev_dispatcher;
 }
 
 
@@ -81,6 +233,34 @@ vrna_fun_zip_add_min(const int  *e1,
 }
 
 
+PUBLIC int
+vrna_fun_zip_add_min_idx(const int  *e1,
+                         const int  *e2,
+                         int        count,
+                         int        *idx)
+{
+  return (*fun_zip_add_min_idx)(e1, e2, count, idx);
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum(const FLT_OR_DBL  *e1,
+                      const FLT_OR_DBL  *e2,
+                      int               count)
+{
+  return (*fun_zip_mult_sum)(e1, e2, count);
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev(const FLT_OR_DBL  *e1,
+                          const FLT_OR_DBL  *e2,
+                          int               count)
+{
+  return (*fun_zip_mult_sum_rev)(e1, e2, count);
+}
+
+
 /*
  #################################
  # STATIC helper functions below #
@@ -103,6 +283,14 @@ zip_add_min_dispatcher(const int  *a,
 
 #endif
 
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_min = &vrna_fun_zip_add_min_avx2;
+    goto exec_fun_zip_add_min;
+  }
+
+#endif
+
 #if VRNA_WITH_SIMD_SSE41
   if (features & VRNA_CPU_SIMD_SSE41) {
     fun_zip_add_min = &vrna_fun_zip_add_min_sse41;
@@ -111,7 +299,11 @@ zip_add_min_dispatcher(const int  *a,
 
 #endif
 
+#if VRNA_WITH_VECTOR_EXTENSION
+  fun_zip_add_min = &fun_zip_add_min_vector;
+#else
   fun_zip_add_min = &fun_zip_add_min_default;
+#endif
 
 exec_fun_zip_add_min:
 
@@ -119,6 +311,131 @@ exec_fun_zip_add_min:
 }
 
 
+/* zip_add_min_idx() dispatcher */
+static int
+zip_add_min_idx_dispatcher(const int  *a,
+                           const int  *b,
+                           int        size,
+                           int        *idx)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_add_min_idx = &vrna_fun_zip_add_min_idx_avx512;
+    goto exec_fun_zip_add_min_idx;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_min_idx = &vrna_fun_zip_add_min_idx_avx2;
+    goto exec_fun_zip_add_min_idx;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_zip_add_min_idx = &vrna_fun_zip_add_min_idx_sse41;
+    goto exec_fun_zip_add_min_idx;
+  }
+
+#endif
+
+#if VRNA_WITH_VECTOR_EXTENSION
+  fun_zip_add_min_idx = &fun_zip_add_min_idx_vector;
+#else
+  fun_zip_add_min_idx = &fun_zip_add_min_idx_default;
+#endif
+
+exec_fun_zip_add_min_idx:
+
+  return (*fun_zip_add_min_idx)(a, b, size, idx);
+}
+
+
+/* zip_mult_sum() dispatcher */
+static FLT_OR_DBL
+zip_mult_sum_dispatcher(const FLT_OR_DBL  *a,
+                        const FLT_OR_DBL  *b,
+                        int               size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_mult_sum = &vrna_fun_zip_mult_sum_avx512;
+    goto exec_fun_zip_mult_sum;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_mult_sum = &vrna_fun_zip_mult_sum_avx2;
+    goto exec_fun_zip_mult_sum;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE2
+  if (features & VRNA_CPU_SIMD_SSE2) {
+    fun_zip_mult_sum = &vrna_fun_zip_mult_sum_sse2;
+    goto exec_fun_zip_mult_sum;
+  }
+
+#endif
+
+  fun_zip_mult_sum = &fun_zip_mult_sum_default;
+
+exec_fun_zip_mult_sum:
+
+  return (*fun_zip_mult_sum)(a, b, size);
+}
+
+
+/* zip_mult_sum_rev() dispatcher */
+static FLT_OR_DBL
+zip_mult_sum_rev_dispatcher(const FLT_OR_DBL  *a,
+                            const FLT_OR_DBL  *b,
+                            int               size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_mult_sum_rev = &vrna_fun_zip_mult_sum_rev_avx512;
+    goto exec_fun_zip_mult_sum_rev;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_mult_sum_rev = &vrna_fun_zip_mult_sum_rev_avx2;
+    goto exec_fun_zip_mult_sum_rev;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE2
+  if (features & VRNA_CPU_SIMD_SSE2) {
+    fun_zip_mult_sum_rev = &vrna_fun_zip_mult_sum_rev_sse2;
+    goto exec_fun_zip_mult_sum_rev;
+  }
+
+#endif
+
+  fun_zip_mult_sum_rev = &fun_zip_mult_sum_rev_default;
+
+exec_fun_zip_mult_sum_rev:
+
+  return (*fun_zip_mult_sum_rev)(a, b, size);
+}
+
+
 static int
 fun_zip_add_min_default(const int *e1,
                         const int *e2,
@@ -136,3 +453,165 @@ fun_zip_add_min_default(const int *e1,
 
   return decomp;
 }
+
+
+static int
+fun_zip_add_min_idx_default(const int *e1,
+                            const int *e2,
+                            int       count,
+                            int       *idx)
+{
+  int i, pos;
+  int decomp = INF;
+
+  pos = -1;
+
+  for (i = 0; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        pos     = i;
+      }
+    }
+  }
+
+  if (idx)
+    *idx = pos;
+
+  return decomp;
+}
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_default(const FLT_OR_DBL *e1,
+                         const FLT_OR_DBL *e2,
+                         int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum = 0.;
+
+  for (i = 0; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_rev_default(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum = 0.;
+
+  for (i = 0; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
+
+
+#if VRNA_WITH_VECTOR_EXTENSION
+
+typedef int vrna_v4si __attribute__ ((vector_size(4 * sizeof(int))));
+
+
+static int
+fun_zip_add_min_vector(const int  *e1,
+                       const int  *e2,
+                       int        count)
+{
+  int       i, k;
+  int       decomp = INF;
+  vrna_v4si inf, vmin;
+
+  inf   = (vrna_v4si){ INF, INF, INF, INF };
+  vmin  = inf;
+
+  for (i = 0; i < count - 3; i += 4) {
+    vrna_v4si a, b, c, mask;
+
+    memcpy(&a, e1 + i, sizeof(vrna_v4si));
+    memcpy(&b, e2 + i, sizeof(vrna_v4si));
+
+    /* mask is all-ones where both, a and b, are less than INF */
+    mask  = (a < inf) & (b < inf);
+    c     = ((a + b) & mask) | (inf & ~mask);
+    mask  = c < vmin;
+    vmin  = (c & mask) | (vmin & ~mask);
+  }
+
+  for (k = 0; k < 4; k++)
+    decomp = MIN2(decomp, vmin[k]);
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+static int
+fun_zip_add_min_idx_vector(const int  *e1,
+                           const int  *e2,
+                           int        count,
+                           int        *idx)
+{
+  int       i, k, pos;
+  int       decomp = INF;
+  vrna_v4si inf, four, vmin, vidx, vpos;
+
+  inf   = (vrna_v4si){ INF, INF, INF, INF };
+  four  = (vrna_v4si){ 4, 4, 4, 4 };
+  vmin  = inf;
+  vidx  = (vrna_v4si){ -1, -1, -1, -1 };
+  vpos  = (vrna_v4si){ 0, 1, 2, 3 };
+
+  for (i = 0; i < count - 3; i += 4, vpos += four) {
+    vrna_v4si a, b, c, mask;
+
+    memcpy(&a, e1 + i, sizeof(vrna_v4si));
+    memcpy(&b, e2 + i, sizeof(vrna_v4si));
+
+    mask  = (a < inf) & (b < inf);
+    c     = ((a + b) & mask) | (inf & ~mask);
+    /* strict comparison keeps the first occurrence in each lane */
+    mask  = c < vmin;
+    vmin  = (c & mask) | (vmin & ~mask);
+    vidx  = (vpos & mask) | (vidx & ~mask);
+  }
+
+  pos = -1;
+
+  for (k = 0; k < 4; k++) {
+    if ((vmin[k] < decomp) ||
+        ((vmin[k] == decomp) && (vidx[k] != -1) && (vidx[k] < pos))) {
+      decomp  = vmin[k];
+      pos     = vidx[k];
+    }
+  }
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        pos     = i;
+      }
+    }
+  }
+
+  if (idx)
+    *idx = pos;
+
+  return decomp;
+}
+
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef VIENNA_RNA_PACKAGE_UTILS_FUN_H
 #define VIENNA_RNA_PACKAGE_UTILS_FUN_H
 
+#include <ViennaRNA/datastructures/basic.h>
+
 void
 vrna_fun_dispatch_disable(void);
 
@@ -15,4 +17,23 @@ vrna_fun_zip_add_min(const int  *e1,
                      int        count);
 
 
+int
+vrna_fun_zip_add_min_idx(const int  *e1,
+                         const int  *e2,
+                         int        count,
+                         int        *idx);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum(const FLT_OR_DBL  *e1,
+                      const FLT_OR_DBL  *e2,
+                      int               count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev(const FLT_OR_DBL  *e1,
+                          const FLT_OR_DBL  *e2,
+                          int               count);
+
+
 #endif
@@ -0,0 +1,221 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "ViennaRNA/datastructures/basic.h"
+#include "ViennaRNA/utils/basic.h"
+
+#include <immintrin.h>
+
+#ifdef USE_FLOAT_PF
+# define VEC              __m256
+# define VEC_WIDTH        8
+# define VEC_ZERO()       _mm256_setzero_ps()
+# define VEC_LOAD(p)      _mm256_loadu_ps(p)
+# define VEC_ADD(a, b)    _mm256_add_ps(a, b)
+# define VEC_MUL(a, b)    _mm256_mul_ps(a, b)
+# define VEC_REVERSE(a)   _mm256_permutevar8x32_ps(a, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0))
+#else
+# define VEC              __m256d
+# define VEC_WIDTH        4
+# define VEC_ZERO()       _mm256_setzero_pd()
+# define VEC_LOAD(p)      _mm256_loadu_pd(p)
+# define VEC_ADD(a, b)    _mm256_add_pd(a, b)
+# define VEC_MUL(a, b)    _mm256_mul_pd(a, b)
+# define VEC_REVERSE(a)   _mm256_permute4x64_pd(a, _MM_SHUFFLE(0, 1, 2, 3))
+#endif
+
+static int
+horizontal_min_Vec8i(__m256i x);
+
+
+static FLT_OR_DBL
+horizontal_sum(VEC x);
+
+
+PUBLIC int
+vrna_fun_zip_add_min_avx2(const int *e1,
+                          const int *e2,
+                          int       count)
+{
+  int     i       = 0;
+  int     decomp  = INF;
+
+  __m256i inf   = _mm256_set1_epi32(INF);
+  __m256i vmin  = inf;
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256i a = _mm256_loadu_si256((__m256i *)&e1[i]);
+    __m256i b = _mm256_loadu_si256((__m256i *)&e2[i]);
+    __m256i c = _mm256_add_epi32(a, b);
+
+    /* create mask for non-INF values */
+    __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi32(inf, a),
+                                    _mm256_cmpgt_epi32(inf, b));
+
+    /* fill all values with INF if they've been INF in a or b before */
+    c = _mm256_blendv_epi8(inf, c, mask);
+
+    /* keep the lane-wise minimum, reduce horizontally only once at the end */
+    vmin = _mm256_min_epi32(vmin, c);
+  }
+
+  decomp = horizontal_min_Vec8i(vmin);
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_min_idx_avx2(const int *e1,
+                              const int *e2,
+                              int       count,
+                              int       *idx)
+{
+  int     i       = 0;
+  int     pos     = -1;
+  int     decomp  = INF;
+
+  __m256i inf   = _mm256_set1_epi32(INF);
+  __m256i eight = _mm256_set1_epi32(8);
+  __m256i vmin  = inf;
+  __m256i vidx  = _mm256_set1_epi32(-1);
+  __m256i vpos  = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256i a = _mm256_loadu_si256((__m256i *)&e1[i]);
+    __m256i b = _mm256_loadu_si256((__m256i *)&e2[i]);
+    __m256i c = _mm256_add_epi32(a, b);
+
+    /* create mask for non-INF values */
+    __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi32(inf, a),
+                                    _mm256_cmpgt_epi32(inf, b));
+
+    c = _mm256_blendv_epi8(inf, c, mask);
+
+    /* update minimum and position where we found a new strict minimum */
+    mask  = _mm256_cmpgt_epi32(vmin, c);
+    vmin  = _mm256_blendv_epi8(vmin, c, mask);
+    vidx  = _mm256_blendv_epi8(vidx, vpos, mask);
+    vpos  = _mm256_add_epi32(vpos, eight);
+  }
+
+  decomp = horizontal_min_Vec8i(vmin);
+
+  if (decomp < INF) {
+    /* smallest position among all lanes that attain the minimum */
+    __m256i eq = _mm256_cmpeq_epi32(vmin, _mm256_set1_epi32(decomp));
+    vidx  = _mm256_blendv_epi8(_mm256_set1_epi32(0x7fffffff), vidx, eq);
+    pos   = horizontal_min_Vec8i(vidx);
+  }
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        pos     = i;
+      }
+    }
+  }
+
+  if (idx)
+    *idx = pos;
+
+  return decomp;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count)
+{
+  int         i   = 0;
+  FLT_OR_DBL  sum = 0.;
+  VEC         acc = VEC_ZERO();
+
+  for (i = 0; i < count - (VEC_WIDTH - 1); i += VEC_WIDTH)
+    acc = VEC_ADD(acc, VEC_MUL(VEC_LOAD(e1 + i), VEC_LOAD(e2 + i)));
+
+  sum = horizontal_sum(acc);
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count)
+{
+  int         i   = 0;
+  FLT_OR_DBL  sum = 0.;
+  VEC         acc = VEC_ZERO();
+
+  for (i = 0; i < count - (VEC_WIDTH - 1); i += VEC_WIDTH) {
+    VEC b = VEC_REVERSE(VEC_LOAD(e2 + count - i - VEC_WIDTH));
+    acc = VEC_ADD(acc, VEC_MUL(VEC_LOAD(e1 + i), b));
+  }
+
+  sum = horizontal_sum(acc);
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
+
+
+/*
+ *  AVX2 minimum: reduce to 128 bit first, then proceed as in the SSE case
+ */
+static int
+horizontal_min_Vec8i(__m256i x)
+{
+  __m128i min0  = _mm_min_epi32(_mm256_castsi256_si128(x),
+                                _mm256_extracti128_si256(x, 1));
+  __m128i min1  = _mm_shuffle_epi32(min0, _MM_SHUFFLE(0, 0, 3, 2));
+  __m128i min2  = _mm_min_epi32(min0, min1);
+  __m128i min3  = _mm_shuffle_epi32(min2, _MM_SHUFFLE(0, 0, 0, 1));
+  __m128i min4  = _mm_min_epi32(min2, min3);
+
+  return _mm_cvtsi128_si32(min4);
+}
+
+
+/*
+ *  AVX2 horizontal sum of floating point values
+ */
+static FLT_OR_DBL
+horizontal_sum(VEC x)
+{
+#ifdef USE_FLOAT_PF
+  __m128  sum0  = _mm_add_ps(_mm256_castps256_ps128(x),
+                             _mm256_extractf128_ps(x, 1));
+  __m128  sum1  = _mm_add_ps(sum0, _mm_movehl_ps(sum0, sum0));
+  __m128  sum2  = _mm_add_ss(sum1, _mm_shuffle_ps(sum1, sum1, _MM_SHUFFLE(0, 0, 0, 1)));
+
+  return _mm_cvtss_f32(sum2);
+#else
+  __m128d sum0  = _mm_add_pd(_mm256_castpd256_pd128(x),
+                             _mm256_extractf128_pd(x, 1));
+  __m128d sum1  = _mm_add_sd(sum0, _mm_unpackhi_pd(sum0, sum0));
+
+  return _mm_cvtsd_f64(sum1);
+#endif
+}
@@ -6,10 +6,30 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/utils/basic.h"
 
 #include <immintrin.h>
 
+#ifdef USE_FLOAT_PF
+# define VEC                __m512
+# define VEC_WIDTH          16
+# define VEC_ZERO()         _mm512_setzero_ps()
+# define VEC_LOAD(p)        _mm512_loadu_ps(p)
+# define VEC_FMADD(a, b, c) _mm512_fmadd_ps(a, b, c)
+# define VEC_REVERSE(a)     _mm512_permutexvar_ps(_mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, \
+                                                                    7, 6, 5, 4, 3, 2, 1, 0), a)
+# define VEC_REDUCE_ADD(a)  _mm512_reduce_add_ps(a)
+#else
+# define VEC                __m512d
+# define VEC_WIDTH          8
+# define VEC_ZERO()         _mm512_setzero_pd()
+# define VEC_LOAD(p)        _mm512_loadu_pd(p)
+# define VEC_FMADD(a, b, c) _mm512_fmadd_pd(a, b, c)
+# define VEC_REVERSE(a)     _mm512_permutexvar_pd(_mm512_setr_epi64(7, 6, 5, 4, 3, 2, 1, 0), a)
+# define VEC_REDUCE_ADD(a)  _mm512_reduce_add_pd(a)
+#endif
+
 
 PUBLIC int
 vrna_fun_zip_add_min_avx512(const int *e1,
@@ -48,3 +68,106 @@ vrna_fun_zip_add_min_avx512(const int *e1,
 
   return decomp;
 }
+
+
+PUBLIC int
+vrna_fun_zip_add_min_idx_avx512(const int *e1,
+                                const int *e2,
+                                int       count,
+                                int       *idx)
+{
+  int     i       = 0;
+  int     pos     = -1;
+  int     decomp  = INF;
+
+  __m512i inf     = _mm512_set1_epi32(INF);
+  __m512i sixteen = _mm512_set1_epi32(16);
+  __m512i vmin    = inf;
+  __m512i vidx    = _mm512_set1_epi32(-1);
+  __m512i vpos    = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                                      8, 9, 10, 11, 12, 13, 14, 15);
+
+  for (i = 0; i < count - 15; i += 16) {
+    __m512i   a = _mm512_loadu_si512((__m512i *)&e1[i]);
+    __m512i   b = _mm512_loadu_si512((__m512i *)&e2[i]);
+
+    /* compute mask for entries where both, a and b, are less than INF */
+    __mmask16 mask = _kand_mask16(_mm512_cmplt_epi32_mask(a, inf),
+                                  _mm512_cmplt_epi32_mask(b, inf));
+
+    /* add values */
+    __m512i   c = _mm512_add_epi32(a, b);
+
+    /* lanes where we found a new strict minimum */
+    mask  = _mm512_mask_cmplt_epi32_mask(mask, c, vmin);
+    vmin  = _mm512_mask_mov_epi32(vmin, mask, c);
+    vidx  = _mm512_mask_mov_epi32(vidx, mask, vpos);
+    vpos  = _mm512_add_epi32(vpos, sixteen);
+  }
+
+  decomp = _mm512_reduce_min_epi32(vmin);
+
+  if (decomp < INF) {
+    __mmask16 eq = _mm512_cmpeq_epi32_mask(vmin, _mm512_set1_epi32(decomp));
+    pos = _mm512_mask_reduce_min_epi32(eq, vidx);
+  }
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        pos     = i;
+      }
+    }
+  }
+
+  if (idx)
+    *idx = pos;
+
+  return decomp;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx512(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count)
+{
+  int         i   = 0;
+  FLT_OR_DBL  sum = 0.;
+  VEC         acc = VEC_ZERO();
+
+  for (i = 0; i < count - (VEC_WIDTH - 1); i += VEC_WIDTH)
+    acc = VEC_FMADD(VEC_LOAD(e1 + i), VEC_LOAD(e2 + i), acc);
+
+  sum = VEC_REDUCE_ADD(acc);
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx512(const FLT_OR_DBL *e1,
+                                 const FLT_OR_DBL *e2,
+                                 int              count)
+{
+  int         i   = 0;
+  FLT_OR_DBL  sum = 0.;
+  VEC         acc = VEC_ZERO();
+
+  for (i = 0; i < count - (VEC_WIDTH - 1); i += VEC_WIDTH) {
+    VEC b = VEC_REVERSE(VEC_LOAD(e2 + count - i - VEC_WIDTH));
+    acc = VEC_FMADD(VEC_LOAD(e1 + i), b, acc);
+  }
+
+  sum = VEC_REDUCE_ADD(acc);
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
@@ -0,0 +1,97 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "ViennaRNA/datastructures/basic.h"
+#include "ViennaRNA/utils/basic.h"
+
+#include <emmintrin.h>
+
+/*
+ *  The partition function data type is either double (default) or float
+ *  (USE_FLOAT_PF). Map the required intrinsics accordingly.
+ */
+#ifdef USE_FLOAT_PF
+# define VEC              __m128
+# define VEC_WIDTH        4
+# define VEC_ZERO()       _mm_setzero_ps()
+# define VEC_LOAD(p)      _mm_loadu_ps(p)
+# define VEC_ADD(a, b)    _mm_add_ps(a, b)
+# define VEC_MUL(a, b)    _mm_mul_ps(a, b)
+# define VEC_REVERSE(a)   _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3))
+#else
+# define VEC              __m128d
+# define VEC_WIDTH        2
+# define VEC_ZERO()       _mm_setzero_pd()
+# define VEC_LOAD(p)      _mm_loadu_pd(p)
+# define VEC_ADD(a, b)    _mm_add_pd(a, b)
+# define VEC_MUL(a, b)    _mm_mul_pd(a, b)
+# define VEC_REVERSE(a)   _mm_shuffle_pd(a, a, 1)
+#endif
+
+static FLT_OR_DBL
+horizontal_sum(VEC x);
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_sse2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count)
+{
+  int         i   = 0;
+  FLT_OR_DBL  sum = 0.;
+  VEC         acc = VEC_ZERO();
+
+  for (i = 0; i < count - (VEC_WIDTH - 1); i += VEC_WIDTH)
+    acc = VEC_ADD(acc, VEC_MUL(VEC_LOAD(e1 + i), VEC_LOAD(e2 + i)));
+
+  sum = horizontal_sum(acc);
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_sse2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count)
+{
+  int         i   = 0;
+  FLT_OR_DBL  sum = 0.;
+  VEC         acc = VEC_ZERO();
+
+  for (i = 0; i < count - (VEC_WIDTH - 1); i += VEC_WIDTH) {
+    VEC b = VEC_REVERSE(VEC_LOAD(e2 + count - i - VEC_WIDTH));
+    acc = VEC_ADD(acc, VEC_MUL(VEC_LOAD(e1 + i), b));
+  }
+
+  sum = horizontal_sum(acc);
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
+
+
+static FLT_OR_DBL
+horizontal_sum(VEC x)
+{
+#ifdef USE_FLOAT_PF
+  __m128  sum1  = _mm_add_ps(x, _mm_movehl_ps(x, x));
+  __m128  sum2  = _mm_add_ss(sum1, _mm_shuffle_ps(sum1, sum1, _MM_SHUFFLE(0, 0, 0, 1)));
+
+  return _mm_cvtss_f32(sum2);
+#else
+  __m128d sum1 = _mm_add_sd(x, _mm_unpackhi_pd(x, x));
+
+  return _mm_cvtsd_f64(sum1);
+#endif
+}
@@ -15,6 +15,12 @@ static int
 horizontal_min_Vec4i(__m128i x);
 
 
+static int
+horizontal_argmin_Vec4i(__m128i x,
+                        __m128i pos,
+                        int     *idx);
+
+
 PUBLIC int
 vrna_fun_zip_add_min_sse41(const int  *e1,
                            const int  *e2,
@@ -55,6 +61,60 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
 }
 
 
+PUBLIC int
+vrna_fun_zip_add_min_idx_sse41(const int  *e1,
+                               const int  *e2,
+                               int        count,
+                               int        *idx)
+{
+  int     i       = 0;
+  int     pos     = -1;
+  int     decomp  = INF;
+
+  __m128i inf   = _mm_set1_epi32(INF);
+  __m128i four  = _mm_set1_epi32(4);
+  __m128i vmin  = inf;
+  __m128i vidx  = _mm_set1_epi32(-1);
+  __m128i vpos  = _mm_setr_epi32(0, 1, 2, 3);
+
+  for (i = 0; i < count - 3; i += 4) {
+    __m128i a = _mm_loadu_si128((__m128i *)&e1[i]);
+    __m128i b = _mm_loadu_si128((__m128i *)&e2[i]);
+    __m128i c = _mm_add_epi32(a, b);
+
+    /* create mask for non-INF values */
+    __m128i mask = _mm_and_si128(_mm_cmplt_epi32(a, inf),
+                                 _mm_cmplt_epi32(b, inf));
+
+    /* fill all values with INF if they've been INF in a or b before */
+    c = _mm_blendv_epi8(inf, c, mask);
+
+    /* update minimum and position where we found a new strict minimum */
+    mask  = _mm_cmplt_epi32(c, vmin);
+    vmin  = _mm_blendv_epi8(vmin, c, mask);
+    vidx  = _mm_blendv_epi8(vidx, vpos, mask);
+    vpos  = _mm_add_epi32(vpos, four);
+  }
+
+  decomp = horizontal_argmin_Vec4i(vmin, vidx, &pos);
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        pos     = i;
+      }
+    }
+  }
+
+  if (idx)
+    *idx = pos;
+
+  return decomp;
+}
+
+
 /*
  *  SSE minimum
  *  see also: http://stackoverflow.com/questions/9877700/getting-max-value-in-a-m128i-vector-with-sse
@@ -69,3 +129,22 @@ horizontal_min_Vec4i(__m128i x)
 
   return _mm_cvtsi128_si32(min4);
 }
+
+
+/*
+ *  SSE minimum together with the smallest position that attains it
+ */
+static int
+horizontal_argmin_Vec4i(__m128i x,
+                        __m128i pos,
+                        int     *idx)
+{
+  int     m   = horizontal_min_Vec4i(x);
+  __m128i eq  = _mm_cmpeq_epi32(x, _mm_set1_epi32(m));
+
+  /* set positions of all non-minimal lanes to INT_MAX and reduce the rest */
+  pos   = _mm_blendv_epi8(_mm_set1_epi32(0x7fffffff), pos, eq);
+  *idx  = (m == INF) ? -1 : horizontal_min_Vec4i(pos);
+
+  return m;
+}
@@ -0,0 +1,295 @@
+/*
+ *    ViennaRNA/utils/rng.c
+ *
+ *    Counter-based pseudo random number generators (Philox4x32-10)
+ *
+ *    See: J.K. Salmon, M.A. Moraes, R.O. Dror, D.E. Shaw (2011)
+ *         "Parallel random numbers: As easy as 1, 2, 3", SC'11
+ *
+ *                Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/rng.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/*
+ #################################
+ # PREPROCESSOR DEFININTIONS     #
+ #################################
+ */
+#define PHILOX_M0       UINT32_C(0xD2511F53)
+#define PHILOX_M1       UINT32_C(0xCD9E8D57)
+#define PHILOX_W0       UINT32_C(0x9E3779B9)
+#define PHILOX_W1       UINT32_C(0xBB67AE85)
+#define PHILOX_ROUNDS   10
+
+/* number of 32 bit words produced per counter value */
+#define BLOCK_WORDS     4
+
+/* number of 32 bit words consumed by vrna_rng_urn() */
+#define DRAW_WORDS      2
+
+struct vrna_rng_s {
+  uint32_t      key[2];
+  uint64_t      stream;
+  uint64_t      counter;            /* counter value of the next block to generate */
+  uint32_t      block[BLOCK_WORDS]; /* current block of random words */
+  unsigned int  pos;                /* next unused word in block */
+};
+
+/*
+ #################################
+ # GLOBAL VARIABLES              #
+ #################################
+ */
+
+
+/*
+ #################################
+ # PRIVATE VARIABLES             #
+ #################################
+ */
+PRIVATE vrna_rng_t *thread_rng = NULL;
+
+#ifdef _OPENMP
+#pragma omp threadprivate(thread_rng)
+#endif
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE INLINE void
+philox4x32(const uint32_t key[2],
+           uint64_t       counter,
+           uint64_t       stream,
+           uint32_t       out[BLOCK_WORDS]);
+
+
+PRIVATE INLINE void
+next_block(vrna_rng_t *rng);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_rng_t *
+vrna_rng_init(uint64_t  seed,
+              uint64_t  stream)
+{
+  vrna_rng_t *rng = (vrna_rng_t *)vrna_alloc(sizeof(vrna_rng_t));
+
+  vrna_rng_seed(rng, seed, stream);
+
+  return rng;
+}
+
+
+PUBLIC vrna_rng_t *
+vrna_rng_stream(const vrna_rng_t  *rng,
+                uint64_t          stream)
+{
+  vrna_rng_t *s = NULL;
+
+  if (rng) {
+    s           = (vrna_rng_t *)vrna_alloc(sizeof(vrna_rng_t));
+    s->key[0]   = rng->key[0];
+    s->key[1]   = rng->key[1];
+    s->stream   = stream;
+    s->counter  = 0;
+    s->pos      = BLOCK_WORDS;
+  }
+
+  return s;
+}
+
+
+PUBLIC vrna_rng_t *
+vrna_rng_copy(const vrna_rng_t *rng)
+{
+  vrna_rng_t *s = NULL;
+
+  if (rng) {
+    s = (vrna_rng_t *)vrna_alloc(sizeof(vrna_rng_t));
+    memcpy(s, rng, sizeof(vrna_rng_t));
+  }
+
+  return s;
+}
+
+
+PUBLIC void
+vrna_rng_assign(vrna_rng_t        *rng,
+                const vrna_rng_t  *src)
+{
+  if ((rng) && (src))
+    memcpy(rng, src, sizeof(vrna_rng_t));
+}
+
+
+PUBLIC void
+vrna_rng_free(vrna_rng_t *rng)
+{
+  if (rng) {
+    if (thread_rng == rng)
+      thread_rng = NULL;
+
+    free(rng);
+  }
+}
+
+
+PUBLIC void
+vrna_rng_seed(vrna_rng_t  *rng,
+              uint64_t    seed,
+              uint64_t    stream)
+{
+  if (rng) {
+    rng->key[0]   = (uint32_t)seed;
+    rng->key[1]   = (uint32_t)(seed >> 32);
+    rng->stream   = stream;
+    rng->counter  = 0;
+    rng->pos      = BLOCK_WORDS;
+  }
+}
+
+
+PUBLIC void
+vrna_rng_skip(vrna_rng_t  *rng,
+              uint64_t    n)
+{
+  uint64_t word;
+
+  if ((rng) && (n > 0)) {
+    /*
+     *  absolute position of the next unused word within the stream. Note,
+     *  that this relies on unsigned wrap-around for the initial state where
+     *  counter = 0 and pos = BLOCK_WORDS
+     */
+    word  = (rng->counter - 1) * BLOCK_WORDS + rng->pos;
+    word  += n * DRAW_WORDS;
+
+    rng->counter  = word / BLOCK_WORDS;
+    rng->pos      = BLOCK_WORDS;
+
+    if (word % BLOCK_WORDS) {
+      next_block(rng);
+      rng->pos = (unsigned int)(word % BLOCK_WORDS);
+    }
+  }
+}
+
+
+PUBLIC uint32_t
+vrna_rng_uint32(vrna_rng_t *rng)
+{
+  if (rng->pos == BLOCK_WORDS)
+    next_block(rng);
+
+  return rng->block[rng->pos++];
+}
+
+
+PUBLIC double
+vrna_rng_urn(vrna_rng_t *rng)
+{
+  uint32_t a, b;
+
+  a = vrna_rng_uint32(rng) >> 5;  /* 27 bits */
+  b = vrna_rng_uint32(rng) >> 6;  /* 26 bits */
+
+  return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+}
+
+
+PUBLIC int
+vrna_rng_int_urn(vrna_rng_t *rng,
+                 int        from,
+                 int        to)
+{
+  return ((int)(vrna_rng_urn(rng) * (to - from + 1))) + from;
+}
+
+
+PUBLIC vrna_rng_t *
+vrna_rng_thread_set(vrna_rng_t *rng)
+{
+  vrna_rng_t *prev = thread_rng;
+
+  thread_rng = rng;
+
+  return prev;
+}
+
+
+PUBLIC vrna_rng_t *
+vrna_rng_thread_get(void)
+{
+  return thread_rng;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE INLINE void
+next_block(vrna_rng_t *rng)
+{
+  philox4x32(rng->key, rng->counter, rng->stream, rng->block);
+  rng->counter++;
+  rng->pos = 0;
+}
+
+
+PRIVATE INLINE void
+philox4x32(const uint32_t key[2],
+           uint64_t       counter,
+           uint64_t       stream,
+           uint32_t       out[BLOCK_WORDS])
+{
+  int       r;
+  uint32_t  c0, c1, c2, c3, k0, k1;
+  uint64_t  p0, p1;
+
+  c0  = (uint32_t)counter;
+  c1  = (uint32_t)(counter >> 32);
+  c2  = (uint32_t)stream;
+  c3  = (uint32_t)(stream >> 32);
+  k0  = key[0];
+  k1  = key[1];
+
+  for (r = 0; r < PHILOX_ROUNDS; r++) {
+    p0  = (uint64_t)PHILOX_M0 * c0;
+    p1  = (uint64_t)PHILOX_M1 * c2;
+    c0  = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+    c2  = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+    c1  = (uint32_t)p1;
+    c3  = (uint32_t)p0;
+    k0  += PHILOX_W0;
+    k1  += PHILOX_W1;
+  }
+
+  out[0]  = c0;
+  out[1]  = c1;
+  out[2]  = c2;
+  out[3]  = c3;
+}
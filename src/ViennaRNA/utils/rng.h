@@ -0,0 +1,204 @@
+#ifndef VIENNA_RNA_PACKAGE_UTILS_RNG_H
+#define VIENNA_RNA_PACKAGE_UTILS_RNG_H
+
+/**
+ *  @file     ViennaRNA/utils/rng.h
+ *  @ingroup  utils
+ *  @brief    Seedable, counter-based pseudo random number generators
+ */
+
+/**
+ *  @addtogroup  utils
+ *  @{
+ *
+ *  @brief  Reproducible random number streams for stochastic algorithms
+ *
+ *  Stochastic backtracking, sequence design, and random walks draw their
+ *  random numbers through vrna_urn() and vrna_int_urn(). By default, these
+ *  functions use a single, process-wide 48 bit linear congruential state
+ *  (see #xsubi) that is shared among all threads. To obtain reproducible
+ *  results, and to safely run stochastic computations from multiple threads,
+ *  a #vrna_rng_t object may be created with an explicit @p seed and @p stream
+ *  identifier, and then be bound to either the calling thread via
+ *  vrna_rng_thread_set(), or to a #vrna_fold_compound_t via
+ *  vrna_fold_compound_rng_seed().
+ *
+ *  The generator is counter-based (Philox4x32-10), i.e. each random number is
+ *  a pure function of the @p seed, the @p stream, and its position within the
+ *  stream. Different streams of the same seed are statistically independent,
+ *  which makes them the preferred way to hand out random numbers to @f$ N @f$
+ *  threads: simply use stream identifiers @f$ 0, \ldots, N - 1 @f$.
+ */
+
+#include <stdint.h>
+
+/**
+ *  @brief  A seedable, counter-based random number generator
+ */
+typedef struct vrna_rng_s vrna_rng_t;
+
+
+/**
+ *  @brief  Create a new random number generator
+ *
+ *  @see  vrna_rng_free(), vrna_rng_seed(), vrna_rng_urn()
+ *
+ *  @param  seed    The seed (key) of the generator
+ *  @param  stream  The stream identifier of the generator
+ *  @return         A new random number generator positioned at the beginning of stream @p stream
+ */
+vrna_rng_t *
+vrna_rng_init(uint64_t  seed,
+              uint64_t  stream);
+
+
+/**
+ *  @brief  Create a new random number generator that draws from a different stream
+ *
+ *  The new generator uses the same seed as @p rng but starts at the beginning of
+ *  stream @p stream.
+ *
+ *  @param  rng     The random number generator to derive the seed from
+ *  @param  stream  The stream identifier of the new generator
+ *  @return         A new random number generator, or @em NULL if @p rng is @em NULL
+ */
+vrna_rng_t *
+vrna_rng_stream(const vrna_rng_t  *rng,
+                uint64_t          stream);
+
+
+/**
+ *  @brief  Create a copy of a random number generator
+ *
+ *  The copy shares seed, stream, and current position with @p rng, i.e. it
+ *  will produce the same sequence of random numbers as @p rng from now on.
+ *
+ *  @param  rng     The random number generator to copy
+ *  @return         A new random number generator, or @em NULL if @p rng is @em NULL
+ */
+vrna_rng_t *
+vrna_rng_copy(const vrna_rng_t *rng);
+
+
+/**
+ *  @brief  Set the state of a random number generator to that of another one
+ *
+ *  In contrast to vrna_rng_copy(), no memory is allocated. This allows for
+ *  re-using the same generator object, e.g. to draw from several sub-streams
+ *  one after another.
+ *
+ *  @param  rng     The random number generator to modify
+ *  @param  src     The random number generator whose state is copied
+ */
+void
+vrna_rng_assign(vrna_rng_t        *rng,
+                const vrna_rng_t  *src);
+
+
+/**
+ *  @brief  Release memory occupied by a random number generator
+ *
+ *  @param  rng   The random number generator to free
+ */
+void
+vrna_rng_free(vrna_rng_t *rng);
+
+
+/**
+ *  @brief  Re-seed a random number generator
+ *
+ *  @param  rng     The random number generator
+ *  @param  seed    The new seed (key)
+ *  @param  stream  The new stream identifier
+ */
+void
+vrna_rng_seed(vrna_rng_t  *rng,
+              uint64_t    seed,
+              uint64_t    stream);
+
+
+/**
+ *  @brief  Advance a random number generator by a number of draws
+ *
+ *  This is equivalent to, but much faster than, calling vrna_rng_urn()
+ *  @p n times and discarding the results.
+ *
+ *  @param  rng   The random number generator
+ *  @param  n     The number of draws to skip
+ */
+void
+vrna_rng_skip(vrna_rng_t  *rng,
+              uint64_t    n);
+
+
+/**
+ *  @brief  Get the next 32 bit random integer of a random number generator
+ *
+ *  @param  rng   The random number generator
+ *  @return       A uniformly distributed random integer
+ */
+uint32_t
+vrna_rng_uint32(vrna_rng_t *rng);
+
+
+/**
+ *  @brief  Get a random number from [0..1) of a random number generator
+ *
+ *  Each call consumes exactly one draw, i.e. two 32 bit words, of the stream
+ *  and yields a double precision number with 53 random bits.
+ *
+ *  @see  vrna_rng_int_urn(), vrna_urn()
+ *
+ *  @param  rng   The random number generator
+ *  @return       A random number in range [0..1)
+ */
+double
+vrna_rng_urn(vrna_rng_t *rng);
+
+
+/**
+ *  @brief  Get a random integer in a specified range from a random number generator
+ *
+ *  @see  vrna_rng_urn(), vrna_int_urn()
+ *
+ *  @param  rng   The random number generator
+ *  @param  from  The first number in range
+ *  @param  to    The last number in range
+ *  @return       A pseudo random number in range [from, to]
+ */
+int
+vrna_rng_int_urn(vrna_rng_t *rng,
+                 int        from,
+                 int        to);
+
+
+/**
+ *  @brief  Bind a random number generator to the calling thread
+ *
+ *  Once bound, vrna_urn() and vrna_int_urn(), and therefore all stochastic
+ *  algorithms of the library, draw their random numbers from @p rng whenever
+ *  they are called from this thread. Passing @em NULL restores the default
+ *  behavior, i.e. drawing from the process-wide generator. The caller retains
+ *  ownership of @p rng and must keep it alive while it is bound.
+ *
+ *  @param  rng   The random number generator to bind (may be @em NULL)
+ *  @return       The random number generator that was bound to the thread before
+ */
+vrna_rng_t *
+vrna_rng_thread_set(vrna_rng_t *rng);
+
+
+/**
+ *  @brief  Get the random number generator bound to the calling thread
+ *
+ *  @return The random number generator bound to this thread, or @em NULL
+ */
+vrna_rng_t *
+vrna_rng_thread_get(void);
+
+
+/**
+ *  @}
+ */
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ *    ViennaRNA/utils/timing.c
+ *
+ *    Per-phase timing and memory instrumentation
+ *
+ *                Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/strings.h"
+#include "ViennaRNA/utils/timing.h"
+
+/*
+ #################################
+ # PRIVATE VARIABLES             #
+ #################################
+ */
+PRIVATE const char *phase_names[VRNA_TIMING_PHASES] = {
+  "params",
+  "constraints",
+  "fill",
+  "backtrack",
+  "outside",
+  "sampling"
+};
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE double
+wall_time(void);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_timing_t *
+vrna_timing_init(void)
+{
+  return (vrna_timing_t *)vrna_alloc(sizeof(vrna_timing_t));
+}
+
+
+PUBLIC void
+vrna_timing_free(vrna_timing_t *timing)
+{
+  free(timing);
+}
+
+
+PUBLIC void
+vrna_timing_reset(vrna_timing_t *timing)
+{
+  if (timing)
+    memset(timing, 0, sizeof(vrna_timing_t));
+}
+
+
+PUBLIC void
+vrna_timing_start(vrna_timing_t *timing,
+                  unsigned int  phase)
+{
+  if ((timing) && (phase < VRNA_TIMING_PHASES)) {
+    timing->start_bytes[phase]  = vrna_alloc_bytes();
+    timing->start[phase]        = wall_time();
+  }
+}
+
+
+PUBLIC void
+vrna_timing_stop(vrna_timing_t      *timing,
+                 unsigned int       phase,
+                 unsigned long long cells)
+{
+  if ((timing) && (phase < VRNA_TIMING_PHASES)) {
+    timing->phase[phase].time   += wall_time() - timing->start[phase];
+    timing->phase[phase].bytes  += vrna_alloc_bytes() - timing->start_bytes[phase];
+    timing->phase[phase].cells  += cells;
+  }
+}
+
+
+PUBLIC const char *
+vrna_timing_phase_name(unsigned int phase)
+{
+  if (phase < VRNA_TIMING_PHASES)
+    return phase_names[phase];
+
+  return NULL;
+}
+
+
+PUBLIC char *
+vrna_timing_to_json(const vrna_timing_t *timing)
+{
+  char          *json;
+  unsigned int  p;
+
+  if (!timing)
+    return NULL;
+
+  json = vrna_strdup_printf("{");
+
+  for (p = 0; p < VRNA_TIMING_PHASES; p++)
+    vrna_strcat_printf(&json,
+                       "%s\"%s\": {\"time_s\": %.6f, \"cells\": %llu, \"bytes\": %llu}",
+                       (p > 0) ? ", " : "",
+                       phase_names[p],
+                       timing->phase[p].time,
+                       timing->phase[p].cells,
+                       timing->phase[p].bytes);
+
+  vrna_strcat_printf(&json, "}");
+
+  return json;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE double
+wall_time(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+
+  return (double)tv.tv_sec + (double)tv.tv_usec * 1e-6;
+}
@@ -0,0 +1,187 @@
+#ifndef VIENNA_RNA_PACKAGE_UTILS_TIMING_H
+#define VIENNA_RNA_PACKAGE_UTILS_TIMING_H
+
+/**
+ *  @file     ViennaRNA/utils/timing.h
+ *  @ingroup  utils
+ *  @brief    Per-phase timing and memory instrumentation of the prediction algorithms
+ */
+
+/**
+ *  @addtogroup  utils
+ *  @{
+ *
+ *  @brief  Attribute run time and memory of predictions to individual phases
+ *
+ *  Once instrumentation is enabled for a #vrna_fold_compound_t via
+ *  vrna_fold_compound_timing(), the prediction algorithms record the wall
+ *  clock time, the number of dynamic programming cells, and the number of
+ *  bytes allocated (see vrna_alloc_bytes()) for each phase of the computation,
+ *  i.e. energy parameter setup, constraints preparation, the DP matrix fill
+ *  (including the allocation of the matrices), backtracking, outside
+ *  recursions for base pair probabilities, and stochastic sampling.
+ *
+ *  Measurements accumulate over subsequent calls until the #vrna_timing_t
+ *  object is reset with vrna_timing_reset(). Without instrumentation, the
+ *  algorithms only perform a single pointer comparison per phase.
+ *
+ *  @note Allocated bytes are counted for the thread that executes the
+ *        respective phase only. Allocations of worker threads, e.g. in
+ *        parallel DP matrix fills, are not accounted for.
+ */
+
+/**
+ *  @brief  Energy parameter and pair type array setup
+ */
+#define VRNA_TIMING_PARAMS        0U
+
+/**
+ *  @brief  Preparation of hard and soft constraints
+ */
+#define VRNA_TIMING_CONSTRAINTS   1U
+
+/**
+ *  @brief  DP matrix allocation and fill (forward/inside recursions)
+ */
+#define VRNA_TIMING_FILL          2U
+
+/**
+ *  @brief  MFE backtracking
+ */
+#define VRNA_TIMING_BACKTRACK     3U
+
+/**
+ *  @brief  Outside recursions, i.e. base pair probability computations
+ */
+#define VRNA_TIMING_OUTSIDE       4U
+
+/**
+ *  @brief  Stochastic backtracking (Boltzmann sampling)
+ */
+#define VRNA_TIMING_SAMPLING      5U
+
+/**
+ *  @brief  The number of distinct phases
+ */
+#define VRNA_TIMING_PHASES        6U
+
+
+/**
+ *  @brief  Measurements of a single phase
+ */
+typedef struct {
+  double              time;   /**<  @brief  Accumulated wall clock time in seconds */
+  unsigned long long  cells;  /**<  @brief  Accumulated number of DP cells (or nucleotides for backtracking and sampling) */
+  unsigned long long  bytes;  /**<  @brief  Accumulated number of bytes allocated */
+} vrna_timing_phase_t;
+
+
+/**
+ *  @brief  Per-phase measurements of the prediction algorithms
+ *  @see    vrna_fold_compound_timing(), vrna_timing_to_json()
+ */
+typedef struct vrna_timing_s vrna_timing_t;
+
+
+/**
+ *  @brief  Per-phase measurements of the prediction algorithms
+ */
+struct vrna_timing_s {
+  vrna_timing_phase_t phase[VRNA_TIMING_PHASES];  /**<  @brief  Measurements, indexed by the phase identifier, e.g. #VRNA_TIMING_FILL */
+
+  /* private attributes for currently running measurements */
+  double              start[VRNA_TIMING_PHASES];
+  unsigned long long  start_bytes[VRNA_TIMING_PHASES];
+};
+
+
+/**
+ *  @brief  Create a new, empty set of measurements
+ *
+ *  @see    vrna_timing_free(), vrna_fold_compound_timing()
+ *
+ *  @return A new #vrna_timing_t object with all measurements set to zero
+ */
+vrna_timing_t *
+vrna_timing_init(void);
+
+
+/**
+ *  @brief  Release memory of a set of measurements
+ *
+ *  @param  timing  The measurements to release
+ */
+void
+vrna_timing_free(vrna_timing_t *timing);
+
+
+/**
+ *  @brief  Reset all measurements to zero
+ *
+ *  @param  timing  The measurements to reset
+ */
+void
+vrna_timing_reset(vrna_timing_t *timing);
+
+
+/**
+ *  @brief  Start measuring a phase
+ *
+ *  This function does nothing if @p timing is @em NULL, such that algorithms
+ *  may unconditionally pass the #vrna_fold_compound_t.timing attribute.
+ *
+ *  @see    vrna_timing_stop()
+ *
+ *  @param  timing  The measurements to add to (may be @em NULL)
+ *  @param  phase   The phase identifier, e.g. #VRNA_TIMING_FILL
+ */
+void
+vrna_timing_start(vrna_timing_t *timing,
+                  unsigned int  phase);
+
+
+/**
+ *  @brief  Stop measuring a phase and accumulate the results
+ *
+ *  @see    vrna_timing_start()
+ *
+ *  @param  timing  The measurements to add to (may be @em NULL)
+ *  @param  phase   The phase identifier, e.g. #VRNA_TIMING_FILL
+ *  @param  cells   The number of cells processed in this phase
+ */
+void
+vrna_timing_stop(vrna_timing_t      *timing,
+                 unsigned int       phase,
+                 unsigned long long cells);
+
+
+/**
+ *  @brief  Get the name of a phase
+ *
+ *  @param  phase   The phase identifier, e.g. #VRNA_TIMING_FILL
+ *  @return         The name of the phase, e.g. @p "fill", or @em NULL for unknown phases
+ */
+const char *
+vrna_timing_phase_name(unsigned int phase);
+
+
+/**
+ *  @brief  Get a JSON representation of a set of measurements
+ *
+ *  The result is a single line JSON object with one member per phase, e.g.
+ *  @verbatim
+{"params": {"time_s": 0.000012, "cells": 0, "bytes": 0}, "constraints": {...}, "fill": {...}, ...}
+    @endverbatim
+ *
+ *  @param  timing  The measurements
+ *  @return         A newly allocated string, or @em NULL if @p timing is @em NULL
+ */
+char *
+vrna_timing_to_json(const vrna_timing_t *timing);
+
+
+/**
+ *  @}
+ */
+
+#endif
@@ -30,6 +30,7 @@
 
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/rng.h"
 
 #ifdef WITH_DMALLOC
 #include "dmalloc.h"
@@ -56,6 +57,12 @@ PUBLIC unsigned short xsubi[3];
  # PRIVATE VARIABLES             #
  #################################
  */
+PRIVATE unsigned long long alloc_bytes = 0; /* bytes requested by the current thread */
+
+#ifdef _OPENMP
+#pragma omp threadprivate(alloc_bytes)
+#endif
+
 PRIVATE char  scale1[]  = "....,....1....,....2....,....3....,....4";
 PRIVATE char  scale2[]  = "....,....5....,....6....,....7....,....8";
 
@@ -84,6 +91,8 @@ vrna_alloc(unsigned size)
 {
   void *pointer;
 
+  alloc_bytes += size;
+
   if ((pointer = (void *)calloc(1, (size_t)size)) == NULL) {
 #ifdef EINVAL
     if (errno == EINVAL) {
@@ -107,6 +116,8 @@ vrna_realloc(void     *p,
   if (p == NULL)
     return vrna_alloc(size);
 
+  alloc_bytes += size;
+
   p = (void *)realloc(p, size);
   if (p == NULL) {
 #ifdef EINVAL
@@ -126,6 +137,14 @@ vrna_realloc(void     *p,
 
 #endif
 
+
+PUBLIC unsigned long long
+vrna_alloc_bytes(void)
+{
+  return alloc_bytes;
+}
+
+
 /*------------------------------------------------------------------------*/
 
 PUBLIC void
@@ -242,8 +261,13 @@ vrna_message_vinfo(FILE       *fp,
 PUBLIC void
 vrna_init_rand(void)
 {
-  uint32_t seed = rj_mix(clock(), time(NULL), getpid());
+  vrna_init_rand_seed(rj_mix(clock(), time(NULL), getpid()));
+}
+
 
+PUBLIC void
+vrna_init_rand_seed(unsigned int seed)
+{
   xsubi[0]  = xsubi[1] = xsubi[2] = (unsigned short)seed;  /* lower 16 bit */
   xsubi[1]  += (unsigned short)((unsigned)seed >> 6);
   xsubi[2]  += (unsigned short)((unsigned)seed >> 12);
@@ -261,6 +285,11 @@ vrna_init_rand(void)
 PUBLIC double
 vrna_urn(void)
 {
+  vrna_rng_t *rng = vrna_rng_thread_get();
+
+  if (rng)
+    return vrna_rng_urn(rng);
+
 #ifdef HAVE_ERAND48
   extern double erand48(unsigned short[]);
 
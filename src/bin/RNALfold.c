@@ -27,15 +27,62 @@
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/commands.h"
 #include "ViennaRNA/constraints/SHAPE.h"
+#include "ViennaRNA/datastructures/char_stream.h"
+#include "ViennaRNA/datastructures/stream_output.h"
 #include "RNALfold_cmdl.h"
 #include "gengetopt_helper.h"
 #include "input_id_helpers.h"
+#include "parallel_helpers.h"
 
 #include "ViennaRNA/color_output.inc"
 
+struct options {
+  int             filename_full;
+  char            *filename_delim;
+  int             noconv;
+  int             verbose;
+  vrna_md_t       md;
+  dataset_id      id_control;
+  vrna_cmd_t      commands;
+
+  int             zsc;
+  double          min_z;
+
+  int             shape;
+  char            *shape_file;
+  char            *shape_method;
+  char            *shape_conversion;
+
+  int             jobs;
+  int             tofile;
+  char            *output_file;
+  int             keep_order;
+  FILE            *output_stream;
+  unsigned int    next_record_number;
+  vrna_ostream_t  output_queue;
+};
+
+
+struct record_data {
+  unsigned int    number;
+  char            *id;
+  char            *sequence;
+  char            *SEQ_ID;
+  char            *input_filename;
+  struct options  *options;
+  int             tty;
+};
+
+
+struct output_stream {
+  vrna_cstr_t data;
+  int         individual;
+};
+
+
 typedef struct {
-  FILE  *output;
-  int   dangle_model;
+  vrna_cstr_t output;
+  int         dangle_model;
 } hit_data;
 
 
@@ -59,45 +106,85 @@ default_callback(int        start,
                  void       *data);
 
 
+static int
+process_input(FILE            *input_stream,
+              const char      *input_filename,
+              struct options  *opt);
+
+
+static void
+process_record(struct record_data *record);
+
+
+void
+init_default_options(struct options *opt)
+{
+  opt->filename_full  = 0;
+  opt->filename_delim = NULL;
+  opt->noconv         = 0;
+  opt->verbose        = 0;
+  opt->commands       = NULL;
+
+  /* apply default model details */
+  vrna_md_set_default(&(opt->md));
+
+  opt->zsc    = 0;
+  opt->min_z  = -2.0;
+
+  opt->shape            = 0;
+  opt->shape_file       = NULL;
+  opt->shape_method     = NULL;
+  opt->shape_conversion = NULL;
+
+  opt->jobs               = 1;
+  opt->tofile             = 0;
+  opt->output_file        = NULL;
+  opt->keep_order         = 1;
+  opt->output_stream      = NULL;
+  opt->next_record_number = 0;
+  opt->output_queue       = NULL;
+}
+
+
+void
+flush_cstr_callback(void          *auxdata,
+                    unsigned int  i,
+                    void          *data)
+{
+  struct output_stream *s = (struct output_stream *)data;
+
+  if (s) {
+    /* flush/free/close data[k] */
+    if (s->individual)
+      vrna_cstr_close(s->data);
+    else
+      vrna_cstr_free(s->data);
+
+    free(s);
+  }
+}
+
+
 int
 main(int  argc,
      char *argv[])
 {
-  FILE                        *input, *output;
+  FILE                        *input;
   struct  RNALfold_args_info  args_info;
-  char                        *ParamFile, *ns_bases, *rec_sequence, *rec_id, **rec_rest,
-                              *command_file, *orig_sequence, *infile, *outfile, *filename_delim,
-                              *shape_file, *shape_method, *shape_conversion;
-  unsigned int                rec_type, read_opt;
-  int                         length, istty, noconv, maxdist, zsc, tofile, filename_full,
-                              with_shapes, verbose;
-  double                      min_en, min_z;
-  vrna_md_t                   md;
-  vrna_cmd_t                  commands;
-  dataset_id                  id_control;
+  char                        *ParamFile, *ns_bases, *command_file, *infile;
+  int                         maxdist;
+  struct options              opt;
 
   ParamFile     = ns_bases = NULL;
   do_backtrack  = 1;
-  noconv        = 0;
   dangles       = 2;
   maxdist       = 150;
-  zsc           = 0;
-  min_z         = -2.0;
   gquad         = 0;
-  rec_type      = read_opt = 0;
-  rec_id        = rec_sequence = orig_sequence = NULL;
-  rec_rest      = NULL;
-  outfile       = NULL;
   infile        = NULL;
   input         = NULL;
-  output        = NULL;
-  tofile        = 0;
-  filename_full = 0;
   command_file  = NULL;
-  commands      = NULL;
 
-  /* apply default model details */
-  vrna_md_set_default(&md);
+  init_default_options(&opt);
 
   /*
    #############################################
@@ -108,15 +195,15 @@ main(int  argc,
     exit(1);
 
   /* parse options for ID manipulation */
-  ggo_get_id_control(args_info, id_control, "Sequence", "sequence", "_", 4, 1);
+  ggo_get_id_control(args_info, opt.id_control, "Sequence", "sequence", "_", 4, 1);
 
   /* temperature */
   if (args_info.temp_given)
-    md.temperature = temperature = args_info.temp_arg;
+    opt.md.temperature = temperature = args_info.temp_arg;
 
   /* do not take special tetra loop energies into account */
   if (args_info.noTetra_given)
-    md.special_hp = tetra_loop = 0;
+    opt.md.special_hp = tetra_loop = 0;
 
   /* set dangle model */
   if (args_info.dangles_given) {
@@ -124,28 +211,28 @@ main(int  argc,
       vrna_message_warning(
         "required dangle model not implemented, falling back to default dangles=2");
     else
-      md.dangles = dangles = args_info.dangles_arg;
+      opt.md.dangles = dangles = args_info.dangles_arg;
   }
 
   /* do not allow weak pairs */
   if (args_info.noLP_given)
-    md.noLP = noLonelyPairs = 1;
+    opt.md.noLP = noLonelyPairs = 1;
 
   /* do not allow wobble pairs (GU) */
   if (args_info.noGU_given)
-    md.noGU = noGU = 1;
+    opt.md.noGU = noGU = 1;
 
   /* do not allow weak closing pairs (AU,GU) */
   if (args_info.noClosingGU_given)
-    md.noGUclosure = no_closingGU = 1;
+    opt.md.noGUclosure = no_closingGU = 1;
 
   /* do not convert DNA nucleotide "T" to appropriate RNA "U" */
   if (args_info.noconv_given)
-    noconv = 1;
+    opt.noconv = 1;
 
   /* set energy model */
   if (args_info.energyModel_given)
-    md.energy_set = energy_set = args_info.energyModel_arg;
+    opt.md.energy_set = energy_set = args_info.energyModel_arg;
 
   /* take another energy parameter set */
   if (args_info.paramFile_given)
@@ -161,9 +248,9 @@ main(int  argc,
 
   if (args_info.zscore_given) {
 #ifdef VRNA_WITH_SVM
-    zsc = 1;
+    opt.zsc = 1;
     if (args_info.zscore_arg != -2)
-      min_z = args_info.zscore_arg;
+      opt.min_z = args_info.zscore_arg;
 
 #else
     vrna_message_error("\'z\' option is available only if compiled with SVM support!");
@@ -172,18 +259,18 @@ main(int  argc,
 
   /* gquadruplex support */
   if (args_info.gquad_given)
-    md.gquad = gquad = 1;
+    opt.md.gquad = gquad = 1;
 
   if (args_info.verbose_given)
-    verbose = 1;
+    opt.verbose = 1;
 
   /* SHAPE reactivity data */
-  ggo_get_SHAPE(args_info, with_shapes, shape_file, shape_method, shape_conversion);
+  ggo_get_SHAPE(args_info, opt.shape, opt.shape_file, opt.shape_method, opt.shape_conversion);
 
   if (args_info.outfile_given) {
-    tofile = 1;
+    opt.tofile = 1;
     if (args_info.outfile_arg)
-      outfile = strdup(args_info.outfile_arg);
+      opt.output_file = strdup(args_info.outfile_arg);
   }
 
   if (args_info.infile_given)
@@ -191,24 +278,49 @@ main(int  argc,
 
   /* filename sanitize delimiter */
   if (args_info.filename_delim_given)
-    filename_delim = strdup(args_info.filename_delim_arg);
-  else if (get_id_delim(id_control))
-    filename_delim = strdup(get_id_delim(id_control));
-  else
-    filename_delim = NULL;
-
-  if ((filename_delim) && isspace(*filename_delim)) {
-    free(filename_delim);
-    filename_delim = NULL;
+    opt.filename_delim = strdup(args_info.filename_delim_arg);
+  else if (get_id_delim(opt.id_control))
+    opt.filename_delim = strdup(get_id_delim(opt.id_control));
+
+  if ((opt.filename_delim) && isspace(*(opt.filename_delim))) {
+    free(opt.filename_delim);
+    opt.filename_delim = NULL;
   }
 
   /* full filename from FASTA header support */
   if (args_info.filename_full_given)
-    filename_full = 1;
+    opt.filename_full = 1;
 
   if (args_info.commands_given)
     command_file = strdup(args_info.commands_arg);
 
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNALfold has been built without parallel input processing capabilities");
+#endif
+
+    if (args_info.unordered_given)
+      opt.keep_order = 0;
+  }
+
   /* check for errorneous parameter options */
   if (maxdist <= 0) {
     RNALfold_cmdline_parser_print_help();
@@ -224,7 +336,7 @@ main(int  argc,
    #############################################
    */
 
-  md.max_bp_span = md.window_size = maxdist;
+  opt.md.max_bp_span = opt.md.window_size = maxdist;
 
   if (infile) {
     input = fopen((const char *)infile, "r");
@@ -242,16 +354,18 @@ main(int  argc,
   }
 
   if (command_file != NULL)
-    commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+    opt.commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
 
   if (ns_bases != NULL)
-    vrna_md_set_nonstandards(&md, ns_bases);
+    vrna_md_set_nonstandards(&(opt.md), ns_bases);
 
-  istty     = (!infile) && isatty(fileno(stdout)) && isatty(fileno(stdin));
-  read_opt  |= VRNA_INPUT_NO_REST;
-  if (istty) {
-    vrna_message_input_seq_simple();
-    read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
+  if (opt.keep_order) {
+    if (opt.jobs > 1)
+      opt.output_queue = vrna_ostream_init_bounded(&flush_cstr_callback,
+                                                   NULL,
+                                                   OUTPUT_QUEUE_CAPACITY(opt.jobs));
+    else
+      opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
   }
 
   /*
@@ -259,153 +373,288 @@ main(int  argc,
    # main loop: continue until end of file
    #############################################
    */
-  while (
-    !((rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, input, read_opt))
-      & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
-    /*
-     ########################################################
-     # init everything according to the data we've read
-     ########################################################
-     */
-    char  *SEQ_ID       = NULL;
-    char  *v_file_name  = NULL;
-    char  *tmp_string   = NULL;
-    /*
-     ########################################################
-     # init everything according to the data we've read
-     ########################################################
-     */
-    if (rec_id) /* remove '>' from FASTA header */
-      rec_id = memmove(rec_id, rec_id + 1, strlen(rec_id));
+  INIT_PARALLELIZATION(opt.jobs);
 
-    /* construct the sequence ID */
-    set_next_id(&rec_id, id_control);
-    SEQ_ID = fileprefix_from_id(rec_id, id_control, filename_full);
-
-    if (tofile) {
-      /* prepare the file name */
-      if (outfile)
-        v_file_name = vrna_strdup_printf("%s", outfile);
-      else
-        v_file_name = (SEQ_ID) ?
-                      vrna_strdup_printf("%s.lfold", SEQ_ID) :
-                      vrna_strdup_printf("RNALfold_output.lfold");
-
-      tmp_string = vrna_filename_sanitize(v_file_name, filename_delim);
-      free(v_file_name);
-      v_file_name = tmp_string;
-
-      if (infile && !strcmp(infile, v_file_name))
-        vrna_message_error("Input and output file names are identical");
-
-      output = fopen((const char *)v_file_name, "a");
-      if (!output)
-        vrna_message_error("Failed to open file for writing");
-    } else {
+  (void)process_input(input, (const char *)infile, &opt);
+
+  UNINIT_PARALLELIZATION
+
+  /*
+   ################################################
+   # post processing
+   ################################################
+   */
+  vrna_ostream_free(opt.output_queue);
+
+  if ((opt.output_stream) && (opt.output_stream != stdout))
+    fclose(opt.output_stream);
+
+  if (infile && input)
+    fclose(input);
+
+  free(infile);
+  free(ParamFile);
+  free(ns_bases);
+  free(opt.shape_file);
+  free(opt.shape_method);
+  free(opt.shape_conversion);
+  free(opt.filename_delim);
+  free(opt.output_file);
+  free(command_file);
+  vrna_commands_free(opt.commands);
+
+  free_id_data(opt.id_control);
+
+  return EXIT_SUCCESS;
+}
+
+
+static struct output_stream *
+get_output_stream(unsigned int    init_size,
+                  struct options  *opt,
+                  const char      *SEQ_ID,
+                  const char      *input_filename)
+{
+  struct output_stream  *o_stream;
+  FILE                  *output;
+  int                   individual_stream;
+
+  individual_stream = 0; /* we default to using a single output sink */
+
+  o_stream = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
+
+  /* in case we do parallel processing of input, let's block access to the opt->output_stream pointer */
+  ATOMIC_BLOCK(({
+    /* default to stream that we've already opened */
+    output = opt->output_stream;
+
+    if ((!opt->tofile) && (!output)) {
       output = stdout;
+      opt->output_stream = stdout;
+    } else if (opt->tofile) {
+      char *filename, *tmp;
+
+      tmp = filename = NULL;
+
+      if ((!opt->output_file) && (SEQ_ID)) {
+        /* need to open new individual output file */
+        tmp = vrna_strdup_printf("%s.lfold", SEQ_ID);
+        individual_stream = 1;
+
+        filename = vrna_filename_sanitize(tmp, opt->filename_delim);
+
+        if ((input_filename) && !strcmp(input_filename, filename))
+          vrna_message_error("Input and output file names are identical");
+
+        if (!(output = fopen(filename, "a")))
+          vrna_message_error("Failed to open file for writing");
+      } else if (!output) {
+        /* we need to open global output file */
+        tmp = (opt->output_file) ?
+              vrna_strdup_printf("%s", opt->output_file) :
+              vrna_strdup_printf("RNALfold_output.lfold");
+
+        filename = vrna_filename_sanitize(tmp, opt->filename_delim);
+
+        if ((input_filename) && !strcmp(input_filename, filename))
+          vrna_message_error("Input and output file names are identical");
+
+        if (!(output = fopen(filename, "a")))
+          vrna_message_error("Failed to open file for writing");
+
+        opt->output_stream = output;
+      }
+
+      free(tmp);
+      free(filename);
     }
 
-    if (!istty)
-      print_fasta_header(output, rec_id);
+    /* actually initialize vrna_cstr_t of the stream */
+    o_stream->data = vrna_cstr(init_size, output);
+    o_stream->individual = (individual_stream) ? 1 : 0;
+  }));
+
+  return o_stream;
+}
+
+
+static int
+process_input(FILE            *input_stream,
+              const char      *input_filename,
+              struct options  *opt)
+{
+  int           ret       = 1;
+  int           istty_in  = (!input_filename) && isatty(fileno(input_stream));
+  int           istty_out = isatty(fileno(stdout));
+
+  unsigned int  read_opt = VRNA_INPUT_NO_REST;
+
+  /* print user help if we get input from tty */
+  if (istty_in && istty_out) {
+    vrna_message_input_seq_simple();
+    read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
+  }
 
-    length = (int)strlen(rec_sequence);
+  /* main loop that processes each record obtained from input stream */
+  do {
+    char          *rec_sequence, *rec_id, **rec_rest;
+    unsigned int  rec_type;
 
-    /* convert DNA alphabet to RNA if not explicitely switched off */
-    if (!noconv)
-      vrna_seq_toRNA(rec_sequence);
+    rec_id    = NULL;
+    rec_rest  = NULL;
 
-    /* store case-unmodified sequence */
-    orig_sequence = strdup(rec_sequence);
-    /* convert sequence to uppercase letters only */
-    vrna_seq_toupper(rec_sequence);
+    rec_type = vrna_file_fasta_read_record(&rec_id,
+                                           &rec_sequence,
+                                           &rec_rest,
+                                           input_stream,
+                                           read_opt);
 
-    if (!tofile && istty)
-      vrna_message_info(output, "length = %d", length);
+    if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
+      break;
 
     /*
      ########################################################
-     # done with 'stdin' handling
-     # begin actual computations
+     # init everything according to the data we've read
      ########################################################
      */
+    if (rec_id) /* remove '>' from FASTA header */
+      rec_id = memmove(rec_id, rec_id + 1, strlen(rec_id));
 
-    vrna_fold_compound_t *vc = vrna_fold_compound((const char *)rec_sequence,
-                                                  &md,
-                                                  VRNA_OPTION_MFE | VRNA_OPTION_WINDOW);
+    /* construct the sequence ID */
+    set_next_id(&rec_id, opt->id_control);
 
-    if (commands)
-      vrna_commands_apply(vc, commands, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    if (with_shapes) {
-      vrna_constraints_add_SHAPE(vc,
-                                 shape_file,
-                                 shape_method,
-                                 shape_conversion,
-                                 verbose,
-                                 VRNA_OPTION_WINDOW);
-    }
+    record->number          = opt->next_record_number;
+    record->sequence        = rec_sequence;
+    record->SEQ_ID          = fileprefix_from_id(rec_id, opt->id_control, opt->filename_full);
+    record->id              = rec_id;
+    record->options         = opt;
+    record->tty             = istty_in && istty_out;
+    record->input_filename  = (input_filename) ? strdup(input_filename) : NULL;
 
-    hit_data data;
-    data.output       = output;
-    data.dangle_model = md.dangles;
+    if (opt->output_queue)
+      vrna_ostream_request(opt->output_queue, opt->next_record_number++);
 
-#ifdef VRNA_WITH_SVM
-    min_en =
-      (zsc) ? vrna_mfe_window_zscore_cb(vc, min_z, &default_callback_z,
-                                        (void *)&data) : vrna_mfe_window_cb(vc, &default_callback,
-                                                                            (void *)&data);
-#else
-    min_en = vrna_mfe_window_cb(vc, &default_callback, (void *)&data);
-#endif
-    fprintf(output, "%s\n", orig_sequence);
+    RUN_IN_PARALLEL(process_record, record);
 
-    char *msg = NULL;
-    if (!tofile && istty)
-      msg = vrna_strdup_printf(" minimum free energy = %6.2f kcal/mol", min_en);
-    else
-      msg = vrna_strdup_printf(" (%6.2f)", min_en);
+    if (opt->shape) {
+      ret = 0;
+      break;
+    }
 
-    print_structure(output, NULL, msg);
-    free(msg);
+    /* print user help for the next round if we get input from tty */
+    if (istty_in && istty_out)
+      vrna_message_input_seq_simple();
+  } while (1);
 
-    if (output)
-      (void)fflush(output);
+  return ret;
+}
 
-    if (tofile && output) {
-      fclose(output);
-      output = NULL;
-    }
 
-    /* clean up */
-    vrna_fold_compound_free(vc);
-    free(rec_id);
-    free(SEQ_ID);
-    free(rec_sequence);
-    free(orig_sequence);
-    rec_id    = rec_sequence = orig_sequence = NULL;
-    rec_rest  = NULL;
+static void
+process_record(struct record_data *record)
+{
+  char                  *rec_sequence;
+  int                   length;
+  double                min_en;
+  struct options        *opt;
+  struct output_stream  *o_stream;
+  vrna_fold_compound_t  *vc;
+  hit_data              data;
+
+  opt           = record->options;
+  rec_sequence  = strdup(record->sequence);
+  length        = (int)strlen(rec_sequence);
+
+  /* retrieve string stream bound to stdout or output file, 6*length should be enough to start with */
+  o_stream = get_output_stream(6 * length,
+                               opt,
+                               record->SEQ_ID,
+                               record->input_filename);
+
+  if (!record->tty)
+    vrna_cstr_print_fasta_header(o_stream->data, record->id);
+
+  /* convert DNA alphabet to RNA if not explicitely switched off */
+  if (!opt->noconv) {
+    vrna_seq_toRNA(rec_sequence);
+    vrna_seq_toRNA(record->sequence);
+  }
 
-    free(v_file_name);
+  /* convert sequence to uppercase letters only */
+  vrna_seq_toupper(rec_sequence);
 
-    if (with_shapes)
-      break;
+  if (!opt->tofile && record->tty)
+    vrna_message_info(stdout, "length = %d", length);
 
-    /* print user help for the next round if we get input from tty */
+  /*
+   ########################################################
+   # done with 'stdin' handling
+   # begin actual computations
+   ########################################################
+   */
 
-    if (istty)
-      vrna_message_input_seq_simple();
+  vc = vrna_fold_compound((const char *)rec_sequence,
+                          &(opt->md),
+                          VRNA_OPTION_MFE | VRNA_OPTION_WINDOW);
+
+  if (opt->commands)
+    vrna_commands_apply(vc, opt->commands, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+
+  if (opt->shape) {
+    vrna_constraints_add_SHAPE(vc,
+                               opt->shape_file,
+                               opt->shape_method,
+                               opt->shape_conversion,
+                               opt->verbose,
+                               VRNA_OPTION_WINDOW);
   }
 
-  if (infile && input)
-    fclose(input);
+  data.output       = o_stream->data;
+  data.dangle_model = opt->md.dangles;
 
-  free(filename_delim);
-  free(command_file);
-  vrna_commands_free(commands);
+#ifdef VRNA_WITH_SVM
+  min_en =
+    (opt->zsc) ? vrna_mfe_window_zscore_cb(vc, opt->min_z, &default_callback_z,
+                                           (void *)&data) : vrna_mfe_window_cb(vc,
+                                                                               &default_callback,
+                                                                               (void *)&data);
+#else
+  min_en = vrna_mfe_window_cb(vc, &default_callback, (void *)&data);
+#endif
+  vrna_cstr_printf(o_stream->data, "%s\n", record->sequence);
+
+  vrna_cstr_printf_structure(o_stream->data,
+                             NULL,
+                             (!opt->tofile && record->tty) ?
+                             " minimum free energy = %6.2f kcal/mol" :
+                             " (%6.2f)",
+                             min_en);
+
+  /* print what we've collected in output charstream */
+  if (opt->output_queue) {
+    if (o_stream->individual) {
+      /* output immediately */
+      ATOMIC_BLOCK(flush_cstr_callback(NULL, record->number, (void *)o_stream));
+
+      /* use dummy element for insert into queue */
+      o_stream = NULL;
+    }
 
-  free_id_data(id_control);
+    vrna_ostream_provide(opt->output_queue, record->number, (void *)o_stream);
+  } else {
+    ATOMIC_BLOCK(flush_cstr_callback(NULL, record->number, (void *)o_stream));
+  }
 
-  return EXIT_SUCCESS;
+  /* clean up */
+  vrna_fold_compound_free(vc);
+  free(record->id);
+  free(record->SEQ_ID);
+  free(record->sequence);
+  free(record->input_filename);
+  free(record);
+  free(rec_sequence);
 }
 
 
@@ -416,22 +665,17 @@ default_callback(int        start,
                  float      en,
                  void       *data)
 {
-  FILE  *output       = ((hit_data *)data)->output;
-  int   dangle_model  = ((hit_data *)data)->dangle_model;
-  char  *struct_d2    = NULL;
-  char  *msg          = NULL;
+  vrna_cstr_t output        = ((hit_data *)data)->output;
+  int         dangle_model  = ((hit_data *)data)->dangle_model;
+  char        *struct_d2    = NULL;
 
   if ((dangle_model == 2) && (start > 1)) {
-    msg       = vrna_strdup_printf(" (%6.2f) %4d", en, start - 1);
     struct_d2 = vrna_strdup_printf(".%s", structure);
-    print_structure(output, struct_d2, msg);
+    vrna_cstr_printf_structure(output, struct_d2, " (%6.2f) %4d", en, start - 1);
     free(struct_d2);
   } else {
-    msg = vrna_strdup_printf(" (%6.2f) %4d", en, start);
-    print_structure(output, structure, msg);
+    vrna_cstr_printf_structure(output, structure, " (%6.2f) %4d", en, start);
   }
-
-  free(msg);
 }
 
 
@@ -444,22 +688,22 @@ default_callback_z(int        start,
                    float      zscore,
                    void       *data)
 {
-  FILE  *output       = ((hit_data *)data)->output;
-  int   dangle_model  = ((hit_data *)data)->dangle_model;
-  char  *struct_d2    = NULL;
-  char  *msg          = NULL;
+  vrna_cstr_t output        = ((hit_data *)data)->output;
+  int         dangle_model  = ((hit_data *)data)->dangle_model;
+  char        *struct_d2    = NULL;
 
   if ((dangle_model == 2) && (start > 1)) {
-    msg       = vrna_strdup_printf(" (%6.2f) %4d z= %.3f", en, start - 1, zscore);
     struct_d2 = vrna_strdup_printf(".%s", structure);
-    print_structure(output, struct_d2, msg);
+    vrna_cstr_printf_structure(output,
+                               struct_d2,
+                               " (%6.2f) %4d z= %.3f",
+                               en,
+                               start - 1,
+                               zscore);
     free(struct_d2);
   } else {
-    msg = vrna_strdup_printf(" (%6.2f) %4d z= %.3f", en, start, zscore);
-    print_structure(output, structure, msg);
+    vrna_cstr_printf_structure(output, structure, " (%6.2f) %4d z= %.3f", en, start, zscore);
   }
-
-  free(msg);
 }
 
 
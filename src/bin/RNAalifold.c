@@ -617,8 +617,14 @@ main(int  argc,
 
   first_alignment_number = get_current_id(opt.id_control);
 
-  if (opt.keep_order)
-    opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  if (opt.keep_order) {
+    if (opt.jobs > 1)
+      opt.output_queue = vrna_ostream_init_bounded(&flush_cstr_callback,
+                                                   NULL,
+                                                   OUTPUT_QUEUE_CAPACITY(opt.jobs));
+    else
+      opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  }
 
   /*
    ################################################
@@ -43,6 +43,7 @@
 #include "input_id_helpers.h"
 #include "ViennaRNA/color_output.inc"
 #include "parallel_helpers.h"
+#include "timing_helpers.h"
 
 
 struct options {
@@ -58,6 +59,7 @@ struct options {
   double          MEAgamma;
   double          bppmThreshold;
   int             verbose;
+  int             timing;
   vrna_md_t       md;
   vrna_cmd_t      commands;
 
@@ -182,6 +184,7 @@ init_default_options(struct options *opt)
   opt->MEAgamma       = 1.;
   opt->bppmThreshold  = 1e-5;
   opt->verbose        = 0;
+  opt->timing         = 0;
   opt->commands       = NULL;
   opt->id_control     = NULL;
   set_model_details(&(opt->md));
@@ -361,6 +364,9 @@ main(int  argc,
   if (args_info.verbose_given)
     opt.verbose = 1;
 
+  if (args_info.timing_given)
+    opt.timing = 1;
+
   if (args_info.commands_given)
     opt.commands = vrna_file_commands_read(args_info.commands_arg,
                                            VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
@@ -460,8 +466,14 @@ main(int  argc,
   if ((opt.verbose) && (opt.jobs > 1))
     vrna_message_info(stderr, "Preparing %d parallel computation slots", opt.jobs);
 
-  if (opt.keep_order)
-    opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  if (opt.keep_order) {
+    if (opt.jobs > 1)
+      opt.output_queue = vrna_ostream_init_bounded(&flush_cstr_callback,
+                                                   NULL,
+                                                   OUTPUT_QUEUE_CAPACITY(opt.jobs));
+    else
+      opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  }
 
   /*
    ################################################
@@ -500,6 +512,8 @@ main(int  argc,
   }
 
   UNINIT_PARALLELIZATION
+
+  fold_compound_pool_free();
   /*
    ################################################
    # post processing
@@ -641,7 +655,7 @@ process_record(struct record_data *record)
 {
   char                  *mfe_structure, *sequence, **rec_rest;
   unsigned int          n, i;
-  double                min_en, kT, *concentrations;
+  double                min_en, kT, *concentrations, t_start;
   vrna_ep_t             *prAB, *prAA, *prBB, *prA, *prB, *mfAB, *mfAA, *mfBB, *mfA, *mfB;
   struct options        *opt;
   struct output_stream  *o_stream;
@@ -650,6 +664,7 @@ process_record(struct record_data *record)
   prAB            = prAA = prBB = prA = prB = NULL;
   concentrations  = NULL;
   opt             = record->options;
+  t_start         = (opt->timing) ? timing_wall_time() : 0.;
   o_stream        = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
   sequence        = strdup(record->sequence);
   rec_rest        = record->rest;
@@ -663,9 +678,14 @@ process_record(struct record_data *record)
   /* convert sequence to uppercase letters only */
   vrna_seq_toupper(sequence);
 
-  vrna_fold_compound_t *vc = vrna_fold_compound(sequence,
-                                                &(opt->md),
-                                                VRNA_OPTION_DEFAULT | VRNA_OPTION_HYBRID);
+  vrna_fold_compound_t *vc = fold_compound_pool_get(sequence,
+                                                    &(opt->md),
+                                                    VRNA_OPTION_DEFAULT | VRNA_OPTION_HYBRID);
+
+  /* re-used fold compounds keep the measurements of their setup for this record */
+  if ((opt->timing) && (!vc->timing))
+    vrna_fold_compound_timing(vc, 1);
+
   n = vc->length;
 
   /* retrieve string stream bound to stdout, 6*length should be enough memory to start with */
@@ -1136,6 +1156,16 @@ cleanup_record:
   else
     flush_cstr_callback(NULL, 0, (void *)o_stream);
 
+  if (opt->timing) {
+    timing_print_record(stderr,
+                        "RNAcofold",
+                        record->number,
+                        record->SEQ_ID,
+                        vc,
+                        timing_wall_time() - t_start);
+    vrna_timing_reset(vc->timing);
+  }
+
   /* clean up */
   free(record->SEQ_ID);
   free(record->id);
@@ -1149,7 +1179,7 @@ cleanup_record:
     free(record->rest);
   }
 
-  vrna_fold_compound_free(vc);
+  fold_compound_pool_release(vc);
 
   free(record);
 }
@@ -21,11 +21,79 @@
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/subopt.h"
 #include "ViennaRNA/duplex.h"
+#include "ViennaRNA/datastructures/char_stream.h"
+#include "ViennaRNA/datastructures/stream_output.h"
 #include "RNAduplex_cmdl.h"
+#include "parallel_helpers.h"
 
 #include "ViennaRNA/color_output.inc"
 
-PRIVATE void  print_struc(duplexT const *dup);
+struct options {
+  int             noconv;
+  int             delta;
+
+  int             jobs;
+  int             keep_order;
+  unsigned int    next_record_number;
+  vrna_ostream_t  output_queue;
+};
+
+
+struct record_data {
+  unsigned int          number;
+  char                  *s1;
+  char                  *s2;
+  struct output_stream  *o_stream;
+  struct options        *options;
+  int                   tty;
+};
+
+
+struct output_stream {
+  vrna_cstr_t data;
+};
+
+
+PRIVATE void
+print_struc(vrna_cstr_t   output,
+            duplexT const *dup);
+
+
+static int
+process_input(struct options *opt);
+
+
+static void
+process_record(struct record_data *record);
+
+
+void
+init_default_options(struct options *opt)
+{
+  opt->noconv = 0;
+  opt->delta  = -1;
+
+  opt->jobs               = 1;
+  opt->keep_order         = 1;
+  opt->next_record_number = 0;
+  opt->output_queue       = NULL;
+}
+
+
+void
+flush_cstr_callback(void          *auxdata,
+                    unsigned int  i,
+                    void          *data)
+{
+  struct output_stream *s = (struct output_stream *)data;
+
+  if (s) {
+    /* flush/free data[k] */
+    vrna_cstr_free(s->data);
+
+    free(s);
+  }
+}
 
 
 /*--------------------------------------------------------------------------*/
@@ -35,17 +103,15 @@ main(int  argc,
      char *argv[])
 {
   struct        RNAduplex_args_info args_info;
-  char                              *input_string, *s1, *s2, *orig_s1, *orig_s2,
-                                    *c, *ParamFile, *ns_bases;
-  unsigned int                      input_type;
-  int                               i, sym, istty, delta, noconv;
+  char                              *c, *ParamFile, *ns_bases;
+  int                               i, sym;
+  struct options                    opt;
 
   ParamFile = NULL;
   ns_bases  = NULL;
-  s1        = s2 = orig_s1 = orig_s2 = NULL;
   dangles   = 2;
-  delta     = -1;
-  noconv    = 0;
+
+  init_default_options(&opt);
 
   /*
    #############################################
@@ -85,7 +151,7 @@ main(int  argc,
 
   /* do not convert DNA nucleotide "T" to appropriate RNA "U" */
   if (args_info.noconv_given)
-    noconv = 1;
+    opt.noconv = 1;
 
   /* take another energy parameter set */
   if (args_info.paramFile_given)
@@ -97,12 +163,39 @@ main(int  argc,
 
   /*energy range */
   if (args_info.deltaEnergy_given)
-    delta = (int)(0.1 + args_info.deltaEnergy_arg * 100);
+    opt.delta = (int)(0.1 + args_info.deltaEnergy_arg * 100);
 
   /* sorted output */
   if (args_info.sorted_given)
     subopt_sorted = 1;
 
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAduplex has been built without parallel input processing capabilities");
+#endif
+
+    if (args_info.unordered_given)
+      opt.keep_order = 0;
+  }
+
   /* free allocated memory of command line data structure */
   RNAduplex_cmdline_parser_free(&args_info);
 
@@ -142,15 +235,54 @@ main(int  argc,
     }
   }
 
-  istty = isatty(fileno(stdout)) && isatty(fileno(stdin));
+  update_fold_params();
+
+  if (opt.keep_order) {
+    if (opt.jobs > 1)
+      opt.output_queue = vrna_ostream_init_bounded(&flush_cstr_callback,
+                                                   NULL,
+                                                   OUTPUT_QUEUE_CAPACITY(opt.jobs));
+    else
+      opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  }
 
   /*
    #############################################
    # main loop: continue until end of file
    #############################################
    */
+  INIT_PARALLELIZATION(opt.jobs);
+
+  (void)process_input(&opt);
+
+  UNINIT_PARALLELIZATION
+
+  vrna_ostream_free(opt.output_queue);
+
+  free(ParamFile);
+  free(ns_bases);
+
+  return 0;
+}
+
+
+static int
+process_input(struct options *opt)
+{
+  char                  *input_string, *s1, *s2;
+  unsigned int          input_type;
+  int                   istty;
+  struct output_stream  *o_stream;
+
+  istty = isatty(fileno(stdout)) && isatty(fileno(stdin));
+
   do {
-    duplexT mfe, *subopt;
+    s1 = s2 = NULL;
+
+    /* collect FASTA headers along with the results of the current pair */
+    o_stream        = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
+    o_stream->data  = vrna_cstr(128, stdout);
+
     /*
      ########################################################
      # handle user input from 'stdin'
@@ -161,7 +293,7 @@ main(int  argc,
 
     /* extract filename from fasta header if available */
     while ((input_type = get_input_line(&input_string, 0)) == VRNA_INPUT_FASTA_HEADER) {
-      print_fasta_header(stdout, input_string);
+      vrna_cstr_print_fasta_header(o_stream->data, input_string);
       free(input_string);
     }
 
@@ -177,7 +309,7 @@ main(int  argc,
 
     /* get second sequence */
     while ((input_type = get_input_line(&input_string, 0)) == VRNA_INPUT_FASTA_HEADER) {
-      print_fasta_header(stdout, input_string);
+      vrna_cstr_print_fasta_header(o_stream->data, input_string);
       free(input_string);
     }
     /* break on any error, EOF or quit request */
@@ -190,71 +322,105 @@ main(int  argc,
       free(input_string);
     }
 
-    /* convert DNA alphabet to RNA if not explicitely switched off */
-    if (!noconv) {
-      vrna_seq_toRNA(s1);
-      vrna_seq_toRNA(s2);
-    }
-
-    /* store case-unmodified sequence */
-    orig_s1 = strdup(s1);
-    orig_s2 = strdup(s2);
-    /* convert sequence to uppercase letters only */
-    vrna_seq_toupper(s1);
-    vrna_seq_toupper(s2);
-
     if (istty)
       vrna_message_info(stdout, "lengths = %d,%d\n", (int)strlen(s1), (int)strlen(s2));
 
-    /*
-     ########################################################
-     # done with 'stdin' handling, now init everything properly
-     ########################################################
-     */
-    update_fold_params();
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    /*
-     ########################################################
-     # begin actual computations
-     ########################################################
-     */
-    if (delta >= 0) {
-      duplexT *sub;
-      subopt = duplex_subopt(s1, s2, delta, 5);
-      for (sub = subopt; sub->i > 0; sub++) {
-        print_struc(sub);
-        free(sub->structure);
-      }
-      free(subopt);
-    } else {
-      mfe = duplexfold(s1, s2);
-      print_struc(&mfe);
-      free(mfe.structure);
-    }
+    record->number    = opt->next_record_number;
+    record->s1        = s1;
+    record->s2        = s2;
+    record->o_stream  = o_stream;
+    record->options   = opt;
+    record->tty       = istty;
+
+    if (opt->output_queue)
+      vrna_ostream_request(opt->output_queue, opt->next_record_number++);
 
-    (void)fflush(stdout);
-    free(s1);
-    free(s2);
-    free(orig_s1);
-    free(orig_s2);
-    s1 = s2 = orig_s1 = orig_s2 = NULL;
+    RUN_IN_PARALLEL(process_record, record);
   } while (1);
-  return 0;
+
+  /* headers of an incomplete pair are printed nevertheless */
+  if (opt->output_queue) {
+    vrna_ostream_request(opt->output_queue, opt->next_record_number);
+    vrna_ostream_provide(opt->output_queue, opt->next_record_number++, (void *)o_stream);
+  } else {
+    ATOMIC_BLOCK(flush_cstr_callback(NULL, 0, (void *)o_stream));
+  }
+
+  free(s1);
+
+  return 1;
+}
+
+
+static void
+process_record(struct record_data *record)
+{
+  char                  *s1, *s2;
+  struct options        *opt;
+  struct output_stream  *o_stream;
+
+  opt       = record->options;
+  o_stream  = record->o_stream;
+  s1        = record->s1;
+  s2        = record->s2;
+
+  /* convert DNA alphabet to RNA if not explicitely switched off */
+  if (!opt->noconv) {
+    vrna_seq_toRNA(s1);
+    vrna_seq_toRNA(s2);
+  }
+
+  /* convert sequence to uppercase letters only */
+  vrna_seq_toupper(s1);
+  vrna_seq_toupper(s2);
+
+  /*
+   ########################################################
+   # begin actual computations
+   ########################################################
+   */
+  if (opt->delta >= 0) {
+    duplexT *sub, *subopt;
+    subopt = duplex_subopt(s1, s2, opt->delta, 5);
+    for (sub = subopt; sub->i > 0; sub++) {
+      print_struc(o_stream->data, sub);
+      free(sub->structure);
+    }
+    free(subopt);
+  } else {
+    duplexT mfe;
+    mfe = duplexfold(s1, s2);
+    print_struc(o_stream->data, &mfe);
+    free(mfe.structure);
+  }
+
+  /* print what we've collected in output charstream */
+  if (opt->output_queue)
+    vrna_ostream_provide(opt->output_queue, record->number, (void *)o_stream);
+  else
+    ATOMIC_BLOCK(flush_cstr_callback(NULL, record->number, (void *)o_stream));
+
+  free(s1);
+  free(s2);
+  free(record);
 }
 
 
 PRIVATE void
-print_struc(duplexT const *dup)
+print_struc(vrna_cstr_t   output,
+            duplexT const *dup)
 {
-  int   l1;
+  int l1;
 
   l1 = strchr(dup->structure, '&') - dup->structure;
-  char  *msg = vrna_strdup_printf(" %3d,%-3d : %3d,%-3d (%5.2f)",
-                                  dup->i + 1 - l1,
-                                  dup->i,
-                                  dup->j,
-                                  dup->j + (int)strlen(dup->structure) - l1 - 2,
-                                  dup->energy);
-  print_structure(stdout, dup->structure, msg);
-  free(msg);
+  vrna_cstr_printf_structure(output,
+                             dup->structure,
+                             " %3d,%-3d : %3d,%-3d (%5.2f)",
+                             dup->i + 1 - l1,
+                             dup->i,
+                             dup->j,
+                             dup->j + (int)strlen(dup->structure) - l1 - 2,
+                             dup->energy);
 }
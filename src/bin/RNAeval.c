@@ -316,8 +316,14 @@ main(int  argc,
   if (opt.md.circ && opt.md.gquad)
     vrna_message_error("G-Quadruplex support is currently not available for circular RNA structures");
 
-  if (opt.keep_order)
-    opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  if (opt.keep_order) {
+    if (opt.jobs > 1)
+      opt.output_queue = vrna_ostream_init_bounded(&flush_cstr_callback,
+                                                   NULL,
+                                                   OUTPUT_QUEUE_CAPACITY(opt.jobs));
+    else
+      opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  }
 
   int (*processing_func)(FILE           *stream,
                          const char     *filename,
@@ -53,8 +53,15 @@
 #include "gengetopt_helper.h"
 #include "input_id_helpers.h"
 #include "parallel_helpers.h"
+#include "timing_helpers.h"
 
 
+/*
+ *  Use banded DP matrices for MFE predictions if the maximum base pair span
+ *  is at most 1/BANDED_MFE_SPAN_RATIO of the sequence length
+ */
+#define BANDED_MFE_SPAN_RATIO   4
+
 struct options {
   int             filename_full;
   char            *filename_delim;
@@ -67,6 +74,7 @@ struct options {
   double          MEAgamma;
   double          bppmThreshold;
   int             verbose;
+  int             timing;
   char            *ligandMotif;
   vrna_cmd_t      cmds;
   vrna_md_t       md;
@@ -83,6 +91,7 @@ struct options {
   char            *shape_conversion;
 
   int             jobs;
+  int             threads;
   int             tofile;
   char            *output_file;
   int             keep_order;
@@ -110,6 +119,11 @@ struct output_stream {
 };
 
 
+static int
+use_banded_mfe(struct options *opt,
+               const char     *sequence);
+
+
 static char *
 annotate_ligand_motif(vrna_fold_compound_t  *vc,
                       const char            *structure);
@@ -370,6 +384,7 @@ init_default_options(struct options *opt)
   opt->MEAgamma       = 1.;
   opt->bppmThreshold  = 1e-5;
   opt->verbose        = 0;
+  opt->timing         = 0;
   opt->ligandMotif    = NULL;
   opt->cmds           = NULL;
   set_model_details(&(opt->md));
@@ -385,6 +400,7 @@ init_default_options(struct options *opt)
   opt->shape_conversion = NULL;
 
   opt->jobs               = 1;
+  opt->threads            = 1;
   opt->tofile             = 0;
   opt->output_file        = NULL;
   opt->keep_order         = 1;
@@ -487,6 +503,9 @@ main(int  argc,
   if (args_info.verbose_given)
     opt.verbose = 1;
 
+  if (args_info.timing_given)
+    opt.timing = 1;
+
   if (args_info.outfile_given) {
     opt.tofile = 1;
     if (args_info.outfile_arg)
@@ -541,6 +560,13 @@ main(int  argc,
       opt.keep_order = 0;
   }
 
+  if (args_info.threads_given) {
+    if (args_info.threads_arg < 0)
+      vrna_message_warning("Number of threads must not be negative. Using a single thread!");
+    else
+      opt.threads = args_info.threads_arg;
+  }
+
   input_files = collect_unnamed_options(&args_info, &num_input);
   input_files = append_input_files(&args_info, input_files, &num_input);
 
@@ -565,8 +591,14 @@ main(int  argc,
   if ((opt.verbose) && (opt.jobs > 1))
     vrna_message_info(stderr, "Preparing %d parallel computation slots", opt.jobs);
 
-  if (opt.keep_order)
-    opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  if (opt.keep_order) {
+    if (opt.jobs > 1)
+      opt.output_queue = vrna_ostream_init_bounded(&flush_cstr_callback,
+                                                   NULL,
+                                                   OUTPUT_QUEUE_CAPACITY(opt.jobs));
+    else
+      opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  }
 
   /*
    ################################################
@@ -606,6 +638,8 @@ main(int  argc,
 
   UNINIT_PARALLELIZATION
 
+  fold_compound_pool_free();
+
   /*
    ################################################
    # post processing
@@ -808,11 +842,12 @@ process_record(struct record_data *record)
   unsigned int          length;
   struct options        *opt;
   char                  *rec_sequence, *mfe_structure;
-  double                min_en, energy;
+  double                min_en, energy, t_start;
   vrna_fold_compound_t  *vc;
   struct output_stream  *o_stream;
 
-  opt = record->options;
+  opt     = record->options;
+  t_start = (opt->timing) ? timing_wall_time() : 0.;
 
   rec_sequence = strdup(record->sequence);
 
@@ -825,7 +860,19 @@ process_record(struct record_data *record)
   /* convert sequence to uppercase letters only */
   vrna_seq_toupper(rec_sequence);
 
-  vc = vrna_fold_compound(rec_sequence, &(opt->md), VRNA_OPTION_DEFAULT);
+  if (use_banded_mfe(opt, rec_sequence)) {
+    vrna_md_t md = opt->md;
+    md.window_size  = md.max_bp_span;
+    vc              = vrna_fold_compound(rec_sequence, &md, VRNA_OPTION_DEFAULT | VRNA_OPTION_WINDOW);
+  } else {
+    vc = fold_compound_pool_get(rec_sequence, &(opt->md), VRNA_OPTION_DEFAULT);
+  }
+
+  vrna_fold_compound_num_threads(vc, opt->threads);
+
+  /* re-used fold compounds keep the measurements of their setup for this record */
+  if ((opt->timing) && (!vc->timing))
+    vrna_fold_compound_timing(vc, 1);
 
   length = vc->length;
 
@@ -1064,8 +1111,18 @@ process_record(struct record_data *record)
     ATOMIC_BLOCK(flush_cstr_callback(NULL, record->number, (void *)o_stream));
   }
 
+  if (opt->timing) {
+    timing_print_record(stderr,
+                        "RNAfold",
+                        record->number,
+                        record->SEQ_ID,
+                        vc,
+                        timing_wall_time() - t_start);
+    vrna_timing_reset(vc->timing);
+  }
+
   /* clean up */
-  vrna_fold_compound_free(vc);
+  fold_compound_pool_release(vc);
   free(record->id);
   free(record->SEQ_ID);
   free(record->sequence);
@@ -1259,6 +1316,31 @@ add_ligand_motif(vrna_fold_compound_t *vc,
 }
 
 
+static int
+use_banded_mfe(struct options *opt,
+               const char     *sequence)
+{
+  int length;
+
+  /* banded matrices only support plain MFE predictions for single strands */
+  if ((opt->pf) ||
+      (opt->md.circ) ||
+      (opt->md.gquad) ||
+      (opt->md.dangles % 2) ||
+      (fold_constrained) ||
+      (opt->shape) ||
+      (opt->ligandMotif) ||
+      (opt->cmds) ||
+      (strchr(sequence, '&')))
+    return 0;
+
+  length = (int)strlen(sequence);
+
+  return (opt->md.max_bp_span > 0) &&
+         (opt->md.max_bp_span * BANDED_MFE_SPAN_RATIO <= length);
+}
+
+
 static char *
 annotate_ligand_motif(vrna_fold_compound_t  *vc,
                       const char            *structure)
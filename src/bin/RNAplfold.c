@@ -32,6 +32,7 @@
 #include "RNAplfold_cmdl.h"
 #include "gengetopt_helper.h"
 #include "input_id_helpers.h"
+#include "parallel_helpers.h"
 
 #include "ViennaRNA/color_output.inc"
 
@@ -86,7 +87,41 @@ typedef struct {
   double    kT;
 } plfold_data;
 
-int unpaired;
+
+struct options {
+  int             filename_full;
+  char            *filename_delim;
+  int             noconv;
+  int             verbose;
+  vrna_md_t       md;
+  dataset_id      id_control;
+  vrna_cmd_t      commands;
+
+  float           cutoff;
+  int             winsize;
+  int             pairdist;
+  int             unpaired;
+  int             plexoutput;
+  int             simply_putout;
+  int             openenergies;
+  int             binaries;
+
+  int             shape;
+  char            *shape_file;
+  char            *shape_method;
+  char            *shape_conversion;
+
+  int             jobs;
+};
+
+
+struct record_data {
+  char            *id;
+  char            *sequence;
+  char            *SEQ_ID;
+  struct options  *options;
+  int             tty;
+};
 
 PRIVATE void
 putoutphakim_u(vrna_fold_compound_t *fc,
@@ -132,46 +167,58 @@ print_pu_bin(vrna_fold_compound_t *fc,
              int                  ulength);
 
 
+static int
+process_input(FILE            *input_stream,
+              struct options  *opt);
+
+
+static void
+process_record(struct record_data *record);
+
+
+void
+init_default_options(struct options *opt)
+{
+  opt->filename_full  = 0;
+  opt->filename_delim = NULL;
+  opt->noconv         = 0;
+  opt->verbose        = 0;
+  opt->commands       = NULL;
+
+  set_model_details(&(opt->md));
+
+  opt->cutoff         = 0.01;
+  opt->winsize        = 70;
+  opt->pairdist       = 0;
+  opt->unpaired       = 0;
+  opt->plexoutput     = 0;
+  opt->simply_putout  = 0;
+  opt->openenergies   = 0;
+  opt->binaries       = 0;
+
+  opt->shape            = 0;
+  opt->shape_file       = NULL;
+  opt->shape_method     = NULL;
+  opt->shape_conversion = NULL;
+
+  opt->jobs = 1;
+}
+
+
 /*--------------------------------------------------------------------------*/
 int
 main(int  argc,
      char *argv[])
 {
-  FILE                        *pUfp;
   struct RNAplfold_args_info  args_info;
-  char                        *structure, *ParamFile, *ns_bases, *rec_sequence, *rec_id,
-                              **rec_rest, *orig_sequence, *filename_delim, *command_file,
-                              *shape_file, *shape_method, *shape_conversion;
-  unsigned int                rec_type, read_opt;
-  int                         length, istty, winsize, pairdist, tempwin, temppair, tempunpaired,
-                              noconv, i, plexoutput, simply_putout, openenergies, binaries,
-                              filename_full, with_shapes, verbose;
-  float                       cutoff;
-  vrna_exp_param_t            *pf_parameters;
-  vrna_md_t                   md;
-  vrna_cmd_t                  commands;
-  dataset_id                  id_control;
-
-  pUfp          = NULL;
+  char                        *ParamFile, *ns_bases, *command_file;
+  struct options              opt;
+
   dangles       = 2;
-  cutoff        = 0.01;
-  winsize       = 70;
-  pairdist      = 0;
-  unpaired      = 0;
-  simply_putout = plexoutput = openenergies = noconv = 0;
-  binaries      = 0;
-  tempwin       = temppair = tempunpaired = 0;
-  structure     = ParamFile = ns_bases = NULL;
-  rec_type      = read_opt = 0;
-  rec_id        = rec_sequence = orig_sequence = NULL;
-  rec_rest      = NULL;
-  pf_parameters = NULL;
-  filename_full = 0;
+  ParamFile     = ns_bases = NULL;
   command_file  = NULL;
-  commands      = NULL;
-  verbose       = 0;
 
-  set_model_details(&md);
+  init_default_options(&opt);
 
   /*
    #############################################
@@ -182,23 +229,23 @@ main(int  argc,
     exit(1);
 
   if (args_info.verbose_given)
-    verbose = 1;
+    opt.verbose = 1;
 
   /* SHAPE reactivity data */
-  ggo_get_SHAPE(args_info, with_shapes, shape_file, shape_method, shape_conversion);
+  ggo_get_SHAPE(args_info, opt.shape, opt.shape_file, opt.shape_method, opt.shape_conversion);
 
   /* parse options for ID manipulation */
-  ggo_get_id_control(args_info, id_control, "Sequence", "sequence", "_", 4, 1);
+  ggo_get_id_control(args_info, opt.id_control, "Sequence", "sequence", "_", 4, 1);
 
-  ggo_get_md_part(args_info, md);
+  ggo_get_md_part(args_info, opt.md);
 
   /* temperature */
   if (args_info.temp_given)
-    md.temperature = temperature = args_info.temp_arg;
+    opt.md.temperature = temperature = args_info.temp_arg;
 
   /* do not take special tetra loop energies into account */
   if (args_info.noTetra_given)
-    md.special_hp = tetra_loop = 0;
+    opt.md.special_hp = tetra_loop = 0;
 
   /* set dangle model */
   if (args_info.dangles_given) {
@@ -206,28 +253,28 @@ main(int  argc,
       vrna_message_warning(
         "required dangle model not implemented, falling back to default dangles=2");
     else
-      md.dangles = dangles = args_info.dangles_arg;
+      opt.md.dangles = dangles = args_info.dangles_arg;
   }
 
   /* do not allow weak pairs */
   if (args_info.noLP_given)
-    md.noLP = noLonelyPairs = 1;
+    opt.md.noLP = noLonelyPairs = 1;
 
   /* do not allow wobble pairs (GU) */
   if (args_info.noGU_given)
-    md.noGU = noGU = 1;
+    opt.md.noGU = noGU = 1;
 
   /* do not allow weak closing pairs (AU,GU) */
   if (args_info.noClosingGU_given)
-    md.noGUclosure = no_closingGU = 1;
+    opt.md.noGUclosure = no_closingGU = 1;
 
   /* do not convert DNA nucleotide "T" to appropriate RNA "U" */
   if (args_info.noconv_given)
-    noconv = 1;
+    opt.noconv = 1;
 
   /* set energy model */
   if (args_info.energyModel_given)
-    md.energy_set = energy_set = args_info.energyModel_arg;
+    opt.md.energy_set = energy_set = args_info.energyModel_arg;
 
   /* take another energy parameter set */
   if (args_info.paramFile_given)
@@ -239,62 +286,84 @@ main(int  argc,
 
   /* set the maximum base pair span */
   if (args_info.span_given)
-    pairdist = args_info.span_arg;
+    opt.pairdist = args_info.span_arg;
 
   /* set the pair probability cutoff */
   if (args_info.cutoff_given)
-    cutoff = args_info.cutoff_arg;
+    opt.cutoff = args_info.cutoff_arg;
 
   /* set the windowsize */
   if (args_info.winsize_given)
-    winsize = args_info.winsize_arg;
+    opt.winsize = args_info.winsize_arg;
 
   /* set the length of unstructured region */
   if (args_info.ulength_given)
-    unpaired = args_info.ulength_arg;
+    opt.unpaired = args_info.ulength_arg;
 
   /* compute opening energies */
   if (args_info.opening_energies_given)
-    openenergies = 1;
+    opt.openenergies = 1;
 
   /* print output on the fly */
   if (args_info.print_onthefly_given)
-    simply_putout = 1;
+    opt.simply_putout = 1;
 
   /* turn on RNAplex output */
   if (args_info.plex_output_given)
-    plexoutput = 1;
+    opt.plexoutput = 1;
 
   /* turn on binary output*/
   if (args_info.binaries_given)
-    binaries = 1;
+    opt.binaries = 1;
 
   /* check for errorneous parameter options */
-  if ((pairdist < 0) || (cutoff < 0.) || (unpaired < 0) || (winsize < 0)) {
+  if ((opt.pairdist < 0) || (opt.cutoff < 0.) || (opt.unpaired < 0) || (opt.winsize < 0)) {
     RNAplfold_cmdline_parser_print_help();
     exit(EXIT_FAILURE);
   }
 
   /* filename sanitize delimiter */
   if (args_info.filename_delim_given)
-    filename_delim = strdup(args_info.filename_delim_arg);
-  else if (get_id_delim(id_control))
-    filename_delim = strdup(get_id_delim(id_control));
-  else
-    filename_delim = NULL;
+    opt.filename_delim = strdup(args_info.filename_delim_arg);
+  else if (get_id_delim(opt.id_control))
+    opt.filename_delim = strdup(get_id_delim(opt.id_control));
 
-  if ((filename_delim) && isspace(*filename_delim)) {
-    free(filename_delim);
-    filename_delim = NULL;
+  if ((opt.filename_delim) && isspace(*(opt.filename_delim))) {
+    free(opt.filename_delim);
+    opt.filename_delim = NULL;
   }
 
   /* full filename from FASTA header support */
   if (args_info.filename_full_given)
-    filename_full = 1;
+    opt.filename_full = 1;
 
   if (args_info.commands_given)
     command_file = strdup(args_info.commands_arg);
 
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAplfold has been built without parallel input processing capabilities");
+#endif
+  }
+
   /* free allocated memory of command line data structure */
   RNAplfold_cmdline_parser_free(&args_info);
 
@@ -311,35 +380,40 @@ main(int  argc,
   }
 
   if (ns_bases != NULL)
-    vrna_md_set_nonstandards(&md, ns_bases);
+    vrna_md_set_nonstandards(&(opt.md), ns_bases);
 
   if (command_file != NULL)
-    commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+    opt.commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
 
   /* check parameter options again and reset to reasonable values if needed */
-  if (openenergies && !unpaired)
-    unpaired = 31;
+  if (opt.openenergies && !opt.unpaired)
+    opt.unpaired = 31;
 
-  if (pairdist == 0)
-    pairdist = winsize;
+  if (opt.pairdist == 0)
+    opt.pairdist = opt.winsize;
 
-  if (pairdist > winsize) {
+  if (opt.pairdist > opt.winsize) {
     vrna_message_warning("pairdist (-L %d) should be <= winsize (-W %d);"
                          "Setting pairdist=winsize",
-                         pairdist, winsize);
-    pairdist = winsize;
+                         opt.pairdist, opt.winsize);
+    opt.pairdist = opt.winsize;
   }
 
   if (dangles % 2) {
     vrna_message_warning("using default dangles = 2");
-    md.dangles = dangles = 2;
+    opt.md.dangles = dangles = 2;
   }
 
-  istty     = isatty(fileno(stdout)) && isatty(fileno(stdin));
-  read_opt  |= VRNA_INPUT_NO_REST;
-  if (istty) {
-    vrna_message_input_seq_simple();
-    read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
+  if ((opt.simply_putout) && (opt.plexoutput)) {
+    vrna_message_warning("plexoutput not available in simple output mode!\n"
+                         "Switching back to full mode instead!");
+    opt.simply_putout = 0;
+  }
+
+  if ((opt.simply_putout) && (opt.binaries)) {
+    vrna_message_warning("binary output not available in simple output mode!\n"
+                         "Switching back to full mode instead!");
+    opt.simply_putout = 0;
   }
 
   /*
@@ -347,10 +421,60 @@ main(int  argc,
    # main loop: continue until end of file
    #############################################
    */
-  while (
-    !((rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, NULL, read_opt))
-      & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
-    char *SEQ_ID = NULL;
+  INIT_PARALLELIZATION(opt.jobs);
+
+  (void)process_input(stdin, &opt);
+
+  UNINIT_PARALLELIZATION
+
+  free(ParamFile);
+  free(ns_bases);
+  free(opt.filename_delim);
+  free(command_file);
+  free(opt.shape_file);
+  free(opt.shape_method);
+  free(opt.shape_conversion);
+  vrna_commands_free(opt.commands);
+
+  free_id_data(opt.id_control);
+
+  return EXIT_SUCCESS;
+}
+
+
+static int
+process_input(FILE            *input_stream,
+              struct options  *opt)
+{
+  int           ret       = 1;
+  int           istty_in  = isatty(fileno(input_stream));
+  int           istty_out = isatty(fileno(stdout));
+
+  unsigned int  read_opt = VRNA_INPUT_NO_REST;
+
+  /* print user help if we get input from tty */
+  if (istty_in && istty_out) {
+    vrna_message_input_seq_simple();
+    read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
+  }
+
+  /* main loop that processes each record obtained from input stream */
+  do {
+    char          *rec_sequence, *rec_id, **rec_rest;
+    unsigned int  rec_type;
+
+    rec_id    = NULL;
+    rec_rest  = NULL;
+
+    rec_type = vrna_file_fasta_read_record(&rec_id,
+                                           &rec_sequence,
+                                           &rec_rest,
+                                           input_stream,
+                                           read_opt);
+
+    if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
+      break;
+
     /*
      ########################################################
      # init everything according to the data we've read
@@ -360,290 +484,272 @@ main(int  argc,
       rec_id = memmove(rec_id, rec_id + 1, strlen(rec_id));
 
     /* construct the sequence ID */
-    set_next_id(&rec_id, id_control);
-    SEQ_ID = fileprefix_from_id(rec_id, id_control, filename_full);
+    set_next_id(&rec_id, opt->id_control);
 
-    length    = (int)strlen(rec_sequence);
-    structure = (char *)vrna_alloc(sizeof(char) * (length + 1));
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    /* convert DNA alphabet to RNA if not explicitely switched off */
-    if (!noconv)
-      vrna_seq_toRNA(rec_sequence);
+    record->sequence  = rec_sequence;
+    record->SEQ_ID    = fileprefix_from_id(rec_id, opt->id_control, opt->filename_full);
+    record->id        = rec_id;
+    record->options   = opt;
+    record->tty       = istty_in && istty_out;
 
-    /* store case-unmodified sequence */
-    orig_sequence = strdup(rec_sequence);
-    /* convert sequence to uppercase letters only */
-    vrna_seq_toupper(rec_sequence);
+    RUN_IN_PARALLEL(process_record, record);
 
-    if (istty)
-      vrna_message_info(stdout, "length = %d", length);
+    if (opt->shape) {
+      ret = 0;
+      break;
+    }
 
-    /*
-     ########################################################
-     # done with 'stdin' handling
-     ########################################################
-     */
+    /* print user help for the next round if we get input from tty */
+    if (istty_in && istty_out)
+      vrna_message_input_seq_simple();
+  } while (1);
 
-    if (length > 1000000) {
-      if (!simply_putout && !unpaired) {
-        vrna_message_warning("Switched to simple output mode!!!");
-        simply_putout = 1;
-      }
-    }
+  return ret;
+}
 
-    if ((simply_putout) && (plexoutput)) {
-      vrna_message_warning("plexoutput not available in simple output mode!\n"
-                           "Switching back to full mode instead!");
-      simply_putout = 0;
-    }
 
-    if ((simply_putout) && (binaries)) {
-      vrna_message_warning("binary output not available in simple output mode!\n"
-                           "Switching back to full mode instead!");
-      simply_putout = 0;
-    }
+static void
+process_record(struct record_data *record)
+{
+  char              *rec_sequence, *SEQ_ID, *filename_delim;
+  int               i, length, winsize, pairdist, unpaired, simply_putout;
+  FILE              *pUfp;
+  struct options    *opt;
+  vrna_exp_param_t  *pf_parameters;
+  vrna_md_t         md;
+
+  opt             = record->options;
+  filename_delim  = opt->filename_delim;
+  rec_sequence    = strdup(record->sequence);
+  length          = (int)strlen(rec_sequence);
+  SEQ_ID          = record->SEQ_ID;
+
+  /* window parameters may be adjusted for each individual input */
+  winsize       = opt->winsize;
+  pairdist      = opt->pairdist;
+  unpaired      = opt->unpaired;
+  simply_putout = opt->simply_putout;
+
+  /* convert DNA alphabet to RNA if not explicitely switched off */
+  if (!opt->noconv) {
+    vrna_seq_toRNA(rec_sequence);
+    vrna_seq_toRNA(record->sequence);
+  }
 
-    /* restore winsize if altered before */
-    if (tempwin != 0) {
-      winsize = tempwin;
-      tempwin = 0;
-    }
+  /* convert sequence to uppercase letters only */
+  vrna_seq_toupper(rec_sequence);
 
-    /* restore pairdist if altered before */
-    if (temppair != 0) {
-      pairdist  = temppair;
-      temppair  = 0;
-    }
+  if (record->tty)
+    vrna_message_info(stdout, "length = %d", length);
+
+  /*
+   ########################################################
+   # done with 'stdin' handling
+   ########################################################
+   */
 
-    /* restore ulength if altered before */
-    if (tempunpaired != 0) {
-      unpaired      = tempunpaired;
-      tempunpaired  = 0;
+  if (length > 1000000) {
+    if (!simply_putout && !unpaired && !opt->plexoutput && !opt->binaries) {
+      vrna_message_warning("Switched to simple output mode!!!");
+      simply_putout = 1;
     }
+  }
 
-    /* adjust winsize, pairdist and ulength if necessary */
-    if (length < winsize) {
-      vrna_message_warning("window size %d larger than sequence length %d", winsize, length);
-      tempwin = winsize;
-      winsize = length;
-      if (pairdist > winsize) {
-        temppair  = pairdist;
-        pairdist  = winsize;
-      }
+  /* adjust winsize, pairdist and ulength if necessary */
+  if (length < winsize) {
+    vrna_message_warning("window size %d larger than sequence length %d", winsize, length);
+    winsize = length;
+    if (pairdist > winsize)
+      pairdist = winsize;
 
-      if (unpaired > winsize) {
-        tempunpaired  = unpaired;
-        unpaired      = winsize;
-      }
-    }
+    if (unpaired > winsize)
+      unpaired = winsize;
+  }
 
-    /*
-     ########################################################
-     # begin actual computations
-     ########################################################
-     */
+  /*
+   ########################################################
+   # begin actual computations
+   ########################################################
+   */
 
-    if (length > 0) {
-      /* construct output file names */
-      char *fname1, *fname2, *fname3, *fname4, *ffname, *tmp_string;
-
-      if (!SEQ_ID)
-        SEQ_ID = strdup("plfold");
-
-      fname1  = vrna_strdup_printf("%s%slunp", SEQ_ID, filename_delim);
-      fname2  = vrna_strdup_printf("%s%sbasepairs", SEQ_ID, filename_delim);
-      fname3  = vrna_strdup_printf("%s%suplex", SEQ_ID, filename_delim);
-      fname4  = (binaries) ?
-                vrna_strdup_printf("%s%sopenen%sbin",
-                                   SEQ_ID,
-                                   filename_delim,
-                                   filename_delim) :
-                vrna_strdup_printf("%s%sopenen",
-                                   SEQ_ID,
-                                   filename_delim);
-      ffname = vrna_strdup_printf("%s%sdp.ps", SEQ_ID, filename_delim);
-
-      /* sanitize filenames */
-      tmp_string = vrna_filename_sanitize(fname1, filename_delim);
-      free(fname1);
-      fname1      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(fname2, filename_delim);
-      free(fname2);
-      fname2      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(fname3, filename_delim);
-      free(fname3);
-      fname3      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(fname4, filename_delim);
-      free(fname4);
-      fname4      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(ffname, filename_delim);
-      free(ffname);
-      ffname = tmp_string;
-
-
-      md.compute_bpp  = 1;
-      md.window_size  = winsize;
-      md.max_bp_span  = pairdist;
-
-      vrna_fold_compound_t *fc = vrna_fold_compound(rec_sequence, &md, VRNA_OPTION_WINDOW);
-
-      if (with_shapes) {
-        vrna_constraints_add_SHAPE(fc,
-                                   shape_file,
-                                   shape_method,
-                                   shape_conversion,
-                                   verbose,
-                                   VRNA_OPTION_DEFAULT | VRNA_OPTION_WINDOW);
-      }
+  if (length > 0) {
+    /* construct output file names */
+    char *fname1, *fname2, *fname3, *fname4, *ffname, *tmp_string;
+
+    if (!SEQ_ID)
+      SEQ_ID = record->SEQ_ID = strdup("plfold");
+
+    fname1  = vrna_strdup_printf("%s%slunp", SEQ_ID, filename_delim);
+    fname2  = vrna_strdup_printf("%s%sbasepairs", SEQ_ID, filename_delim);
+    fname3  = vrna_strdup_printf("%s%suplex", SEQ_ID, filename_delim);
+    fname4  = (opt->binaries) ?
+              vrna_strdup_printf("%s%sopenen%sbin",
+                                 SEQ_ID,
+                                 filename_delim,
+                                 filename_delim) :
+              vrna_strdup_printf("%s%sopenen",
+                                 SEQ_ID,
+                                 filename_delim);
+    ffname = vrna_strdup_printf("%s%sdp.ps", SEQ_ID, filename_delim);
+
+    /* sanitize filenames */
+    tmp_string = vrna_filename_sanitize(fname1, filename_delim);
+    free(fname1);
+    fname1      = tmp_string;
+    tmp_string  = vrna_filename_sanitize(fname2, filename_delim);
+    free(fname2);
+    fname2      = tmp_string;
+    tmp_string  = vrna_filename_sanitize(fname3, filename_delim);
+    free(fname3);
+    fname3      = tmp_string;
+    tmp_string  = vrna_filename_sanitize(fname4, filename_delim);
+    free(fname4);
+    fname4      = tmp_string;
+    tmp_string  = vrna_filename_sanitize(ffname, filename_delim);
+    free(ffname);
+    ffname = tmp_string;
+
+    md              = opt->md;
+    md.compute_bpp  = 1;
+    md.window_size  = winsize;
+    md.max_bp_span  = pairdist;
+
+    vrna_fold_compound_t *fc = vrna_fold_compound(rec_sequence, &md, VRNA_OPTION_WINDOW);
+
+    if (opt->shape) {
+      vrna_constraints_add_SHAPE(fc,
+                                 opt->shape_file,
+                                 opt->shape_method,
+                                 opt->shape_conversion,
+                                 opt->verbose,
+                                 VRNA_OPTION_DEFAULT | VRNA_OPTION_WINDOW);
+    }
 
-      if (commands)
-        vrna_commands_apply(fc, commands, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+    if (opt->commands)
+      vrna_commands_apply(fc, opt->commands, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
 
-      pf_parameters = vrna_exp_params(&md);
+    pf_parameters = vrna_exp_params(&md);
 
-      /* prepare data structure for callback */
-      plfold_data data;
+    /* prepare data structure for callback */
+    plfold_data data;
 
-      data.cutoff         = cutoff;
-      data.spup           = (simply_putout) ? fopen(fname2, "w") : NULL;
-      data.plexoutput     = plexoutput;
-      data.simply_putout  = simply_putout;
-      data.openenergies   = openenergies;
-      data.plist          = NULL;
-      data.plist_cnt      = 0;
-      data.ulength        = unpaired;
-      data.n              = length;
-      data.kT             = pf_parameters->kT;
+    data.cutoff         = opt->cutoff;
+    data.spup           = (simply_putout) ? fopen(fname2, "w") : NULL;
+    data.plexoutput     = opt->plexoutput;
+    data.simply_putout  = simply_putout;
+    data.openenergies   = opt->openenergies;
+    data.plist          = NULL;
+    data.plist_cnt      = 0;
+    data.ulength        = unpaired;
+    data.n              = length;
+    data.kT             = pf_parameters->kT;
 
-      if (unpaired > 0) {
-        if (simply_putout) {
-          data.pup  = NULL;
-          data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
-          prepare_up_file(&data);
-        } else {
-          /* if we don't print on-the-fly we store unpaired probabilities for later */
-          data.pup        = (double **)vrna_alloc(MAX2(unpaired, length + 1) * sizeof(double *));
-          data.pup[0]     = (double *)vrna_alloc(sizeof(double));   /*I only need entry 0*/
-          data.pup[0][0]  = unpaired;
-          data.pUfp       = NULL;
-        }
-      } else {
+    if (unpaired > 0) {
+      if (simply_putout) {
         data.pup  = NULL;
-        data.pUfp = NULL;
+        data.pUfp = fopen(opt->openenergies ? fname4 : fname1, "w");
+        prepare_up_file(&data);
+      } else {
+        /* if we don't print on-the-fly we store unpaired probabilities for later */
+        data.pup        = (double **)vrna_alloc(MAX2(unpaired, length + 1) * sizeof(double *));
+        data.pup[0]     = (double *)vrna_alloc(sizeof(double));   /*I only need entry 0*/
+        data.pup[0][0]  = unpaired;
+        data.pUfp       = NULL;
       }
+    } else {
+      data.pup  = NULL;
+      data.pUfp = NULL;
+    }
 
-      /* prepare option flags */
-      unsigned int plfold_opt = 0;
-
-      /* always compute base pair probabilities */
-      plfold_opt |= VRNA_PROBS_WINDOW_BPP;
+    /* prepare option flags */
+    unsigned int plfold_opt = 0;
 
-      if (unpaired > 0)
-        plfold_opt |= VRNA_PROBS_WINDOW_UP;
+    /* always compute base pair probabilities */
+    plfold_opt |= VRNA_PROBS_WINDOW_BPP;
 
-      /* perform recursions */
-      int r = vrna_probs_window(fc, unpaired, plfold_opt, &plfold_callback, (void *)&data);
+    if (unpaired > 0)
+      plfold_opt |= VRNA_PROBS_WINDOW_UP;
 
-      if (!r) {
-        vrna_message_warning("Something bad happened while processing the input! "
-                             "Aborting now...");
-        goto rnaplfold_exit;
-      }
+    /* perform recursions */
+    int r = vrna_probs_window(fc, unpaired, plfold_opt, &plfold_callback, (void *)&data);
 
-      if (!simply_putout) {
-        /* create dot plot output */
-        PS_dot_plot_turn(orig_sequence, data.plist, ffname, pairdist);
+    if (!r) {
+      vrna_message_warning("Something bad happened while processing the input! "
+                           "Skipping output for \"%s\"",
+                           SEQ_ID);
+    } else if (!simply_putout) {
+      /* create dot plot output */
+      PS_dot_plot_turn(record->sequence, data.plist, ffname, pairdist);
 
-        /* print unpaired probabilities */
-        if (unpaired > 0) {
-          if (plexoutput) {
-            pUfp = fopen(fname3, "w");
-            putoutphakim_u(fc, data.pup, length, unpaired, pUfp);
-            fclose(pUfp);
-          }
+      /* print unpaired probabilities */
+      if (unpaired > 0) {
+        if (opt->plexoutput) {
+          pUfp = fopen(fname3, "w");
+          putoutphakim_u(fc, data.pup, length, unpaired, pUfp);
+          fclose(pUfp);
+        }
 
-          /* print unpaired probabilities to file */
+        /* print unpaired probabilities to file */
 
-          data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
-          if (binaries) {
-            print_pu_bin(fc, &data, unpaired);
+        data.pUfp = fopen(opt->openenergies ? fname4 : fname1, "w");
+        if (opt->binaries) {
+          print_pu_bin(fc, &data, unpaired);
+        } else {
+          prepare_up_file(&data);
+          if (opt->openenergies) {
+            for (i = 1; i <= length; i++)
+              print_up_open(data.pUfp,
+                            i,
+                            data.pup[i],
+                            (i > unpaired) ? unpaired : i,
+                            unpaired,
+                            data.kT / 1000.);
           } else {
-            prepare_up_file(&data);
-            if (openenergies) {
-              for (i = 1; i <= length; i++)
-                print_up_open(data.pUfp,
-                              i,
-                              data.pup[i],
-                              (i > unpaired) ? unpaired : i,
-                              unpaired,
-                              data.kT / 1000.);
-            } else {
-              for (i = 1; i <= length; i++)
-                print_up(data.pUfp, i, data.pup[i], (i > unpaired) ? unpaired : i, unpaired);
-            }
+            for (i = 1; i <= length; i++)
+              print_up(data.pUfp, i, data.pup[i], (i > unpaired) ? unpaired : i, unpaired);
           }
-
-          fclose(data.pUfp);
-          data.pUfp = NULL;
-
-          for (i = 0; i <= length; i++)
-            free(data.pup[i]);
-          free(data.pup);
         }
-      }
 
-      vrna_fold_compound_free(fc);
-
-      free(pf_parameters);
-
-      /* clean up data */
-      if (data.pUfp)
         fclose(data.pUfp);
-
-      if (data.spup)
-        fclose(data.spup);
-
-      free(data.plist);
-
-
-      free(fname1);
-      free(fname2);
-      free(fname3);
-      free(fname4);
-      free(ffname);
+        data.pUfp = NULL;
+      }
     }
 
-    (void)fflush(stdout);
+    if (data.pup) {
+      for (i = 0; i <= length; i++)
+        free(data.pup[i]);
+      free(data.pup);
+    }
 
-    /* clean up */
-    free(rec_id);
-    free(rec_sequence);
-    free(orig_sequence);
-    free(structure);
-    free(SEQ_ID);
+    vrna_fold_compound_free(fc);
 
-    if (with_shapes)
-      break;
+    free(pf_parameters);
 
-    rec_id    = rec_sequence = orig_sequence = NULL;
-    rec_rest  = NULL;
+    /* clean up data */
+    if (data.pUfp)
+      fclose(data.pUfp);
 
-    /* print user help for the next round if we get input from tty */
-    if (istty)
-      vrna_message_input_seq_simple();
-  }
+    if (data.spup)
+      fclose(data.spup);
 
-rnaplfold_exit:
+    free(data.plist);
 
-  free(filename_delim);
-  free(command_file);
-  free(shape_method);
-  free(shape_conversion);
-  vrna_commands_free(commands);
 
-  free_id_data(id_control);
+    free(fname1);
+    free(fname2);
+    free(fname3);
+    free(fname4);
+    free(ffname);
+  }
 
-  return EXIT_SUCCESS;
+  /* clean up */
+  free(record->id);
+  free(record->sequence);
+  free(record->SEQ_ID);
+  free(record);
+  free(rec_sequence);
 }
 
 
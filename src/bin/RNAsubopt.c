@@ -31,24 +31,92 @@
 #include "ViennaRNA/io/file_formats.h"
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/commands.h"
+#include "ViennaRNA/datastructures/char_stream.h"
+#include "ViennaRNA/datastructures/stream_output.h"
 #include "RNAsubopt_cmdl.h"
 #include "gengetopt_helper.h"
 #include "input_id_helpers.h"
+#include "parallel_helpers.h"
+#include "timing_helpers.h"
 
 #include "ViennaRNA/color_output.inc"
 
-PRIVATE void putoutzuker(FILE                   *output,
-                         vrna_subopt_solution_t *zukersolution);
+struct options {
+  int             filename_full;
+  char            *filename_delim;
+  int             noconv;
+  int             verbose;
+  int             timing;
+  vrna_md_t       md;
+  dataset_id      id_control;
+  vrna_cmd_t      commands;
+
+  char            *constraint_file;
+  int             constraint_batch;
+  int             constraint_enforce;
+  int             constraint_canonical;
+
+  int             shape;
+  char            *shape_file;
+  char            *shape_method;
+  char            *shape_conversion;
+
+  int             delta;
+  int             n_back;
+  int             st_back_en;
+  int             non_redundant;
+  int             dos;
+  int             zuker;
+
+  int             jobs;
+  int             threads;
+  int             tofile;
+  char            *output_file;
+  int             keep_order;
+  FILE            *output_stream;
+  unsigned int    next_record_number;
+  vrna_ostream_t  output_queue;
+};
+
+
+struct record_data {
+  unsigned int    number;
+  char            *id;
+  char            *sequence;
+  char            *SEQ_ID;
+  char            **rest;
+  char            *input_filename;
+  int             multiline_input;
+  struct options  *options;
+  int             tty;
+};
+
+
+struct output_stream {
+  vrna_cstr_t data;
+  int         individual;
+};
 
 
 struct nr_en_data {
-  FILE                  *output;
+  vrna_cstr_t           output;
   vrna_fold_compound_t  *fc;
   double                kT;
   double                ens_en;
 };
 
 
+PRIVATE void
+putoutzuker(vrna_cstr_t             output,
+            vrna_subopt_solution_t  *zukersolution);
+
+
+PRIVATE void
+print_subopt(const char *structure,
+             float      energy,
+             void       *data);
+
+
 PRIVATE void
 print_samples(const char  *structure,
               void        *data);
@@ -59,47 +127,109 @@ print_samples_en(const char *structure,
                  void       *data);
 
 
+static int
+process_input(FILE            *input_stream,
+              const char      *input_filename,
+              struct options  *opt);
+
+
+static void
+process_record(struct record_data *record);
+
+
+void
+init_default_options(struct options *opt)
+{
+  opt->filename_full  = 0;
+  opt->filename_delim = NULL;
+  opt->noconv         = 0;
+  opt->verbose        = 0;
+  opt->timing         = 0;
+  opt->commands       = NULL;
+
+  set_model_details(&(opt->md));
+  /* switch on unique multibranch loop decomposition */
+  opt->md.uniq_ML = 1;
+
+  opt->constraint_file      = NULL;
+  opt->constraint_batch     = 0;
+  opt->constraint_enforce   = 0;
+  opt->constraint_canonical = 0;
+
+  opt->shape            = 0;
+  opt->shape_file       = NULL;
+  opt->shape_method     = NULL;
+  opt->shape_conversion = NULL;
+
+  opt->delta          = 100;
+  opt->n_back         = 0;
+  opt->st_back_en     = 0;
+  opt->non_redundant  = 0;
+  opt->dos            = 0;
+  opt->zuker          = 0;
+
+  opt->jobs               = 1;
+  opt->threads            = 1;
+  opt->tofile             = 0;
+  opt->output_file        = NULL;
+  opt->keep_order         = 1;
+  opt->output_stream      = NULL;
+  opt->next_record_number = 0;
+  opt->output_queue       = NULL;
+}
+
+
+void
+flush_cstr_callback(void          *auxdata,
+                    unsigned int  i,
+                    void          *data)
+{
+  struct output_stream *s = (struct output_stream *)data;
+
+  if (s) {
+    /* flush/free/close data[k] */
+    if (s->individual)
+      vrna_cstr_close(s->data);
+    else
+      vrna_cstr_free(s->data);
+
+    free(s);
+  }
+}
+
+
+static void
+print_input_help(struct options *opt)
+{
+  if (!opt->zuker)
+    print_comment(stdout, "Use '&' to connect 2 sequences that shall form a complex.");
+
+  if (fold_constrained) {
+    vrna_message_constraint_options(
+      VRNA_CONSTRAINT_DB_DOT | VRNA_CONSTRAINT_DB_X | VRNA_CONSTRAINT_DB_ANG_BRACK |
+      VRNA_CONSTRAINT_DB_RND_BRACK);
+    vrna_message_input_seq("Input sequence (upper or lower case) followed by structure constraint");
+  } else {
+    vrna_message_input_seq_simple();
+  }
+}
+
+
 int
 main(int  argc,
      char *argv[])
 {
-  FILE                                *input, *output;
-  struct          RNAsubopt_args_info args_info;
-  char                                *rec_sequence, *rec_id,
-                                      **rec_rest, *orig_sequence, *constraints_file, *cstruc,
-                                      *structure, *shape_file, *shape_method, *shape_conversion,
-                                      *infile, *outfile, *filename_delim;
-  unsigned int                        rec_type, read_opt;
-  int                                 i, length, cl, istty, delta, n_back, noconv, dos, zuker,
-                                      with_shapes, verbose, enforceConstraints, st_back_en, batch,
-                                      tofile, filename_full, canonicalBPonly, nonRedundant;
-  double                              deltap;
-  vrna_md_t                           md;
-  dataset_id                          id_control;
-  vrna_cmd_t                          commands;
-
-  do_backtrack    = 1;
-  delta           = 100;
-  deltap          = n_back = noconv = dos = zuker = 0;
-  rec_type        = read_opt = 0;
-  rec_id          = rec_sequence = orig_sequence = NULL;
-  rec_rest        = NULL;
-  cstruc          = structure = NULL;
-  verbose         = 0;
-  st_back_en      = 0;
-  infile          = NULL;
-  outfile         = NULL;
-  output          = NULL;
-  tofile          = 0;
-  filename_full   = 0;
-  canonicalBPonly = 0;
-  commands        = NULL;
-  nonRedundant    = 0;
-
-  set_model_details(&md);
+  FILE                        *input;
+  struct RNAsubopt_args_info  args_info;
+  char                        *infile;
+  double                      deltap;
+  struct options              opt;
 
-  /* switch on unique multibranch loop decomposition */
-  md.uniq_ML = 1;
+  do_backtrack  = 1;
+  deltap        = 0;
+  infile        = NULL;
+
+  init_default_options(&opt);
 
   /*
    #############################################
@@ -110,46 +240,49 @@ main(int  argc,
     exit(1);
 
   /* parse options for ID manipulation */
-  ggo_get_id_control(args_info, id_control, "Sequence", "sequence", "_", 4, 1);
+  ggo_get_id_control(args_info, opt.id_control, "Sequence", "sequence", "_", 4, 1);
 
   /* get basic set of model details */
-  ggo_get_md_eval(args_info, md);
-  ggo_get_md_fold(args_info, md);
-  ggo_get_md_part(args_info, md);
-  ggo_get_circ(args_info, md.circ);
+  ggo_get_md_eval(args_info, opt.md);
+  ggo_get_md_fold(args_info, opt.md);
+  ggo_get_md_part(args_info, opt.md);
+  ggo_get_circ(args_info, opt.md.circ);
 
   /* temperature */
-  ggo_get_temperature(args_info, md.temperature);
+  ggo_get_temperature(args_info, opt.md.temperature);
 
   /* check dangle model */
-  if ((md.dangles < 0) || (md.dangles > 3)) {
+  if ((opt.md.dangles < 0) || (opt.md.dangles > 3)) {
     vrna_message_warning("required dangle model not implemented, falling back to default dangles=2");
-    md.dangles = dangles = 2;
+    opt.md.dangles = dangles = 2;
   }
 
   /* SHAPE reactivity data */
-  ggo_get_SHAPE(args_info, with_shapes, shape_file, shape_method, shape_conversion);
+  ggo_get_SHAPE(args_info, opt.shape, opt.shape_file, opt.shape_method, opt.shape_conversion);
 
   ggo_get_constraints_settings(args_info,
                                fold_constrained,
-                               constraints_file,
-                               enforceConstraints,
-                               batch);
+                               opt.constraint_file,
+                               opt.constraint_enforce,
+                               opt.constraint_batch);
 
   if (args_info.verbose_given)
-    verbose = 1;
+    opt.verbose = 1;
+
+  if (args_info.timing_given)
+    opt.timing = 1;
 
   /* enforce canonical base pairs in any case? */
   if (args_info.canonicalBPonly_given)
-    canonicalBPonly = 1;
+    opt.constraint_canonical = 1;
 
   /* do not convert DNA nucleotide "T" to appropriate RNA "U" */
   if (args_info.noconv_given)
-    noconv = 1;
+    opt.noconv = 1;
 
   /* energy range */
   if (args_info.deltaEnergy_given)
-    delta = (int)(0.1 + args_info.deltaEnergy_arg * 100);
+    opt.delta = (int)(0.1 + args_info.deltaEnergy_arg * 100);
 
   /* energy range after post evaluation */
   if (args_info.deltaEnergyPost_given)
@@ -161,49 +294,49 @@ main(int  argc,
 
   /* stochastic backtracking */
   if (args_info.stochBT_given) {
-    n_back = args_info.stochBT_arg;
+    opt.n_back = args_info.stochBT_arg;
     vrna_init_rand();
-    md.compute_bpp = 0;
+    opt.md.compute_bpp = 0;
   }
 
   if (args_info.stochBT_en_given) {
-    n_back          = args_info.stochBT_en_arg;
-    st_back_en      = 1;
-    md.compute_bpp  = 0;
+    opt.n_back          = args_info.stochBT_en_arg;
+    opt.st_back_en      = 1;
+    opt.md.compute_bpp  = 0;
     vrna_init_rand();
   }
 
   /* density of states */
   if (args_info.dos_given) {
-    dos           = 1;
+    opt.dos       = 1;
     print_energy  = -999999;
   }
 
   /* logarithmic multiloop energies */
   if (args_info.logML_given)
-    md.logML = logML = 1;
+    opt.md.logML = logML = 1;
 
   /* zuker subopts */
   if (args_info.zuker_given)
-    zuker = 1;
+    opt.zuker = 1;
 
-  if (zuker) {
-    if (md.circ) {
+  if (opt.zuker) {
+    if (opt.md.circ) {
       vrna_message_warning("Sorry, zuker subopts not yet implemented for circfold");
       RNAsubopt_cmdline_parser_print_help();
       exit(1);
-    } else if (n_back > 0) {
+    } else if (opt.n_back > 0) {
       vrna_message_warning("Can't do zuker subopts and stochastic subopts at the same time");
       RNAsubopt_cmdline_parser_print_help();
       exit(1);
-    } else if (md.gquad) {
+    } else if (opt.md.gquad) {
       vrna_message_warning("G-quadruplex support for Zuker subopts not implemented yet");
       RNAsubopt_cmdline_parser_print_help();
       exit(1);
     }
   }
 
-  if (md.gquad && (n_back > 0)) {
+  if (opt.md.gquad && (opt.n_back > 0)) {
     vrna_message_warning("G-quadruplex support for stochastic backtracking not implemented yet");
     RNAsubopt_cmdline_parser_print_help();
     exit(1);
@@ -213,35 +346,74 @@ main(int  argc,
     infile = strdup(args_info.infile_arg);
 
   if (args_info.outfile_given) {
-    tofile = 1;
+    opt.tofile = 1;
     if (args_info.outfile_arg)
-      outfile = strdup(args_info.outfile_arg);
+      opt.output_file = strdup(args_info.outfile_arg);
   }
 
   /* filename sanitize delimiter */
   if (args_info.filename_delim_given)
-    filename_delim = strdup(args_info.filename_delim_arg);
-  else if (get_id_delim(id_control))
-    filename_delim = strdup(get_id_delim(id_control));
-  else
-    filename_delim = NULL;
-
-  if ((filename_delim) && isspace(*filename_delim)) {
-    free(filename_delim);
-    filename_delim = NULL;
+    opt.filename_delim = strdup(args_info.filename_delim_arg);
+  else if (get_id_delim(opt.id_control))
+    opt.filename_delim = strdup(get_id_delim(opt.id_control));
+
+  if ((opt.filename_delim) && isspace(*(opt.filename_delim))) {
+    free(opt.filename_delim);
+    opt.filename_delim = NULL;
   }
 
   /* full filename from FASTA header support */
   if (args_info.filename_full_given)
-    filename_full = 1;
+    opt.filename_full = 1;
 
   /* non-redundant backtracing */
   if (args_info.nonRedundant_given)
-    nonRedundant = 1;
+    opt.non_redundant = 1;
 
   if (args_info.commands_given)
-    commands = vrna_file_commands_read(args_info.commands_arg,
-                                       VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+    opt.commands = vrna_file_commands_read(args_info.commands_arg,
+                                           VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAsubopt has been built without parallel input processing capabilities");
+#endif
+
+    if (args_info.unordered_given)
+      opt.keep_order = 0;
+  }
+
+  if (args_info.threads_given) {
+    if (args_info.threads_arg < 0)
+      vrna_message_warning("Number of threads must not be negative. Using a single thread!");
+    else
+      opt.threads = args_info.threads_arg;
+  }
+
+  /* the density of states is accumulated in a global array */
+  if ((opt.dos) && (opt.jobs > 1)) {
+    vrna_message_warning("Density of states computation (--dos) requires serial input processing!\n"
+                         "Falling back to a single job");
+    opt.jobs = 1;
+  }
 
   /* free allocated memory of command line data structure */
   RNAsubopt_cmdline_parser_free(&args_info);
@@ -251,7 +423,6 @@ main(int  argc,
    # begin initializing
    #############################################
    */
-
   if (infile) {
     input = fopen((const char *)infile, "r");
     if (!input)
@@ -260,42 +431,171 @@ main(int  argc,
     input = stdin;
   }
 
-  istty = (!infile) && isatty(fileno(stdout)) && isatty(fileno(stdin));
+  /* energy threshold for re-evaluated structures, set once for all records */
+  if ((logML != 0 || opt.md.dangles == 1 || opt.md.dangles == 3) && opt.dos == 0)
+    if (deltap <= 0)
+      deltap = opt.delta / 100. + 0.001;
+
+  if (deltap > 0)
+    print_energy = deltap;
+
+  if (opt.keep_order) {
+    if (opt.jobs > 1)
+      opt.output_queue = vrna_ostream_init_bounded(&flush_cstr_callback,
+                                                   NULL,
+                                                   OUTPUT_QUEUE_CAPACITY(opt.jobs));
+    else
+      opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+  }
 
-  /* print user help if we get input from tty */
-  if (istty) {
-    if (!zuker)
-      print_comment(stdout, "Use '&' to connect 2 sequences that shall form a complex.");
-
-    if (fold_constrained) {
-      vrna_message_constraint_options(
-        VRNA_CONSTRAINT_DB_DOT | VRNA_CONSTRAINT_DB_X | VRNA_CONSTRAINT_DB_ANG_BRACK |
-        VRNA_CONSTRAINT_DB_RND_BRACK);
-      vrna_message_input_seq("Input sequence (upper or lower case) followed by structure constraint");
-    } else {
-      vrna_message_input_seq_simple();
+  /*
+   #############################################
+   # main loop: continue until end of file
+   #############################################
+   */
+  INIT_PARALLELIZATION(opt.jobs);
+
+  (void)process_input(input, (const char *)infile, &opt);
+
+  UNINIT_PARALLELIZATION
+
+  fold_compound_pool_free();
+
+  /*
+   ################################################
+   # post processing
+   ################################################
+   */
+  vrna_ostream_free(opt.output_queue);
+
+  if ((opt.output_stream) && (opt.output_stream != stdout))
+    fclose(opt.output_stream);
+
+  if (infile && input)
+    fclose(input);
+
+  free(infile);
+  free(opt.constraint_file);
+  free(opt.shape_file);
+  free(opt.shape_method);
+  free(opt.shape_conversion);
+  free(opt.filename_delim);
+  free(opt.output_file);
+  vrna_commands_free(opt.commands);
+
+  free_id_data(opt.id_control);
+
+  return EXIT_SUCCESS;
+}
+
+
+static struct output_stream *
+get_output_stream(unsigned int    init_size,
+                  struct options  *opt,
+                  const char      *SEQ_ID,
+                  const char      *input_filename)
+{
+  struct output_stream  *o_stream;
+  FILE                  *output;
+  int                   individual_stream;
+
+  individual_stream = 0; /* we default to using a single output sink */
+
+  o_stream = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
+
+  /* in case we do parallel processing of input, let's block access to the opt->output_stream pointer */
+  ATOMIC_BLOCK(({
+    /* default to stream that we've already opened */
+    output = opt->output_stream;
+
+    if ((!opt->tofile) && (!output)) {
+      output = stdout;
+      opt->output_stream = stdout;
+    } else if (opt->tofile) {
+      char *filename, *tmp;
+
+      tmp = filename = NULL;
+
+      if ((!opt->output_file) && (SEQ_ID)) {
+        /* need to open new individual output file */
+        tmp = vrna_strdup_printf("%s.sub", SEQ_ID);
+        individual_stream = 1;
+
+        filename = vrna_filename_sanitize(tmp, opt->filename_delim);
+
+        if ((input_filename) && !strcmp(input_filename, filename))
+          vrna_message_error("Input and output file names are identical");
+
+        if (!(output = fopen(filename, "a")))
+          vrna_message_error("Failed to open file for writing");
+      } else if (!output) {
+        /* we need to open global output file */
+        tmp = (opt->output_file) ?
+              vrna_strdup_printf("%s", opt->output_file) :
+              vrna_strdup_printf("RNAsubopt_output.sub");
+
+        filename = vrna_filename_sanitize(tmp, opt->filename_delim);
+
+        if ((input_filename) && !strcmp(input_filename, filename))
+          vrna_message_error("Input and output file names are identical");
+
+        if (!(output = fopen(filename, "a")))
+          vrna_message_error("Failed to open file for writing");
+
+        opt->output_stream = output;
+      }
+
+      free(tmp);
+      free(filename);
     }
-  }
 
-  /* set options we wanna pass to vrna_file_fasta_read_record() */
-  if (istty)
+    /* actually initialize vrna_cstr_t of the stream */
+    o_stream->data = vrna_cstr(init_size, output);
+    o_stream->individual = (individual_stream) ? 1 : 0;
+  }));
+
+  return o_stream;
+}
+
+
+static int
+process_input(FILE            *input_stream,
+              const char      *input_filename,
+              struct options  *opt)
+{
+  int           ret       = 1;
+  int           istty_in  = (!input_filename) && isatty(fileno(input_stream));
+  int           istty_out = isatty(fileno(stdout));
+
+  unsigned int  read_opt = 0;
+
+  /* print user help if we get input from tty */
+  if (istty_in && istty_out) {
+    print_input_help(opt);
     read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
+  }
 
   if (!fold_constrained)
     read_opt |= VRNA_INPUT_NO_REST;
 
-  /*
-   #############################################
-   # main loop: continue until end of file
-   #############################################
-   */
-  while (
-    !((rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, input, read_opt))
-      & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
-    char  *SEQ_ID         = NULL;
-    char  *v_file_name    = NULL;
-    char  *tmp_string     = NULL;
-    int   maybe_multiline = 0;
+  /* main loop that processes each record obtained from input stream */
+  do {
+    char          *rec_sequence, *rec_id, **rec_rest;
+    unsigned int  rec_type;
+    int           maybe_multiline;
+
+    rec_id          = NULL;
+    rec_rest        = NULL;
+    maybe_multiline = 0;
+
+    rec_type = vrna_file_fasta_read_record(&rec_id,
+                                           &rec_sequence,
+                                           &rec_rest,
+                                           input_stream,
+                                           read_opt);
+
+    if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
+      break;
 
     /*
      ########################################################
@@ -309,270 +609,319 @@ main(int  argc,
     }
 
     /* construct the sequence ID */
-    set_next_id(&rec_id, id_control);
-    SEQ_ID = fileprefix_from_id(rec_id, id_control, filename_full);
-
-    if (tofile) {
-      /* prepare the file name */
-      if (outfile)
-        v_file_name = vrna_strdup_printf("%s", outfile);
-      else
-        v_file_name = (SEQ_ID) ?
-                      vrna_strdup_printf("%s.sub", SEQ_ID) :
-                      vrna_strdup_printf("RNAsubopt_output.sub");
-
-      tmp_string = vrna_filename_sanitize(v_file_name, filename_delim);
-      free(v_file_name);
-      v_file_name = tmp_string;
-
-      if (infile && !strcmp(infile, v_file_name))
-        vrna_message_error("Input and output file names are identical");
-
-      output = fopen((const char *)v_file_name, "a");
-      if (!output)
-        vrna_message_error("Failed to open file for writing");
-    } else {
-      output = stdout;
-    }
+    set_next_id(&rec_id, opt->id_control);
 
-    /* convert DNA alphabet to RNA if not explicitely switched off */
-    if (!noconv)
-      vrna_seq_toRNA(rec_sequence);
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    /* store case-unmodified sequence */
-    orig_sequence = strdup(rec_sequence);
-    /* convert sequence to uppercase letters only */
-    vrna_seq_toupper(rec_sequence);
+    record->number          = opt->next_record_number;
+    record->sequence        = rec_sequence;
+    record->SEQ_ID          = fileprefix_from_id(rec_id, opt->id_control, opt->filename_full);
+    record->id              = rec_id;
+    record->rest            = rec_rest;
+    record->multiline_input = maybe_multiline;
+    record->options         = opt;
+    record->tty             = istty_in && istty_out;
+    record->input_filename  = (input_filename) ? strdup(input_filename) : NULL;
 
-    vrna_fold_compound_t *vc =
-      vrna_fold_compound(rec_sequence, &md,
-                         VRNA_OPTION_MFE | (circ ? 0 : VRNA_OPTION_HYBRID) |
-                         ((n_back > 0) ? VRNA_OPTION_PF : 0));
-    length = vc->length;
+    if (opt->output_queue)
+      vrna_ostream_request(opt->output_queue, opt->next_record_number++);
 
-    structure = (char *)vrna_alloc(sizeof(char) * (length + 1));
+    RUN_IN_PARALLEL(process_record, record);
 
-    /* parse the rest of the current dataset to obtain a structure constraint */
-    if (fold_constrained) {
-      if (constraints_file) {
-        vrna_constraints_add(vc, constraints_file, VRNA_OPTION_DEFAULT);
-      } else {
-        cstruc = NULL;
-        int           cp        = -1;
-        unsigned int  coptions  = (maybe_multiline) ? VRNA_OPTION_MULTILINE : 0;
-        cstruc  = vrna_extract_record_rest_structure((const char **)rec_rest, 0, coptions);
-        cstruc  = vrna_cut_point_remove(cstruc, &cp);
-        if (vc->cutpoint != cp) {
-          vrna_message_error("Sequence and Structure have different cut points.\n"
-                             "sequence: %d, structure: %d",
-                             vc->cutpoint, cp);
-        }
-
-        cl = (cstruc) ? (int)strlen(cstruc) : 0;
-
-        if (cl == 0)
-          vrna_message_warning("Structure constraint is missing");
-        else if (cl < length)
-          vrna_message_warning("Structure constraint is shorter than sequence");
-        else if (cl > length)
-          vrna_message_error("Structure constraint is too long");
-
-        if (cstruc) {
-          /* convert pseudo-dot-bracket to actual hard constraints */
-          unsigned int constraint_options = VRNA_CONSTRAINT_DB_DEFAULT;
-
-          if (enforceConstraints)
-            constraint_options |= VRNA_CONSTRAINT_DB_ENFORCE_BP;
-
-          if (canonicalBPonly)
-            constraint_options |= VRNA_CONSTRAINT_DB_CANONICAL_BP;
-
-          vrna_constraints_add(vc, (const char *)cstruc, constraint_options);
-        }
-      }
+    if (opt->shape || (opt->constraint_file && (!opt->constraint_batch))) {
+      ret = 0;
+      break;
     }
 
-    if (with_shapes) {
-      vrna_constraints_add_SHAPE(vc,
-                                 shape_file,
-                                 shape_method,
-                                 shape_conversion,
-                                 verbose,
-                                 VRNA_OPTION_MFE | ((n_back > 0) ? VRNA_OPTION_PF : 0));
-    }
+    /* print user help for the next round if we get input from tty */
+    if (istty_in && istty_out)
+      print_input_help(opt);
+  } while (1);
 
-    if (commands)
-      vrna_commands_apply(vc,
-                          commands,
-                          VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+  return ret;
+}
 
-    if (istty) {
-      if (cut_point == -1) {
-        vrna_message_info(stdout, "length = %d", length);
-      } else {
-        vrna_message_info(stdout,
-                          "length1 = %d\nlength2 = %d",
-                          cut_point - 1,
-                          length - cut_point + 1);
+
+static void
+process_record(struct record_data *record)
+{
+  char                  *rec_sequence, *structure, *cstruc;
+  int                   i, length, cl;
+  double                t_start;
+  struct options        *opt;
+  struct output_stream  *o_stream;
+  vrna_fold_compound_t  *vc;
+
+  opt           = record->options;
+  t_start       = (opt->timing) ? timing_wall_time() : 0.;
+  cstruc        = NULL;
+  rec_sequence  = strdup(record->sequence);
+
+  /* convert DNA alphabet to RNA if not explicitely switched off */
+  if (!opt->noconv)
+    vrna_seq_toRNA(rec_sequence);
+
+  /* convert sequence to uppercase letters only */
+  vrna_seq_toupper(rec_sequence);
+
+  vc = fold_compound_pool_get(rec_sequence,
+                              &(opt->md),
+                              VRNA_OPTION_MFE | (opt->md.circ ? 0 : VRNA_OPTION_HYBRID) |
+                              ((opt->n_back > 0) ? VRNA_OPTION_PF : 0));
+
+  vrna_fold_compound_num_threads(vc, opt->threads);
+
+  /* re-used fold compounds keep the measurements of their setup for this record */
+  if ((opt->timing) && (!vc->timing))
+    vrna_fold_compound_timing(vc, 1);
+
+  length = vc->length;
+
+  structure = (char *)vrna_alloc(sizeof(char) * (length + 1));
+
+  /* retrieve string stream bound to stdout or output file, 6*length should be enough to start with */
+  o_stream = get_output_stream(6 * length,
+                               opt,
+                               record->SEQ_ID,
+                               record->input_filename);
+
+  /* parse the rest of the current dataset to obtain a structure constraint */
+  if (fold_constrained) {
+    if (opt->constraint_file) {
+      vrna_constraints_add(vc, opt->constraint_file, VRNA_OPTION_DEFAULT);
+    } else {
+      int           cp        = -1;
+      unsigned int  coptions  = (record->multiline_input) ? VRNA_OPTION_MULTILINE : 0;
+      cstruc  = vrna_extract_record_rest_structure((const char **)record->rest, 0, coptions);
+      cstruc  = vrna_cut_point_remove(cstruc, &cp);
+      if (vc->cutpoint != cp) {
+        vrna_message_error("Sequence and Structure have different cut points.\n"
+                           "sequence: %d, structure: %d",
+                           vc->cutpoint, cp);
       }
-    }
 
-    /*
-     ########################################################
-     # begin actual computations
-     ########################################################
-     */
+      cl = (cstruc) ? (int)strlen(cstruc) : 0;
 
-    if ((logML != 0 || md.dangles == 1 || md.dangles == 3) && dos == 0)
-      if (deltap <= 0)
-        deltap = delta / 100. + 0.001;
-
-    if (deltap > 0)
-      print_energy = deltap;
-
-    /* stochastic backtracking */
-    if (n_back > 0) {
-      double        mfe, kT, ens_en;
-      unsigned int  options = (nonRedundant) ?
-                              VRNA_PBACKTRACK_NON_REDUNDANT :
-                              VRNA_PBACKTRACK_DEFAULT;
-
-      if (vc->cutpoint != -1)
-        vrna_message_error("Boltzmann sampling for cofolded structures not implemented (yet)!");
-
-      print_fasta_header(output, rec_id);
-
-      fprintf(output, "%s\n", rec_sequence);
-
-      mfe = vrna_mfe(vc, structure);
-      /* rescale Boltzmann factors according to predicted MFE */
-      vrna_exp_params_rescale(vc, &mfe);
-      /* ignore return value, we are not interested in the free energy */
-      ens_en  = vrna_pf(vc, structure);
-      kT      = vc->exp_params->kT / 1000.;
-
-      if (st_back_en) {
-        struct nr_en_data dat;
-        dat.output  = output;
-        dat.fc      = vc;
-        dat.kT      = kT;
-        dat.ens_en  = ens_en;
-
-        vrna_pbacktrack_cb(vc,
-                           n_back,
-                           &print_samples_en,
-                           (void *)&dat,
-                           options);
-      } else {
-        vrna_pbacktrack_cb(vc,
-                           n_back,
-                           &print_samples,
-                           (void *)output,
-                           options);
-      }
-    }
-    /* normal subopt */
-    else if (!zuker) {
-      /* first lines of output (suitable  for sort +1n) */
-      if (rec_id) {
-        char *head = vrna_strdup_printf("%s [%d]", rec_id, delta);
-        print_fasta_header(output, head);
-        free(head);
-      }
+      if (cl == 0)
+        vrna_message_warning("Structure constraint is missing");
+      else if (cl < length)
+        vrna_message_warning("Structure constraint is shorter than sequence");
+      else if (cl > length)
+        vrna_message_error("Structure constraint is too long");
+
+      if (cstruc) {
+        /* convert pseudo-dot-bracket to actual hard constraints */
+        unsigned int constraint_options = VRNA_CONSTRAINT_DB_DEFAULT;
+
+        if (opt->constraint_enforce)
+          constraint_options |= VRNA_CONSTRAINT_DB_ENFORCE_BP;
 
-      vrna_subopt(vc, delta, subopt_sorted, output);
+        if (opt->constraint_canonical)
+          constraint_options |= VRNA_CONSTRAINT_DB_CANONICAL_BP;
 
-      if (dos) {
-        int i;
-        for (i = 0; i <= MAXDOS && i <= delta / 10; i++) {
-          char *tline = vrna_strdup_printf("%4d %6d", i, density_of_states[i]);
-          print_table(output, NULL, tline);
-          free(tline);
-        }
+        vrna_constraints_add(vc, (const char *)cstruc, constraint_options);
       }
     }
-    /* Zuker suboptimals */
-    else {
-      vrna_subopt_solution_t  *zr;
+  }
 
-      if (vc->cutpoint != -1)
-        vrna_message_error("Sorry, zuker subopts not yet implemented for cofold");
+  if (opt->shape) {
+    vrna_constraints_add_SHAPE(vc,
+                               opt->shape_file,
+                               opt->shape_method,
+                               opt->shape_conversion,
+                               opt->verbose,
+                               VRNA_OPTION_MFE | ((opt->n_back > 0) ? VRNA_OPTION_PF : 0));
+  }
 
-      int                     i;
-      print_fasta_header(output, rec_id);
+  if (opt->commands)
+    vrna_commands_apply(vc,
+                        opt->commands,
+                        VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
 
-      fprintf(output, "%s\n", rec_sequence);
+  if (record->tty) {
+    if (vc->cutpoint == -1) {
+      vrna_message_info(stdout, "length = %d", length);
+    } else {
+      vrna_message_info(stdout,
+                        "length1 = %d\nlength2 = %d",
+                        vc->cutpoint - 1,
+                        length - vc->cutpoint + 1);
+    }
+  }
 
-      zr = vrna_subopt_zuker(vc);
+  /*
+   ########################################################
+   # begin actual computations
+   ########################################################
+   */
 
-      putoutzuker(output, zr);
-      (void)fflush(output);
-      for (i = 0; zr[i].structure; i++)
-        free(zr[i].structure);
-      free(zr);
+  /* stochastic backtracking */
+  if (opt->n_back > 0) {
+    double        mfe, kT, ens_en;
+    unsigned int  options = (opt->non_redundant) ?
+                            VRNA_PBACKTRACK_NON_REDUNDANT :
+                            VRNA_PBACKTRACK_DEFAULT;
+
+    if (vc->cutpoint != -1)
+      vrna_message_error("Boltzmann sampling for cofolded structures not implemented (yet)!");
+
+    vrna_cstr_print_fasta_header(o_stream->data, record->id);
+
+    vrna_cstr_printf(o_stream->data, "%s\n", rec_sequence);
+
+    mfe = vrna_mfe(vc, structure);
+    /* rescale Boltzmann factors according to predicted MFE */
+    vrna_exp_params_rescale(vc, &mfe);
+    /* ignore return value, we are not interested in the free energy */
+    ens_en  = vrna_pf(vc, structure);
+    kT      = vc->exp_params->kT / 1000.;
+
+    if (opt->st_back_en) {
+      struct nr_en_data dat;
+      dat.output  = o_stream->data;
+      dat.fc      = vc;
+      dat.kT      = kT;
+      dat.ens_en  = ens_en;
+
+      vrna_pbacktrack_cb(vc,
+                         opt->n_back,
+                         &print_samples_en,
+                         (void *)&dat,
+                         options);
+    } else {
+      vrna_pbacktrack_cb(vc,
+                         opt->n_back,
+                         &print_samples,
+                         (void *)o_stream->data,
+                         options);
+    }
+  }
+  /* normal subopt */
+  else if (!opt->zuker) {
+    float mfe;
+    char  *seq;
+
+    /* first lines of output (suitable  for sort +1n) */
+    if (record->id) {
+      char *head = vrna_strdup_printf("%s [%d]", record->id, opt->delta);
+      vrna_cstr_print_fasta_header(o_stream->data, head);
+      free(head);
     }
 
-    (void)fflush(output);
+    if (vc->strands > 1)
+      mfe = vrna_mfe_dimer(vc, NULL);
+    else
+      mfe = vrna_mfe(vc, NULL);
 
-    /* clean up */
-    vrna_fold_compound_free(vc);
+    seq = vrna_cut_point_insert(vc->sequence, vc->cutpoint);
+    vrna_cstr_printf_structure(o_stream->data,
+                               seq,
+                               " %6.2f %6.2f",
+                               mfe,
+                               (float)opt->delta / 100.);
+    free(seq);
 
-    free(cstruc);
+    vrna_mx_mfe_free(vc);
 
-    free(rec_id);
-    free(SEQ_ID);
-    free(rec_sequence);
-    free(orig_sequence);
-    free(structure);
+    if (subopt_sorted) {
+      vrna_subopt_solution_t *sol, *s;
 
-    /* free the rest of current dataset */
-    if (rec_rest) {
-      for (i = 0; rec_rest[i]; i++)
-        free(rec_rest[i]);
-      free(rec_rest);
-    }
+      sol = vrna_subopt(vc, opt->delta, 1, NULL);
 
-    rec_id    = rec_sequence = orig_sequence = structure = cstruc = NULL;
-    rec_rest  = NULL;
+      for (s = sol; (s) && (s->structure); s++) {
+        print_subopt(s->structure, s->energy, (void *)o_stream->data);
+        free(s->structure);
+      }
 
-    if (tofile && output) {
-      fclose(output);
-      output = NULL;
+      free(sol);
+    } else {
+      vrna_subopt_cb(vc, opt->delta, &print_subopt, (void *)o_stream->data);
     }
 
-    free(v_file_name);
+    if (opt->dos) {
+      for (i = 0; i <= MAXDOS && i <= opt->delta / 10; i++)
+        vrna_cstr_printf_tbody(o_stream->data,
+                               "%4d %6d",
+                               i,
+                               density_of_states[i]);
+    }
+  }
+  /* Zuker suboptimals */
+  else {
+    vrna_subopt_solution_t *zr;
 
-    if (with_shapes || (constraints_file && (!batch)))
-      break;
+    if (vc->cutpoint != -1)
+      vrna_message_error("Sorry, zuker subopts not yet implemented for cofold");
 
-    /* print user help for the next round if we get input from tty */
-    if (istty) {
-      if (!zuker)
-        print_comment(stdout, "Use '&' to connect 2 sequences that shall form a complex.");
-
-      if (fold_constrained) {
-        vrna_message_constraint_options(
-          VRNA_CONSTRAINT_DB_DOT | VRNA_CONSTRAINT_DB_X | VRNA_CONSTRAINT_DB_ANG_BRACK |
-          VRNA_CONSTRAINT_DB_RND_BRACK);
-        vrna_message_input_seq(
-          "Input sequence (upper or lower case) followed by structure constraint");
-      } else {
-        vrna_message_input_seq_simple();
-      }
+    vrna_cstr_print_fasta_header(o_stream->data, record->id);
+
+    vrna_cstr_printf(o_stream->data, "%s\n", rec_sequence);
+
+    zr = vrna_subopt_zuker(vc);
+
+    putoutzuker(o_stream->data, zr);
+
+    for (i = 0; zr[i].structure; i++)
+      free(zr[i].structure);
+    free(zr);
+  }
+
+  /* print what we've collected in output charstream */
+  if (opt->output_queue) {
+    if (o_stream->individual) {
+      /* output immediately */
+      ATOMIC_BLOCK(flush_cstr_callback(NULL, record->number, (void *)o_stream));
+
+      /* use dummy element for insert into queue */
+      o_stream = NULL;
     }
+
+    vrna_ostream_provide(opt->output_queue, record->number, (void *)o_stream);
+  } else {
+    ATOMIC_BLOCK(flush_cstr_callback(NULL, record->number, (void *)o_stream));
   }
 
-  if (infile && input)
-    fclose(input);
+  if (opt->timing) {
+    timing_print_record(stderr,
+                        "RNAsubopt",
+                        record->number,
+                        record->SEQ_ID,
+                        vc,
+                        timing_wall_time() - t_start);
+    vrna_timing_reset(vc->timing);
+  }
 
-  free(shape_method);
-  free(shape_conversion);
-  free(filename_delim);
-  vrna_commands_free(commands);
+  /* clean up */
+  fold_compound_pool_release(vc);
 
-  free_id_data(id_control);
+  free(cstruc);
+  free(rec_sequence);
+  free(structure);
 
-  return EXIT_SUCCESS;
+  free(record->id);
+  free(record->SEQ_ID);
+  free(record->sequence);
+
+  /* free the rest of current dataset */
+  if (record->rest) {
+    for (i = 0; record->rest[i]; i++)
+      free(record->rest[i]);
+    free(record->rest);
+  }
+
+  free(record->input_filename);
+
+  free(record);
+}
+
+
+PRIVATE void
+print_subopt(const char *structure,
+             float      energy,
+             void       *data)
+{
+  if (structure)
+    vrna_cstr_printf_structure((vrna_cstr_t)data, structure, " %6.2f", energy);
 }
 
 
@@ -581,7 +930,7 @@ print_samples(const char  *structure,
               void        *data)
 {
   if (structure)
-    print_structure((FILE *)data, structure, NULL);
+    vrna_cstr_printf_structure((vrna_cstr_t)data, structure, NULL);
 }
 
 
@@ -591,33 +940,30 @@ print_samples_en(const char *structure,
 {
   if (structure) {
     struct nr_en_data     *d      = (struct nr_en_data *)data;
-    FILE                  *output = d->output;
+    vrna_cstr_t           output  = d->output;
     vrna_fold_compound_t  *fc     = d->fc;
     double                kT      = d->kT;
     double                ens_en  = d->ens_en;
 
-    double                e         = vrna_eval_structure(fc, structure);
-    double                prob      = exp((ens_en - e) / kT);
-    char                  *e_string = vrna_strdup_printf(" %6.2f %6g", e, prob);
-
-    print_structure(output, structure, e_string);
+    double                e     = vrna_eval_structure(fc, structure);
+    double                prob  = exp((ens_en - e) / kT);
 
-    free(e_string);
+    vrna_cstr_printf_structure(output, structure, " %6.2f %6g", e, prob);
   }
 }
 
 
 PRIVATE void
-putoutzuker(FILE                    *output,
+putoutzuker(vrna_cstr_t             output,
             vrna_subopt_solution_t  *zukersolution)
 {
-  int   i;
-  char  *e_string;
+  int i;
+
+  for (i = 0; zukersolution[i].structure; i++)
+    vrna_cstr_printf_structure(output,
+                               zukersolution[i].structure,
+                               " [%6.2f]",
+                               zukersolution[i].energy);
 
-  for (i = 0; zukersolution[i].structure; i++) {
-    e_string = vrna_strdup_printf(" [%6.2f]", zukersolution[i].energy);
-    print_structure(output, zukersolution[i].structure, e_string);
-    free(e_string);
-  }
   return;
 }
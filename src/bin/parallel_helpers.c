@@ -7,6 +7,10 @@
  *
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -18,6 +22,25 @@
 #include <string.h>
 #include <errno.h>
 
+#if VRNA_WITH_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "ViennaRNA/fold_compound.h"
+
+/*
+ *  Maximum sequence length of fold compounds that are kept in the pool.
+ *  Larger ones are released to avoid holding on to huge DP matrices
+ */
+#define FOLD_COMPOUND_POOL_MAX_LENGTH 2000
+
+#if VRNA_WITH_PTHREADS
+static pthread_key_t  fc_pool_key;
+static pthread_once_t fc_pool_once = PTHREAD_ONCE_INIT;
+#else
+static vrna_fold_compound_t *fc_pool = NULL;
+#endif
+
 
 int
 num_proc_cores(int  *num_cores,
@@ -134,3 +157,75 @@ max_user_threads(void)
 
   return threadm;
 }
+
+
+#if VRNA_WITH_PTHREADS
+static void
+fc_pool_destroy(void *fc)
+{
+  vrna_fold_compound_free((vrna_fold_compound_t *)fc);
+}
+
+
+static void
+fc_pool_init(void)
+{
+  (void)pthread_key_create(&fc_pool_key, &fc_pool_destroy);
+}
+
+
+#endif
+
+
+/* take the fold compound of the calling thread out of the pool */
+static vrna_fold_compound_t *
+fc_pool_take(void)
+{
+  vrna_fold_compound_t *fc;
+
+#if VRNA_WITH_PTHREADS
+  pthread_once(&fc_pool_once, &fc_pool_init);
+  fc = (vrna_fold_compound_t *)pthread_getspecific(fc_pool_key);
+  (void)pthread_setspecific(fc_pool_key, NULL);
+#else
+  fc      = fc_pool;
+  fc_pool = NULL;
+#endif
+
+  return fc;
+}
+
+
+vrna_fold_compound_t *
+fold_compound_pool_get(const char   *sequence,
+                       vrna_md_t    *md,
+                       unsigned int options)
+{
+  return vrna_fold_compound_recycle(fc_pool_take(), sequence, md, options);
+}
+
+
+void
+fold_compound_pool_release(vrna_fold_compound_t *fc)
+{
+  /* make room for fc, there is only one pool entry per thread */
+  vrna_fold_compound_free(fc_pool_take());
+
+  if ((fc) && (fc->length > FOLD_COMPOUND_POOL_MAX_LENGTH)) {
+    vrna_fold_compound_free(fc);
+    return;
+  }
+
+#if VRNA_WITH_PTHREADS
+  (void)pthread_setspecific(fc_pool_key, (void *)fc);
+#else
+  fc_pool = fc;
+#endif
+}
+
+
+void
+fold_compound_pool_free(void)
+{
+  vrna_fold_compound_free(fc_pool_take());
+}
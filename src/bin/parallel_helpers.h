@@ -1,6 +1,8 @@
 #ifndef VRNA_PARALLELIZATION_HELPERS
 #define VRNA_PARALLELIZATION_HELPERS
 
+#include "ViennaRNA/fold_compound.h"
+
 #if VRNA_WITH_PTHREADS
 
 #include <pthread.h>
@@ -60,16 +62,19 @@ threadpool      worker_pool;
       thpool_destroy(worker_pool); \
 }
 
-#define RUN_IN_PARALLEL(fun, data)  { \
-    if (max_threads > 1) { thpool_add_work(worker_pool, (void *)&fun, (void *)data); } \
-    else { fun(data); } \
-}
+/*
+ *  Maximum number of jobs per thread that wait in the queue of the thread pool.
+ *  Adding further jobs blocks until a thread picks up the next pending job.
+ */
+#define MAX_PENDING_JOBS_PER_THREAD 2
 
-#define WAIT_FOR_FREE_SLOT(a) { \
+#define RUN_IN_PARALLEL(fun, data)  { \
     if (max_threads > 1) { \
-      while (thpool_num_threads_working(worker_pool) == (a)) \
-        sleep(1); \
-    } \
+      thpool_add_work_bounded(worker_pool, \
+                              (void *)&fun, \
+                              (void *)data, \
+                              MAX_PENDING_JOBS_PER_THREAD * max_threads); \
+    } else { fun(data); } \
 }
 
 #else
@@ -80,10 +85,16 @@ threadpool      worker_pool;
 #define INIT_PARALLELIZATION(a)
 #define UNINIT_PARALLELIZATION
 #define RUN_IN_PARALLEL(fun, data)  { fun(data); }
-#define WAIT_FOR_FREE_SLOT(a)
 
 #endif
 
+/*
+ *  Maximum number of records in the ordered output queue, i.e. records that
+ *  have been read but not yet written. Reading input stalls whenever a slow
+ *  record at the head of the queue holds back this many others.
+ */
+#define OUTPUT_QUEUE_CAPACITY(a)  (16 * (unsigned int)(a))
+
 int
 num_proc_cores(int  *num_cores,
                int  *num_cores_conf);
@@ -93,4 +104,23 @@ int
 max_user_threads(void);
 
 
+/*
+ *  Per-thread pool of fold compounds. Instead of creating a new fold compound
+ *  for each input record, a thread may re-use the memory of the fold compound
+ *  it released after processing its previous record, see vrna_fold_compound_recycle()
+ */
+vrna_fold_compound_t *
+fold_compound_pool_get(const char   *sequence,
+                       vrna_md_t    *md,
+                       unsigned int options);
+
+
+void
+fold_compound_pool_release(vrna_fold_compound_t *fc);
+
+
+void
+fold_compound_pool_free(void);
+
+
 #endif
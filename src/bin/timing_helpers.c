@@ -0,0 +1,90 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/strings.h"
+#include "ViennaRNA/utils/timing.h"
+#include "ViennaRNA/fold_compound.h"
+#include "timing_helpers.h"
+
+
+static char *
+json_escape(const char *s)
+{
+  char        *e;
+  const char  *p;
+  size_t      n;
+
+  e = (char *)vrna_alloc(sizeof(char) * (6 * strlen(s) + 1));
+
+  for (n = 0, p = s; *p; p++) {
+    switch (*p) {
+      case '"':
+      case '\\':
+        e[n++]  = '\\';
+        e[n++]  = *p;
+        break;
+
+      default:
+        if ((unsigned char)*p < 0x20)
+          n += sprintf(e + n, "\\u%04x", (unsigned int)(unsigned char)*p);
+        else
+          e[n++] = *p;
+
+        break;
+    }
+  }
+
+  e[n] = '\0';
+
+  return e;
+}
+
+
+double
+timing_wall_time(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+
+  return (double)tv.tv_sec + (double)tv.tv_usec * 1e-6;
+}
+
+
+void
+timing_print_record(FILE                        *out,
+                    const char                  *program,
+                    unsigned int                record_number,
+                    const char                  *id,
+                    const vrna_fold_compound_t  *fc,
+                    double                      total)
+{
+  char *phases, *escaped_id;
+
+  if ((!out) || (!fc) || (!fc->timing))
+    return;
+
+  phases      = vrna_timing_to_json(fc->timing);
+  escaped_id  = json_escape((id) ? id : "");
+
+  /* a single call, such that lines of concurrently processed records do not interleave */
+  fprintf(out,
+          "{\"program\": \"%s\", \"record\": %u, \"id\": \"%s\", \"length\": %u, "
+          "\"total_s\": %.6f, \"phases\": %s}\n",
+          program,
+          record_number,
+          escaped_id,
+          fc->length,
+          total,
+          phases);
+
+  free(escaped_id);
+  free(phases);
+}
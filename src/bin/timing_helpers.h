@@ -0,0 +1,27 @@
+#ifndef VRNA_TIMING_HELPERS
+#define VRNA_TIMING_HELPERS
+
+#include <stdio.h>
+
+#include "ViennaRNA/fold_compound.h"
+
+/*
+ *  Helpers for the --timing option of the executable programs. Each input
+ *  record is reported as a single JSON line that contains the per-phase
+ *  measurements collected in the record's fold compound, see
+ *  vrna_fold_compound_timing()
+ */
+double
+timing_wall_time(void);
+
+
+void
+timing_print_record(FILE                        *out,
+                    const char                  *program,
+                    unsigned int                record_number,
+                    const char                  *id,
+                    const vrna_fold_compound_t  *fc,
+                    double                      total);
+
+
+#endif
@@ -82,6 +82,7 @@ typedef struct jobqueue{
 	job  *rear;                          /* pointer to rear  of queue */
 	bsem *has_jobs;                      /* flag as binary semaphore  */
 	int   len;                           /* number of jobs in queue   */
+	pthread_cond_t has_space;            /* signal to bounded push    */
 } jobqueue;
 
 
@@ -118,7 +119,7 @@ static void  thread_destroy(struct thread* thread_p);
 
 static int   jobqueue_init(jobqueue* jobqueue_p);
 static void  jobqueue_clear(jobqueue* jobqueue_p);
-static void  jobqueue_push(jobqueue* jobqueue_p, struct job* newjob_p);
+static void  jobqueue_push(jobqueue* jobqueue_p, struct job* newjob_p, int max_len);
 static struct job* jobqueue_pull(jobqueue* jobqueue_p);
 static void  jobqueue_destroy(jobqueue* jobqueue_p);
 
@@ -194,6 +195,12 @@ struct thpool_* thpool_init(int num_threads){
 
 /* Add work to the thread pool */
 int thpool_add_work(thpool_* thpool_p, void (*function_p)(void*), void* arg_p){
+	return thpool_add_work_bounded(thpool_p, function_p, arg_p, 0);
+}
+
+
+/* Add work to the thread pool, wait while max_pending jobs are queued */
+int thpool_add_work_bounded(thpool_* thpool_p, void (*function_p)(void*), void* arg_p, int max_pending){
 	job* newjob;
 
 	newjob=(struct job*)malloc(sizeof(struct job));
@@ -207,7 +214,7 @@ int thpool_add_work(thpool_* thpool_p, void (*function_p)(void*), void* arg_p){
 	newjob->arg=arg_p;
 
 	/* add job to queue */
-	jobqueue_push(&thpool_p->jobqueue, newjob);
+	jobqueue_push(&thpool_p->jobqueue, newjob, max_pending);
 
 	/* increment the job placed count */
 	thpool_p->num_jobs_placed++;
@@ -403,6 +410,7 @@ static int jobqueue_init(jobqueue* jobqueue_p){
 	}
 
 	pthread_mutex_init(&(jobqueue_p->rwmutex), NULL);
+	pthread_cond_init(&(jobqueue_p->has_space), NULL);
 	bsem_init(jobqueue_p->has_jobs, 0);
 
 	return 0;
@@ -425,10 +433,15 @@ static void jobqueue_clear(jobqueue* jobqueue_p){
 
 
 /* Add (allocated) job to queue
+ *
+ * If max_len > 0, wait until less than max_len jobs are in the queue
  */
-static void jobqueue_push(jobqueue* jobqueue_p, struct job* newjob){
+static void jobqueue_push(jobqueue* jobqueue_p, struct job* newjob, int max_len){
 
 	pthread_mutex_lock(&jobqueue_p->rwmutex);
+	while (max_len > 0 && jobqueue_p->len >= max_len) {
+		pthread_cond_wait(&jobqueue_p->has_space, &jobqueue_p->rwmutex);
+	}
 	newjob->prev = NULL;
 
 	switch(jobqueue_p->len){
@@ -478,6 +491,10 @@ static struct job* jobqueue_pull(jobqueue* jobqueue_p){
 
 	}
 
+	if (job_p) {
+		pthread_cond_signal(&jobqueue_p->has_space);
+	}
+
 	pthread_mutex_unlock(&jobqueue_p->rwmutex);
 	return job_p;
 }
@@ -486,6 +503,7 @@ static struct job* jobqueue_pull(jobqueue* jobqueue_p){
 /* Free all queue resources back to the system */
 static void jobqueue_destroy(jobqueue* jobqueue_p){
 	jobqueue_clear(jobqueue_p);
+	pthread_cond_destroy(&(jobqueue_p->has_space));
 	free(jobqueue_p->has_jobs);
 }
 
@@ -67,6 +67,31 @@ threadpool thpool_init(int num_threads);
 int thpool_add_work(threadpool, void (*function_p)(void*), void* arg_p);
 
 
+/**
+ * @brief Add work to the job queue, block while the queue is full
+ *
+ * Same as thpool_add_work() but waits until less than max_pending jobs are
+ * queued, i.e. not yet picked up by any thread. This keeps the producer from
+ * running arbitrarily far ahead of the threads in the pool without polling.
+ *
+ * @example
+ *
+ *    int main() {
+ *       ..
+ *       for (i = 0; i < num_records; i++)
+ *          thpool_add_work_bounded(thpool, (void*)process, (void*)records[i], 8);
+ *       ..
+ *    }
+ *
+ * @param  threadpool    threadpool to which the work will be added
+ * @param  function_p    pointer to function to add as work
+ * @param  arg_p         pointer to an argument
+ * @param  max_pending   maximum number of queued jobs (0 for unlimited)
+ * @return 0 on successs, -1 otherwise.
+ */
+int thpool_add_work_bounded(threadpool, void (*function_p)(void*), void* arg_p, int max_pending);
+
+
 /**
  * @brief Wait for all queued jobs to finish
  *
@@ -0,0 +1,1056 @@
+/*
+ *                Benchmark driver for the core dynamic programming engines
+ *
+ *                Each benchmark is run on a fixed corpus of random sequences
+ *                of increasing length. Every single run is executed in its
+ *                own child process, such that the peak resident set size
+ *                reported by the operating system can be attributed to the
+ *                respective run. Results are written as one JSON object per
+ *                line. Optionally, the results are compared against those of
+ *                an earlier run, e.g. a stored baseline, and regressions that
+ *                exceed a given tolerance are reported.
+ *
+ *                Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/utils/rng.h>
+#include <ViennaRNA/model.h>
+#include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/mfe.h>
+#include <ViennaRNA/part_func.h>
+#include <ViennaRNA/equilibrium_probs.h>
+#include <ViennaRNA/subopt.h>
+#include <ViennaRNA/boltzmann_sampling.h>
+#include <ViennaRNA/mfe_window.h>
+#include <ViennaRNA/part_func_window.h>
+#include <ViennaRNA/eval.h>
+#include <ViennaRNA/landscape/findpath.h>
+
+#ifndef VERSION
+# define VERSION "unknown"
+#endif
+
+/* window size and maximum base pair span of the sliding-window benchmarks */
+#define BENCH_WINDOW_SIZE     200
+#define BENCH_MAX_BP_SPAN     150
+
+/* block length used to assemble the structure for the evaluation benchmark */
+#define BENCH_EVAL_BLOCK      200
+
+#define BENCH_SUBOPT_DELTA    100   /* in dcal/mol */
+#define BENCH_SAMPLES         1000
+#define BENCH_FINDPATH_WIDTH  10
+
+/*
+ *  default relative tolerance for the comparison against a baseline, and
+ *  absolute differences below which time and memory are considered noise
+ */
+#define BENCH_TOLERANCE       0.1
+#define BENCH_NOISE_TIME      0.01  /* in seconds */
+#define BENCH_NOISE_RSS       1024  /* in kilobytes */
+
+typedef struct {
+  double              time;   /* wall clock time of the benchmarked call in seconds */
+  unsigned long long  items;  /* number of items produced, e.g. structures */
+  double              result; /* characteristic result, e.g. an energy */
+} bench_result_t;
+
+typedef struct {
+  char                *benchmark;
+  unsigned int        length;
+  int                 threads;
+  double              time;     /* fastest run */
+  long                peak_rss; /* largest peak resident set size */
+} bench_record_t;
+
+typedef struct {
+  const char  *name;
+  unsigned int max_length; /* default maximum sequence length, unless --full is set */
+  int         windowed;   /* number of DP cells grows with n * span */
+  int         (*run)(const char     *sequence,
+                     bench_result_t *res);
+} bench_t;
+
+
+static int
+bench_eval(const char     *sequence,
+           bench_result_t *res);
+
+
+static int
+bench_mfe(const char      *sequence,
+          bench_result_t  *res);
+
+
+static int
+bench_pf(const char     *sequence,
+         bench_result_t *res);
+
+
+static int
+bench_subopt(const char     *sequence,
+             bench_result_t *res);
+
+
+static int
+bench_pbacktrack(const char     *sequence,
+                 bench_result_t *res);
+
+
+static int
+bench_mfe_window(const char     *sequence,
+                 bench_result_t *res);
+
+
+static int
+bench_probs_window(const char     *sequence,
+                   bench_result_t *res);
+
+
+static int
+bench_findpath(const char     *sequence,
+               bench_result_t *res);
+
+
+static const bench_t benchmarks[] = {
+  { "eval",         20000, 0, &bench_eval         },
+  { "mfe",          5000,  0, &bench_mfe          },
+  { "pf",           2000,  0, &bench_pf           },
+  { "subopt",       200,   0, &bench_subopt       },
+  { "pbacktrack",   2000,  0, &bench_pbacktrack   },
+  { "mfe_window",   20000, 1, &bench_mfe_window   },
+  { "probs_window", 20000, 1, &bench_probs_window },
+  { "findpath",     1000,  0, &bench_findpath     },
+  { NULL,           0,     0, NULL                }
+};
+
+static const unsigned int default_lengths[] = {
+  50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 0
+};
+
+static int num_threads = 1;
+
+/*
+ #################################
+ # Helpers                       #
+ #################################
+ */
+static double
+now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+static char *
+random_sequence(unsigned int  length,
+                uint64_t      seed)
+{
+  const char    *alphabet = "ACGU";
+  char          *seq      = (char *)vrna_alloc(sizeof(char) * (length + 1));
+  vrna_rng_t    *rng      = vrna_rng_init(seed, (uint64_t)length);
+  unsigned int  i;
+
+  for (i = 0; i < length; i++)
+    seq[i] = alphabet[vrna_rng_int_urn(rng, 0, 3)];
+
+  seq[length] = '\0';
+
+  vrna_rng_free(rng);
+
+  return seq;
+}
+
+
+static void
+model_details(vrna_md_t *md)
+{
+  vrna_md_set_default(md);
+}
+
+
+static vrna_fold_compound_t *
+fold_compound(const char    *sequence,
+              vrna_md_t     *md,
+              unsigned int  options)
+{
+  vrna_fold_compound_t *fc;
+
+  fc = vrna_fold_compound(sequence, md, options);
+  vrna_fold_compound_num_threads(fc, num_threads);
+
+  return fc;
+}
+
+
+/*
+ #################################
+ # Benchmarks                    #
+ #################################
+ */
+static int
+bench_eval(const char     *sequence,
+           bench_result_t *res)
+{
+  char                  *structure, *block, *s;
+  unsigned int          n, i, l;
+  double                t;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  /*
+   *  obtain a reasonably structured input by folding independent blocks,
+   *  this is not part of the measurement
+   */
+  n         = strlen(sequence);
+  structure = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  block     = (char *)vrna_alloc(sizeof(char) * (BENCH_EVAL_BLOCK + 1));
+  s         = (char *)vrna_alloc(sizeof(char) * (BENCH_EVAL_BLOCK + 1));
+
+  model_details(&md);
+
+  for (i = 0; i < n; i += BENCH_EVAL_BLOCK) {
+    l = (n - i < BENCH_EVAL_BLOCK) ? n - i : BENCH_EVAL_BLOCK;
+    memcpy(block, sequence + i, sizeof(char) * l);
+    block[l] = '\0';
+    fc        = fold_compound(block, &md, VRNA_OPTION_DEFAULT);
+    (void)vrna_mfe(fc, s);
+    memcpy(structure + i, s, sizeof(char) * l);
+    vrna_fold_compound_free(fc);
+  }
+
+  fc = fold_compound(sequence, &md, VRNA_OPTION_EVAL_ONLY);
+
+  t           = now();
+  res->result = (double)vrna_eval_structure(fc, structure);
+  res->time   = now() - t;
+  res->items  = 1;
+
+  vrna_fold_compound_free(fc);
+  free(structure);
+  free(block);
+  free(s);
+
+  return 1;
+}
+
+
+static int
+bench_mfe(const char      *sequence,
+          bench_result_t  *res)
+{
+  char                  *structure;
+  double                t;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  model_details(&md);
+
+  fc        = fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  structure = (char *)vrna_alloc(sizeof(char) * (strlen(sequence) + 1));
+
+  t           = now();
+  res->result = (double)vrna_mfe(fc, structure);
+  res->time   = now() - t;
+  res->items  = 1;
+
+  vrna_fold_compound_free(fc);
+  free(structure);
+
+  return 1;
+}
+
+
+static int
+bench_pf(const char     *sequence,
+         bench_result_t *res)
+{
+  char                  *structure;
+  double                t, mfe;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  model_details(&md);
+
+  fc        = fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  structure = (char *)vrna_alloc(sizeof(char) * (strlen(sequence) + 1));
+
+  /* MFE for rescaling the Boltzmann factors, not part of the measurement */
+  mfe = (double)vrna_mfe(fc, structure);
+  vrna_exp_params_rescale(fc, &mfe);
+
+  t           = now();
+  res->result = (double)vrna_pf(fc, structure);
+  res->time   = now() - t;
+  res->items  = 1;
+
+  vrna_fold_compound_free(fc);
+  free(structure);
+
+  return 1;
+}
+
+
+static void
+count_subopt(const char *structure,
+             float      energy,
+             void       *data)
+{
+  (void)energy;
+
+  if (structure)
+    (*((unsigned long long *)data))++;
+}
+
+
+static int
+bench_subopt(const char     *sequence,
+             bench_result_t *res)
+{
+  double                t;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  model_details(&md);
+  md.uniq_ML = 1;
+
+  fc = fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+
+  res->items = 0;
+
+  t = now();
+  vrna_subopt_cb(fc, BENCH_SUBOPT_DELTA, &count_subopt, (void *)&(res->items));
+  res->time   = now() - t;
+  res->result = (double)res->items;
+
+  vrna_fold_compound_free(fc);
+
+  return 1;
+}
+
+
+static int
+bench_pbacktrack(const char     *sequence,
+                 bench_result_t *res)
+{
+  char                  *structure, **samples, **ptr;
+  double                t, mfe;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  model_details(&md);
+  md.uniq_ML = 1;
+
+  fc        = fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  structure = (char *)vrna_alloc(sizeof(char) * (strlen(sequence) + 1));
+
+  /* fill the partition function matrices, not part of the measurement */
+  mfe = (double)vrna_mfe(fc, structure);
+  vrna_exp_params_rescale(fc, &mfe);
+  (void)vrna_pf(fc, structure);
+
+  t       = now();
+  samples = vrna_pbacktrack_num(fc, BENCH_SAMPLES, VRNA_PBACKTRACK_DEFAULT);
+  res->time = now() - t;
+
+  res->items = 0;
+  if (samples) {
+    for (ptr = samples; *ptr; ptr++) {
+      res->items++;
+      free(*ptr);
+    }
+    free(samples);
+  }
+
+  res->result = (double)res->items;
+
+  vrna_fold_compound_free(fc);
+  free(structure);
+
+  return 1;
+}
+
+
+static void
+count_mfe_window(int        start,
+                 int        end,
+                 const char *structure,
+                 float      en,
+                 void       *data)
+{
+  (void)start;
+  (void)end;
+  (void)structure;
+  (void)en;
+
+  (*((unsigned long long *)data))++;
+}
+
+
+static int
+bench_mfe_window(const char     *sequence,
+                 bench_result_t *res)
+{
+  double                t;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  model_details(&md);
+  md.window_size  = BENCH_WINDOW_SIZE;
+  md.max_bp_span  = BENCH_MAX_BP_SPAN;
+
+  fc = fold_compound(sequence, &md, VRNA_OPTION_WINDOW);
+
+  res->items = 0;
+
+  t           = now();
+  res->result = (double)vrna_mfe_window_cb(fc, &count_mfe_window, (void *)&(res->items));
+  res->time   = now() - t;
+
+  vrna_fold_compound_free(fc);
+
+  return 1;
+}
+
+
+static void
+count_probs_window(FLT_OR_DBL   *pr,
+                   int          pr_size,
+                   int          i,
+                   int          max,
+                   unsigned int type,
+                   void         *data)
+{
+  (void)pr;
+  (void)pr_size;
+  (void)i;
+  (void)max;
+  (void)type;
+
+  (*((unsigned long long *)data))++;
+}
+
+
+static int
+bench_probs_window(const char     *sequence,
+                   bench_result_t *res)
+{
+  double                t;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  model_details(&md);
+  md.window_size  = BENCH_WINDOW_SIZE;
+  md.max_bp_span  = BENCH_MAX_BP_SPAN;
+
+  fc = fold_compound(sequence, &md, VRNA_OPTION_WINDOW | VRNA_OPTION_PF);
+
+  res->items = 0;
+
+  t           = now();
+  res->result = (double)vrna_probs_window(fc,
+                                          0,
+                                          VRNA_PROBS_WINDOW_BPP,
+                                          &count_probs_window,
+                                          (void *)&(res->items));
+  res->time = now() - t;
+
+  vrna_fold_compound_free(fc);
+
+  return 1;
+}
+
+
+static int
+bench_findpath(const char     *sequence,
+               bench_result_t *res)
+{
+  char                  *s1, *s2;
+  unsigned int          n;
+  double                t;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  vrna_path_t           *path, *ptr;
+
+  model_details(&md);
+
+  n   = strlen(sequence);
+  fc  = fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  s1  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s2  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  /* refold the MFE structure from the open chain */
+  memset(s1, '.', sizeof(char) * n);
+  (void)vrna_mfe(fc, s2);
+
+  t     = now();
+  path  = vrna_path_findpath(fc, s1, s2, BENCH_FINDPATH_WIDTH);
+  res->time = now() - t;
+
+  res->items  = 0;
+  res->result = 0.;
+  if (path) {
+    for (ptr = path; ptr->s; ptr++) {
+      if ((res->items == 0) || (ptr->en > res->result))
+        res->result = (double)ptr->en;
+
+      res->items++;
+    }
+    vrna_path_free(path);
+  }
+
+  vrna_fold_compound_free(fc);
+  free(s1);
+  free(s2);
+
+  return 1;
+}
+
+
+/*
+ #################################
+ # Driver                        #
+ #################################
+ */
+static int
+run_isolated(const bench_t      *b,
+             const char         *sequence,
+             bench_result_t     *res,
+             long               *peak_rss)
+{
+  int           fd[2], status, ok;
+  ssize_t       r;
+  pid_t         pid;
+  struct rusage usage;
+
+  if (pipe(fd) != 0)
+    return 0;
+
+  fflush(NULL);
+
+  pid = fork();
+  if (pid < 0) {
+    close(fd[0]);
+    close(fd[1]);
+    return 0;
+  }
+
+  if (pid == 0) {
+    close(fd[0]);
+    memset(res, 0, sizeof(bench_result_t));
+    ok = b->run(sequence, res);
+    if (ok)
+      r = write(fd[1], res, sizeof(bench_result_t));
+    else
+      r = 0;
+
+    close(fd[1]);
+    _exit((r == sizeof(bench_result_t)) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  close(fd[1]);
+
+  r = read(fd[0], res, sizeof(bench_result_t));
+  close(fd[0]);
+
+  while (wait4(pid, &status, 0, &usage) < 0)
+    if (errno != EINTR)
+      return 0;
+
+  /* ru_maxrss is reported in kilobytes on Linux */
+  *peak_rss = usage.ru_maxrss;
+
+  return (r == sizeof(bench_result_t)) &&
+         WIFEXITED(status) &&
+         (WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+
+static double
+num_cells(const bench_t *b,
+          unsigned int  n)
+{
+  double span;
+
+  if (!strcmp(b->name, "eval"))
+    return (double)n;
+
+  if (b->windowed) {
+    span = (n < BENCH_MAX_BP_SPAN) ? n : BENCH_MAX_BP_SPAN;
+    return (double)n * span;
+  }
+
+  return (double)n * (n + 1) / 2.;
+}
+
+
+static const bench_t *
+find_benchmark(const char *name)
+{
+  const bench_t *b;
+
+  for (b = benchmarks; b->name; b++)
+    if (!strcmp(b->name, name))
+      return b;
+
+  return NULL;
+}
+
+
+static unsigned int *
+parse_lengths(const char *arg)
+{
+  char          *copy, *tok, *end, *save;
+  unsigned int  *lengths, num;
+  unsigned long v;
+
+  copy    = strdup(arg);
+  lengths = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (strlen(arg) + 2));
+  num     = 0;
+
+  for (tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+    v = strtoul(tok, &end, 10);
+    if ((*end != '\0') || (v == 0)) {
+      fprintf(stderr, "benchmark: invalid sequence length \"%s\"\n", tok);
+      free(copy);
+      free(lengths);
+      return NULL;
+    }
+
+    lengths[num++] = (unsigned int)v;
+  }
+
+  lengths[num] = 0;
+  free(copy);
+
+  return lengths;
+}
+
+
+static const char *
+json_value(const char *line,
+           const char *key)
+{
+  char        pattern[64];
+  const char  *v;
+
+  snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+
+  if (!(v = strstr(line, pattern)))
+    return NULL;
+
+  for (v += strlen(pattern); (*v == ' ') || (*v == '\t'); v++);
+
+  return v;
+}
+
+
+/* read the results of an earlier run, i.e. one JSON object per line */
+static bench_record_t *
+read_baseline(const char    *filename,
+              unsigned int  *num)
+{
+  char            line[1024];
+  const char      *v, *e;
+  unsigned int    size, k;
+  double          time;
+  long            rss;
+  FILE            *fp;
+  bench_record_t  *records, rec;
+
+  if (!(fp = fopen(filename, "r"))) {
+    fprintf(stderr, "benchmark: can't open baseline file \"%s\"\n", filename);
+    return NULL;
+  }
+
+  size    = 64;
+  *num    = 0;
+  records = (bench_record_t *)vrna_alloc(sizeof(bench_record_t) * size);
+
+  while (fgets(line, sizeof(line), fp)) {
+    if ((!(v = json_value(line, "benchmark"))) ||
+        (*v != '"') ||
+        (!(e = strchr(v + 1, '"'))))
+      continue;
+
+    rec.benchmark = NULL;
+    rec.length    = (v = json_value(line, "length")) ? (unsigned int)strtoul(v, NULL, 10) : 0;
+    rec.threads   = (v = json_value(line, "threads")) ? atoi(v) : 1;
+    time          = (v = json_value(line, "time_s")) ? strtod(v, NULL) : -1.;
+    rss           = (v = json_value(line, "peak_rss_kb")) ? strtol(v, NULL, 10) : -1;
+
+    if ((rec.length == 0) || (time < 0.) || (rss < 0))
+      continue;
+
+    v = json_value(line, "benchmark") + 1;
+
+    /* keep the fastest time and the largest peak RSS among repetitions */
+    for (k = 0; k < *num; k++)
+      if ((records[k].length == rec.length) &&
+          (records[k].threads == rec.threads) &&
+          (strlen(records[k].benchmark) == (size_t)(e - v)) &&
+          (!strncmp(records[k].benchmark, v, e - v)))
+        break;
+
+    if (k == *num) {
+      if (*num == size) {
+        size    *= 2;
+        records = (bench_record_t *)vrna_realloc(records, sizeof(bench_record_t) * size);
+      }
+
+      rec.benchmark = (char *)vrna_alloc(sizeof(char) * (e - v + 1));
+      memcpy(rec.benchmark, v, sizeof(char) * (e - v));
+      rec.time      = time;
+      rec.peak_rss  = rss;
+      records[(*num)++] = rec;
+    } else {
+      if (time < records[k].time)
+        records[k].time = time;
+
+      if (rss > records[k].peak_rss)
+        records[k].peak_rss = rss;
+    }
+  }
+
+  fclose(fp);
+
+  return records;
+}
+
+
+static void
+free_baseline(bench_record_t  *records,
+              unsigned int    num)
+{
+  unsigned int k;
+
+  if (records) {
+    for (k = 0; k < num; k++)
+      free(records[k].benchmark);
+
+    free(records);
+  }
+}
+
+
+static int
+exceeds(double  value,
+        double  reference,
+        double  tolerance,
+        double  noise)
+{
+  return (value - reference > tolerance * reference) &&
+         (value - reference > noise);
+}
+
+
+/*
+ *  compare a run against the baseline, print a summary line to stderr and
+ *  return 0 if time or peak RSS regressed by more than the tolerance
+ */
+static int
+compare_baseline(const bench_record_t *records,
+                 unsigned int         num,
+                 const bench_record_t *current,
+                 double               tolerance)
+{
+  int           slow, fat;
+  unsigned int  k;
+
+  for (k = 0; k < num; k++)
+    if ((records[k].length == current->length) &&
+        (records[k].threads == current->threads) &&
+        (!strcmp(records[k].benchmark, current->benchmark)))
+      break;
+
+  if (k == num) {
+    fprintf(stderr,
+            "benchmark: %s length %u: no baseline\n",
+            current->benchmark,
+            current->length);
+    return 1;
+  }
+
+  slow  = exceeds(current->time, records[k].time, tolerance, BENCH_NOISE_TIME);
+  fat   = exceeds((double)current->peak_rss,
+                  (double)records[k].peak_rss,
+                  tolerance,
+                  (double)BENCH_NOISE_RSS);
+
+  fprintf(stderr,
+          "benchmark: %s length %u: time %.6fs (baseline %.6fs), "
+          "peak RSS %ldkB (baseline %ldkB)%s%s\n",
+          current->benchmark,
+          current->length,
+          current->time,
+          records[k].time,
+          current->peak_rss,
+          records[k].peak_rss,
+          (slow) ? ", time regression" : "",
+          (fat) ? ", memory regression" : "");
+
+  return !(slow || fat);
+}
+
+
+static void
+usage(FILE *out)
+{
+  const bench_t *b;
+
+  fprintf(out,
+          "Usage: benchmark [OPTIONS]\n\n"
+          "Run the benchmark suite and print one JSON object per run\n\n"
+          "  -b, --benchmark=LIST   Comma separated list of benchmarks (default: all)\n"
+          "  -l, --lengths=LIST     Comma separated list of sequence lengths\n"
+          "                         (default: 50,100,200,500,1000,2000,5000,10000,20000)\n"
+          "  -m, --max-length=N     Override the per-benchmark maximum sequence length\n"
+          "  -f, --full             Run every benchmark on the entire corpus, i.e. ignore\n"
+          "                         the per-benchmark maximum sequence length\n"
+          "  -r, --repeat=N         Number of repetitions per benchmark and length (default: 3)\n"
+          "  -s, --seed=N           Seed for the random sequence corpus (default: 1)\n"
+          "  -j, --threads=N        Number of threads per fold compound (default: 1)\n"
+          "  -o, --output=FILE      Write results to FILE instead of stdout\n"
+          "  -c, --baseline=FILE    Compare the results against those stored in FILE\n"
+          "  -t, --tolerance=X      Relative slowdown or memory growth that is reported\n"
+          "                         as regression in the comparison (default: %.2f)\n"
+          "  -h, --help             Print this help and exit\n\n"
+          "Available benchmarks:\n",
+          BENCH_TOLERANCE);
+
+  for (b = benchmarks; b->name; b++)
+    fprintf(out, "  %-14s (default maximum length %u)\n", b->name, b->max_length);
+}
+
+
+int
+main(int  argc,
+     char *argv[])
+{
+  char                *selection, *tok, *save, *seq, *baseline_file;
+  int                 c, ret, repeat, r, full, use[sizeof(benchmarks) / sizeof(bench_t)];
+  unsigned int        *lengths, max_length, k, n, num_records;
+  unsigned long long  seed;
+  long                peak_rss;
+  double              cells, tolerance;
+  FILE                *out;
+  const bench_t       *b;
+  bench_result_t      res;
+  bench_record_t      *records, current;
+
+  static struct option long_options[] = {
+    { "benchmark",  required_argument, NULL, 'b' },
+    { "lengths",    required_argument, NULL, 'l' },
+    { "max-length", required_argument, NULL, 'm' },
+    { "full",       no_argument,       NULL, 'f' },
+    { "repeat",     required_argument, NULL, 'r' },
+    { "seed",       required_argument, NULL, 's' },
+    { "threads",    required_argument, NULL, 'j' },
+    { "output",     required_argument, NULL, 'o' },
+    { "baseline",   required_argument, NULL, 'c' },
+    { "tolerance",  required_argument, NULL, 't' },
+    { "help",       no_argument,       NULL, 'h' },
+    { NULL,         0,                 NULL, 0   }
+  };
+
+  selection   = NULL;
+  lengths     = NULL;
+  max_length    = 0;
+  full          = 0;
+  repeat        = 3;
+  seed          = 1;
+  out           = stdout;
+  baseline_file = NULL;
+  tolerance     = BENCH_TOLERANCE;
+  records       = NULL;
+  num_records   = 0;
+  ret           = EXIT_SUCCESS;
+
+  while ((c = getopt_long(argc, argv, "b:l:m:fr:s:j:o:c:t:h", long_options, NULL)) != -1) {
+    switch (c) {
+      case 'b':
+        free(selection);
+        selection = strdup(optarg);
+        break;
+
+      case 'l':
+        free(lengths);
+        if (!(lengths = parse_lengths(optarg)))
+          return EXIT_FAILURE;
+
+        break;
+
+      case 'm':
+        max_length = (unsigned int)strtoul(optarg, NULL, 10);
+        break;
+
+      case 'f':
+        full = 1;
+        break;
+
+      case 'r':
+        repeat = atoi(optarg);
+        if (repeat < 1)
+          repeat = 1;
+
+        break;
+
+      case 's':
+        seed = strtoull(optarg, NULL, 10);
+        break;
+
+      case 'j':
+        num_threads = atoi(optarg);
+        break;
+
+      case 'o':
+        if (out != stdout)
+          fclose(out);
+
+        if (!(out = fopen(optarg, "w"))) {
+          fprintf(stderr, "benchmark: can't open output file \"%s\"\n", optarg);
+          return EXIT_FAILURE;
+        }
+
+        break;
+
+      case 'c':
+        baseline_file = optarg;
+        break;
+
+      case 't':
+        tolerance = strtod(optarg, NULL);
+        if (tolerance < 0.)
+          tolerance = 0.;
+
+        break;
+
+      case 'h':
+        usage(stdout);
+        return EXIT_SUCCESS;
+
+      default:
+        usage(stderr);
+        return EXIT_FAILURE;
+    }
+  }
+
+  /* select benchmarks */
+  memset(use, 0, sizeof(use));
+  if (selection) {
+    for (tok = strtok_r(selection, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+      if (!(b = find_benchmark(tok))) {
+        fprintf(stderr, "benchmark: unknown benchmark \"%s\"\n", tok);
+        return EXIT_FAILURE;
+      }
+
+      use[b - benchmarks] = 1;
+    }
+    free(selection);
+  } else {
+    for (b = benchmarks; b->name; b++)
+      use[b - benchmarks] = 1;
+  }
+
+  if ((baseline_file) &&
+      (!(records = read_baseline(baseline_file, &num_records))))
+    return EXIT_FAILURE;
+
+  if (!lengths) {
+    lengths = (unsigned int *)vrna_alloc(sizeof(default_lengths));
+    memcpy(lengths, default_lengths, sizeof(default_lengths));
+  }
+
+  for (b = benchmarks; b->name; b++) {
+    if (!use[b - benchmarks])
+      continue;
+
+    for (k = 0; (n = lengths[k]); k++) {
+      if (max_length) {
+        if (n > max_length)
+          continue;
+      } else if ((!full) && (n > b->max_length)) {
+        continue;
+      }
+
+      seq   = random_sequence(n, (uint64_t)seed);
+      cells = num_cells(b, n);
+
+      current.benchmark = (char *)b->name;
+      current.length    = n;
+      current.threads   = num_threads;
+      current.time      = -1.;
+      current.peak_rss  = 0;
+
+      for (r = 0; r < repeat; r++) {
+        if (!run_isolated(b, seq, &res, &peak_rss)) {
+          fprintf(stderr, "benchmark: %s failed for length %u\n", b->name, n);
+          ret = EXIT_FAILURE;
+          continue;
+        }
+
+        if ((current.time < 0.) || (res.time < current.time))
+          current.time = res.time;
+
+        if (peak_rss > current.peak_rss)
+          current.peak_rss = peak_rss;
+
+        fprintf(out,
+                "{\"version\": \"%s\", \"benchmark\": \"%s\", \"length\": %u, "
+                "\"threads\": %d, \"seed\": %llu, \"repeat\": %d, "
+                "\"time_s\": %.6f, \"peak_rss_kb\": %ld, \"cells\": %.0f, "
+                "\"cells_per_s\": %.6g, \"items\": %llu, \"result\": %.6g}\n",
+                VERSION,
+                b->name,
+                n,
+                num_threads,
+                seed,
+                r,
+                res.time,
+                peak_rss,
+                cells,
+                (res.time > 0.) ? cells / res.time : 0.,
+                res.items,
+                res.result);
+        fflush(out);
+      }
+
+      if ((records) &&
+          (current.time >= 0.) &&
+          (!compare_baseline(records, num_records, &current, tolerance)))
+        ret = EXIT_FAILURE;
+
+      free(seq);
+    }
+  }
+
+  free(lengths);
+  free_baseline(records, num_records);
+
+  if (out != stdout)
+    fclose(out);
+
+  return ret;
+}
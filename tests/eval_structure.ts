@@ -148,3 +148,36 @@ typedef struct {
     vrna_fold_compound_free(vc);
   }
 }
+
+#test eval_structure_pt_circular
+{
+  const char            *sequence   = "GGGAAACCCAGGGAAACCCAGGGAAACCCA";
+  const char            *structures[] = {
+    "(((...)))..(((...)))..........",
+    "..((.......)).((((.......)))).",
+    "(((...))).(((...))).(((...))).",
+    NULL
+  };
+  int                   i, e_pt;
+  float                 e;
+  short                 *pt;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+
+  vrna_md_set_default(&md);
+  md.circ = 1;
+  vc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+
+  for (i = 0; structures[i]; i++) {
+    pt    = vrna_ptable(structures[i]);
+    e_pt  = vrna_eval_structure_pt(vc, pt);
+    e     = vrna_eval_structure(vc, structures[i]);
+
+    ck_assert_msg(e_pt == (int)(e * 100. + (e < 0 ? -0.5 : 0.5)),
+                  "\n structure: %s   pair table = %d , string = %6.2f\n",
+                  structures[i], e_pt, e);
+    free(pt);
+  }
+
+  vrna_fold_compound_free(vc);
+}
@@ -1,5 +1,6 @@
 #include <stdio.h>      /* printf, scanf, NULL */
 #include <stdlib.h>     /* malloc, free, rand */
+#include <string.h>
 
 #include <ViennaRNA/fold_vars.h>
 #include <ViennaRNA/data_structures.h>
@@ -7,8 +8,58 @@
 #include <ViennaRNA/utils/structures.h>
 #include <ViennaRNA/constraints/basic.h>
 #include <ViennaRNA/fold.h>
+#include <ViennaRNA/mfe.h>
 #include <ViennaRNA/part_func.h>
 
+/* forbid every fifth pair (k,l) to be enclosed by an interior loop */
+static unsigned char
+hc_interior_cb(int            i,
+               int            j,
+               int            k,
+               int            l,
+               unsigned char  d,
+               void           *data)
+{
+  (void)i;
+  (void)j;
+  (void)data;
+
+  if ((d == VRNA_DECOMP_PAIR_IL) && ((k + l) % 5 == 0))
+    return (unsigned char)0;
+
+  return (unsigned char)1;
+}
+
+
+/* add the same constraints to fold compounds of either type */
+static void
+add_constraints(vrna_fold_compound_t  *fc,
+                int                   setup,
+                unsigned int          options)
+{
+  unsigned int  i;
+
+  switch (setup) {
+    case 1:
+      /* soft constraints without callback, i.e. SHAPE-like pseudo energies */
+      for (i = 1; i <= fc->length; i++) {
+        vrna_sc_add_up(fc, (int)i, (FLT_OR_DBL)(i % 7) * 0.3, options);
+        if (i + 20 <= fc->length)
+          vrna_sc_add_bp(fc, (int)i, (int)i + 20, -0.4, options);
+      }
+
+      break;
+
+    case 2:
+      vrna_hc_add_f(fc, &hc_interior_cb);
+      break;
+
+    default:
+      break;
+  }
+}
+
+
 #suite  MFE_Prediction
 
 #tcase  Backward_Compatibility
@@ -24,6 +75,165 @@
   free(structure);
 }
 
+#tcase  Parallel_Fill
+
+#test test_mfe_num_threads
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  s1[sizeof(sequence)], s2[sizeof(sequence)];
+  float                 mfe1, mfe2;
+  int                   noLP;
+
+  for (noLP = 0; noLP <= 1; noLP++) {
+    vrna_md_set_default(&md);
+    md.noLP = noLP;
+
+    fc    = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    mfe1  = vrna_mfe(fc, s1);
+    vrna_fold_compound_free(fc);
+
+    fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    ck_assert(vrna_fold_compound_num_threads(fc, 4));
+    mfe2 = vrna_mfe(fc, s2);
+    vrna_fold_compound_free(fc);
+
+    ck_assert(mfe1 == mfe2);
+    ck_assert(strcmp(s1, s2) == 0);
+  }
+}
+
+#tcase  Batch
+
+#test test_mfe_batch
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            *sequences[] = {
+    "CGCAGGGAUACCCGCG",
+    "GGGGAAAACCCC",
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCC",
+    "GCGCUUCGGCGC",
+    "ACGU",
+    "GUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAUAAAUUU",
+    "AUAUAUAUAUAUAUAUAUAU",
+    "CGCAGGGAUACCCGCG"
+  };
+  unsigned int          i, num = sizeof(sequences) / sizeof(sequences[0]);
+  char                  *structures[sizeof(sequences) / sizeof(sequences[0])], *s;
+  float                 *mfe, en;
+  int                   d;
+
+  for (d = 0; d <= 2; d++) {
+    vrna_md_defaults_reset(NULL);
+    vrna_md_defaults_dangles(d);
+    vrna_md_set_default(&md);
+
+    for (i = 0; i < num; i++)
+      structures[i] = (char *)vrna_alloc(sizeof(char) * (strlen(sequences[i]) + 1));
+
+    mfe = vrna_mfe_batch(sequences, num, &md, structures);
+    ck_assert(mfe != NULL);
+
+    for (i = 0; i < num; i++) {
+      s   = (char *)vrna_alloc(sizeof(char) * (strlen(sequences[i]) + 1));
+      fc  = vrna_fold_compound(sequences[i], &md, VRNA_OPTION_DEFAULT);
+      en  = vrna_mfe(fc, s);
+
+      ck_assert(en == mfe[i]);
+      ck_assert(strcmp(s, structures[i]) == 0);
+
+      vrna_fold_compound_free(fc);
+      free(s);
+      free(structures[i]);
+    }
+
+    free(mfe);
+  }
+
+  vrna_md_defaults_reset(NULL);
+}
+
+#tcase  Prefix
+
+#test test_mfe_prefix
+{
+  vrna_fold_compound_t  *fc, *fc_prefix;
+  const char            *seq = "GUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAUAAAUUU";
+  char                  *prefix, *s;
+  float                 *mfe, en;
+  unsigned int          k, n;
+
+  n       = strlen(seq);
+  prefix  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s       = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  fc      = vrna_fold_compound(seq, NULL, VRNA_OPTION_DEFAULT);
+  mfe     = vrna_mfe_prefix(fc);
+
+  ck_assert(mfe != NULL);
+
+  for (k = 1; k <= n; k++) {
+    memcpy(prefix, seq, sizeof(char) * k);
+    prefix[k] = '\0';
+
+    fc_prefix = vrna_fold_compound(prefix, NULL, VRNA_OPTION_DEFAULT);
+    en        = vrna_mfe(fc_prefix, s);
+
+    ck_assert(en == mfe[k]);
+
+    vrna_fold_compound_free(fc_prefix);
+  }
+
+  free(mfe);
+  free(s);
+  free(prefix);
+  vrna_fold_compound_free(fc);
+}
+
+#tcase  Instrumentation
+
+#test test_timing
+{
+  vrna_fold_compound_t  *fc;
+  const char            *seq = "GUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAUAAAUUU";
+  char                  *s, *json;
+  unsigned long long    n;
+
+  n   = strlen(seq);
+  s   = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  fc  = vrna_fold_compound(seq, NULL, VRNA_OPTION_DEFAULT);
+
+  ck_assert(fc->timing == NULL);
+  ck_assert_int_eq(vrna_fold_compound_timing(fc, 1), 1);
+
+  (void)vrna_mfe(fc, s);
+
+  ck_assert(fc->timing->phase[VRNA_TIMING_FILL].cells == n * (n + 1) / 2);
+  ck_assert(fc->timing->phase[VRNA_TIMING_FILL].bytes > 0);
+  ck_assert(fc->timing->phase[VRNA_TIMING_BACKTRACK].cells == n);
+  ck_assert(fc->timing->phase[VRNA_TIMING_OUTSIDE].cells == 0);
+
+  (void)vrna_pf(fc, s);
+
+  ck_assert(fc->timing->phase[VRNA_TIMING_FILL].cells == n * (n + 1));
+  ck_assert(fc->timing->phase[VRNA_TIMING_OUTSIDE].cells == n * (n + 1) / 2);
+
+  json = vrna_timing_to_json(fc->timing);
+  ck_assert(strstr(json, "\"outside\": {") != NULL);
+  free(json);
+
+  vrna_timing_reset(fc->timing);
+  ck_assert(fc->timing->phase[VRNA_TIMING_FILL].cells == 0);
+
+  ck_assert_int_eq(vrna_fold_compound_timing(fc, 0), 0);
+  ck_assert(fc->timing == NULL);
+
+  free(s);
+  vrna_fold_compound_free(fc);
+}
+
 #suite  Partition_Function
 
 #tcase Stochastic_Backtracking
@@ -55,6 +265,403 @@
   vrna_fold_compound_free(vc);
 }
 
+
+#test test_sample_structure_seeded
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  **s1, **s2, **s3;
+  int                   i;
+  vrna_rng_t            *rng;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+
+  vrna_pf(vc, NULL);
+
+  vrna_fold_compound_rng_seed(vc, 42, 0);
+  s1 = vrna_pbacktrack_num(vc, 20, VRNA_PBACKTRACK_DEFAULT);
+
+  vrna_fold_compound_rng_seed(vc, 42, 0);
+  s2 = vrna_pbacktrack_num(vc, 20, VRNA_PBACKTRACK_DEFAULT);
+
+  /* a generator bound to the thread takes precedence */
+  rng = vrna_rng_init(42, 0);
+  vrna_fold_compound_rng_seed(vc, 7, 1);
+  vrna_rng_thread_set(rng);
+  s3 = vrna_pbacktrack_num(vc, 20, VRNA_PBACKTRACK_DEFAULT);
+  vrna_rng_thread_set(NULL);
+
+  for (i = 0; i < 20; i++) {
+    ck_assert_str_eq(s1[i], s2[i]);
+    ck_assert_str_eq(s1[i], s3[i]);
+    free(s1[i]);
+    free(s2[i]);
+    free(s3[i]);
+  }
+
+  free(s1);
+  free(s2);
+  free(s3);
+  vrna_rng_free(rng);
+  vrna_fold_compound_free(vc);
+}
+
+
+#test test_sample_structure_num_threads
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  **s1, **s2, **s3;
+  int                   i, j, n;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+
+  vrna_pf(vc, NULL);
+
+  vrna_fold_compound_num_threads(vc, 1);
+  vrna_fold_compound_rng_seed(vc, 42, 0);
+  s1 = vrna_pbacktrack_num(vc, 100, VRNA_PBACKTRACK_DEFAULT);
+
+  vrna_fold_compound_num_threads(vc, 4);
+  vrna_fold_compound_rng_seed(vc, 42, 0);
+  s2 = vrna_pbacktrack_num(vc, 100, VRNA_PBACKTRACK_DEFAULT);
+
+  vrna_fold_compound_rng_seed(vc, 42, 0);
+  s3 = vrna_pbacktrack_num(vc, 100, VRNA_PBACKTRACK_UNORDERED);
+
+  /* ordered delivery reproduces the sequential order */
+  for (i = 0; i < 100; i++)
+    ck_assert_str_eq(s1[i], s2[i]);
+
+  /* unordered delivery yields the same samples */
+  for (n = 0; s3[n]; n++) {
+    for (j = 0; j < 100; j++)
+      if ((s2[j]) && (!strcmp(s2[j], s3[n]))) {
+        free(s2[j]);
+        s2[j] = NULL;
+        break;
+      }
+
+    ck_assert_int_lt(j, 100);
+  }
+
+  ck_assert_int_eq(n, 100);
+
+  for (i = 0; i < 100; i++) {
+    free(s1[i]);
+    free(s3[i]);
+  }
+
+  free(s1);
+  free(s2);
+  free(s3);
+  vrna_fold_compound_free(vc);
+}
+
+#test test_sample_structure_nr_num_threads
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  vrna_pbacktrack_mem_t nr_mem, nr_mem2;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  **s1, **s2, **s3;
+  int                   i, j, n;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+
+  vrna_pf(vc, NULL);
+
+  vrna_fold_compound_num_threads(vc, 4);
+  vrna_fold_compound_rng_seed(vc, 42, 0);
+  nr_mem  = NULL;
+  s1      = vrna_pbacktrack_resume(vc, 200, &nr_mem, VRNA_PBACKTRACK_NON_REDUNDANT);
+  s2      = vrna_pbacktrack_resume(vc, 200, &nr_mem, VRNA_PBACKTRACK_NON_REDUNDANT);
+
+  /* same seed, same number of threads, same samples */
+  vrna_fold_compound_rng_seed(vc, 42, 0);
+  nr_mem2 = NULL;
+  s3      = vrna_pbacktrack_resume(vc, 200, &nr_mem2, VRNA_PBACKTRACK_NON_REDUNDANT);
+
+  for (n = 0; s1[n]; n++)
+    ck_assert_str_eq(s1[n], s3[n]);
+
+  ck_assert_int_eq(n, 200);
+
+  /* all 400 samples are unique */
+  for (i = 0; i < 200; i++) {
+    ck_assert(s2[i] != NULL);
+    for (j = 0; j < 200; j++) {
+      ck_assert_str_ne(s1[i], s2[j]);
+      if (j > i) {
+        ck_assert_str_ne(s1[i], s1[j]);
+        ck_assert_str_ne(s2[i], s2[j]);
+      }
+    }
+  }
+
+  for (i = 0; i < 200; i++) {
+    free(s1[i]);
+    free(s2[i]);
+    free(s3[i]);
+  }
+
+  free(s1);
+  free(s2);
+  free(s3);
+  vrna_pbacktrack_mem_free(nr_mem);
+  vrna_pbacktrack_mem_free(nr_mem2);
+  vrna_fold_compound_free(vc);
+}
+
+#test test_sample_structure_nr_num_threads_distribution
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  vrna_pbacktrack_mem_t nr_mem;
+  const char            sequence[] = "GGGAAAUCCCAGCUAGCGAUCGAUGCUAGGGC";
+  char                  **s, *structures[1000];
+  unsigned int          counts[2][1000], num_structures, rep, t, n, k;
+  double                d;
+
+  num_structures = 0;
+  memset(counts, 0, sizeof(counts));
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+
+  vrna_pf(vc, NULL);
+
+  /*
+   *  The probability of each structure to be part of a non-redundant sample
+   *  set must not depend on whether the samples are drawn by a single thread
+   *  or by several threads that extend the prefix tree concurrently
+   */
+  for (t = 0; t < 2; t++) {
+    vrna_fold_compound_num_threads(vc, (t == 0) ? 1 : 4);
+
+    for (rep = 0; rep < 1000; rep++) {
+      vrna_fold_compound_rng_seed(vc, 1000 * t + rep, 0);
+      nr_mem  = NULL;
+      s       = vrna_pbacktrack_resume(vc, 10, &nr_mem, VRNA_PBACKTRACK_NON_REDUNDANT);
+
+      for (n = 0; s[n]; n++) {
+        for (k = 0; k < num_structures; k++)
+          if (!strcmp(s[n], structures[k]))
+            break;
+
+        if (k == num_structures) {
+          ck_assert(num_structures < 1000);
+          structures[num_structures++] = strdup(s[n]);
+        }
+
+        counts[t][k]++;
+        free(s[n]);
+      }
+
+      ck_assert_int_eq(n, 10);
+
+      free(s);
+      vrna_pbacktrack_mem_free(nr_mem);
+    }
+  }
+
+  for (k = 0; k < num_structures; k++) {
+    d = ((double)counts[0][k] - (double)counts[1][k]) / 1000.;
+    ck_assert(d < 0.1);
+    ck_assert(d > -0.1);
+    free(structures[k]);
+  }
+
+  vrna_fold_compound_free(vc);
+}
+
+#tcase  Parallel_Recursions
+
+#test test_pf_num_threads
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  FLT_OR_DBL            *probs;
+  double                ens1, ens2;
+  unsigned int          size;
+
+  size = (sizeof(sequence) * (sizeof(sequence) + 1)) / 2;
+
+  vrna_md_set_default(&md);
+
+  fc    = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  ens1  = vrna_pf(fc, NULL);
+  probs = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+  memcpy(probs, fc->exp_matrices->probs, sizeof(FLT_OR_DBL) * size);
+  vrna_fold_compound_free(fc);
+
+  fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  vrna_fold_compound_num_threads(fc, 4);
+  ens2 = vrna_pf(fc, NULL);
+
+  /* results must not depend on the number of threads */
+  ck_assert(ens1 == ens2);
+  ck_assert(memcmp(probs, fc->exp_matrices->probs, sizeof(FLT_OR_DBL) * size) == 0);
+
+  vrna_fold_compound_free(fc);
+  free(probs);
+}
+
+#tcase  Banded
+
+#test test_pf_banded
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  double                ens1, ens2;
+
+  vrna_md_set_default(&md);
+  md.max_bp_span  = 40;
+  md.window_size  = 40;
+
+  fc    = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  ens1  = vrna_pf(fc, NULL);
+  vrna_fold_compound_free(fc);
+
+  /* banded matrices must yield the same ensemble as the span-limited full matrices */
+  fc    = vrna_fold_compound(sequence, &md, VRNA_OPTION_WINDOW);
+  ens2  = vrna_pf(fc, NULL);
+
+  ck_assert(ens1 - ens2 < 1e-4);
+  ck_assert(ens2 - ens1 < 1e-4);
+
+  vrna_fold_compound_free(fc);
+}
+
+#test test_interior_loop_variants
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_banded;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  *s1, *s2;
+  float                 mfe1, mfe2;
+  double                e, ens1, ens2;
+  int                   setup, n;
+
+  n = (int)strlen(sequence);
+
+  vrna_md_set_default(&md);
+  md.max_bp_span  = n;
+  md.window_size  = n;
+
+  s1  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s2  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  /*
+   *  the full matrix fills decompose interior loops through the variants
+   *  instantiated from internal_window*.inc, the banded fills use the
+   *  generic decomposition. Both must agree for default constraints,
+   *  soft constraint arrays, and hard constraint callbacks
+   */
+  for (setup = 0; setup <= 2; setup++) {
+    fc        = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    fc_banded = vrna_fold_compound(sequence, &md, VRNA_OPTION_WINDOW);
+
+    add_constraints(fc, setup, VRNA_OPTION_DEFAULT);
+    add_constraints(fc_banded, setup, VRNA_OPTION_WINDOW);
+
+    mfe1  = vrna_mfe(fc, s1);
+    mfe2  = vrna_mfe(fc_banded, s2);
+
+    ck_assert(mfe1 == mfe2);
+    ck_assert(strcmp(s1, s2) == 0);
+
+    /* the banded partition function does not support hard constraint callbacks */
+    if (setup != 2) {
+      e = (double)mfe1;
+      vrna_exp_params_rescale(fc, &e);
+      vrna_exp_params_rescale(fc_banded, &e);
+
+      ens1  = vrna_pf(fc, NULL);
+      ens2  = vrna_pf(fc_banded, NULL);
+
+      ck_assert(ens1 - ens2 < 1e-4);
+      ck_assert(ens2 - ens1 < 1e-4);
+    }
+
+    vrna_fold_compound_free(fc);
+    vrna_fold_compound_free(fc_banded);
+  }
+
+  free(s1);
+  free(s2);
+}
+
+#test test_mfe_banded_dangles
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_banded;
+  char                  *sequence, *s1, *s2;
+  float                 mfe1, mfe2;
+  int                   d, i, n;
+
+  n         = 400;
+  sequence  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s1        = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s2        = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  for (i = 0; i < n; i++)
+    sequence[i] = "ACGU"[(i * 7 + (i / 3) * 5 + (i * i) % 11) % 4];
+
+  for (d = 0; d <= 3; d++) {
+    vrna_md_set_default(&md);
+    md.dangles      = d;
+    md.max_bp_span  = 40;
+    md.window_size  = 40;
+
+    fc        = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    fc_banded = vrna_fold_compound(sequence, &md, VRNA_OPTION_WINDOW);
+
+    mfe1  = vrna_mfe(fc, s1);
+    mfe2  = vrna_mfe(fc_banded, s2);
+
+    if (d % 2) {
+      /* odd dangle models are rejected by the banded implementation */
+      ck_assert(mfe2 == (float)(INF / 100.));
+    } else {
+      ck_assert(mfe1 == mfe2);
+      ck_assert(strcmp(s1, s2) == 0);
+    }
+
+    vrna_fold_compound_free(fc);
+    vrna_fold_compound_free(fc_banded);
+  }
+
+  free(sequence);
+  free(s1);
+  free(s2);
+}
+
 #suite  Constraints_Implementation
 
 #tcase  Soft_Constraints
@@ -4,6 +4,7 @@ RNApath.addSwigInterfacePath()
 
 import RNA
 import unittest
+import json
 
 seq1          = "CGCAGGGAUACCCGCG"
 struct1       = "(((.(((...))))))"
@@ -24,6 +25,18 @@ class mfe_eval_functionTest(unittest.TestCase):
         self.assertEqual(ss,struct1)
 
 
+    def test_mfe_timing(self):
+        print "test_mfe_timing"
+        fc = RNA.fold_compound(seq1)
+        self.assertEqual(fc.timing(), 1)
+        (ss,mfe) = fc.mfe()
+        phases = json.loads(fc.timing_json())
+        self.assertEqual(phases["fill"]["cells"], len(seq1) * (len(seq1) + 1) // 2)
+        self.assertEqual(phases["backtrack"]["cells"], len(seq1))
+        self.assertEqual(fc.timing(0), 0)
+        self.assertEqual(fc.timing_json(), "")
+
+
     def test_mfe_Dimer(self):
         print "test_mfe_Dimer"
         fc=RNA.fold_compound(seq1Dimer)
@@ -1,8 +1,25 @@
 #include <stdlib.h>
+#include <math.h>
 
 #include <ViennaRNA/model.h>
 #include <ViennaRNA/utils/basic.h>
 #include <ViennaRNA/alphabet.h>
+#include <ViennaRNA/utils/higher_order_functions.h>
+#include <ViennaRNA/datastructures/stream_output.h>
+
+static void
+ostream_check_order(void          *auxdata,
+                    unsigned int  i,
+                    void          *data)
+{
+  unsigned int *next = (unsigned int *)auxdata;
+
+  ck_assert_uint_eq(i, *next);
+  ck_assert_uint_eq(*((unsigned int *)data), i);
+  (*next)++;
+  free(data);
+}
+
 
 #suite Utilities
 
@@ -205,3 +222,161 @@
 //@TODO: extend alphabeth
 //@TODO: details.noLP = 1
 //@TODO: idx_type = 1
+
+#tcase Higher_Order_Functions
+
+#test test_vrna_fun_zip_add_min
+{
+  int e1[100], e2[100], i, n, r, r_ref, idx, idx_ref;
+
+  srand(42);
+
+  for (n = 0; n < 100; n++) {
+    for (i = 0; i < n; i++) {
+      e1[i] = (rand() % 4) ? rand() % 100 - 50 : INF;
+      e2[i] = (rand() % 4) ? rand() % 100 - 50 : INF;
+    }
+
+    vrna_fun_dispatch_disable();
+    r_ref = vrna_fun_zip_add_min(e1, e2, n);
+    ck_assert_int_eq(vrna_fun_zip_add_min_idx(e1, e2, n, &idx_ref), r_ref);
+
+    if (r_ref == INF)
+      ck_assert_int_eq(idx_ref, -1);
+    else
+      ck_assert_int_eq(e1[idx_ref] + e2[idx_ref], r_ref);
+
+    vrna_fun_dispatch_enable();
+    r = vrna_fun_zip_add_min(e1, e2, n);
+    ck_assert_int_eq(r, r_ref);
+
+    r = vrna_fun_zip_add_min_idx(e1, e2, n, &idx);
+    ck_assert_int_eq(r, r_ref);
+    ck_assert_int_eq(idx, idx_ref);
+  }
+}
+
+
+#test test_vrna_fun_zip_mult_sum
+{
+  int         i, n;
+  FLT_OR_DBL  e1[100], e2[100], r, r_rev, ref, ref_rev;
+
+  srand(42);
+
+  for (n = 0; n < 100; n++) {
+    for (i = 0; i < n; i++) {
+      e1[i] = (FLT_OR_DBL)rand() / (FLT_OR_DBL)RAND_MAX;
+      e2[i] = (FLT_OR_DBL)rand() / (FLT_OR_DBL)RAND_MAX;
+    }
+
+    vrna_fun_dispatch_disable();
+    ref     = vrna_fun_zip_mult_sum(e1, e2, n);
+    ref_rev = vrna_fun_zip_mult_sum_rev(e1, e2, n);
+
+    vrna_fun_dispatch_enable();
+    r     = vrna_fun_zip_mult_sum(e1, e2, n);
+    r_rev = vrna_fun_zip_mult_sum_rev(e1, e2, n);
+
+    ck_assert(fabs(r - ref) <= 1e-5 * (1. + ref));
+    ck_assert(fabs(r_rev - ref_rev) <= 1e-5 * (1. + ref_rev));
+  }
+}
+
+
+#tcase Random_Numbers
+
+#test test_vrna_rng
+{
+  int         i;
+  double      r[100], v;
+  vrna_rng_t  *rng, *rng2, *prev;
+
+  /* Philox4x32-10 known answer for zero key and counter */
+  rng = vrna_rng_init(0, 0);
+  ck_assert_uint_eq(vrna_rng_uint32(rng), 0x6627e8d5);
+  ck_assert_uint_eq(vrna_rng_uint32(rng), 0xe169c58d);
+  ck_assert_uint_eq(vrna_rng_uint32(rng), 0xbc57ac4c);
+  ck_assert_uint_eq(vrna_rng_uint32(rng), 0x9b00dbd8);
+
+  /* same seed and stream reproduce the same numbers */
+  vrna_rng_seed(rng, 4711, 3);
+  for (i = 0; i < 100; i++) {
+    r[i] = vrna_rng_urn(rng);
+    ck_assert(r[i] >= 0. && r[i] < 1.);
+  }
+
+  rng2 = vrna_rng_init(4711, 3);
+  for (i = 0; i < 100; i++)
+    ck_assert(vrna_rng_urn(rng2) == r[i]);
+
+  /* skipping ahead is equivalent to drawing */
+  for (i = 0; i < 100; i++) {
+    vrna_rng_seed(rng2, 4711, 3);
+    vrna_rng_skip(rng2, i);
+    ck_assert(vrna_rng_urn(rng2) == r[i]);
+  }
+
+  vrna_rng_seed(rng2, 4711, 3);
+  vrna_rng_urn(rng2);
+  vrna_rng_skip(rng2, 41);
+  ck_assert(vrna_rng_urn(rng2) == r[42]);
+
+  /* different streams are different */
+  vrna_rng_free(rng2);
+  rng2 = vrna_rng_stream(rng, 4);
+  ck_assert(vrna_rng_urn(rng2) != r[0]);
+
+  for (i = 0; i < 1000; i++) {
+    int k = vrna_rng_int_urn(rng2, -3, 5);
+    ck_assert_int_ge(k, -3);
+    ck_assert_int_le(k, 5);
+  }
+
+  /* thread-bound generator drives vrna_urn() */
+  vrna_rng_seed(rng, 4711, 3);
+  prev = vrna_rng_thread_set(rng);
+  ck_assert(vrna_rng_thread_get() == rng);
+  for (i = 0; i < 100; i++)
+    ck_assert(vrna_urn() == r[i]);
+
+  vrna_rng_thread_set(prev);
+  v = vrna_urn();
+  ck_assert(v >= 0. && v <= 1.);
+
+  vrna_rng_free(rng);
+  vrna_rng_free(rng2);
+}
+
+#tcase Ordered_Stream
+
+#test test_vrna_ostream
+{
+  unsigned int    i, j, *d, next, order[8] = {
+    3, 1, 0, 2, 7, 5, 6, 4
+  };
+  vrna_ostream_t  queue;
+
+  for (j = 0; j < 2; j++) {
+    next  = 0;
+    queue = (j == 0) ?
+            vrna_ostream_init(&ostream_check_order, (void *)&next) :
+            vrna_ostream_init_bounded(&ostream_check_order, (void *)&next, 4);
+
+    /* provide data out of order within blocks of 4 */
+    for (i = 0; i < 8; i++) {
+      if (i % 4 == 0) {
+        vrna_ostream_request(queue, i);
+        vrna_ostream_request(queue, i + 3);
+      }
+
+      d   = (unsigned int *)vrna_alloc(sizeof(unsigned int));
+      *d  = order[i];
+      vrna_ostream_provide(queue, order[i], (void *)d);
+    }
+
+    vrna_ostream_free(queue);
+
+    ck_assert_uint_eq(next, 8);
+  }
+}
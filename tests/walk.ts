@@ -1,6 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#include <string.h>
 #include <ViennaRNA/landscape/walk.h>
+#include <ViennaRNA/landscape/findpath.h>
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/mfe.h>
+#include <ViennaRNA/eval.h>
 #include <ViennaRNA/model.h>
 #include <ViennaRNA/utils/structures.h>
 #include <ViennaRNA/data_structures.h>
@@ -48,3 +54,51 @@
   free(resultMoves);
   free(resultStructure);
 }
+
+
+#test Findpath_Verify_Energies
+{
+  const char            *sequence =
+    "GGGCGCGGUUCGCCCAUGCAGCUACGACGUAGCAGCUGCAUAAGCGAUCGCUUAGCCGAUCGGCAAUUGCCUUUAAAG";
+  char                  *mfe_structure, *open_chain;
+  int                   n, verify;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  vrna_path_t           *path[2], *p, *q;
+  vrna_path_options_t   options;
+
+  vrna_md_set_default(&md);
+  fc            = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  n             = (int)strlen(sequence);
+  mfe_structure = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  open_chain    = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  (void)vrna_mfe(fc, mfe_structure);
+  memset(open_chain, '.', sizeof(char) * n);
+
+  /* incremental energies must agree with full evaluation, with and without verification */
+  for (verify = 0; verify < 2; verify++) {
+    options = vrna_path_options_findpath(10,
+                                         VRNA_PATH_TYPE_DOT_BRACKET |
+                                         (verify ? VRNA_PATH_VERIFY_ENERGIES : 0U));
+    path[verify] = vrna_path_direct(fc, open_chain, mfe_structure, options);
+    vrna_path_options_free(options);
+    ck_assert(path[verify] != NULL);
+
+    for (p = path[verify]; p->s; p++)
+      ck_assert(fabs(p->en - vrna_eval_structure(fc, p->s)) < 1e-3);
+  }
+
+  for (p = path[0], q = path[1]; p->s && q->s; p++, q++) {
+    ck_assert_str_eq(p->s, q->s);
+    ck_assert(p->en == q->en);
+  }
+
+  ck_assert((p->s == NULL) && (q->s == NULL));
+
+  vrna_path_free(path[0]);
+  vrna_path_free(path[1]);
+  vrna_fold_compound_free(fc);
+  free(mfe_structure);
+  free(open_chain);
+}